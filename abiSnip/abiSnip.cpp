@@ -77,6 +77,32 @@
 			Add Snipping Tool 11 on Windows 11 24H2 computers for "Edit last screenshot..."
 			Add option to disable PrintScreenKeyForSnippingEnabled
             Version update to 1.0.0.5
+  20261016, Screenshot is stored in a DIB section and pixel operations (pixelate, mark,
+            zoom, color change search) work directly on the pixel buffer
+            Pixelate with SSE2/AVX2 block averaging, partial blocks at the right and bottom border are pixelated too
+            Pixelate large areas in parallel on a small worker pool
+            Search color change for Shift+cursor keys with SSE2/AVX2 compares
+            Color tolerance for Shift+cursor keys can be set by registry, color changes are looked up in an edge index built in the background
+            Darkened background is created once per screenshot instead of AlphaBlend on every paint
+            Repaint only changed areas (frame, zoom boxes, internal information) while selecting, painted pixels shown in internal information
+            Output buffer, fonts and brushes for painting are created once per capture instead of every paint, paint time shown in internal information
+            Built-in PNG encoder (filter, deflate, CRC, chunks) replaces GDI+
+            Large PNG files are compressed in parallel chunks on the worker pool
+            Compression profile (fast, balanced, smallest) for PNG files can be set by registry or GPO
+            PNG filter is selected per row (sum of absolute differences), filters with SSE2/AVX2 kernels
+            Screenshots with max. 256 colors are saved as indexed PNG (bit depth 1, 2, 4 or 8)
+            Screenshot files are written by a background writer thread (bounded queue), save queue shown in internal information
+            PNG encoder and clipboard (CF_DIB) read the selection directly from the screenshot without a cropped bitmap
+            Screenshot is freed while waiting in the tray, optional run-length encoded copy for "Reopen last capture", working set shown in program information
+            Capture surfaces are reused from a pool while the virtual screen size is unchanged (released on display change, low memory or idle), capture time shown in internal information
+            Latency from Print screen key to the first frame is measured per stage, shown in internal information and optionally logged to %TEMP%\abiSnipLatency.log
+            Optional Chrome trace-event JSON (%TEMP%\abiSnipTrace.json) for capture, paint, pixelate, mark, crop, encode and file write (registry value trace or /trace)
+            Settings are read from an in-memory snapshot of the registry, which is refreshed by registry change notifications
+            Capture sources deliver the frame with its monitor layout (GDI for the desktop, replay of recorded frames by /replay=, recording by /record=)
+            Optional parallel capture of each monitor by its own thread (registry value parallelMonitorCapture), gaps between monitors are filled with a defined color
+            Optional capture of only the monitor under the mouse cursor (registry value or GPO captureMonitorOnly or /m)
+            Optional rolling history of background captures in the tray (keyframes and changed 64x64 tiles), earlier frames can be selected with the keys , and .
+            Repeated captures by /interval= with /count= or /duration=, equal captures are skipped by hash, files are encoded while the next capture runs
 
 ===================================================================+*/
 
@@ -94,24 +120,35 @@
 #include <wingdi.h>
 #include <shlwapi.h>
 #include <shlobj.h>
-#include <gdiplus.h>
+#include <psapi.h>
+#include <new>
 #include <string>
 #include <sysinfoapi.h>
+#include <thread>
 #include <vector>
 #pragma warning(push)
 #pragma warning(disable : 4005)
 #include <ntstatus.h>
 #pragma warning(pop)
 #include "resource.h"
+#include "imageBuffer.h"
+#include "pixelate.h"
+#include "colorScan.h"
+#include "edgeIndex.h"
+#include "pngEncoder.h"
+#include "saveQueue.h"
+#include "imageRLE.h"
+#include "trace.h"
+#include "settingsResolver.h"
+#include "captureSource.h"
+#include "captureHistory.h"
 
 // Library-search records for visual studio
-#pragma comment(lib,"msimg32")
 #pragma comment(lib,"Shlwapi")
-#pragma comment(lib,"Gdiplus")
 #pragma comment(lib,"Version")
 #pragma comment(lib,"Comctl32")
+#pragma comment(lib,"Psapi")
 
-using namespace Gdiplus;
 // Defines
 #define REGISTRYSETTINGSPATH L"SOFTWARE\\codingABI\\abiSnip" // Registry path under HKCU to store program settings
 #define REGISTRYGPOPATH L"SOFTWARE\\Policies\\codingABI\\abiSnip" // GPO path under HKLM/HKCU to force program settings
@@ -130,8 +167,35 @@ using namespace Gdiplus;
 #define DEFAULTUSEALTERNATIVECOLORS FALSE // TRUE, when alternative colors are enabled
 #define DEFAULTSHOWDISPLAYINFORMATION FALSE // TRUE, when drawing internal information on screen is enabled
 #define PIXELATEFACTOR 8 // Factor for pixelating an area with key "p"
+#define DEFAULTCOLORTOLERANCE 0 // Default max difference per color channel for Shift+cursor keys (0 = every color change)
+#define MAXCOLORTOLERANCE 255 // Max difference per color channel for Shift+cursor keys
+#define DEFAULTCOMPRESSIONPROFILE pngProfileBalanced // Default compression profile for PNG files
+#define MAXCOMPRESSIONPROFILE pngProfileSmallest // Max value of compression profile
+#define SURFACEPOOLMAX 1 // Max capture surfaces in the pool (only the screenshot, the darkened copy is deleted in the tray)
+#define SURFACEPOOLIDLETIME 60 // Seconds in the tray until the surface pool is released
+#define SURFACEPOOLCHECKINTERVAL 10 // Seconds between two checks for low memory and idle time of the surface pool
+#define DEFAULTLATENCYLOG FALSE // TRUE, when the latency stages of each capture are logged
+#define LATENCYLOGFILE L"abiSnipLatency.log" // Log file in %TEMP% for the latency stages
+#define LATENCYLOGMAXSIZE (1024 * 1024) // Max size in bytes of the latency log (log is started again, when it is bigger)
+#define DEFAULTTRACE FALSE // TRUE, when the capture pipeline is traced
+#define DEFAULTPARALLELMONITORCAPTURE FALSE // TRUE, when each monitor is captured by its own thread
+#define DEFAULTCAPTUREMONITORONLY FALSE // TRUE, when only the monitor under the mouse cursor is captured
+#define DEFAULTCAPTUREHISTORY 0 // Seconds of background captures kept in the capture history (0 = disabled)
+#define MAXCAPTUREHISTORY 60 // Max seconds of the capture history
+#define DEFAULTCAPTUREHISTORYINTERVAL 500 // Milliseconds between two background captures for the capture history
+#define MINCAPTUREHISTORYINTERVAL 100 // Min milliseconds between two background captures
+#define MAXCAPTUREHISTORYINTERVAL 10000 // Max milliseconds between two background captures
+#define DEFAULTCAPTUREHISTORYMEMORY 256 // Memory budget in MB of the capture history
+#define MINCAPTUREHISTORYMEMORY 64 // Min memory budget in MB of the capture history (has to hold at least an uncompressed copy of the virtual screen)
+#define MAXCAPTUREHISTORYMEMORY 4096 // Max memory budget in MB of the capture history
+#define MINCAPTUREINTERVAL 50 // Min milliseconds between two captures of /interval=
+#define MONITORGAPCOLOR IMAGEPIXELRGB(0, 0, 0) // Color for areas of the virtual screen without a monitor
+#define TRACEFILE L"abiSnipTrace.json" // Chrome trace-event JSON file in %TEMP%
+#define DEFAULTKEEPLASTCAPTURE FALSE // TRUE, when a compressed copy of the last capture is kept in the tray for "Reopen last capture"
 #define MARKEDWIDTH 3 // Line width when marking selected area
 #define MARKEDALPHA 128 // Alpha value when marking selected area
+#define DIMMEDALPHA 50 // Brightness (0-255) of the darkened screenshot in the background while selecting
+#define OVERLAYMARGIN 64 // Margin in pixels around selection frame and zoom boxes for labels, when invalidating only changed areas
 #define UNINITIALIZEDLONG (LONG) 0x80000000 // Value for uninitialized pixel positions
 
 // Default colors
@@ -144,6 +208,7 @@ using namespace Gdiplus;
 
 // Vector to store monitor positions
 std::vector<RECT> g_rectMonitor;
+RECT g_captureRect = { 0 }; // Virtual screen rectangle of the screenshot (from the capture source)
 DWORD g_selectedMonitor = 0;
 
 // Cursor types
@@ -161,6 +226,18 @@ enum APPSTATE {
 	statePointB, // Selection/Modification of point B in fullscreen mode
 };
 
+// Stages from the Print screen key to the first painted frame
+enum LATENCYSTAGE {
+	latencyHook, // Print screen key in KeyboardProc
+	latencyStarted, // WM_STARTED is processed
+	latencyCaptured, // CaptureScreen is finished (includes the monitor layout of the capture)
+	latencySettings, // Settings are refreshed from registry
+	latencyFullScreen, // Window is fullscreen and visible
+	latencyFocused, // Window has the input focus
+	latencyFirstFrame // First WM_PAINT is finished
+};
+#define LATENCYSTAGES 7 // Number of latency stages
+
 // Simple DWORD settings
 enum APPDWORDSETTINGS {
 	defaultZoomScale,
@@ -174,14 +251,80 @@ enum APPDWORDSETTINGS {
 	storedSelectionRight,
 	storedSelectionBottom,
 	disablePrintScreenKeyForSnipping,
+	colorTolerance,
+	compressionProfile,
+	keepLastCapture,
+	latencyLog,
+	trace,
+	parallelMonitorCapture,
+	captureMonitorOnly,
+	captureHistory,
+	captureHistoryInterval,
+	captureHistoryMemory,
 	DEV
 };
+#define APPDWORDSETTINGSCOUNT (DEV + 1) // Number of APPDWORDSETTINGS (DEV has to be the last one)
+
+// Registry values of all settings, read at once and refreshed after registry change notifications
+struct SETTINGSSNAPSHOT {
+	DWORDSETTINGCANDIDATES dwordSettings[APPDWORDSETTINGSCOUNT]; // Values of the DWORD settings per registry location
+	bool bScreenshotPathFound[SETTINGSOURCES] = {}; // true, when screenshotPath exists in the registry location
+	std::wstring sScreenshotPath[SETTINGSOURCES]; // screenshotPath per registry location
+	BOOL bValid = FALSE; // FALSE, when the snapshot was never read
+	DWORD dwReads = 0; // Number of reads from the registry
+};
+
+// Opened registry key of a registry location with its change notification
+struct SETTINGSKEY {
+	HKEY hKey = NULL; // Opened key or nearest existing parent key, when the key does not exist
+	BOOL bExists = FALSE; // TRUE, when hKey is the key of the registry location and not a parent key
+	HANDLE hChanged = NULL; // Auto-reset event for RegNotifyChangeKeyValue
+	HANDLE hWait = NULL; // Wait registration for hChanged
+};
+
+// GDI resources for painting, created once and reused for every WM_PAINT while selecting
+struct PAINTRESOURCES {
+	HDC hdcOutputBuffer = NULL; // Memory device context for the output buffer
+	HBITMAP hbmOutputBuffer = NULL; // Output buffer bitmap (painting target, copied to the display after the last painting)
+	HGDIOBJ hbmOutputBufferOld = NULL; // Bitmap of hdcOutputBuffer before hbmOutputBuffer was selected
+	IMAGEBUFFER outputBuffer = { 0 }; // Pixels of hbmOutputBuffer
+	HFONT hFont = NULL; // Font for labels and information
+	HFONT hFontRotated = NULL; // Font rotated 90 degree for vertical labels
+	HBRUSH hBrushForeground = NULL; // Brush for frames in the current colors
+	HBRUSH hBrushBackground = NULL; // Brush for the background of information
+	BOOL bAlternativeColors = FALSE; // Colors used for hBrushForeground
+};
+
+// Screenshot file for the writer thread of the save queue (created on the UI thread, returned by WM_SAVEFINISHED)
+struct SAVEJOB {
+	IMAGEBUFFER image = { 0 }; // Copy of the selected area (owned by the job)
+	std::wstring sFileName; // Filename without path
+	std::wstring sFullPath; // Path and filename, set when the job is enqueued
+	PNGOPTIONS options; // Encoder options, set when the job is enqueued
+	DWORD dwError = ERROR_SUCCESS; // Result of writePNGFile
+	BOOL bFileError = FALSE; // dwError is a file error of writePNGFile
+};
+
+// DIB section of the virtual screen size, which can be reused by the next capture
+struct CAPTURESURFACE {
+	HBITMAP hBitmap = NULL; // DIB section
+	IMAGEBUFFER image = { 0 }; // Pixels of hBitmap
+};
 
 // Global Variables:
 HINSTANCE g_hInst = NULL; // Current instance
 HWND g_hWindow = NULL; // Handle to main window
-POINT g_appWindowPos; // SM_XVIRTUALSCREEN, SM_YVIRTUALSCREEN when fullscreen was started
+POINT g_appWindowPos; // Upper left corner of g_captureRect when fullscreen was started
 HBITMAP g_hBitmap = NULL; // Bitmap for screenshot over all monitors
+IMAGEBUFFER g_screenshot = { 0 }; // Pixels of g_hBitmap (32bpp top-down DIB section)
+HBITMAP g_hDimmedBitmap = NULL; // Darkened copy of g_hBitmap for the background while selecting (created once per screenshot)
+IMAGEBUFFER g_dimmedScreenshot = { 0 }; // Pixels of g_hDimmedBitmap
+HRGN g_hPaintedOverlay = NULL; // Area of frame, labels, zoom boxes and information drawn by the last WM_PAINT (NULL = repaint all)
+RECT g_paintedInner = { 0 }; // Bright selected area drawn by the last WM_PAINT
+RECT g_rectInformation[2] = { 0 }; // Possible areas (left/right position) of the internal information drawn by the last WM_PAINT
+DWORD g_paintedPixels = 0; // Pixels painted by the last WM_PAINT
+PAINTRESOURCES g_paint; // Cached GDI resources for WM_PAINT
+double g_paintTime = 0; // Duration of the last WM_PAINT in milliseconds
 RECT g_selection = { UNINITIALIZEDLONG,UNINITIALIZEDLONG,UNINITIALIZEDLONG,UNINITIALIZEDLONG }; // Selected screenshot area
 RECT g_storedSelection = { UNINITIALIZEDLONG,UNINITIALIZEDLONG,UNINITIALIZEDLONG,UNINITIALIZEDLONG }; // Stored selection
 BOOL g_useAlternativeColors = DEFAULTUSEALTERNATIVECOLORS; // TRUE when alternative colors are used
@@ -197,6 +340,7 @@ wchar_t g_screenshotPath[MAX_PATH] = L""; // Path for screenshots
 BOOL g_bScreenshotPathGPO = FALSE; // TRUE when path for screenshots is set by a GPO
 BOOL g_bRunKeyReadOnly = FALSE; // TRUE when automatic run via registry is set in HKLM
 BOOL g_onetimeCapture = FALSE; // TRUE in onetimeCapture mode (capture once at program start and exit program afterwards)
+BOOL g_bSavingSelection = FALSE; // TRUE while saveSelection uses the screenshot (releaseScreenshot must not free it)
 APPSTATE g_appState = stateTrayIcon; // Current program state
 HWND g_activeWindow = NULL; // Active window before program starts fullscreen mode
 DWORD g_zoomScale = DEFAULTZOOMSCALE; // Zoom scale for mouse cursor
@@ -208,6 +352,42 @@ UINT WM_TASKBARCREATED = 0; // Windows sends this message when the taskbar is cr
 BOOL g_ignoreNextClick = FALSE; // TRUE when focus was force by a simulated click
 std::wstring g_sLastScreenshotFile = L""; // Last used filename (Path + filename + extension)
 BOOL g_bDisablePrintScreenKeyForSnipping = FALSE; // TRUE when should bei disabel PrintScreenKeyForSnipping silently
+DWORD g_colorTolerance = DEFAULTCOLORTOLERANCE; // Max difference per color channel for Shift+cursor keys
+DWORD g_compressionProfile = DEFAULTCOMPRESSIONPROFILE; // Compression profile for PNG files (PNGCOMPRESSIONPROFILE)
+BOOL g_bCompressionProfileGPO = FALSE; // TRUE when compression profile is set by a GPO
+BOOL g_keepLastCapture = DEFAULTKEEPLASTCAPTURE; // TRUE when a compressed copy of the last capture is kept in the tray
+std::vector<CAPTURESURFACE> g_surfacePool; // Released capture surfaces for the next capture (oldest first)
+ULONGLONG g_surfacePoolReleaseTime = 0; // GetTickCount64 when the last surface was added to the pool
+HANDLE g_hLowMemoryNotification = NULL; // Memory resource notification, which is signaled when the physical memory is low
+double g_captureTime = 0; // Duration of the last CaptureScreen in milliseconds
+BOOL g_bCaptureSurfaceReused = FALSE; // TRUE when the last CaptureScreen used a surface from the pool
+LARGE_INTEGER g_latencyStamps[LATENCYSTAGES] = { 0 }; // QueryPerformanceCounter at the end of each latency stage of the running capture (0 = not reached)
+double g_latencyTimes[LATENCYSTAGES] = { 0 }; // Milliseconds of each latency stage of the last capture (0 for latencyHook and stages not reached)
+double g_latencyTotal = 0; // Milliseconds from the first to the last reached latency stage of the last capture
+const wchar_t* g_latencyStageNames[LATENCYSTAGES] = { L"Hook", L"Started", L"Capture", L"Settings", L"Fullscreen", L"Focus", L"First frame" }; // Names for display and log
+SETTINGSSNAPSHOT g_settings; // Snapshot of the registry values for all settings
+SETTINGSKEY g_settingsKeys[SETTINGSOURCES]; // Registry keys of the registry locations (index is SETTINGSOURCE)
+BOOL g_bSettingsNotification = FALSE; // TRUE, when g_settings is refreshed by registry change notifications
+volatile LONG g_settingsChangedSources = 0; // Bit mask of changed registry locations, which are not yet refreshed
+BOOL g_trace = DEFAULTTRACE; // TRUE when the capture pipeline is traced to TRACEFILE (registry value trace or /trace)
+BOOL g_parallelMonitorCapture = DEFAULTPARALLELMONITORCAPTURE; // TRUE when each monitor is captured by its own thread
+BOOL g_captureMonitorOnly = DEFAULTCAPTUREMONITORONLY; // TRUE when only the monitor under the mouse cursor is captured
+BOOL g_bCaptureMonitorOnlyGPO = FALSE; // TRUE when captureMonitorOnly is set by a GPO
+DWORD g_captureHistorySeconds = DEFAULTCAPTUREHISTORY; // Seconds of background captures kept in g_captureHistory (0 = disabled)
+DWORD g_captureHistoryInterval = DEFAULTCAPTUREHISTORYINTERVAL; // Milliseconds between two background captures
+DWORD g_captureHistoryMemory = DEFAULTCAPTUREHISTORYMEMORY; // Memory budget in MB of g_captureHistory
+CAPTUREHISTORY g_captureHistory; // Background captures while the program waits in the tray
+DWORD g_captureInterval = 0; // Milliseconds between two captures of /interval= (0 = one capture)
+volatile LONG g_failedSaveJobs = 0; // Save jobs without window (/interval=), which could not write their file
+int g_historyFrame = -1; // Index of the shown frame in g_captureHistory (-1 = current capture)
+BOOL g_bCaptureMonitorOnlyArgument = FALSE; // TRUE when only the monitor under the mouse cursor is captured because of /m (ignored, when captureMonitorOnly is set by a GPO)
+BOOL g_latencyLog = DEFAULTLATENCYLOG; // TRUE when the latency stages are logged to LATENCYLOGFILE
+RLEIMAGE g_lastCapture; // Compressed copy of the last capture (empty without keepLastCapture)
+RECT g_lastCaptureRect = { 0 }; // Virtual screen rectangle of g_lastCapture
+std::vector<RECT> g_lastCaptureMonitors; // Monitor positions of g_lastCapture
+CAPTURESOURCE g_captureSource; // Source for CaptureScreen (GDI or replay file)
+std::wstring g_sCaptureError = L""; // Error message of the last failed capture
+std::wstring g_sRecordFile = L""; // Replay file to append each capture (/record=)
 BOOL g_bDEV = FALSE; // TRUE when development functions are enabled (only used temporary)
 
 // Function declarations
@@ -244,6 +424,176 @@ bool IsWindows11_24H2OrNewer() {
 	return false;
 }
 
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: resetLatencyStages
+
+  Summary:   Resets the timestamps of the latency stages
+
+  Args:
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void resetLatencyStages()
+{
+	for (int i = 0; i < LATENCYSTAGES; i++) g_latencyStamps[i].QuadPart = 0;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: writeLatencyLog
+
+  Summary:   Appends the latency stages of the last capture as CSV line to
+			 LATENCYLOGFILE in %TEMP%
+
+  Args:
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void writeLatencyLog()
+{
+	wchar_t szTempPath[MAX_PATH];
+	DWORD dwLength = GetTempPath(MAX_PATH, szTempPath);
+	if ((dwLength == 0) || (dwLength >= MAX_PATH)) return;
+	std::wstring sFile(szTempPath);
+	sFile.append(LATENCYLOGFILE);
+
+	HANDLE hFile = CreateFile(sFile.c_str(), FILE_APPEND_DATA, FILE_SHARE_READ, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (hFile == INVALID_HANDLE_VALUE) return;
+
+	LARGE_INTEGER fileSize = { 0 };
+	if (GetFileSizeEx(hFile, &fileSize) && (fileSize.QuadPart > LATENCYLOGMAXSIZE)) // Start again
+	{
+		CloseHandle(hFile);
+		hFile = CreateFile(sFile.c_str(), GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (hFile == INVALID_HANDLE_VALUE) return;
+		fileSize.QuadPart = 0;
+	}
+
+	std::string sLine;
+	char szData[MAX_PATH];
+	if (fileSize.QuadPart == 0) // Header for new file
+	{
+		sLine.assign("Time;Total ms");
+		for (int i = latencyStarted; i < LATENCYSTAGES; i++)
+		{
+			_snprintf_s(szData, MAX_PATH, _TRUNCATE, ";%ls ms", g_latencyStageNames[i]);
+			sLine.append(szData);
+		}
+		sLine.append("\r\n");
+	}
+
+	SYSTEMTIME tLocal;
+	GetLocalTime(&tLocal);
+	_snprintf_s(szData, MAX_PATH, _TRUNCATE, "%04u-%02u-%02u %02u:%02u:%02u.%03u;%.2f",
+		tLocal.wYear, tLocal.wMonth, tLocal.wDay, tLocal.wHour, tLocal.wMinute, tLocal.wSecond, tLocal.wMilliseconds, g_latencyTotal);
+	sLine.append(szData);
+	for (int i = latencyStarted; i < LATENCYSTAGES; i++)
+	{
+		_snprintf_s(szData, MAX_PATH, _TRUNCATE, ";%.2f", g_latencyTimes[i]);
+		sLine.append(szData);
+	}
+	sLine.append("\r\n");
+
+	DWORD dwWritten = 0;
+	WriteFile(hFile, sLine.c_str(), (DWORD)sLine.size(), &dwWritten, NULL);
+	CloseHandle(hFile);
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: writeTraceFile
+
+  Summary:   Writes the recorded trace events to TRACEFILE in %TEMP%. The file
+			 is replaced each time and contains all events since program start.
+
+  Args:
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void writeTraceFile()
+{
+	if (!isTraceEnabled()) return;
+
+	wchar_t szTempPath[MAX_PATH];
+	DWORD dwLength = GetTempPath(MAX_PATH, szTempPath);
+	if ((dwLength == 0) || (dwLength >= MAX_PATH)) return;
+	std::wstring sFile(szTempPath);
+	sFile.append(TRACEFILE);
+
+	HANDLE hFile = CreateFile(sFile.c_str(), GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (hFile == INVALID_HANDLE_VALUE) return;
+	BOOL bWritten = writeTraceJSON([hFile](const char* pData, size_t size) {
+		DWORD dwWritten = 0;
+		return WriteFile(hFile, pData, (DWORD)size, &dwWritten, NULL) && (dwWritten == size);
+	});
+	CloseHandle(hFile);
+	if (!bWritten) DeleteFile(sFile.c_str()); // Remove incomplete file
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: finishLatencyStages
+
+  Summary:   Calculates the duration of each reached latency stage, writes
+			 them to the debugger and the optional log and resets the
+			 timestamps for the next capture
+
+  Args:
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void finishLatencyStages()
+{
+	LARGE_INTEGER frequency;
+	if (!QueryPerformanceFrequency(&frequency) || (frequency.QuadPart <= 0)) return;
+
+	int first = -1;
+	int previous = -1;
+	for (int i = 0; i < LATENCYSTAGES; i++)
+	{
+		g_latencyTimes[i] = 0;
+		if (g_latencyStamps[i].QuadPart == 0) continue; // Not reached (for example no Print screen key)
+
+		if (first < 0) first = i;
+		if (previous >= 0) g_latencyTimes[i] = (double)(g_latencyStamps[i].QuadPart - g_latencyStamps[previous].QuadPart) * 1000 / frequency.QuadPart;
+		previous = i;
+	}
+	g_latencyTotal = (first >= 0) ? (double)(g_latencyStamps[previous].QuadPart - g_latencyStamps[first].QuadPart) * 1000 / frequency.QuadPart : 0;
+	resetLatencyStages();
+
+	std::wstring sDebug;
+	wchar_t szData[MAX_PATH];
+	_snwprintf_s(szData, MAX_PATH, _TRUNCATE, L"Latency %.2f ms", g_latencyTotal);
+	sDebug.assign(szData);
+	for (int i = latencyStarted; i < LATENCYSTAGES; i++)
+	{
+		_snwprintf_s(szData, MAX_PATH, _TRUNCATE, L", %s %.2f ms", g_latencyStageNames[i], g_latencyTimes[i]);
+		sDebug.append(szData);
+	}
+	OutputDebugString(sDebug.append(L"\n").c_str());
+
+	if (g_latencyLog) writeLatencyLog();
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: markLatencyStage
+
+  Summary:   Stores a high-resolution timestamp for the end of a latency stage.
+			 The first frame finishes the measurement.
+
+  Args:     LATENCYSTAGE stage
+			  Stage
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void markLatencyStage(LATENCYSTAGE stage)
+{
+	QueryPerformanceCounter(&g_latencyStamps[stage]);
+	if (stage == latencyFirstFrame) finishLatencyStages();
+}
+
 /*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
   Function: KeyboardProc
 
@@ -263,7 +613,12 @@ LRESULT CALLBACK KeyboardProc(int nCode, WPARAM wParam, LPARAM lParam)
 		KBDLLHOOKSTRUCT* pKeyBoard = (KBDLLHOOKSTRUCT*)lParam;
 		if (pKeyBoard->vkCode == VK_SNAPSHOT)
 		{
-			if (g_appState == stateTrayIcon) SendMessage(g_hWindow, WM_STARTED, 0, 0);
+			if (g_appState == stateTrayIcon)
+			{
+				resetLatencyStages();
+				markLatencyStage(latencyHook);
+				SendMessage(g_hWindow, WM_STARTED, 0, 0);
+			}
 			return 1; // Prevents keypress forwarding
 		}
 	}
@@ -396,6 +751,386 @@ RECT normalizeRectangle(RECT rect)
 	return result;
 }
 
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: toImageRect
+
+  Summary:   Converts RECT to IMAGERECT
+
+  Args:     RECT rect
+			  Rectangle
+
+  Returns:  IMAGERECT
+
+-----------------------------------------------------------------F-F*/
+IMAGERECT toImageRect(RECT rect)
+{
+	IMAGERECT result = { (int)rect.left, (int)rect.top, (int)rect.right, (int)rect.bottom };
+	return result;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: createImageBitmap
+
+  Summary:   Creates a 32bpp top-down DIB section and attaches an image buffer to its pixels
+			 (Call GdiFlush before accessing the pixels after GDI drawing operations)
+
+  Args:     HDC hdc
+			  Handle to device context (can be NULL)
+			int width
+			int height
+			  Size of bitmap
+			IMAGEBUFFER &image
+			  Image buffer for the pixels of the bitmap (call by ref)
+
+  Returns:  HBITMAP
+			  NULL = failure
+
+-----------------------------------------------------------------F-F*/
+HBITMAP createImageBitmap(HDC hdc, int width, int height, IMAGEBUFFER& image)
+{
+	BITMAPINFO bmi = { 0 };
+	void* pBits = NULL;
+	HBITMAP hBitmap = NULL;
+
+	image = { 0 };
+	if ((width <= 0) || (height <= 0)) return NULL;
+
+	bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	bmi.bmiHeader.biWidth = width;
+	bmi.bmiHeader.biHeight = -height; // Negative height for a top-down bitmap
+	bmi.bmiHeader.biPlanes = 1;
+	bmi.bmiHeader.biBitCount = 32;
+	bmi.bmiHeader.biCompression = BI_RGB;
+
+	hBitmap = CreateDIBSection(hdc, &bmi, DIB_RGB_COLORS, &pBits, NULL, 0);
+	if ((hBitmap == NULL) || (pBits == NULL)) return NULL;
+
+	attachImageBuffer(image, pBits, width, height, (ptrdiff_t)width * IMAGEBYTESPERPIXEL);
+	return hBitmap;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: freeCaptureSurfacePool
+
+  Summary:   Deletes all capture surfaces of the pool
+
+  Args:
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void freeCaptureSurfacePool()
+{
+	for (CAPTURESURFACE& surface : g_surfacePool) DeleteObject(surface.hBitmap);
+	g_surfacePool.clear();
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: isLowMemory
+
+  Summary:   Checks, if Windows reports low physical memory
+
+  Args:
+
+  Returns:	BOOL
+			  TRUE = low memory
+			  FALSE = enough memory or unknown
+
+-----------------------------------------------------------------F-F*/
+BOOL isLowMemory()
+{
+	BOOL bLowMemory = FALSE;
+	if (g_hLowMemoryNotification == NULL) g_hLowMemoryNotification = CreateMemoryResourceNotification(LowMemoryResourceNotification);
+	if (g_hLowMemoryNotification == NULL) return FALSE;
+	if (!QueryMemoryResourceNotification(g_hLowMemoryNotification, &bLowMemory)) return FALSE;
+	return bLowMemory;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: acquireCaptureSurface
+
+  Summary:   Gets a DIB section from the surface pool or creates a new one.
+			 Pooled surfaces of another size are deleted, because the
+			 virtual screen size has changed.
+
+  Args:     int width, int height
+			  Size of the surface
+			IMAGEBUFFER &image
+			  Image buffer for the pixels of the surface (call by ref)
+			BOOL *pReused
+			  Optional result, TRUE when the surface was taken from the pool
+
+  Returns:  HBITMAP
+			  NULL = failure
+
+-----------------------------------------------------------------F-F*/
+HBITMAP acquireCaptureSurface(int width, int height, IMAGEBUFFER& image, BOOL* pReused = NULL)
+{
+	if (pReused != NULL) *pReused = FALSE;
+	for (size_t i = g_surfacePool.size(); i > 0; i--)
+	{
+		CAPTURESURFACE surface = g_surfacePool[i - 1];
+		if ((surface.image.width == width) && (surface.image.height == height))
+		{
+			g_surfacePool.erase(g_surfacePool.begin() + (i - 1));
+			image = surface.image;
+			if (pReused != NULL) *pReused = TRUE;
+			return surface.hBitmap;
+		}
+	}
+	freeCaptureSurfacePool(); // Sizes do not match the virtual screen anymore
+
+	return createImageBitmap(NULL, width, height, image);
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: releaseCaptureSurface
+
+  Summary:   Returns a DIB section to the surface pool. The surface is deleted
+			 instead, when the pool is full (oldest surface) or the physical
+			 memory is low.
+
+  Args:     HBITMAP &hBitmap
+			  DIB section (call by ref, is set to NULL)
+			IMAGEBUFFER &image
+			  Pixels of the DIB section (call by ref, is reset)
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void releaseCaptureSurface(HBITMAP& hBitmap, IMAGEBUFFER& image)
+{
+	if (hBitmap == NULL) return;
+
+	if (isLowMemory() || !isImageValid(image))
+	{
+		DeleteObject(hBitmap);
+		freeCaptureSurfacePool();
+	}
+	else
+	{
+		CAPTURESURFACE surface;
+		surface.hBitmap = hBitmap;
+		surface.image = image;
+		g_surfacePool.push_back(surface);
+		if (g_surfacePool.size() > SURFACEPOOLMAX)
+		{
+			DeleteObject(g_surfacePool.front().hBitmap);
+			g_surfacePool.erase(g_surfacePool.begin());
+		}
+		g_surfacePoolReleaseTime = GetTickCount64();
+	}
+	hBitmap = NULL;
+	image = { 0 };
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: updateDimmedScreenshot
+
+  Summary:   Updates the darkened copy of the screenshot, which is used as background
+			 while selecting. Creates the copy, when it does not exist.
+
+  Args:     const RECT *pRect
+			  Changed area of the screenshot (NULL = whole screenshot)
+
+  Returns:  BOOL
+			  TRUE = success
+			  FALSE = failure
+
+-----------------------------------------------------------------F-F*/
+BOOL updateDimmedScreenshot(const RECT* pRect)
+{
+	TRACESCOPE traceScope("updateDimmedScreenshot");
+	IMAGEBUFFER source, target;
+	IMAGERECT area = { 0, 0, g_screenshot.width - 1, g_screenshot.height - 1 };
+
+	if (!isImageValid(g_screenshot)) return FALSE;
+
+	if (g_hDimmedBitmap == NULL)
+	{
+		g_hDimmedBitmap = acquireCaptureSurface(g_screenshot.width, g_screenshot.height, g_dimmedScreenshot);
+		if (g_hDimmedBitmap == NULL) return FALSE;
+	}
+	else if (pRect != NULL) area = toImageRect(normalizeRectangle(*pRect));
+
+	if (!getImageViewFromRect(g_screenshot, area, source)) return TRUE; // Nothing to do
+	if (!getImageViewFromRect(g_dimmedScreenshot, area, target)) return TRUE;
+
+	GdiFlush(); // Finish GDI drawing before accessing the pixels
+	copyImage(target, source);
+	blendImage(target, IMAGEPIXELRGB(0, 0, 0), 255 - DIMMEDALPHA);
+	return TRUE;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: freeDimmedScreenshot
+
+  Summary:   Deletes the darkened copy of the screenshot. The copy is not
+			 kept in the surface pool, because a second virtual screen sized
+			 surface would double the memory held in the tray.
+
+  Args:
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void freeDimmedScreenshot()
+{
+	if (g_hDimmedBitmap == NULL) return;
+
+	DeleteObject(g_hDimmedBitmap);
+	g_hDimmedBitmap = NULL;
+	g_dimmedScreenshot = { 0 };
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: freeScreenshot
+
+  Summary:   Returns screenshot bitmap to the surface pool, deletes the
+			 darkened copy and frees the edge index
+
+  Args:
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void freeScreenshot()
+{
+	if (g_hBitmap == NULL) return;
+
+	stopEdgeIndexBuild();
+	freeDimmedScreenshot();
+	releaseCaptureSurface(g_hBitmap, g_screenshot);
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: releaseScreenshot
+
+  Summary:   Frees the screenshot, when the program goes to the tray, so an
+			 idle program does not hold the full virtual screen. With
+			 keepLastCapture a run-length encoded copy is kept for
+			 "Reopen last capture".
+
+  Args:
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void releaseScreenshot()
+{
+	if (g_hBitmap == NULL) return;
+	if (g_bSavingSelection)
+	{ // Selection is a view to the screenshot => Release after saving (see releaseScreenshotInTray)
+		OutputDebugString(L"releaseScreenshot while saving the selection is skipped\n");
+		return;
+	}
+
+	freeRLEImage(g_lastCapture);
+	if (g_keepLastCapture)
+	{
+		if (compressImageRLE(g_screenshot, g_lastCapture))
+		{
+			g_lastCaptureRect = g_captureRect;
+			g_lastCaptureMonitors = g_rectMonitor;
+
+			wchar_t szDebug[MAX_PATH];
+			_snwprintf_s(szDebug, MAX_PATH, _TRUNCATE, L"Last capture kept with %.1f MB (uncompressed %.1f MB)\n",
+				getRLEImageBytes(g_lastCapture) / 1048576.0, (double)g_screenshot.width * g_screenshot.height * IMAGEBYTESPERPIXEL / 1048576.0);
+			OutputDebugString(szDebug);
+		}
+	}
+	freeScreenshot();
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: releaseScreenshotInTray
+
+  Summary:   Releases the screenshot, when the program is still in the tray,
+			 and starts the idle timer for the surface pool. Called after
+			 the selection was saved, because the selection is only a view
+			 to the screenshot.
+
+  Args:     HWND hWindow
+			  Handle to window
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void releaseScreenshotInTray(HWND hWindow)
+{
+	if (g_appState != stateTrayIcon) return; // Next capture is already running
+	if (g_onetimeCapture) return; // Program ends and frees the screenshot in WinMain
+
+	releaseScreenshot();
+	if (!g_surfacePool.empty()) SetTimer(hWindow, IDT_TIMERSURFACEPOOL, SURFACEPOOLCHECKINTERVAL * 1000, (TIMERPROC)NULL);
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: isLastCaptureAvailable
+
+  Summary:   Checks, if the kept copy of the last capture fits to the current
+			 virtual screen
+
+  Args:
+
+  Returns:	BOOL
+			  TRUE = last capture can be reopened
+			  FALSE = no copy or the monitor layout has changed
+
+-----------------------------------------------------------------F-F*/
+BOOL isLastCaptureAvailable()
+{
+	if (g_lastCapture.width <= 0) return FALSE;
+
+	// Capture of one monitor (captureMonitorOnly) fits, as long as the monitor is unchanged
+	if ((g_lastCaptureMonitors.size() == 1) && EqualRect(&g_lastCaptureRect, &g_lastCaptureMonitors[0]))
+	{
+		MONITORINFO monitorInfo = { 0 };
+		monitorInfo.cbSize = sizeof(monitorInfo);
+		HMONITOR hMonitor = MonitorFromRect(&g_lastCaptureRect, MONITOR_DEFAULTTONULL);
+		if ((hMonitor != NULL) && GetMonitorInfo(hMonitor, &monitorInfo) && EqualRect(&monitorInfo.rcMonitor, &g_lastCaptureRect)) return TRUE;
+	}
+
+	return (g_lastCaptureRect.right - g_lastCaptureRect.left == GetSystemMetrics(SM_CXVIRTUALSCREEN)) &&
+		(g_lastCaptureRect.bottom - g_lastCaptureRect.top == GetSystemMetrics(SM_CYVIRTUALSCREEN)) &&
+		(g_lastCaptureRect.left == GetSystemMetrics(SM_XVIRTUALSCREEN)) &&
+		(g_lastCaptureRect.top == GetSystemMetrics(SM_YVIRTUALSCREEN));
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: restoreLastCapture
+
+  Summary:   Restores the screenshot from the kept copy of the last capture.
+			 The copy is freed afterwards, because it is created again when
+			 the program goes back to the tray.
+
+  Args:
+
+  Returns:	BOOL
+			  TRUE = success
+			  FALSE = failure
+
+-----------------------------------------------------------------F-F*/
+BOOL restoreLastCapture()
+{
+	if (!isLastCaptureAvailable()) return FALSE;
+
+	freeScreenshot();
+
+	g_hBitmap = acquireCaptureSurface(g_lastCapture.width, g_lastCapture.height, g_screenshot);
+	if (g_hBitmap == NULL) return FALSE;
+
+	if (!decompressImageRLE(g_lastCapture, g_screenshot))
+	{
+		freeScreenshot();
+		return FALSE;
+	}
+	g_captureRect = g_lastCaptureRect;
+	g_rectMonitor = g_lastCaptureMonitors;
+	freeRLEImage(g_lastCapture);
+	return TRUE;
+}
+
 /*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
   Function: programInformationProc
 
@@ -468,6 +1203,22 @@ void showProgramInformation(HWND hWindow)
 		delete[] verData;
 	}
 
+	// Add memory usage
+	PROCESS_MEMORY_COUNTERS memoryCounters = { 0 };
+	memoryCounters.cb = sizeof(memoryCounters);
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &memoryCounters, sizeof(memoryCounters)))
+	{
+		wchar_t szMemory[MAX_PATH];
+		_snwprintf_s(szMemory, MAX_PATH, _TRUNCATE, LoadStringAsWstr(g_hInst, IDS_WORKINGSET).c_str(),
+			memoryCounters.WorkingSetSize / 1048576.0, memoryCounters.PeakWorkingSetSize / 1048576.0);
+		sMessage.append(L"\n\n").append(szMemory);
+		if (g_lastCapture.width > 0)
+		{
+			_snwprintf_s(szMemory, MAX_PATH, _TRUNCATE, LoadStringAsWstr(g_hInst, IDS_LASTCAPTURESIZE).c_str(), getRLEImageBytes(g_lastCapture) / 1048576.0);
+			sMessage.append(L"\n").append(szMemory);
+		}
+	}
+
 	// Add flag for DEV enabled
 	if (g_bDEV) sTitle.append(L" DEV");
 
@@ -516,15 +1267,22 @@ void showProgramArguments(HWND hWindow)
 	wchar_t szFullPath[MAX_PATH] = L"";
     if (GetModuleFileName(NULL, szFullPath, MAX_PATH) == 0) return;
 	std::wstring sMain = PathFindFileName(szFullPath);
-	sMain.append(L" [/af] [/ac] | [/f | /rd | /re | /s | /v | /?]");
+	sMain.append(L" [/trace] [/replay=file] [/record=file] [/m] [/interval=ms [/count=n] [/duration=s]] [/af] [/ac] | [/f | /rd | /re | /s | /v | /?]");
 
 	sContent
 		.append(L"/ac Create and save screenshot to clipboard\n")
 		.append(L"/af Create and save screenshot to file\n")
+		.append(L"/count=n Number of screenshots of /interval=\n")
+		.append(L"/duration=s Seconds of screenshots of /interval=\n")
 		.append(L"/f Open screenshot folder\n")
+		.append(L"/interval=ms Create screenshots repeatedly like /af or /ac, skip unchanged screenshots\n")
+		.append(L"/m Capture only the monitor under the mouse cursor\n")
 		.append(L"/rd Disable program start at logon for all users\n")
 		.append(L"/re Enable program start at logon for all users\n")
+		.append(L"/record=file Append each capture to a replay file\n")
+		.append(L"/replay=file Use the frames of a replay file instead of the screen\n")
 		.append(L"/s Open screenshot selection\n")
+		.append(L"/trace Write trace of the capture pipeline to %TEMP%\\abiSnipTrace.json\n")
 		.append(L"/v Show version information\n")
 		.append(L"/? Show this dialog");
 
@@ -705,51 +1463,322 @@ LSTATUS getDWORDValueFromRegistry(HKEY hkRoot,LPCWSTR lpSubKey, LPCWSTR lpValueN
 }
 
 /*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-  Function: setDWORDValueToRegistry
+  Function: setDWORDValueToRegistry
+
+  Summary:   Sets REG_DWORD value to registry
+
+  Args:     HKEY hKey
+              Registry key used as root
+            LPCWSTR lpSubKey
+              Registry key
+			LPCWSTR lpValueName
+			  Registry value
+			DWORD dwValue
+			  Content of value to set
+
+  Returns:	LSTATUS
+			  ERROR_SUCCESS = Success
+			  Return codes from Winerror.h
+
+-----------------------------------------------------------------F-F*/
+LSTATUS setDWORDValueToRegistry(HKEY hkRoot,LPCWSTR lpSubKey, LPCWSTR lpValueName, DWORD dwValue)
+{
+	HKEY hKey;
+	DWORD dwSize = sizeof(DWORD);
+	LSTATUS lsResult = ERROR_SUCCESS;
+
+	if (lpSubKey == NULL) return ERROR_INVALID_PARAMETER;
+	if (lpValueName == NULL) return ERROR_INVALID_PARAMETER;
+
+	// Open registry key
+	lsResult = RegCreateKeyEx(hkRoot, lpSubKey, 0, NULL, 0, KEY_WRITE, NULL, &hKey, NULL);
+	if (lsResult == ERROR_SUCCESS) {
+
+		// Write to registry
+		lsResult = RegSetValueEx(hKey, lpValueName, 0, REG_DWORD, (const BYTE*)&dwValue, sizeof(dwValue));
+		if (lsResult != ERROR_SUCCESS) {
+			OutputDebugString(L"Error writing to registry");
+		}
+		RegCloseKey(hKey);
+	}
+	return lsResult;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getDWORDSettingName
+
+  Summary:   Gets registry value name of a DWORD setting
+
+  Args:      APPDWORDSETTINGS setting
+			   Setting
+
+  Returns:	LPCWSTR
+			  Registry value name or NULL for an invalid setting
+
+-----------------------------------------------------------------F-F*/
+LPCWSTR getDWORDSettingName(APPDWORDSETTINGS setting) {
+	switch (setting)
+	{
+		case defaultZoomScale: return L"defaultZoomScale";
+		case screenshotDelay: return L"screenshotDelay";
+		case saveToClipboard: return L"saveToClipboard";
+		case saveToFile: return L"saveToFile";
+		case useAlternativeColors: return L"useAlternativeColors";
+		case displayInternalInformation: return L"displayInternalInformation";
+		case storedSelectionLeft: return L"storedSelectionLeft";
+		case storedSelectionTop: return L"storedSelectionTop";
+		case storedSelectionRight: return L"storedSelectionRight";
+		case storedSelectionBottom: return L"storedSelectionBottom";
+		case disablePrintScreenKeyForSnipping: return L"disablePrintScreenKeyForSnipping";
+		case colorTolerance: return L"colorTolerance";
+		case compressionProfile: return L"compressionProfile";
+		case keepLastCapture: return L"keepLastCapture";
+		case latencyLog: return L"latencyLog";
+		case trace: return L"trace";
+		case parallelMonitorCapture: return L"parallelMonitorCapture";
+		case captureMonitorOnly: return L"captureMonitorOnly";
+		case captureHistory: return L"captureHistory";
+		case captureHistoryInterval: return L"captureHistoryInterval";
+		case captureHistoryMemory: return L"captureHistoryMemory";
+		case DEV: return L"DEV";
+	}
+	return NULL;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: isPolicyDWORDSetting
+
+  Summary:   Checks, if a DWORD setting can be set by GPO
+
+  Args:      APPDWORDSETTINGS setting
+			   Setting
+
+  Returns:	BOOL
+			  TRUE = GPO and GPO recommended values are used
+			  FALSE = Only the user registry value is used
+
+-----------------------------------------------------------------F-F*/
+BOOL isPolicyDWORDSetting(APPDWORDSETTINGS setting) {
+	switch (setting)
+	{
+		case defaultZoomScale:
+		case screenshotDelay:
+		case saveToClipboard:
+		case saveToFile:
+		case displayInternalInformation:
+		case disablePrintScreenKeyForSnipping:
+		case compressionProfile:
+		case captureMonitorOnly:
+			return TRUE;
+	}
+	return FALSE;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: openSettingsKey
+
+  Summary:   Opens the registry key of a registry location and requests a
+			 change notification for it. When the key does not exist, the
+			 nearest existing parent key is watched, so the creation of the key
+			 is notified too.
+
+  Args:      SETTINGSOURCE source
+			   Registry location
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void openSettingsKey(SETTINGSOURCE source)
+{
+	static const HKEY hkRoots[SETTINGSOURCES] = { HKEY_CURRENT_USER, HKEY_LOCAL_MACHINE, HKEY_CURRENT_USER, HKEY_CURRENT_USER, HKEY_LOCAL_MACHINE };
+	static const LPCWSTR paths[SETTINGSOURCES] = { REGISTRYGPOPATH, REGISTRYGPOPATH, REGISTRYSETTINGSPATH, REGISTRYGPODEFAULTSPATH, REGISTRYGPODEFAULTSPATH };
+	SETTINGSKEY& key = g_settingsKeys[source];
+
+	if (key.hKey != NULL) RegCloseKey(key.hKey);
+	key.hKey = NULL;
+	key.bExists = (RegOpenKeyEx(hkRoots[source], paths[source], 0, KEY_READ, &key.hKey) == ERROR_SUCCESS);
+	if (!key.bExists) key.hKey = NULL;
+	if (key.hChanged == NULL) return; // No change notification
+
+	// Find nearest existing parent key
+	std::wstring sPath(paths[source]);
+	while (key.hKey == NULL)
+	{
+		size_t pos = sPath.find_last_of(L'\\');
+		if (pos == std::wstring::npos) sPath.clear(); else sPath.resize(pos);
+		if (RegOpenKeyEx(hkRoots[source], sPath.c_str(), 0, KEY_NOTIFY, &key.hKey) != ERROR_SUCCESS) key.hKey = NULL;
+		if (sPath.empty()) break;
+	}
+
+	if (key.hKey != NULL) RegNotifyChangeKeyValue(key.hKey, TRUE, REG_NOTIFY_CHANGE_NAME | REG_NOTIFY_CHANGE_LAST_SET, key.hChanged, TRUE);
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: readSettingsSnapshot
+
+  Summary:   Reads the values of all settings from the opened registry keys
+
+  Args:
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void readSettingsSnapshot()
+{
+	TRACESCOPE traceScope("readSettingsSnapshot");
+	for (int source = 0; source < SETTINGSOURCES; source++)
+	{
+		const SETTINGSKEY& key = g_settingsKeys[source];
+		for (int setting = 0; setting < APPDWORDSETTINGSCOUNT; setting++)
+		{
+			DWORDSETTINGCANDIDATES& candidates = g_settings.dwordSettings[setting];
+			DWORD dwValue = 0;
+			DWORD dwSize = sizeof(DWORD);
+			candidates.bFound[source] = key.bExists &&
+				(RegQueryValueEx(key.hKey, getDWORDSettingName((APPDWORDSETTINGS)setting), NULL, NULL, (LPBYTE)&dwValue, &dwSize) == ERROR_SUCCESS);
+			candidates.value[source] = candidates.bFound[source] ? dwValue : 0;
+		}
+
+		wchar_t szPath[MAX_PATH];
+		g_settings.bScreenshotPathFound[source] = key.bExists && getSZFromRegistry(key.hKey, L"", L"screenshotPath", szPath, MAX_PATH);
+		g_settings.sScreenshotPath[source].assign(g_settings.bScreenshotPathFound[source] ? szPath : L"");
+	}
+	g_settings.bValid = TRUE;
+	g_settings.dwReads++;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: refreshSettingsSnapshot
+
+  Summary:   Reopens the registry keys of changed registry locations and reads
+			 the snapshot again, when a value could have changed. Without
+			 change notifications all keys are reopened.
+
+  Args:      DWORD dwChangedSources
+			   Bit mask of the changed registry locations (SETTINGSOURCESALL = all)
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void refreshSettingsSnapshot(DWORD dwChangedSources)
+{
+	BOOL bRead = !g_settings.bValid;
+	for (int source = 0; source < SETTINGSOURCES; source++)
+	{
+		if (g_bSettingsNotification && !(dwChangedSources & (1 << source))) continue;
+		BOOL bExisted = g_settingsKeys[source].bExists;
+		openSettingsKey((SETTINGSOURCE)source);
+		if (bExisted || g_settingsKeys[source].bExists) bRead = TRUE; // Changes of parent keys need no read
+	}
+	if (bRead) readSettingsSnapshot();
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: updateSettingsSnapshot
+
+  Summary:   Makes sure that the snapshot is current. With change notifications
+			 this is done without registry access.
+
+  Args:
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void updateSettingsSnapshot()
+{
+	if (g_settings.bValid && g_bSettingsNotification) return; // Refreshed by WM_SETTINGSCHANGED
+	refreshSettingsSnapshot(SETTINGSOURCESALL);
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: settingsChangedCallback
+
+  Summary:   Called by the thread pool when a watched registry key has changed.
+			 Posts one WM_SETTINGSCHANGED for all changes until it is handled.
+
+  Args:      PVOID lpParameter
+			   Registry location (SETTINGSOURCE)
+			 BOOLEAN TimerOrWaitFired
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+VOID CALLBACK settingsChangedCallback(PVOID lpParameter, BOOLEAN TimerOrWaitFired)
+{
+	LONG source = (LONG)(INT_PTR)lpParameter;
+	if (InterlockedOr(&g_settingsChangedSources, 1 << source) == 0) PostMessage(g_hWindow, WM_SETTINGSCHANGED, 0, 0);
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: stopSettingsNotification
 
-  Summary:   Sets REG_DWORD value to registry
+  Summary:   Stops the registry change notifications and closes the keys
 
-  Args:     HKEY hKey
-              Registry key used as root
-            LPCWSTR lpSubKey
-              Registry key
-			LPCWSTR lpValueName
-			  Registry value
-			DWORD dwValue
-			  Content of value to set
+  Args:
 
-  Returns:	LSTATUS
-			  ERROR_SUCCESS = Success
-			  Return codes from Winerror.h
+  Returns:
 
 -----------------------------------------------------------------F-F*/
-LSTATUS setDWORDValueToRegistry(HKEY hkRoot,LPCWSTR lpSubKey, LPCWSTR lpValueName, DWORD dwValue)
+void stopSettingsNotification()
 {
-	HKEY hKey;
-	DWORD dwSize = sizeof(DWORD);
-	LSTATUS lsResult = ERROR_SUCCESS;
+	g_bSettingsNotification = FALSE;
+	for (int source = 0; source < SETTINGSOURCES; source++)
+	{
+		SETTINGSKEY& key = g_settingsKeys[source];
+		if (key.hWait != NULL) UnregisterWaitEx(key.hWait, INVALID_HANDLE_VALUE); // Waits for running callbacks
+		key.hWait = NULL;
+		if (key.hKey != NULL) RegCloseKey(key.hKey);
+		key.hKey = NULL;
+		key.bExists = FALSE;
+		if (key.hChanged != NULL) CloseHandle(key.hChanged);
+		key.hChanged = NULL;
+	}
+}
 
-	if (lpSubKey == NULL) return ERROR_INVALID_PARAMETER;
-	if (lpValueName == NULL) return ERROR_INVALID_PARAMETER;
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: startSettingsNotification
 
-	// Open registry key
-	lsResult = RegCreateKeyEx(hkRoot, lpSubKey, 0, NULL, 0, KEY_WRITE, NULL, &hKey, NULL);
-	if (lsResult == ERROR_SUCCESS) {
+  Summary:   Starts the registry change notifications for the settings and
+			 reads the snapshot. Without notifications (error) the snapshot
+			 is read again by every updateSettingsSnapshot.
 
-		// Write to registry
-		lsResult = RegSetValueEx(hKey, lpValueName, 0, REG_DWORD, (const BYTE*)&dwValue, sizeof(dwValue));
-		if (lsResult != ERROR_SUCCESS) {
-			OutputDebugString(L"Error writing to registry");
+  Args:
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void startSettingsNotification()
+{
+	BOOL bSuccess = TRUE;
+	for (int source = 0; source < SETTINGSOURCES; source++)
+	{
+		SETTINGSKEY& key = g_settingsKeys[source];
+		key.hChanged = CreateEvent(NULL, FALSE, FALSE, NULL);
+		if ((key.hChanged == NULL) ||
+			!RegisterWaitForSingleObject(&key.hWait, key.hChanged, settingsChangedCallback, (PVOID)(INT_PTR)source, INFINITE, WT_EXECUTEDEFAULT))
+		{
+			key.hWait = NULL;
+			bSuccess = FALSE;
+			break;
 		}
-		RegCloseKey(hKey);
 	}
-	return lsResult;
+	if (!bSuccess)
+	{
+		OutputDebugString(L"Registry change notification not available");
+		stopSettingsNotification();
+		return;
+	}
+
+	g_bSettingsNotification = TRUE;
+	for (int source = 0; source < SETTINGSOURCES; source++) openSettingsKey((SETTINGSOURCE)source);
+	readSettingsSnapshot();
 }
 
 /*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
   Function: getDWORDSettingFromRegistry
 
-  Summary:   Gets stored DWORD setting from registry
+  Summary:   Gets stored DWORD setting from the snapshot of the registry
+			 (see updateSettingsSnapshot)
 
   Args:      APPDWORDSETTINGS setting
 			   Setting
@@ -761,86 +1790,17 @@ LSTATUS setDWORDValueToRegistry(HKEY hkRoot,LPCWSTR lpSubKey, LPCWSTR lpValueNam
 -----------------------------------------------------------------F-F*/
 BOOL getDWORDSettingFromRegistry(APPDWORDSETTINGS setting) {
 	DWORD dwValue = 0;
-	BOOL bFound = FALSE;
+	bool bPolicy = false;
 
-	std::wstring sValueName = L"";
-	switch (setting)
-	{
-		case defaultZoomScale: sValueName.assign(L"defaultZoomScale"); break;
-		case screenshotDelay: sValueName.assign(L"screenshotDelay"); break;
-		case saveToClipboard: sValueName.assign(L"saveToClipboard"); break;
-		case saveToFile: sValueName.assign(L"saveToFile"); break;
-		case useAlternativeColors: sValueName.assign(L"useAlternativeColors"); break;
-		case displayInternalInformation: sValueName.assign(L"displayInternalInformation"); break;
-		case storedSelectionLeft: sValueName.assign(L"storedSelectionLeft"); break;
-		case storedSelectionTop: sValueName.assign(L"storedSelectionTop"); break;
-		case storedSelectionRight: sValueName.assign(L"storedSelectionRight"); break;
-		case storedSelectionBottom: sValueName.assign(L"storedSelectionBottom"); break;
-		case disablePrintScreenKeyForSnipping: sValueName.assign(L"disablePrintScreenKeyForSnipping"); break;
-		case DEV: sValueName.assign(L"DEV"); break;
-		default: OutputDebugString(L"Invalid setting");	return FALSE;
-	}
-	if (sValueName.empty())
+	if ((setting < 0) || (setting >= APPDWORDSETTINGSCOUNT))
 	{
 		OutputDebugString(L"Invalid setting");
 		return FALSE;
 	}
+	if (!g_settings.bValid) refreshSettingsSnapshot(SETTINGSOURCESALL);
 
-	// Reset GPO flag
-	switch (setting)
-	{
-		case screenshotDelay: g_bScreenshotDelayGPO = FALSE; break;
-		case saveToClipboard: g_bSaveToClipboardGPO = FALSE; break;
-		case saveToFile: g_bSaveToFileGPO = FALSE; break;
-		case displayInternalInformation: g_bDisplayInternalInformationGPO = FALSE; break;
-	}
-
-	// Check GPO settings
+	// Program defaults
 	switch (setting)
-	{
-		case defaultZoomScale:
-		case screenshotDelay:
-		case saveToClipboard:
-		case saveToFile:
-		case displayInternalInformation:
-		case disablePrintScreenKeyForSnipping:
-		{
-			// Get stored path from GPO or registry
-			if (!bFound) bFound = (getDWORDValueFromRegistry(HKEY_CURRENT_USER, REGISTRYGPOPATH, sValueName.c_str(), dwValue) == ERROR_SUCCESS);
-			if (!bFound) bFound = (getDWORDValueFromRegistry(HKEY_LOCAL_MACHINE, REGISTRYGPOPATH, sValueName.c_str(), dwValue) == ERROR_SUCCESS);
-			break;
-		}
-	}
-	if (bFound) switch (setting)
-	{
-		case screenshotDelay: g_bScreenshotDelayGPO = TRUE; break;
-		case saveToClipboard: g_bSaveToClipboardGPO = TRUE; break;
-		case saveToFile: g_bSaveToFileGPO = TRUE; break;
-		case displayInternalInformation: g_bDisplayInternalInformationGPO = TRUE; break;
-	}
-
-	// User registry value
-	if (!bFound) bFound = (getDWORDValueFromRegistry(HKEY_CURRENT_USER, REGISTRYSETTINGSPATH, sValueName.c_str(), dwValue) == ERROR_SUCCESS);
-
-	// Failback to GPO default settings, if not found
-	if (!bFound) switch (setting)
-	{
-		case defaultZoomScale:
-		case screenshotDelay:
-		case saveToClipboard:
-		case saveToFile:
-		case displayInternalInformation:
-		case disablePrintScreenKeyForSnipping:
-		{
-			// Get stored path from GPO default settings
-			if (!bFound) bFound = (getDWORDValueFromRegistry(HKEY_CURRENT_USER, REGISTRYGPODEFAULTSPATH, sValueName.c_str(), dwValue) == ERROR_SUCCESS);
-			if (!bFound) bFound = (getDWORDValueFromRegistry(HKEY_LOCAL_MACHINE, REGISTRYGPODEFAULTSPATH, sValueName.c_str(), dwValue) == ERROR_SUCCESS);
-			break;
-		}
-	}
-
-	// Use program defaults, if not found
-	if (!bFound) switch (setting)
 	{
 		case defaultZoomScale: dwValue = DEFAULTZOOMSCALE; break;
 		case screenshotDelay: dwValue = DEFAULTSCREENSHOTDELAY; break;
@@ -853,10 +1813,34 @@ BOOL getDWORDSettingFromRegistry(APPDWORDSETTINGS setting) {
 		case storedSelectionRight: dwValue = UNINITIALIZEDLONG; break;
 		case storedSelectionBottom: dwValue = UNINITIALIZEDLONG; break;
 		case disablePrintScreenKeyForSnipping: dwValue = FALSE; break;
+		case colorTolerance: dwValue = DEFAULTCOLORTOLERANCE; break;
+		case compressionProfile: dwValue = DEFAULTCOMPRESSIONPROFILE; break;
+		case keepLastCapture: dwValue = DEFAULTKEEPLASTCAPTURE; break;
+		case latencyLog: dwValue = DEFAULTLATENCYLOG; break;
+		case trace: dwValue = DEFAULTTRACE; break;
+		case parallelMonitorCapture: dwValue = DEFAULTPARALLELMONITORCAPTURE; break;
+		case captureMonitorOnly: dwValue = DEFAULTCAPTUREMONITORONLY; break;
+		case captureHistory: dwValue = DEFAULTCAPTUREHISTORY; break;
+		case captureHistoryInterval: dwValue = DEFAULTCAPTUREHISTORYINTERVAL; break;
+		case captureHistoryMemory: dwValue = DEFAULTCAPTUREHISTORYMEMORY; break;
 		case DEV: dwValue = 0; break;
 		default: OutputDebugString(L"Invalid setting");	return FALSE;
 	}
 
+	// GPO, user registry value, GPO default settings or program default
+	dwValue = resolveDWORDSetting(g_settings.dwordSettings[setting], isPolicyDWORDSetting(setting) ? true : false, dwValue, &bPolicy);
+
+	// Set GPO flag
+	switch (setting)
+	{
+		case screenshotDelay: g_bScreenshotDelayGPO = bPolicy; break;
+		case saveToClipboard: g_bSaveToClipboardGPO = bPolicy; break;
+		case saveToFile: g_bSaveToFileGPO = bPolicy; break;
+		case displayInternalInformation: g_bDisplayInternalInformationGPO = bPolicy; break;
+		case compressionProfile: g_bCompressionProfileGPO = bPolicy; break;
+		case captureMonitorOnly: g_bCaptureMonitorOnlyGPO = bPolicy; break;
+	}
+
 	// Check limits
 	switch (setting)
 	{
@@ -875,8 +1859,30 @@ BOOL getDWORDSettingFromRegistry(APPDWORDSETTINGS setting) {
 			if (dwValue > 1) dwValue = 1;
 			break;
 		case disablePrintScreenKeyForSnipping:
+		case keepLastCapture:
+		case latencyLog:
+		case trace:
+		case parallelMonitorCapture:
+		case captureMonitorOnly:
 			if (dwValue > 1) dwValue = 1;
 			break;
+		case colorTolerance:
+			if (dwValue > MAXCOLORTOLERANCE) dwValue = MAXCOLORTOLERANCE;
+			break;
+		case compressionProfile:
+			if (dwValue > MAXCOMPRESSIONPROFILE) dwValue = MAXCOMPRESSIONPROFILE;
+			break;
+		case captureHistory:
+			if (dwValue > MAXCAPTUREHISTORY) dwValue = MAXCAPTUREHISTORY;
+			break;
+		case captureHistoryInterval:
+			if (dwValue < MINCAPTUREHISTORYINTERVAL) dwValue = MINCAPTUREHISTORYINTERVAL;
+			if (dwValue > MAXCAPTUREHISTORYINTERVAL) dwValue = MAXCAPTUREHISTORYINTERVAL;
+			break;
+		case captureHistoryMemory:
+			if (dwValue < MINCAPTUREHISTORYMEMORY) dwValue = MINCAPTUREHISTORYMEMORY;
+			if (dwValue > MAXCAPTUREHISTORYMEMORY) dwValue = MAXCAPTUREHISTORYMEMORY;
+			break;
 	}
 
 	switch (setting)
@@ -892,6 +1898,16 @@ BOOL getDWORDSettingFromRegistry(APPDWORDSETTINGS setting) {
 		case storedSelectionRight: g_storedSelection.right = dwValue; break;
 		case storedSelectionBottom: g_storedSelection.bottom = dwValue; break;
 		case disablePrintScreenKeyForSnipping: g_bDisablePrintScreenKeyForSnipping = dwValue; break;
+		case colorTolerance: g_colorTolerance = dwValue; break;
+		case compressionProfile: g_compressionProfile = dwValue; break;
+		case keepLastCapture: g_keepLastCapture = dwValue; break;
+		case latencyLog: g_latencyLog = dwValue; break;
+		case trace: g_trace = dwValue; break;
+		case parallelMonitorCapture: g_parallelMonitorCapture = dwValue; break;
+		case captureMonitorOnly: g_captureMonitorOnly = dwValue; break;
+		case captureHistory: g_captureHistorySeconds = dwValue; break;
+		case captureHistoryInterval: g_captureHistoryInterval = dwValue; break;
+		case captureHistoryMemory: g_captureHistoryMemory = dwValue; break;
 		case DEV: g_bDEV = dwValue; break;
 		default:
 			OutputDebugString(L"Invalid setting");
@@ -957,7 +1973,12 @@ BOOL storeDWORDSettingInRegistry(APPDWORDSETTINGS setting, DWORD dwValue) {
 	}
 
 	if (setDWORDValueToRegistry(HKEY_CURRENT_USER,REGISTRYSETTINGSPATH, sValueName.c_str(), dwValue) == ERROR_SUCCESS)
+	{
+		// Update snapshot without waiting for the change notification
+		g_settings.dwordSettings[setting].bFound[settingSourceUser] = true;
+		g_settings.dwordSettings[setting].value[settingSourceUser] = dwValue;
 		return TRUE;
+	}
 	else
 		return FALSE;
 }
@@ -1063,7 +2084,7 @@ BOOL isRunKeyEnabledFromRegistry()
 /*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
   Function: getScreenshotPathFromRegistry
 
-  Summary:   Get path of screenshot folder from GPO, registry or path to EXE file
+  Summary:   Get path of screenshot folder from GPO, registry (snapshot) or path to EXE file
 
   Args:
 
@@ -1072,29 +2093,20 @@ BOOL isRunKeyEnabledFromRegistry()
 -----------------------------------------------------------------F-F*/
 void getScreenshotPathFromRegistry()
 {
-	BOOL bFound = FALSE;
-	wchar_t szRegistryValue[]=L"screenshotPath";
-	g_bScreenshotPathGPO = FALSE;
-	g_screenshotPath[0] = L'\0';
-
-	// Get stored path from GPO or registry
-	bFound = getSZFromRegistry(HKEY_CURRENT_USER, REGISTRYGPOPATH, szRegistryValue, g_screenshotPath, MAX_PATH);
-	if (!bFound) bFound = getSZFromRegistry(HKEY_LOCAL_MACHINE, REGISTRYGPOPATH, szRegistryValue, g_screenshotPath, MAX_PATH);
-	if (bFound) g_bScreenshotPathGPO = TRUE;
-	if (!bFound) bFound = getSZFromRegistry(HKEY_CURRENT_USER, REGISTRYSETTINGSPATH, szRegistryValue, g_screenshotPath, MAX_PATH);
-
-	// Failback value (also check folder to be folder and nothing else, because later we use ShellExecute)
-	if (!bFound || !PathIsDirectory(g_screenshotPath))
+	if (!g_settings.bValid) refreshSettingsSnapshot(SETTINGSOURCESALL);
+
+	// Stored path from GPO, registry or GPO default settings (also check folder to be folder and nothing else, because later we use ShellExecute)
+	SETTINGRESOLUTION resolution = resolveSettingSource(g_settings.bScreenshotPathFound, true, [](SETTINGSOURCE source) {
+		return PathIsDirectory(g_settings.sScreenshotPath[source].c_str()) ? true : false;
+	});
+	g_bScreenshotPathGPO = resolution.bPolicy;
+
+	if (resolution.source != settingSourceDefault) wcsncpy_s(g_screenshotPath, MAX_PATH, g_settings.sScreenshotPath[resolution.source].c_str(), _TRUNCATE);
+	else // Last failback
 	{
-		// GPO default settings
-		bFound = getSZFromRegistry(HKEY_CURRENT_USER, REGISTRYGPODEFAULTSPATH, szRegistryValue, g_screenshotPath, MAX_PATH);
-		if (!bFound) bFound = getSZFromRegistry(HKEY_LOCAL_MACHINE, REGISTRYGPODEFAULTSPATH, szRegistryValue, g_screenshotPath, MAX_PATH);
-		if (!bFound || !PathIsDirectory(g_screenshotPath)) // Last failback
-		{
-			// Use path of EXE file
-			GetModuleFileName(NULL, g_screenshotPath, MAX_PATH);
-			PathRemoveFileSpec(g_screenshotPath);
-		}
+		// Use path of EXE file
+		GetModuleFileName(NULL, g_screenshotPath, MAX_PATH);
+		PathRemoveFileSpec(g_screenshotPath);
 	}
 }
 
@@ -1155,68 +2167,18 @@ void changeScreenshotPathAndStorePathToRegistry()
 		WCHAR szPath[MAX_PATH];
 		if (SHGetPathFromIDList(pidlSelected, szPath))
 		{
-			RegSetKeyValue(HKEY_CURRENT_USER, REGISTRYSETTINGSPATH, L"screenshotPath", REG_SZ, szPath, (DWORD)(wcslen(szPath) + 1) * sizeof(WCHAR));
+			if (RegSetKeyValue(HKEY_CURRENT_USER, REGISTRYSETTINGSPATH, L"screenshotPath", REG_SZ, szPath, (DWORD)(wcslen(szPath) + 1) * sizeof(WCHAR)) == ERROR_SUCCESS)
+			{
+				// Update snapshot without waiting for the change notification
+				g_settings.bScreenshotPathFound[settingSourceUser] = true;
+				g_settings.sScreenshotPath[settingSourceUser].assign(szPath);
+			}
 		}
 		CoTaskMemFree(pidlSelected);
 	}
 	CoTaskMemFree(pidl);
 }
 
-/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-  Function: GetEncoderClsid
-
-  Summary:   Get encoder CLsid for a mime type string
-
-  Args:     const WCHAR* format
-			  Mime type string
-			CLSID* pClsid
-			  Pointer to encoder CLsid
-
-  Returns:	int
-			  >=0 = Ok (Index in encoder array)
-			  -1 = Error
-
------------------------------------------------------------------F-F*/
-int GetEncoderClsid(const WCHAR* format, CLSID* pClsid)
-{
-	Status status;
-	UINT num = 0; // Number of available image encoders
-	UINT size = 0; // Total size, in bytes, of the array of ImageCodecInfo objects
-
-	Gdiplus::ImageCodecInfo* pImageCodecInfo = NULL;
-
-	status = Gdiplus::GetImageEncodersSize(&num, &size);
-	if (status != Gdiplus::Ok) return -1; // Windows GDI+ not OK
-	if (size == 0) return -1; // Error
-	if (num == 0) return -1; // No encoders
-
-	pImageCodecInfo = (Gdiplus::ImageCodecInfo*)(malloc(size));
-	if (pImageCodecInfo == NULL) return -1;
-
-	status = Gdiplus::GetImageEncoders(num, size, pImageCodecInfo);
-	if (status != Gdiplus::Ok) // Windows GDI+ not OK
-	{
-		free(pImageCodecInfo);
-		return -1; // Error
-	}
-
-	for (UINT j = 0; j < num; j++)
-	{
-		// warning C6385: Reading invalid data from 'pImageCodecInfo'
-#ifdef _MSC_VER
-#pragma warning( suppress: 6385 )
-#endif
-		if (wcscmp(pImageCodecInfo[j].MimeType, format) == 0)
-		{
-			*pClsid = pImageCodecInfo[j].Clsid;
-			free(pImageCodecInfo);
-			return j; // Success
-		}
-	}
-	free(pImageCodecInfo);
-	return -1; // Error
-}
-
 /*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
   Function: checkPrintScreenKeyForSnipping
 
@@ -1322,10 +2284,11 @@ void enterFullScreen(HWND hWindow)
 {
 	DWORD dwStyle = GetWindowLong(hWindow, GWL_STYLE);
 
-	int screenX = GetSystemMetrics(SM_XVIRTUALSCREEN);
-	int screenY = GetSystemMetrics(SM_YVIRTUALSCREEN);
-	int screenWidth = GetSystemMetrics(SM_CXVIRTUALSCREEN);
-	int screenHeight = GetSystemMetrics(SM_CYVIRTUALSCREEN);
+	// Virtual screen of the screenshot
+	int screenX = g_captureRect.left;
+	int screenY = g_captureRect.top;
+	int screenWidth = g_captureRect.right - g_captureRect.left;
+	int screenHeight = g_captureRect.bottom - g_captureRect.top;
 
 	g_appWindowPos.x = screenX;
 	g_appWindowPos.y = screenY;
@@ -1340,167 +2303,358 @@ void enterFullScreen(HWND hWindow)
 /*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
   Function: MySetCursorPos
 
-  Summary:   Set mouse cursor position (Variant of SetCursorPos. See comments for "Check position")
+  Summary:   Set mouse cursor position (Variant of SetCursorPos. See comments for "Check position")
+
+  Args:     int posX
+			  mouse x position
+			int posY
+			  mouse y position
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void MySetCursorPos(int posX, int posY)
+{
+	SetCursorPos(posX + g_appWindowPos.x, posY + g_appWindowPos.y);
+
+	/*
+	 * Check position
+	 *
+	 * Under special conditions SetCursorPos does not set correct position, see:
+	 * https://stackoverflow.com/questions/65519784/why-does-setcursorpos-reset-the-cursor-position-to-the-left-hand-side-of-the-dis
+	 * https://stackoverflow.com/questions/58753372/winapi-setcursorpos-seems-like-not-working-properly-on-multiple-monitors-with-di
+	 * As a workaround, try move horizontally first and than repeat whole position
+	 */
+	POINT mouse;
+	GetCursorPos(&mouse);
+	if ((mouse.x - g_appWindowPos.x != posX) || (mouse.y - g_appWindowPos.y != posY))
+	{
+		SetCursorPos(posX + g_appWindowPos.x, mouse.y / 2);
+		SetCursorPos(posX + g_appWindowPos.x, posY + g_appWindowPos.y);
+	}
+}
+
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: limitXtoBitmap
+
+  Summary:   Ensures that X is inside screenshot bitmap
+
+  Args:     int X
+
+  Returns:	int
+			  X inside the screenshot bitmap
+
+-----------------------------------------------------------------F-F*/
+int limitXtoBitmap(int X) {
+	if (!isImageValid(g_screenshot)) return X;
+
+	if (X < 0) return 0;
+	if (X > g_screenshot.width - 1) return g_screenshot.width - 1;
+	return X;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: limitYtoBitmap
+
+  Summary:   Ensures that Y is inside screenshot bitmap
+
+  Args:     int Y
+
+  Returns:	int
+			  Y inside the screenshot bitmap
+
+-----------------------------------------------------------------F-F*/
+int limitYtoBitmap(int Y) {
+	if (!isImageValid(g_screenshot)) return Y;
+
+	if (Y < 0) return 0;
+	if (Y > g_screenshot.height - 1) return g_screenshot.height - 1;
+	return Y;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: writePNGFile
+
+  Summary:   Encodes image and writes it to a PNG file. Shows no message boxes
+			 and can be used by the writer thread of the save queue.
+
+  Args:     const IMAGEBUFFER& image
+			  Image
+			const std::wstring& sFullPath
+			  Path and filename for PNG file
+			const PNGOPTIONS& options
+			  Encoder options
+			BOOL& bFileError
+			  TRUE = error of the file (call by ref), another folder can help
+			  FALSE = success or error of the encoder (invalid image or out of memory)
+
+  Returns:	DWORD
+			  ERROR_SUCCESS = success
+			  Other = Win32 error code
+
+-----------------------------------------------------------------F-F*/
+DWORD writePNGFile(const IMAGEBUFFER& image, const std::wstring& sFullPath, const PNGOPTIONS& options, BOOL& bFileError)
+{
+	TRACESCOPE traceScope("writePNGFile");
+	DWORD dwError = ERROR_SUCCESS;
+	bFileError = FALSE;
+	if (!isImageValid(image)) return ERROR_INVALID_PARAMETER;
+
+	HANDLE hFile = CreateFile(sFullPath.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (hFile == INVALID_HANDLE_VALUE)
+	{
+		bFileError = TRUE;
+		return GetLastError();
+	}
+
+	BOOL bEncoded = encodePNG(image, [hFile, &dwError](const uint8_t* pData, size_t size) {
+		DWORD dwWritten = 0;
+		if (WriteFile(hFile, pData, (DWORD)size, &dwWritten, NULL) && (dwWritten == size)) return true;
+		dwError = GetLastError();
+		return false;
+	}, options);
+	CloseHandle(hFile);
+	if (!bEncoded)
+	{
+		DeleteFile(sFullPath.c_str()); // Remove incomplete file
+		bFileError = (dwError != ERROR_SUCCESS);
+		if (!bFileError) dwError = ERROR_NOT_ENOUGH_MEMORY; // Encoder failed without write error, only memory allocations can fail for a valid image
+	}
+	return dwError;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: showSaveError
+
+  Summary:   Shows error for a PNG file, which could not be written, and asks
+			 for a new screenshot folder, when the error was caused by the file
+
+  Args:     const std::wstring& sFullPath
+			  Path and filename of the PNG file
+			DWORD dwError
+			  Win32 error code
+			BOOL bFileError
+			  TRUE = error of the file, ask for a new folder
+			  FALSE = error of the encoder, only show the error
+
+  Returns:	BOOL
+			  TRUE = folder was changed, retry
+			  FALSE = canceled or no file error
+
+-----------------------------------------------------------------F-F*/
+BOOL showSaveError(const std::wstring& sFullPath, DWORD dwError, BOOL bFileError)
+{
+	wchar_t szHex[_MAX_ITOSTR_BASE16_COUNT + 2];
+	std::wstring sError;
+
+	sError.assign(LoadStringAsWstr(g_hInst, IDS_ERRORCREATING).c_str()).append(L"\n").append(sFullPath);
+
+	size_t size;
+	LPWSTR messageBuffer = nullptr;
+	size = FormatMessage(FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
+		NULL, dwError, MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT), (LPWSTR)&messageBuffer, 0, NULL);
+	if (size > 0)
+	{
+		StrTrim(messageBuffer, L"\r\n");
+		sError.append(L"\n").append(messageBuffer);
+	}
+	_snwprintf_s(szHex, _MAX_ITOSTR_BASE16_COUNT + 2, _TRUNCATE, L"0x%08X", dwError);
+	LocalFree(messageBuffer);
+	sError.append(L" ").append(szHex);
+	if (bFileError) sError.append(L"\n").append(LoadStringAsWstr(g_hInst, IDS_CHANGEFOLDER));
+
+	// No new capture while the message box is shown, because a synchronous save reads the image from the screenshot
+	BOOL bModalBlocked = (WaitForSingleObject(g_hSemaphoreModalBlocked, 0) == WAIT_OBJECT_0);
+	BOOL bRetry = (MessageBox(g_hWindow, sError.c_str(), LoadStringAsWstr(g_hInst, IDS_APP_TITLE).c_str(), (bFileError ? MB_OKCANCEL : MB_OK) | MB_ICONERROR) != IDCANCEL) && bFileError;
+	if (bRetry) changeScreenshotPathAndStorePathToRegistry();
+	if (bModalBlocked) ReleaseSemaphore(g_hSemaphoreModalBlocked, 1, NULL);
+	return bRetry;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: saveImageAsPNG
+
+  Summary:   Save image as PNG file
+
+  Args:     const IMAGEBUFFER& image
+			  Image or view to the selected area of the screenshot
+			const WCHAR* fileName
+			  Filename for PNG file
+
+  Returns:	BOOL
+			  TRUE = success
+			  FALSE = failure
+
+-----------------------------------------------------------------F-F*/
+BOOL saveImageAsPNG(const IMAGEBUFFER& image, const WCHAR* fileName)
+{
+	BOOL bRC = TRUE;
+	std::wstring sFullPathWorkingFile;
+
+	DWORD dwError;
+	BOOL bFileError;
+	do
+	{
+		// Get Path
+		sFullPathWorkingFile.assign(g_screenshotPath).append(L"\\").append(fileName);
+
+		// Create PNG
+		dwError = writePNGFile(image, sFullPathWorkingFile, getPNGOptionsForProfile((PNGCOMPRESSIONPROFILE)g_compressionProfile), bFileError);
+	} while ((dwError != ERROR_SUCCESS) && showSaveError(sFullPathWorkingFile, dwError, bFileError));
+	bRC = (dwError == ERROR_SUCCESS);
+
+	if (bRC) g_sLastScreenshotFile = sFullPathWorkingFile;
+	return bRC;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: freeSaveJob
+
+  Summary:   Frees save job and its image
 
-  Args:     int posX
-			  mouse x position
-			int posY
-			  mouse y position
+  Args:     SAVEJOB* pJob
+			  Save job
 
   Returns:
 
 -----------------------------------------------------------------F-F*/
-void MySetCursorPos(int posX, int posY)
+void freeSaveJob(SAVEJOB* pJob)
 {
-	SetCursorPos(posX + g_appWindowPos.x, posY + g_appWindowPos.y);
-
-	/*
-	 * Check position
-	 *
-	 * Under special conditions SetCursorPos does not set correct position, see:
-	 * https://stackoverflow.com/questions/65519784/why-does-setcursorpos-reset-the-cursor-position-to-the-left-hand-side-of-the-dis
-	 * https://stackoverflow.com/questions/58753372/winapi-setcursorpos-seems-like-not-working-properly-on-multiple-monitors-with-di
-	 * As a workaround, try move horizontally first and than repeat whole position
-	 */
-	POINT mouse;
-	GetCursorPos(&mouse);
-	if ((mouse.x - g_appWindowPos.x != posX) || (mouse.y - g_appWindowPos.y != posY))
-	{
-		SetCursorPos(posX + g_appWindowPos.x, mouse.y / 2);
-		SetCursorPos(posX + g_appWindowPos.x, posY + g_appWindowPos.y);
-	}
+	if (pJob == NULL) return;
+	freeImageBuffer(pJob->image);
+	delete pJob;
 }
 
-
 /*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-  Function: limitXtoBitmap
+  Function: enqueueSaveJobForScreenshotPath
 
-  Summary:   Ensures that X is inside screenshot bitmap
+  Summary:   Sets path and encoder options of the save job from the current
+			 settings and adds the job to the save queue. The writer thread
+			 returns the job to the UI thread by WM_SAVEFINISHED or frees it
+			 itself, when there is no window.
 
-  Args:     int X
+  Args:     SAVEJOB* pJob
+			  Save job
 
-  Returns:	int
-			  X inside the screenshot bitmap
+  Returns:	BOOL
+			  TRUE = success
+			  FALSE = failure (job was not enqueued and is still owned by the caller)
 
 -----------------------------------------------------------------F-F*/
-int limitXtoBitmap(int X) {
-	if (g_hBitmap == NULL) return X;
-
-	BITMAP bm;
-	if (GetObject(g_hBitmap, sizeof(bm), &bm) != 0)
-	{
-		if (X < 0) return 0;
-		if (X > bm.bmWidth - 1) return bm.bmWidth - 1;
-	}
-	return X;
+BOOL enqueueSaveJobForScreenshotPath(SAVEJOB* pJob)
+{
+	pJob->sFullPath.assign(g_screenshotPath).append(L"\\").append(pJob->sFileName);
+	pJob->options = getPNGOptionsForProfile((PNGCOMPRESSIONPROFILE)g_compressionProfile);
+	pJob->dwError = ERROR_SUCCESS;
+	pJob->bFileError = FALSE;
+
+	HWND hWindow = g_hWindow;
+	return enqueueSaveJob([pJob, hWindow]() {
+		pJob->dwError = writePNGFile(pJob->image, pJob->sFullPath, pJob->options, pJob->bFileError);
+		if (hWindow == NULL) // No window (/interval=), errors are reported when all captures are finished
+		{
+			if (pJob->dwError != ERROR_SUCCESS) InterlockedIncrement(&g_failedSaveJobs);
+			freeSaveJob(pJob);
+		}
+		else if (!PostMessage(hWindow, WM_SAVEFINISHED, 0, (LPARAM)pJob)) freeSaveJob(pJob); // Window is already destroyed
+	});
 }
 
 /*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-  Function: limitYtoBitmap
+  Function: saveSelectionAsPNGAsync
 
-  Summary:   Ensures that Y is inside screenshot bitmap
+  Summary:   Copies the selected area of the screenshot and saves it as PNG
+			 file in the writer thread of the save queue, so a new capture can
+			 start while the file is compressed. The copy is needed, because
+			 the next capture replaces the screenshot.
 
-  Args:     int Y
+  Args:     const IMAGEBUFFER& selection
+			  View to the selected area of the screenshot
+			const WCHAR* fileName
+			  Filename for PNG file
 
-  Returns:	int
-			  Y inside the screenshot bitmap
+  Returns:	BOOL
+			  TRUE = success
+			  FALSE = failure or save queue is full (nothing enqueued, caller can save synchronously)
 
 -----------------------------------------------------------------F-F*/
-int limitYtoBitmap(int Y) {
-	if (g_hBitmap == NULL) return Y;
+BOOL saveSelectionAsPNGAsync(const IMAGEBUFFER& selection, const WCHAR* fileName)
+{
+	TRACESCOPE traceScope("saveSelectionAsPNGAsync");
+	SAVEJOB* pJob = new (std::nothrow) SAVEJOB;
+	if (pJob == NULL) return FALSE;
+	if (!createImageBuffer(pJob->image, selection.width, selection.height))
+	{
+		delete pJob;
+		return FALSE;
+	}
+	copyImage(pJob->image, selection);
+	pJob->sFileName = fileName;
 
-	BITMAP bm;
-	if (GetObject(g_hBitmap, sizeof(bm), &bm) != 0)
+	if (!enqueueSaveJobForScreenshotPath(pJob))
 	{
-		if (Y < 0) return 0;
-		if (Y > bm.bmHeight - 1) return bm.bmHeight - 1;
+		freeSaveJob(pJob);
+		return FALSE;
 	}
-	return Y;
+	return TRUE;
 }
 
 /*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-  Function: SaveBitmapAsPNG
+  Function: createClipboardDIB
 
-  Summary:   Save bitmap as PNG file
+  Summary:   Creates a packed 24bpp DIB (CF_DIB) from an image. Rows are
+			 converted directly from the image or view, so no cropped bitmap is
+			 needed. 24bpp has no fourth byte, which alpha aware programs could
+			 read as transparency (the upper byte of screenshot pixels is
+			 undefined). Windows converts CF_DIB to CF_BITMAP on request.
 
-  Args:     HBITMAP hBitmap
-			  Bitmap
-			const WCHAR* fileName
-			  Filename for PNG file
+  Args:     const IMAGEBUFFER& image
+			  Image or view to the selected area of the screenshot
 
-  Returns:	BOOL
-			  TRUE = success
-			  FALSE = failure
+  Returns:	HGLOBAL
+			  Movable memory for SetClipboardData or NULL on failure
 
 -----------------------------------------------------------------F-F*/
-BOOL SaveBitmapAsPNG(HBITMAP hBitmap, const WCHAR* fileName)
+HGLOBAL createClipboardDIB(const IMAGEBUFFER& image)
 {
-	BOOL bRC = TRUE;
-	wchar_t szHex[_MAX_ITOSTR_BASE16_COUNT + 2];
-	std::wstring sError;
-	ULONG_PTR gdiplusToken;
-	GdiplusStartupInput gdiplusStartupInput;
-	std::wstring sFullPathWorkingFile;
+	TRACESCOPE traceScope("createClipboardDIB");
+	if (!isImageValid(image)) return NULL;
 
-	GdiplusStartup(&gdiplusToken, &gdiplusStartupInput, NULL);
+	size_t rowSize = ((size_t)image.width * 3 + 3) & ~(size_t)3; // DIB rows are aligned to 4 bytes
+	HGLOBAL hDIB = GlobalAlloc(GMEM_MOVEABLE, sizeof(BITMAPINFOHEADER) + rowSize * image.height);
+	if (hDIB == NULL) return NULL;
 
-	// Convert bitmap to GDI+
-	Bitmap* bitmap = new Bitmap(hBitmap, NULL);
-	if (bitmap != NULL)
+	BITMAPINFOHEADER* pHeader = (BITMAPINFOHEADER*)GlobalLock(hDIB);
+	if (pHeader == NULL)
 	{
-		// Create PNG
-		CLSID clsidPng;
-		GetEncoderClsid(L"image/png", &clsidPng);
-
-		bool bFinished = false;
-		do
+		GlobalFree(hDIB);
+		return NULL;
+	}
+	memset(pHeader, 0, sizeof(BITMAPINFOHEADER));
+	pHeader->biSize = sizeof(BITMAPINFOHEADER);
+	pHeader->biWidth = image.width;
+	pHeader->biHeight = image.height; // Bottom-up, like most clipboard readers expect
+	pHeader->biPlanes = 1;
+	pHeader->biBitCount = 24;
+	pHeader->biCompression = BI_RGB;
+
+	uint8_t* pBits = (uint8_t*)(pHeader + 1);
+	for (int y = 0; y < image.height; y++)
+	{
+		const IMAGEPIXEL* pPixel = imageRow(image, y);
+		uint8_t* pTarget = pBits + rowSize * (image.height - 1 - y);
+		for (int x = 0; x < image.width; x++) // B,G,R without the undefined upper byte
 		{
-			// Get Path
-			sFullPathWorkingFile.assign(g_screenshotPath).append(L"\\").append(fileName);
-
-			Status status = bitmap->Save(sFullPathWorkingFile.c_str(), &clsidPng, NULL);
-			if (status != Gdiplus::Ok) // Windows GDI+ not OK
-			{
-				sError.assign(LoadStringAsWstr(g_hInst, IDS_ERRORCREATING).c_str()).append(L"\n").append(sFullPathWorkingFile);
-
-				if (status == Win32Error) {
-					size_t size;
-					LPWSTR messageBuffer = nullptr;
-					size = FormatMessage(FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
-						NULL, GetLastError(), MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT), (LPWSTR)&messageBuffer, 0, NULL);
-					if (size > 0)
-					{
-						StrTrim(messageBuffer, L"\r\n");
-						sError.append(L"\n").append(messageBuffer);
-					}
-					_snwprintf_s(szHex, _MAX_ITOSTR_BASE16_COUNT + 2, _TRUNCATE, L"0x%08X", GetLastError());
-					LocalFree(messageBuffer);
-					sError.append(L" ").append(szHex).append(L"\n").append(LoadStringAsWstr(g_hInst, IDS_CHANGEFOLDER));
-					if (MessageBox(g_hWindow, sError.c_str(), LoadStringAsWstr(g_hInst, IDS_APP_TITLE).c_str(), MB_OKCANCEL | MB_ICONERROR) != IDCANCEL)
-						changeScreenshotPathAndStorePathToRegistry();
-					else
-						bFinished = true;
-				}
-				else
-				{
-					_snwprintf_s(szHex, _MAX_ITOSTR_BASE16_COUNT + 2, _TRUNCATE, L"0x%08X", status);
-					sError.append(L"\nStatus:").append(szHex);
-					MessageBox(g_hWindow, sError.c_str(), LoadStringAsWstr(g_hInst, IDS_APP_TITLE).c_str(), MB_OK | MB_ICONERROR);
-					bFinished = true;
-				}
-				bRC = FALSE;
-			}
-			else {
-				bFinished = true;
-			}
-		} while (!bFinished);
-		delete bitmap;
+			*pTarget++ = (uint8_t)pPixel[x];
+			*pTarget++ = (uint8_t)(pPixel[x] >> 8);
+			*pTarget++ = (uint8_t)(pPixel[x] >> 16);
+		}
+		for (size_t i = (size_t)image.width * 3; i < rowSize; i++) *pTarget++ = 0; // Padding
 	}
-	else bRC = FALSE;
 
-	if (bRC) g_sLastScreenshotFile = sFullPathWorkingFile;
-	GdiplusShutdown(gdiplusToken);
-	return bRC;
+	GlobalUnlock(hDIB);
+	return hDIB;
 }
 
 /*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -1518,103 +2672,85 @@ BOOL SaveBitmapAsPNG(HBITMAP hBitmap, const WCHAR* fileName)
 -----------------------------------------------------------------F-F*/
 BOOL saveSelection(HWND hWindow)
 {
-	HDC hdcScreenshot = NULL;
-	HDC hdcSelection = NULL;
-	HGDIOBJ hbmScreenshotOld = NULL;
-	HGDIOBJ hbmSelectionOld = NULL;
-	HBITMAP hBitmap = NULL;
+	TRACESCOPE traceScope("saveSelection");
 	BOOL bResult = TRUE;
 	RECT finalSelection;
-	wchar_t szHex[_MAX_ITOSTR_BASE16_COUNT + 2];
+	IMAGEBUFFER selection;
 	std::wstring sMessage = L"";
-	int selectionWidth = 0;
-	int selectionHeight = 0;
 
-	// Retrieves information the entire screenshot bitmap
-	BITMAP bm;
-	if (GetObject(g_hBitmap, sizeof(bm), &bm) == 0) goto FAIL;
+	if (!isImageValid(g_screenshot)) goto FAIL;
+	g_bSavingSelection = TRUE; // Keep screenshot while message boxes run their message loop
 
 	finalSelection = normalizeRectangle(g_selection);
 
 	if (finalSelection.left < 0) finalSelection.left = 0;
-	if (finalSelection.right > bm.bmWidth - 1) finalSelection.right = bm.bmWidth - 1;
+	if (finalSelection.right > g_screenshot.width - 1) finalSelection.right = g_screenshot.width - 1;
 	if (finalSelection.top < 0) finalSelection.top = 0;
-	if (finalSelection.bottom > bm.bmHeight - 1) finalSelection.bottom = bm.bmHeight - 1;
-
-	selectionWidth = finalSelection.right - finalSelection.left + 1;
-	selectionHeight = finalSelection.bottom - finalSelection.top + 1;
-
-	// Copy selected area from entire screenshot to new bitmap
-	hdcScreenshot = CreateCompatibleDC(NULL);
-	if (hdcScreenshot == NULL) goto FAIL;
-
-	hbmScreenshotOld = SelectObject(hdcScreenshot, g_hBitmap);
-	if (hbmScreenshotOld == NULL) goto FAIL;
+	if (finalSelection.bottom > g_screenshot.height - 1) finalSelection.bottom = g_screenshot.height - 1;
 
-	hdcSelection = CreateCompatibleDC(NULL);
-	if (hdcSelection == NULL) goto FAIL;
-
-	hBitmap = CreateCompatibleBitmap(hdcScreenshot, selectionWidth, selectionHeight);
-	if (hBitmap == NULL)
+	// View to the selected area of the screenshot (no copy)
+	if (!getImageView(g_screenshot, finalSelection.left, finalSelection.top,
+		finalSelection.right - finalSelection.left + 1, finalSelection.bottom - finalSelection.top + 1, selection))
 	{
-		sMessage.assign(L"CreateCompatibleBitmap@saveSelection ")
+		sMessage.assign(L"getImageView@saveSelection ")
 			.append(LoadStringAsWstr(g_hInst, IDS_HASFAILED));
 		goto FAIL;
 	}
 
-	hbmSelectionOld = SelectObject(hdcSelection, hBitmap);
-	if (hbmSelectionOld == NULL) goto FAIL;
-
-	if (BitBlt(hdcSelection, 0, 0, selectionWidth, selectionHeight,
-		hdcScreenshot, finalSelection.left, finalSelection.top, SRCCOPY))
+	if (g_saveToFile) // Save selected area to file?
 	{
-		if (g_saveToFile) // Save selected area to file?
-		{
-			// Create folder
-			CreateDirectory(g_screenshotPath, NULL);
+		// Create folder
+		CreateDirectory(g_screenshotPath, NULL);
 
-			// Create file
-			SYSTEMTIME tLocal;
-			GetLocalTime(&tLocal);
-			wchar_t szFileName[MAX_PATH] = L"";
+		// Create file
+		SYSTEMTIME tLocal;
+		GetLocalTime(&tLocal);
+		wchar_t szFileName[MAX_PATH] = L"";
 
 #define FILEPATTERN L"Screenshot %04u-%02u-%02u %02d%02d%02d.png"
-			if (_snwprintf_s(szFileName, MAX_PATH, _TRUNCATE, FILEPATTERN, tLocal.wYear, tLocal.wMonth, tLocal.wDay, tLocal.wHour, tLocal.wMinute, tLocal.wSecond) >= 0) {
-				SaveBitmapAsPNG(hBitmap, szFileName);
-			}
+#define FILEPATTERNMILLISECONDS L"Screenshot %04u-%02u-%02u %02d%02d%02d %03u.png" // For /interval=, because more than one file per second can be created
+		int length;
+		if (g_captureInterval > 0)
+			length = _snwprintf_s(szFileName, MAX_PATH, _TRUNCATE, FILEPATTERNMILLISECONDS, tLocal.wYear, tLocal.wMonth, tLocal.wDay, tLocal.wHour, tLocal.wMinute, tLocal.wSecond, tLocal.wMilliseconds);
+		else
+			length = _snwprintf_s(szFileName, MAX_PATH, _TRUNCATE, FILEPATTERN, tLocal.wYear, tLocal.wMonth, tLocal.wDay, tLocal.wHour, tLocal.wMinute, tLocal.wSecond);
+		if (length >= 0) {
+			// Save in background, except for one capture by /ac, /af (no window) and onetimeCapture mode (program ends after saving)
+			if (((hWindow == NULL) && (g_captureInterval == 0)) || g_onetimeCapture || !saveSelectionAsPNGAsync(selection, szFileName))
+				saveImageAsPNG(selection, szFileName);
+		}
+	}
+
+	if (g_saveToClipboard) // Save selected area to clipboard?
+	{
+		HGLOBAL hDIB = createClipboardDIB(selection);
+		if (hDIB == NULL)
+		{
+			sMessage.assign(L"createClipboardDIB@saveSelection ")
+				.append(LoadStringAsWstr(g_hInst, IDS_HASFAILED));
+			goto FAIL;
 		}
 
-		if (g_saveToClipboard) // Save selected area to clipboard?
+		if (OpenClipboard(NULL))
 		{
-			if (OpenClipboard(NULL))
-			{
-				EmptyClipboard(); // Clear clipboard
+			EmptyClipboard(); // Clear clipboard
 
-				// Set bitmap to clipboard
-				SetClipboardData(CF_BITMAP, hBitmap);
+			// Set bitmap to clipboard (clipboard owns the memory on success)
+			if (SetClipboardData(CF_DIB, hDIB) == NULL) GlobalFree(hDIB);
 
-				CloseClipboard(); // Close clipboard
-			}
-			else
-			{
-				// Clipboard error
-				MessageBox(hWindow, LoadStringAsWstr(g_hInst, IDS_ERRORCOPYTOCLIPBOARD).c_str(), LoadStringAsWstr(g_hInst, IDS_APP_TITLE).c_str(), MB_OK | MB_ICONERROR);
-			}
+			CloseClipboard(); // Close clipboard
 		}
+		else
+		{
+			GlobalFree(hDIB);
 
-		checkScreenshotTargets(hWindow);
-	}
-	else
-	{
-		// BitBlt error
-		_snwprintf_s(szHex, _MAX_ITOSTR_BASE16_COUNT + 2, _TRUNCATE, L"0x%08X", GetLastError());
-		sMessage.assign(L"BitBlt@saveSelection ")
-			.append(LoadStringAsWstr(g_hInst, IDS_HASFAILED))
-			.append(L" ")
-			.append(szHex);
-		goto FAIL;
+			// Clipboard error
+			MessageBox(hWindow, LoadStringAsWstr(g_hInst, IDS_ERRORCOPYTOCLIPBOARD).c_str(), LoadStringAsWstr(g_hInst, IDS_APP_TITLE).c_str(), MB_OK | MB_ICONERROR);
+		}
 	}
 
+	checkScreenshotTargets(hWindow);
+
 	goto CLEANUP;
 FAIL:
 	bResult = FALSE;
@@ -1623,20 +2759,128 @@ FAIL:
 		sMessage.assign(L"saveSelection ").append(LoadStringAsWstr(g_hInst, IDS_HASFAILED));
 	MessageBox(hWindow, sMessage.c_str(), LoadStringAsWstr(g_hInst, IDS_APP_TITLE).c_str(), MB_OK | MB_ICONERROR);
 CLEANUP:
-	// Free resources/Cleanup
-	if (hBitmap != NULL) DeleteObject(hBitmap);
+	g_bSavingSelection = FALSE;
+	return bResult;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: freePaintResources
+
+  Summary:   Frees the cached GDI resources for WM_PAINT
+
+  Args:
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void freePaintResources()
+{
+	if (g_paint.hdcOutputBuffer != NULL)
+	{
+		if (g_paint.hbmOutputBufferOld != NULL) SelectObject(g_paint.hdcOutputBuffer, g_paint.hbmOutputBufferOld);
+		DeleteDC(g_paint.hdcOutputBuffer);
+	}
+	if (g_paint.hbmOutputBuffer != NULL) DeleteObject(g_paint.hbmOutputBuffer);
+	if (g_paint.hFont != NULL) DeleteObject(g_paint.hFont);
+	if (g_paint.hFontRotated != NULL) DeleteObject(g_paint.hFontRotated);
+	if (g_paint.hBrushForeground != NULL) DeleteObject(g_paint.hBrushForeground);
+	if (g_paint.hBrushBackground != NULL) DeleteObject(g_paint.hBrushBackground);
+	g_paint = PAINTRESOURCES();
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: createPaintResources
+
+  Summary:   Creates the GDI resources for WM_PAINT, when they do not exist or
+			 do not match the window size or colors
+
+  Args:     HDC hdc
+			  Handle to display device context
+			int width
+			int height
+			  Size of the output buffer
+			BOOL &bNewOutputBuffer
+			  Set to TRUE when the output buffer was (re)created and has to be painted completely
+
+  Returns:  BOOL
+			  TRUE = success
+			  FALSE = failure
+
+-----------------------------------------------------------------F-F*/
+BOOL createPaintResources(HDC hdc, int width, int height, BOOL& bNewOutputBuffer)
+{
+	LOGFONT lf = { 0 };
+	BOOL bResult = TRUE;
+
+	bNewOutputBuffer = FALSE;
+
+	// Brushes depend on colors
+	if ((g_paint.hBrushForeground != NULL) && (g_paint.bAlternativeColors != g_useAlternativeColors))
+	{
+		DeleteObject(g_paint.hBrushForeground);
+		g_paint.hBrushForeground = NULL;
+	}
+	if (g_paint.hBrushForeground == NULL)
+	{
+		g_paint.hBrushForeground = CreateSolidBrush(g_useAlternativeColors ? ALTAPPCOLOR : APPCOLOR);
+		if (g_paint.hBrushForeground == NULL) goto FAIL;
+		g_paint.bAlternativeColors = g_useAlternativeColors;
+	}
+	if (g_paint.hBrushBackground == NULL)
+	{
+		g_paint.hBrushBackground = CreateSolidBrush(ALTAPPCOLORINV);
+		if (g_paint.hBrushBackground == NULL) goto FAIL;
+	}
 
-	if (hdcSelection != NULL)
+	// Fonts
+	if ((g_paint.hFont == NULL) || (g_paint.hFontRotated == NULL))
 	{
-		if (hbmSelectionOld != NULL) SelectObject(hdcSelection, hbmSelectionOld);
-		DeleteDC(hdcSelection);
+		// Specify a font typeface name and weight.
+		if (_snwprintf_s(lf.lfFaceName, 12, _TRUNCATE, L"%s", DEFAULTFONT) < 0) goto FAIL;
+		lf.lfWeight = FW_NORMAL;
+		if (g_paint.hFont == NULL) g_paint.hFont = CreateFontIndirect(&lf);
+		lf.lfEscapement = 900; // 90 degree, does not work with lfFaceName "System"
+		if (g_paint.hFontRotated == NULL) g_paint.hFontRotated = CreateFontIndirect(&lf);
+		if ((g_paint.hFont == NULL) || (g_paint.hFontRotated == NULL))
+		{
+			OutputDebugString(L"CreateFontIndirect@createPaintResources fails");
+			goto FAIL;
+		}
 	}
 
-	if (hdcScreenshot != NULL)
+	// Output buffer
+	if ((g_paint.hbmOutputBuffer != NULL) && ((g_paint.outputBuffer.width != width) || (g_paint.outputBuffer.height != height)))
+	{
+		SelectObject(g_paint.hdcOutputBuffer, g_paint.hbmOutputBufferOld);
+		DeleteObject(g_paint.hbmOutputBuffer);
+		g_paint.hbmOutputBuffer = NULL;
+		g_paint.hbmOutputBufferOld = NULL;
+		g_paint.outputBuffer = { 0 };
+	}
+	if (g_paint.hdcOutputBuffer == NULL)
 	{
-		if (hbmScreenshotOld != NULL) SelectObject(hdcScreenshot, hbmScreenshotOld);
-		DeleteDC(hdcScreenshot);
+		g_paint.hdcOutputBuffer = CreateCompatibleDC(hdc);
+		if (g_paint.hdcOutputBuffer == NULL) goto FAIL;
 	}
+	if (g_paint.hbmOutputBuffer == NULL)
+	{
+		g_paint.hbmOutputBuffer = createImageBitmap(hdc, width, height, g_paint.outputBuffer);
+		if (g_paint.hbmOutputBuffer == NULL)
+		{
+			OutputDebugString(L"CreateDIBSection@createPaintResources fails");
+			goto FAIL;
+		}
+		g_paint.hbmOutputBufferOld = SelectObject(g_paint.hdcOutputBuffer, g_paint.hbmOutputBuffer);
+		if (g_paint.hbmOutputBufferOld == NULL) goto FAIL;
+		bNewOutputBuffer = TRUE;
+	}
+
+	goto CLEANUP;
+FAIL:
+	bResult = FALSE;
+	OutputDebugString(L"createPaintResources fails");
+	freePaintResources();
+CLEANUP:
 	return bResult;
 }
 
@@ -1647,6 +2891,8 @@ CLEANUP:
 
   Args:     HDC hdcOutputBuffer
 			  Handle to drawing context for the output buffer
+			const IMAGEBUFFER &outputBuffer
+			  Pixels of the output buffer
 			BOXTYPE boxType
 			  Type of position (BoxFirstPointA, BoxFinalPointA, BoxFinalPointB)
 
@@ -1655,16 +2901,16 @@ CLEANUP:
 			  TRUE = failure
 
 -----------------------------------------------------------------F-F*/
-BOOL zoomMousePosition(HDC hdcOutputBuffer, BOXTYPE boxType)
+BOOL zoomMousePosition(HDC hdcOutputBuffer, const IMAGEBUFFER& outputBuffer, BOXTYPE boxType)
 {
+	TRACESCOPE traceScope("zoomMousePosition");
 #define MAXSTRDATAZOOM 30
 	wchar_t strData[MAXSTRDATAZOOM];
 	UINT textFormat = 0;
 	POINT textPosition = { 0, 0 };
 	RECT rectText{ 0, 0, 0, 0 };
-	PLOGFONT plf = (PLOGFONT)LocalAlloc(LPTR, sizeof(LOGFONT));
-	HGDIOBJ hfnt = NULL, hfntPrev = NULL;
-	HBRUSH hBrush = NULL;
+	HGDIOBJ hfntPrev = NULL;
+	HBRUSH hBrush = g_paint.hBrushForeground;
 	int zoomCenterX, zoomCenterY, zoomBoxX, zoomBoxY;
 	BOOL bResult = TRUE;
 	std::wstring sMessage = L"";
@@ -1676,20 +2922,10 @@ BOOL zoomMousePosition(HDC hdcOutputBuffer, BOXTYPE boxType)
 		if ((boxType != BoxFirstPointA) && (abs(g_selection.bottom - g_selection.top) < (long) (ZOOMHEIGHT * g_zoomScale))) goto CLEANUP; // Selection too small
 	}
 
-	// Font
-	// Specify a font typeface name and weight.
-	if (plf == NULL) goto FAIL;
-	if (_snwprintf_s(plf->lfFaceName, 12, _TRUNCATE, L"%s", DEFAULTFONT) < 0) goto FAIL;
-	plf->lfWeight = FW_NORMAL;
-	hfnt = CreateFontIndirect(plf);
-	if (hfnt == NULL)
-	{
-		sMessage.assign(L"CreateFontIndirect@zoomMousePosition ")
-			.append(LoadStringAsWstr(g_hInst, IDS_HASFAILED));
-		goto FAIL;
-	}
+	// Font and brush are created once by createPaintResources
+	if ((g_paint.hFont == NULL) || (g_paint.hFontRotated == NULL) || (hBrush == NULL)) goto FAIL;
 
-	hfntPrev = SelectObject(hdcOutputBuffer, hfnt);
+	hfntPrev = SelectObject(hdcOutputBuffer, g_paint.hFont);
 	if (hfntPrev == NULL) goto FAIL;
 
 	switch (boxType)
@@ -1747,19 +2983,10 @@ BOOL zoomMousePosition(HDC hdcOutputBuffer, BOXTYPE boxType)
 	}
 
 	// Zoom bitmap
-	if (g_hBitmap != NULL)
+	if (isImageValid(outputBuffer))
 	{
-		BITMAP bm;
-		if (GetObject(g_hBitmap, sizeof(BITMAP), (PSTR)&bm) == 0) goto FAIL;
-		SetStretchBltMode(hdcOutputBuffer, COLORONCOLOR);
-
-		if (!StretchBlt(hdcOutputBuffer, zoomBoxX, zoomBoxY, ZOOMWIDTH * g_zoomScale, ZOOMHEIGHT * g_zoomScale,
-			hdcOutputBuffer, zoomCenterX - ZOOMWIDTH / 2, zoomCenterY - ZOOMHEIGHT / 2, ZOOMWIDTH, ZOOMHEIGHT, SRCCOPY))
-		{
-			sMessage.assign(L"StretchBlt@zoomMousePosition ")
-				.append(LoadStringAsWstr(g_hInst, IDS_HASFAILED));
-			goto FAIL;
-		}
+		GdiFlush(); // Finish GDI drawing before accessing the pixels
+		zoomImage(outputBuffer, zoomCenterX - ZOOMWIDTH / 2, zoomCenterY - ZOOMHEIGHT / 2, ZOOMWIDTH, ZOOMHEIGHT, zoomBoxX, zoomBoxY, g_zoomScale);
 	}
 	else goto FAIL;
 
@@ -1769,8 +2996,6 @@ BOOL zoomMousePosition(HDC hdcOutputBuffer, BOXTYPE boxType)
 	outer.top = zoomBoxY - 1;
 	outer.right = zoomBoxX + ZOOMWIDTH * g_zoomScale + 1;
 	outer.bottom = zoomBoxY + ZOOMHEIGHT * g_zoomScale + 1;
-	hBrush = CreateSolidBrush(g_useAlternativeColors ? ALTAPPCOLOR : APPCOLOR);
-	if (hBrush == NULL) goto FAIL;
 
 	if (g_zoomScale > 1) FrameRect(hdcOutputBuffer, &outer, hBrush);
 
@@ -2021,19 +3246,7 @@ BOOL zoomMousePosition(HDC hdcOutputBuffer, BOXTYPE boxType)
 	// Text position Y
 
 	// Text rotated 90 degree
-	SelectObject(hdcOutputBuffer, hfntPrev);
-	DeleteObject(hfnt);
-	plf->lfEscapement = 900; // 90 degree, does not work with lfFaceName "System"
-	hfnt = CreateFontIndirect(plf);
-	if (hfnt == NULL)
-	{
-		sMessage.assign(L"CreateFontIndirect@zoomMousePosition ")
-			.append(LoadStringAsWstr(g_hInst, IDS_HASFAILED));
-		goto FAIL;
-	}
-
-	hfntPrev = SelectObject(hdcOutputBuffer, hfnt);
-	if (hfntPrev == NULL) goto FAIL;
+	SelectObject(hdcOutputBuffer, g_paint.hFontRotated);
 
 	textFormat = 0;
 	textPosition = { 0, 0 };
@@ -2095,28 +3308,218 @@ BOOL zoomMousePosition(HDC hdcOutputBuffer, BOXTYPE boxType)
 		break;
 	}
 
-	rectText.left = textPosition.x;
-	rectText.top = textPosition.y;
+	rectText.left = textPosition.x;
+	rectText.top = textPosition.y;
+
+	DrawText(hdcOutputBuffer, strData, -1, &rectText, DT_SINGLELINE | DT_NOCLIP);
+
+	goto CLEANUP;
+FAIL:
+	bResult = FALSE;
+	OutputDebugString(L"zoomMousePosition fails");
+	if (sMessage.length() == 0)
+		sMessage.assign(L"zoomMousePosition ").append(LoadStringAsWstr(g_hInst, IDS_HASFAILED));
+	MessageBox(g_hWindow, sMessage.c_str(), LoadStringAsWstr(g_hInst, IDS_APP_TITLE).c_str(), MB_OK | MB_ICONERROR);
+
+CLEANUP:
+	// Free resources/Cleanup
+	if (hfntPrev != NULL) SelectObject(hdcOutputBuffer, hfntPrev);
+
+	return bResult;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getSelectionInner
+
+  Summary:   Gets the bright selected area limited to the screenshot
+
+  Args:
+
+  Returns:  RECT
+			  Selected area (GDI style, right and bottom are not part of the area).
+			  Empty when there is no selection.
+
+-----------------------------------------------------------------F-F*/
+RECT getSelectionInner()
+{
+	RECT inner = { 0 };
+
+	if (((g_appState != statePointA) && (g_appState != statePointB)) || !isSelectionValid(g_selection)) return inner;
+
+	inner = normalizeRectangle(g_selection);
+	if (inner.left < 0) inner.left = 0;
+	if (inner.right > g_screenshot.width - 1) inner.right = g_screenshot.width - 1;
+	if (inner.top < 0) inner.top = 0;
+	if (inner.bottom > g_screenshot.height - 1) inner.bottom = g_screenshot.height - 1;
+	inner.right++;
+	inner.bottom++;
+	return inner;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: addRectToRegion
+
+  Summary:   Combines a rectangle with a region
+
+  Args:     HRGN hRegion
+			  Region
+			RECT rect
+			  Rectangle (GDI style)
+			int mode
+			  RGN_OR, RGN_DIFF...
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void addRectToRegion(HRGN hRegion, RECT rect, int mode)
+{
+	if ((rect.right <= rect.left) || (rect.bottom <= rect.top)) return;
+
+	HRGN hRect = CreateRectRgnIndirect(&rect);
+	if (hRect == NULL) return;
+	CombineRgn(hRegion, hRegion, hRect, mode);
+	DeleteObject(hRect);
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: createOverlayRegion
+
+  Summary:   Creates a region, which covers everything drawn over the background for
+			 the current state and selection: Selection frame with labels, zoom boxes
+			 and internal information. The bright selected area is not part of the region.
+
+  Args:
+
+  Returns:  HRGN
+			  Region (must be deleted with DeleteObject)
+			  NULL = failure
+
+-----------------------------------------------------------------F-F*/
+HRGN createOverlayRegion()
+{
+	HRGN hRegion = CreateRectRgn(0, 0, 0, 0);
+	if (hRegion == NULL) return NULL;
+
+	// Half size of a zoom box with its labels
+	int zoomSize = (int)(((ZOOMWIDTH > ZOOMHEIGHT) ? ZOOMWIDTH : ZOOMHEIGHT) * g_zoomScale) + OVERLAYMARGIN;
+
+	switch (g_appState)
+	{
+	case stateFirstPoint:
+		addRectToRegion(hRegion, { g_selection.left - zoomSize, g_selection.top - zoomSize, g_selection.left + zoomSize, g_selection.top + zoomSize }, RGN_OR);
+		break;
+	case statePointA:
+	case statePointB:
+	{
+		RECT inner = getSelectionInner();
+
+		// Frame with labels for width and height
+		RECT ring = inner;
+		InflateRect(&ring, OVERLAYMARGIN, OVERLAYMARGIN);
+		addRectToRegion(hRegion, ring, RGN_OR);
+		ring = inner;
+		InflateRect(&ring, -OVERLAYMARGIN, -OVERLAYMARGIN);
+		addRectToRegion(hRegion, ring, RGN_DIFF);
+
+		// Zoom boxes at point A and B
+		addRectToRegion(hRegion, { g_selection.left - zoomSize, g_selection.top - zoomSize, g_selection.left + zoomSize, g_selection.top + zoomSize }, RGN_OR);
+		addRectToRegion(hRegion, { g_selection.right - zoomSize, g_selection.bottom - zoomSize, g_selection.right + zoomSize, g_selection.bottom + zoomSize }, RGN_OR);
+		break;
+	}
+	}
+
+	if (g_displayInternalInformation)
+	{
+		addRectToRegion(hRegion, g_rectInformation[0], RGN_OR);
+		addRectToRegion(hRegion, g_rectInformation[1], RGN_OR);
+	}
+	return hRegion;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: invalidateOverlay
+
+  Summary:   Invalidates only the areas, which could be changed by a modified
+			 selection or mouse position, instead of the whole window
+
+  Args:     HWND hWindow
+			  Handle to window
 
-	DrawText(hdcOutputBuffer, strData, -1, &rectText, DT_SINGLELINE | DT_NOCLIP);
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void invalidateOverlay(HWND hWindow)
+{
+	HRGN hDirty = NULL;
+	HRGN hInner = NULL;
+	RECT inner;
+
+	if (g_hPaintedOverlay == NULL) goto FAIL; // Nothing painted so far
+
+	hDirty = createOverlayRegion();
+	if (hDirty == NULL) goto FAIL;
+
+	// Overlay of the last paint and the current state
+	CombineRgn(hDirty, hDirty, g_hPaintedOverlay, RGN_OR);
 
+	// Changed part of the bright selected area
+	inner = getSelectionInner();
+	hInner = CreateRectRgnIndirect(&inner);
+	if (hInner == NULL) goto FAIL;
+	addRectToRegion(hInner, g_paintedInner, RGN_XOR);
+	CombineRgn(hDirty, hDirty, hInner, RGN_OR);
+
+	InvalidateRgn(hWindow, hDirty, FALSE);
 	goto CLEANUP;
 FAIL:
-	bResult = FALSE;
-	OutputDebugString(L"zoomMousePosition fails");
-	if (sMessage.length() == 0)
-		sMessage.assign(L"zoomMousePosition ").append(LoadStringAsWstr(g_hInst, IDS_HASFAILED));
-	MessageBox(g_hWindow, sMessage.c_str(), LoadStringAsWstr(g_hInst, IDS_APP_TITLE).c_str(), MB_OK | MB_ICONERROR);
-
+	InvalidateRect(hWindow, NULL, FALSE);
 CLEANUP:
-	// Free resources/Cleanup
-	if (hfntPrev != NULL) SelectObject(hdcOutputBuffer, hfntPrev);
+	if (hInner != NULL) DeleteObject(hInner);
+	if (hDirty != NULL) DeleteObject(hDirty);
+}
 
-	if (hfnt != NULL) DeleteObject(hfnt);
-	if (plf != NULL) LocalFree((LOCALHANDLE)plf);
-	if (hBrush != NULL) DeleteObject(hBrush);
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: resetPaintedOverlay
 
-	return bResult;
+  Summary:   Forgets the overlay of the last paint, so the next invalidateOverlay invalidates the whole window
+
+  Args:
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void resetPaintedOverlay()
+{
+	if (g_hPaintedOverlay != NULL) DeleteObject(g_hPaintedOverlay);
+	g_hPaintedOverlay = NULL;
+	g_paintedInner = { 0 };
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getRegionRects
+
+  Summary:   Gets the rectangles of a region
+
+  Args:     HRGN hRegion
+			  Region
+
+  Returns:  std::vector<RECT>
+			  Rectangles of the region (empty on error)
+
+-----------------------------------------------------------------F-F*/
+std::vector<RECT> getRegionRects(HRGN hRegion)
+{
+	std::vector<RECT> rects;
+	DWORD size = GetRegionData(hRegion, 0, NULL);
+	if (size < sizeof(RGNDATAHEADER)) return rects;
+
+	std::vector<BYTE> data(size);
+	RGNDATA* pData = (RGNDATA*)data.data();
+	if (GetRegionData(hRegion, size, pData) != size) return rects;
+
+	RECT* pRects = (RECT*)pData->Buffer;
+	rects.assign(pRects, pRects + pData->rdh.nCount);
+	return rects;
 }
 
 /*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -2147,13 +3550,13 @@ void OnMouseMove(HWND hWindow, int pixelX, int pixelY, DWORD flags) {
 	case statePointA:
 		g_selection.left = limitXtoBitmap(pixelX);
 		g_selection.top = limitYtoBitmap(pixelY);
-		InvalidateRect(hWindow, NULL, TRUE);
+		invalidateOverlay(hWindow);
 		break;
 	case statePointB:
 	{
 		g_selection.right = limitXtoBitmap(pixelX);
 		g_selection.bottom = limitYtoBitmap(pixelY);
-		InvalidateRect(hWindow, NULL, TRUE);
+		invalidateOverlay(hWindow);
 		break;
 	}
 	}
@@ -2178,65 +3581,23 @@ void OnMouseMove(HWND hWindow, int pixelX, int pixelY, DWORD flags) {
 
 -----------------------------------------------------------------F-F*/
 BOOL pixelateScreenshotRect(RECT rect, DWORD blockSize) {
-	HDC hdcScreenshot = NULL;
-	HDC hdcPixelated = NULL;
-	HBITMAP hBitmapPixelated = NULL;
-	RECT rectPixelated = { UNINITIALIZEDLONG, UNINITIALIZEDLONG, UNINITIALIZEDLONG, UNINITIALIZEDLONG };
-	HGDIOBJ hbmPixelatedOld = NULL;
-	HGDIOBJ hbmScreenshotOld = NULL;
+	TRACESCOPE traceScope("pixelateScreenshotRect");
+	IMAGEBUFFER pixelated;
 	BOOL bResult = TRUE;
 	std::wstring sMessage = L"";
 
-	if (g_hBitmap == NULL) goto FAIL;
+	if (!isImageValid(g_screenshot)) goto FAIL;
 
 	if (!isSelectionValid(rect)) goto FAIL;
 
-	rectPixelated = normalizeRectangle(rect);
-
-	hdcScreenshot = CreateCompatibleDC(NULL);
-	if (hdcScreenshot == NULL) goto FAIL;
-
-	hbmScreenshotOld = SelectObject(hdcScreenshot, g_hBitmap);
-	if (hbmScreenshotOld == NULL) goto FAIL;
-
-	hdcPixelated = CreateCompatibleDC(hdcScreenshot);
-	if (hdcPixelated == NULL) goto FAIL;
-
-	hBitmapPixelated = CreateCompatibleBitmap(hdcScreenshot, (rectPixelated.right - rectPixelated.left + 1) / blockSize, (rectPixelated.bottom - rectPixelated.top + 1) / blockSize);
-	if (hBitmapPixelated == NULL)
-	{
-		sMessage.assign(L"CreateCompatibleBitmap@pixelateScreenshotRect ")
-			.append(LoadStringAsWstr(g_hInst, IDS_HASFAILED));
-		goto FAIL;
-	}
+	if (!getImageViewFromRect(g_screenshot, toImageRect(rect), pixelated)) goto FAIL;
 
-	hbmPixelatedOld = SelectObject(hdcPixelated, hBitmapPixelated);
-	if (hbmPixelatedOld == NULL) goto FAIL;
+	stopEdgeIndexBuild();
+	GdiFlush(); // Finish GDI drawing before accessing the pixels
+	pixelateImage(pixelated, blockSize);
+	startEdgeIndexBuild(g_screenshot, g_colorTolerance);
+	if (g_hDimmedBitmap != NULL) updateDimmedScreenshot(&rect);
 
-	SetStretchBltMode(hdcPixelated, HALFTONE);
-	SetStretchBltMode(hdcScreenshot, COLORONCOLOR);
-
-	// Create reduced pixels for selected area
-	if (!StretchBlt(hdcPixelated, 0, 0, (rectPixelated.right - rectPixelated.left + 1) / blockSize,
-		(rectPixelated.bottom - rectPixelated.top + 1) / blockSize,
-		hdcScreenshot, rectPixelated.left, rectPixelated.top, rectPixelated.right - rectPixelated.left + 1,
-		rectPixelated.bottom - rectPixelated.top + 1, SRCCOPY))
-	{
-		sMessage.assign(L"StretchBlt@pixelateScreenshotRect ")
-			.append(LoadStringAsWstr(g_hInst, IDS_HASFAILED));
-		goto FAIL;
-	}
-
-	// Copy  back to screenshot => pixelated
-	if (!StretchBlt(hdcScreenshot, rectPixelated.left, rectPixelated.top, rectPixelated.right - rectPixelated.left + 1,
-		rectPixelated.bottom - rectPixelated.top + 1,
-		hdcPixelated, 0, 0, (rectPixelated.right - rectPixelated.left + 1) / blockSize,
-		(rectPixelated.bottom - rectPixelated.top + 1) / blockSize, SRCCOPY))
-	{
-		sMessage.assign(L"StretchBlt@pixelateScreenshotRect ")
-			.append(LoadStringAsWstr(g_hInst, IDS_HASFAILED));
-		goto FAIL;
-	}
 	goto CLEANUP;
 FAIL:
 	bResult = FALSE;
@@ -2245,14 +3606,6 @@ FAIL:
 		sMessage.assign(L"pixelateScreenshotRect ").append(LoadStringAsWstr(g_hInst, IDS_HASFAILED));
 	MessageBox(g_hWindow, sMessage.c_str(), LoadStringAsWstr(g_hInst, IDS_APP_TITLE).c_str(), MB_OK | MB_ICONERROR);
 CLEANUP:
-	// Free resources/Cleanup
-	if (hbmPixelatedOld != NULL) SelectObject(hdcPixelated, hbmPixelatedOld);
-	if (hbmScreenshotOld != NULL) SelectObject(hdcScreenshot, hbmScreenshotOld);
-
-	if (hBitmapPixelated != NULL) DeleteObject(hBitmapPixelated);
-
-	if (hdcPixelated != NULL) DeleteDC(hdcPixelated);
-	if (hdcScreenshot != NULL) DeleteDC(hdcScreenshot);
 	return bResult;
 }
 
@@ -2274,23 +3627,12 @@ CLEANUP:
 
 -----------------------------------------------------------------F-F*/
 BOOL markScreenshotRect(RECT rect, int lineWidth, BYTE blendAlpha) {
-	HDC hdcScreenshot = NULL;
-	HDC hdcInner = NULL;
-	HDC hdcOuter = NULL;
-	HBITMAP hBitmapOuter = NULL;
-	HBITMAP hBitmapInner = NULL;
-	HGDIOBJ hbmInnerOld = NULL;
-	HGDIOBJ hbmOuterOld = NULL;
-	HGDIOBJ hbmScreenshotOld = NULL;
-	HBRUSH hBrush = NULL;
-	RECT frame = { 0 };
+	TRACESCOPE traceScope("markScreenshotRect");
 	RECT inner{ 0 }, outer{ 0 };
-	BLENDFUNCTION blendFunc;
 	BOOL bResult = TRUE;
 	std::wstring sMessage = L"";
-	wchar_t szHex[_MAX_ITOSTR_BASE16_COUNT + 2];
 
-	if (g_hBitmap == NULL) goto FAIL;
+	if (!isImageValid(g_screenshot)) goto FAIL;
 
 	if (lineWidth < 1) goto FAIL;
 
@@ -2301,78 +3643,12 @@ BOOL markScreenshotRect(RECT rect, int lineWidth, BYTE blendAlpha) {
 	InflateRect(&inner, -(lineWidth / 2 + 1), -(lineWidth / 2 + 1));
 	InflateRect(&outer, lineWidth / 2, lineWidth / 2);
 
-	// hdc for screenshot bitmap
-	hdcScreenshot = CreateCompatibleDC(NULL);
-	if (hdcScreenshot == NULL) goto FAIL;
-
-	hbmScreenshotOld = SelectObject(hdcScreenshot, g_hBitmap);
-	if (hbmScreenshotOld == NULL) goto FAIL;
-
-	// Copy inner of marked screenshot area to buffer
-	hdcInner = CreateCompatibleDC(hdcScreenshot);
-	if (hdcInner == NULL) goto FAIL;
-
-	hBitmapInner = CreateCompatibleBitmap(hdcScreenshot, inner.right - inner.left + 1, inner.bottom - inner.top + 1);
-	if (hBitmapInner == NULL)
-	{
-		sMessage.assign(L"CreateCompatibleBitmap@markScreenshotRect ")
-			.append(LoadStringAsWstr(g_hInst, IDS_HASFAILED));
-		goto FAIL;
-	}
-
-	hbmInnerOld = SelectObject(hdcInner, hBitmapInner);
-	if (hbmInnerOld == NULL) goto FAIL;
-
-	if (!BitBlt(hdcInner, 0, 0, inner.right - inner.left + 1, inner.bottom - inner.top + 1,
-		hdcScreenshot, inner.left, inner.top, SRCCOPY)) goto FAIL;
-
-	// Blend colored frame over outer of marked screenshot area
-	hdcOuter = CreateCompatibleDC(hdcScreenshot);
-	if (hdcOuter == NULL) goto FAIL;
-
-	hBitmapOuter = CreateCompatibleBitmap(hdcScreenshot, outer.right - outer.left + 1, outer.bottom - outer.top + 1);
-	if (hBitmapOuter == NULL)
-	{
-		sMessage.assign(L"CreateCompatibleBitmap@markScreenshotRect ")
-			.append(LoadStringAsWstr(g_hInst, IDS_HASFAILED));
-		goto FAIL;
-	}
-
-	hbmOuterOld = SelectObject(hdcOuter, hBitmapOuter);
-	if (hbmOuterOld == NULL) goto FAIL;
-
-	hBrush = CreateSolidBrush(MARKCOLOR);
-	if (hBrush == NULL) goto CLEANUP;
-	frame.right = outer.right - outer.left + 1;
-	frame.bottom = outer.bottom - outer.top + 1;
-	FillRect(hdcOuter, &frame, hBrush);
-
-	blendFunc.BlendOp = AC_SRC_OVER;
-	blendFunc.BlendFlags = 0;
-	blendFunc.SourceConstantAlpha = blendAlpha;
-	blendFunc.AlphaFormat = 0;
-
-	if (!AlphaBlend(hdcScreenshot, outer.left, outer.top,
-		outer.right - outer.left + 1,
-		outer.bottom - outer.top + 1,
-		hdcOuter, 0, 0, outer.right - outer.left + 1, outer.bottom - outer.top + 1, blendFunc))
-	{
-		sMessage.assign(L"AlphaBlend@markScreenshotRect ")
-			.append(LoadStringAsWstr(g_hInst, IDS_HASFAILED));
-		goto FAIL;
-	}
-
-	// Copy inner area back from buffer to screenshot
-	if (!BitBlt(hdcScreenshot, inner.left, inner.top, inner.right - inner.left + 1, inner.bottom - inner.top + 1,
-		hdcInner, 0, 0, SRCCOPY))
-	{
-		_snwprintf_s(szHex, _MAX_ITOSTR_BASE16_COUNT + 2, _TRUNCATE, L"0x%08X", GetLastError());
-		sMessage.assign(L"BitBlt@markScreenshotRect ")
-			.append(LoadStringAsWstr(g_hInst, IDS_HASFAILED))
-			.append(L" ")
-			.append(szHex);
-		goto FAIL;
-	}
+	// Blend colored frame between outer and inner of marked screenshot area
+	stopEdgeIndexBuild();
+	GdiFlush(); // Finish GDI drawing before accessing the pixels
+	frameImageRect(g_screenshot, toImageRect(outer), toImageRect(inner), IMAGEPIXELRGB(GetRValue(MARKCOLOR), GetGValue(MARKCOLOR), GetBValue(MARKCOLOR)), blendAlpha);
+	startEdgeIndexBuild(g_screenshot, g_colorTolerance);
+	if (g_hDimmedBitmap != NULL) updateDimmedScreenshot(&outer);
 
 	goto CLEANUP;
 FAIL:
@@ -2382,19 +3658,6 @@ FAIL:
 		sMessage.assign(L"markScreenshotRect ").append(LoadStringAsWstr(g_hInst, IDS_HASFAILED));
 	MessageBox(g_hWindow, sMessage.c_str(), LoadStringAsWstr(g_hInst, IDS_APP_TITLE).c_str(), MB_OK | MB_ICONERROR);
 CLEANUP:
-	// Free resources/Cleanup
-	if (hBrush != NULL) DeleteObject(hBrush);
-
-	if (hbmOuterOld != NULL) SelectObject(hdcOuter, hbmOuterOld);
-	if (hbmInnerOld != NULL) SelectObject(hdcInner, hbmInnerOld);
-	if (hbmScreenshotOld != NULL) SelectObject(hdcScreenshot, hbmScreenshotOld);
-
-	if (hBitmapOuter != NULL) DeleteObject(hBitmapOuter);
-	if (hBitmapInner != NULL) DeleteObject(hBitmapInner);
-
-	if (hdcOuter != NULL) DeleteDC(hdcOuter);
-	if (hdcInner != NULL) DeleteDC(hdcInner);
-	if (hdcScreenshot != NULL) DeleteDC(hdcScreenshot);
 	return bResult;
 }
 
@@ -2412,18 +3675,15 @@ CLEANUP:
 
 -----------------------------------------------------------------F-F*/
 BOOL OnPaint(HWND hWindow) {
+	TRACESCOPE traceScope("OnPaint");
 	PAINTSTRUCT ps;
 	RECT rect;
 	HDC hdcScreenshot = NULL;
 	HGDIOBJ hbmScreenshotOld = NULL;
-	HBITMAP bmOutputBuffer = NULL;
+	BOOL bNewOutputBuffer = FALSE;
 	int iBackupOutputDC = 0;
-	HBRUSH hBrushForeground = NULL;
-	HBRUSH hBrushBackground = NULL;
 #define MAXSTRDATA 128
 	wchar_t strData[MAXSTRDATA];
-	PLOGFONT plf = (PLOGFONT)LocalAlloc(LPTR, sizeof(LOGFONT));
-	HGDIOBJ hfnt = NULL, hfntPrev = NULL;
 	RECT inner, outer;
 	RECT rectText{ 0, 0, 0, 0 };
 	HDC hdc = NULL;
@@ -2432,14 +3692,24 @@ BOOL OnPaint(HWND hWindow) {
 	int iHeight = 0;
 	UINT textFormat = 0;
 	std::wstring sDisplayInfos;
-	COLORREF color;
+	IMAGEPIXEL color;
+	HRGN hUpdateRegion = NULL;
+	std::vector<RECT> updateRects;
 	BOOL bResult = TRUE;
 	std::wstring sMessage = L"";
 	wchar_t szHex[_MAX_ITOSTR_BASE16_COUNT + 2];
+	LARGE_INTEGER paintStart, paintEnd, frequency;
+
+	QueryPerformanceCounter(&paintStart);
+
+	// Get invalidated region before BeginPaint validates it
+	hUpdateRegion = CreateRectRgn(0, 0, 0, 0);
+	if (hUpdateRegion != NULL) {
+		if (GetUpdateRgn(hWindow, hUpdateRegion, FALSE) != ERROR) updateRects = getRegionRects(hUpdateRegion);
+	}
 
 	hdc = BeginPaint(hWindow, &ps);
 	if (hdc == NULL) goto FAIL;
-	if (plf == NULL) goto FAIL;
 	if (g_appState == stateTrayIcon) goto FAIL;
 	if (g_hBitmap == NULL) goto FAIL;
 
@@ -2448,69 +3718,55 @@ BOOL OnPaint(HWND hWindow) {
 	iWidth = rect.right + 1;
 	iHeight = rect.bottom + 1;
 
-	// Create buffer memory device (Used as painting target and will be copied after the last painting to the display)
-	hdcOutputBuffer = CreateCompatibleDC(hdc);
-	if (hdcOutputBuffer == NULL) goto FAIL;
-
-	// Bitmap in buffer memory
-	bmOutputBuffer = CreateCompatibleBitmap(hdc, iWidth, iHeight);
-	if (bmOutputBuffer == NULL)
+	// Buffer memory device, bitmap, fonts and brushes (Output buffer is used as painting target and will be copied after the last painting to the display)
+	if (!createPaintResources(hdc, iWidth, iHeight, bNewOutputBuffer))
 	{
-		sMessage.assign(L"CreateCompatibleBitmap@OnPaint ")
+		sMessage.assign(L"createPaintResources@OnPaint ")
 			.append(LoadStringAsWstr(g_hInst, IDS_HASFAILED));
 		goto FAIL;
 	}
+	hdcOutputBuffer = g_paint.hdcOutputBuffer;
 
 	// Backup memory device context state
 	iBackupOutputDC = SaveDC(hdcOutputBuffer);
 	if (iBackupOutputDC == 0) goto FAIL;
 
-	// Font
-	// Specify a font typeface name and weight.
-	if (_snwprintf_s(plf->lfFaceName, 12, _TRUNCATE, L"%s", DEFAULTFONT) < 0) goto FAIL;
-
-	plf->lfWeight = FW_NORMAL;
-	hfnt = CreateFontIndirect(plf);
-	if (hfnt == NULL) {
-		sMessage.assign(L"CreateFontIndirect@OnPaint ")
-			.append(LoadStringAsWstr(g_hInst, IDS_HASFAILED));
-		goto FAIL;
-	}
-
-	hfntPrev = SelectObject(hdcOutputBuffer, hfnt);
-	if (hfntPrev == NULL) goto FAIL;
+	if (SelectObject(hdcOutputBuffer, g_paint.hFont) == NULL) goto FAIL;
 
 	SetTextColor(hdcOutputBuffer, g_useAlternativeColors ? ALTAPPCOLORINV : APPCOLORINV);
 	SetBkColor(hdcOutputBuffer, g_useAlternativeColors ? ALTAPPCOLOR : APPCOLOR);
 
-	SelectObject(hdcOutputBuffer, bmOutputBuffer);
+	// Draw only in the invalidated region (a new output buffer has to be drawn completely)
+	if ((hUpdateRegion != NULL) && !updateRects.empty() && !bNewOutputBuffer) SelectClipRgn(hdcOutputBuffer, hUpdateRegion);
+	else updateRects.assign(1, rect);
 
-	// Get screenshot bitmap information and select bitmap
-	BITMAP bm;
-	if (GetObject(g_hBitmap, sizeof(bm), &bm) == 0) goto FAIL;
+	// Select screenshot bitmap
 	hdcScreenshot = CreateCompatibleDC(hdc);
 	if (hdcScreenshot == NULL) goto FAIL;
 	hbmScreenshotOld = SelectObject(hdcScreenshot, g_hBitmap);
 	if (hbmScreenshotOld == NULL) goto FAIL;
 
-	// Use a blen function to get a darker image of the screenshot
-	BLENDFUNCTION blendFunc;
-	blendFunc.BlendOp = AC_SRC_OVER;
-	blendFunc.BlendFlags = 0;
-	blendFunc.SourceConstantAlpha = g_useAlternativeColors ? 255 : 50; // Factor to darken the screenshot
-	blendFunc.AlphaFormat = 0;
-
-	if (!AlphaBlend(hdcOutputBuffer, 0, 0, bm.bmWidth, bm.bmHeight, hdcScreenshot, 0, 0, bm.bmWidth, bm.bmHeight, blendFunc))
+	// Copy darkened screenshot (created once per screenshot) as background. Alternative colors use the screenshot without darkening.
+	if (!g_useAlternativeColors && (g_hDimmedBitmap == NULL))
 	{
-		sMessage.assign(L"AlphaBlend@OnPaint ")
-			.append(LoadStringAsWstr(g_hInst, IDS_HASFAILED));
-		goto FAIL;
+		if (!updateDimmedScreenshot(NULL))
+		{
+			sMessage.assign(L"CreateDIBSection@OnPaint ")
+				.append(LoadStringAsWstr(g_hInst, IDS_HASFAILED));
+			goto FAIL;
+		}
+	}
+	GdiFlush(); // Finish GDI drawing before accessing the pixels
+	g_paintedPixels = 0;
+	for (const RECT& update : updateRects)
+	{
+		IMAGEBUFFER source, target;
+		IMAGERECT area = { (int)update.left, (int)update.top, (int)update.right - 1, (int)update.bottom - 1 };
+		if (!getImageViewFromRect(g_paint.outputBuffer, area, target)) continue;
+		if (!getImageViewFromRect(g_useAlternativeColors ? g_screenshot : g_dimmedScreenshot, area, source)) continue;
+		copyImage(target, source);
+		g_paintedPixels += (DWORD)target.width * target.height;
 	}
-
-	hBrushForeground = CreateSolidBrush(g_useAlternativeColors ? ALTAPPCOLOR : APPCOLOR);
-	if (hBrushForeground == NULL) goto FAIL;
-	hBrushBackground = CreateSolidBrush(ALTAPPCOLORINV);
-	if (hBrushBackground == NULL) goto FAIL;
 
 	// Get inner/outer rects and zoom mouse position
 	switch (g_appState)
@@ -2518,16 +3774,16 @@ BOOL OnPaint(HWND hWindow) {
 	case stateFirstPoint:
 		inner.left = g_selection.left;
 		inner.top = g_selection.top;
-		zoomMousePosition(hdcOutputBuffer, BoxFirstPointA);
+		zoomMousePosition(hdcOutputBuffer, g_paint.outputBuffer, BoxFirstPointA);
 		break;
 	case statePointA:
 	case statePointB:
 	{
 		inner = normalizeRectangle(g_selection);
 		if (inner.left < 0) inner.left = 0;
-		if (inner.right > bm.bmWidth - 1) inner.right = bm.bmWidth - 1;
+		if (inner.right > g_screenshot.width - 1) inner.right = g_screenshot.width - 1;
 		if (inner.top < 0) inner.top = 0;
-		if (inner.bottom > bm.bmHeight - 1) inner.bottom = bm.bmHeight - 1;
+		if (inner.bottom > g_screenshot.height - 1) inner.bottom = g_screenshot.height - 1;
 
 		outer.left = inner.left - 1;
 		outer.right = inner.right + 1 + 1; // +1 because GDI the second edge of a rect is not part of the drawn rectangle
@@ -2547,7 +3803,7 @@ BOOL OnPaint(HWND hWindow) {
 		}
 
 		// Draw frame
-		FrameRect(hdcOutputBuffer, &outer, hBrushForeground);
+		FrameRect(hdcOutputBuffer, &outer, g_paint.hBrushForeground);
 
 		// Draw text for selection width
 		rectText = { 0, 0, 0, 0 };
@@ -2576,26 +3832,14 @@ BOOL OnPaint(HWND hWindow) {
 			DrawText(hdcOutputBuffer, strData, -1, &rectText, DT_SINGLELINE | DT_NOCLIP | DT_CENTER | DT_BOTTOM);
 
 		// Draw mouse position
-		zoomMousePosition(hdcOutputBuffer, BoxFinalPointA);
-		zoomMousePosition(hdcOutputBuffer, BoxFinalPointB);
+		zoomMousePosition(hdcOutputBuffer, g_paint.outputBuffer, BoxFinalPointA);
+		zoomMousePosition(hdcOutputBuffer, g_paint.outputBuffer, BoxFinalPointB);
 
 		// Draw text for selection height
 		rectText = { 0, 0, 0, 0 };
 
 		// Text rotated 90 degree
-		SelectObject(hdc, hfntPrev);
-		DeleteObject(hfnt);
-		plf->lfEscapement = 900; // 90 degree, does not work with lfFaceName "System"
-		hfnt = CreateFontIndirect(plf);
-		if (hfnt == NULL)
-		{
-			sMessage.assign(L"CreateFontIndirect@OnPaint ")
-				.append(LoadStringAsWstr(g_hInst, IDS_HASFAILED));
-			goto FAIL;
-		}
-
-		hfntPrev = SelectObject(hdcOutputBuffer, hfnt);
-		if (hfntPrev == NULL) goto FAIL;
+		SelectObject(hdcOutputBuffer, g_paint.hFontRotated);
 
 		_snwprintf_s(strData, MAXSTRDATA, _TRUNCATE, L"%d", inner.bottom - inner.top + 1);
 		DrawText(hdcOutputBuffer, strData, -1, &rectText, DT_SINGLELINE | DT_NOCLIP | DT_CALCRECT);
@@ -2604,7 +3848,7 @@ BOOL OnPaint(HWND hWindow) {
 		int dX = rectText.right - rectText.left + 1;
 		int dY = rectText.bottom - rectText.top + 1;
 
-		if (bm.bmWidth - inner.right >= (rectText.bottom - rectText.top + 1))
+		if (g_screenshot.width - inner.right >= (rectText.bottom - rectText.top + 1))
 		{ // Enough space for text
 			rectText.left = outer.right;
 			rectText.top = (outer.bottom + outer.top + dX) / 2;
@@ -2633,24 +3877,12 @@ BOOL OnPaint(HWND hWindow) {
 	// Draw information
 	if (g_displayInternalInformation)
 	{
-		HBRUSH hBrushDisplayForeground = (g_useAlternativeColors ? hBrushBackground : hBrushForeground);
-		HBRUSH hBrushDisplayBackground = (g_useAlternativeColors ? hBrushForeground : hBrushBackground);
+		HBRUSH hBrushDisplayForeground = (g_useAlternativeColors ? g_paint.hBrushBackground : g_paint.hBrushForeground);
+		HBRUSH hBrushDisplayBackground = (g_useAlternativeColors ? g_paint.hBrushForeground : g_paint.hBrushBackground);
 
 		RECT rectTextArea = { 0, 0, 0, 0 };
 		// Text rotated 0 degree
-		SelectObject(hdc, hfntPrev);
-		DeleteObject(hfnt);
-		plf->lfEscapement = 0;
-		hfnt = CreateFontIndirect(plf);
-		if (hfnt == NULL)
-		{
-			sMessage.assign(L"CreateFontIndirect@OnPaint ")
-				.append(LoadStringAsWstr(g_hInst, IDS_HASFAILED));
-			goto FAIL;
-		}
-
-		hfntPrev = SelectObject(hdcOutputBuffer, hfnt);
-		if (hfntPrev == NULL) goto FAIL;
+		SelectObject(hdcOutputBuffer, g_paint.hFont);
 
 		SetBkMode(hdcOutputBuffer, TRANSPARENT);
 		if (!g_useAlternativeColors)
@@ -2658,10 +3890,8 @@ BOOL OnPaint(HWND hWindow) {
 		else
 			SetTextColor(hdcOutputBuffer, ALTAPPCOLORINV);
 
-		int screenX = GetSystemMetrics(SM_XVIRTUALSCREEN);
-		int screenY = GetSystemMetrics(SM_YVIRTUALSCREEN);
-
-		_snwprintf_s(strData, MAXSTRDATA, _TRUNCATE, L"Virtual desktop [%d,%d] %dx%d", screenX, screenY, GetSystemMetrics(SM_CXVIRTUALSCREEN), GetSystemMetrics(SM_CYVIRTUALSCREEN));
+		_snwprintf_s(strData, MAXSTRDATA, _TRUNCATE, L"%s [%d,%d] %dx%d (%hs)", ((g_rectMonitor.size() == 1) && EqualRect(&g_captureRect, &g_rectMonitor[0])) ? L"Monitor" : L"Virtual desktop",
+			g_captureRect.left, g_captureRect.top, g_captureRect.right - g_captureRect.left, g_captureRect.bottom - g_captureRect.top, g_captureSource.name);
 		sDisplayInfos.assign(strData);
 
 		_snwprintf_s(strData, MAXSTRDATA, _TRUNCATE, L"Selection [%d,%d] [%d,%d]", g_selection.left, g_selection.top, g_selection.right, g_selection.bottom);
@@ -2670,14 +3900,57 @@ BOOL OnPaint(HWND hWindow) {
 		_snwprintf_s(strData, MAXSTRDATA, _TRUNCATE, L"Stored selection [%d,%d] [%d,%d]", g_storedSelection.left, g_storedSelection.top, g_storedSelection.right, g_storedSelection.bottom);
 		sDisplayInfos.append(L"\n").append(strData);
 
-		_snwprintf_s(strData, MAXSTRDATA, _TRUNCATE, L"Bitmap %dx%d", bm.bmWidth, bm.bmHeight);
+		_snwprintf_s(strData, MAXSTRDATA, _TRUNCATE, L"Bitmap %dx%d", g_screenshot.width, g_screenshot.height);
+		sDisplayInfos.append(L"\n").append(strData);
+
+		_snwprintf_s(strData, MAXSTRDATA, _TRUNCATE, L"Painted pixels %u", g_paintedPixels);
+		sDisplayInfos.append(L"\n").append(strData);
+
+		_snwprintf_s(strData, MAXSTRDATA, _TRUNCATE, L"Last paint time %.2f ms", g_paintTime);
+		sDisplayInfos.append(L"\n").append(strData);
+
+		_snwprintf_s(strData, MAXSTRDATA, _TRUNCATE, L"Capture time %.2f ms (%s surface%s)",
+			g_captureTime, g_bCaptureSurfaceReused ? L"reused" : L"new", (g_parallelMonitorCapture && (g_rectMonitor.size() > 1)) ? L", parallel" : L"");
+		sDisplayInfos.append(L"\n").append(strData);
+
+		if (!g_captureHistory.frames.empty())
+		{
+			_snwprintf_s(strData, MAXSTRDATA, _TRUNCATE, L"Capture history %u frames %.1f MB", (unsigned int)g_captureHistory.frames.size(),
+				(double)g_captureHistory.bytes / (1024 * 1024));
+			sDisplayInfos.append(L"\n").append(strData);
+			if ((g_historyFrame >= 0) && (g_historyFrame < (int)g_captureHistory.frames.size()))
+			{
+				_snwprintf_s(strData, MAXSTRDATA, _TRUNCATE, L", shown frame %d (%.1f s before newest)", g_historyFrame,
+					(double)(g_captureHistory.frames.back().time - g_captureHistory.frames[g_historyFrame].time) / 1000);
+				sDisplayInfos.append(strData);
+			}
+		}
+
+		_snwprintf_s(strData, MAXSTRDATA, _TRUNCATE, L"Latency %.1f ms: Started %.1f, Capture %.1f",
+			g_latencyTotal, g_latencyTimes[latencyStarted], g_latencyTimes[latencyCaptured]);
+		sDisplayInfos.append(L"\n").append(strData);
+
+		_snwprintf_s(strData, MAXSTRDATA, _TRUNCATE, L"Settings %.1f, Fullscreen %.1f, Focus %.1f, First frame %.1f ms",
+			g_latencyTimes[latencySettings], g_latencyTimes[latencyFullScreen], g_latencyTimes[latencyFocused], g_latencyTimes[latencyFirstFrame]);
+		sDisplayInfos.append(L"\n").append(strData);
+
+		_snwprintf_s(strData, MAXSTRDATA, _TRUNCATE, L"Settings snapshot read %u times (%s)",
+			g_settings.dwReads, g_bSettingsNotification ? L"change notification" : L"no change notification");
+		sDisplayInfos.append(L"\n").append(strData);
+
+		SAVEQUEUESTATISTICS saveQueue = getSaveQueueStatistics();
+		_snwprintf_s(strData, MAXSTRDATA, _TRUNCATE, L"Save queue %d (max %d), %u saved, %u full, latency %.0f ms (max %.0f ms)",
+			saveQueue.depth, saveQueue.maxDepth, saveQueue.finishedJobs, saveQueue.rejectedJobs, saveQueue.lastLatency, saveQueue.maxLatency);
 		sDisplayInfos.append(L"\n").append(strData);
 
 		POINT mouse;
 		GetCursorPos(&mouse);
-		color = GetPixel(hdcScreenshot, mouse.x - g_appWindowPos.x, mouse.y - g_appWindowPos.y);
+		color = 0;
+		if ((mouse.x - g_appWindowPos.x >= 0) && (mouse.x - g_appWindowPos.x < g_screenshot.width) &&
+			(mouse.y - g_appWindowPos.y >= 0) && (mouse.y - g_appWindowPos.y < g_screenshot.height))
+			color = getImagePixel(g_screenshot, mouse.x - g_appWindowPos.x, mouse.y - g_appWindowPos.y);
 
-		_snwprintf_s(strData, MAXSTRDATA, _TRUNCATE, L"Mouse [%d,%d] RGB %d,%d,%d", mouse.x, mouse.y, GetRValue(color), GetGValue(color), GetBValue(color));
+		_snwprintf_s(strData, MAXSTRDATA, _TRUNCATE, L"Mouse [%d,%d] RGB %d,%d,%d", mouse.x, mouse.y, (color >> 16) & 0xff, (color >> 8) & 0xff, color & 0xff);
 		sDisplayInfos.append(L"\n").append(strData);
 
 		_snwprintf_s(strData, MAXSTRDATA, _TRUNCATE, L"Save to file %s", g_saveToFile ? L"On" : L"Off");
@@ -2686,6 +3959,11 @@ BOOL OnPaint(HWND hWindow) {
 		_snwprintf_s(strData, MAXSTRDATA, _TRUNCATE, L"Save to clipboard %s", g_saveToClipboard ? L"On" : L"Off");
 		sDisplayInfos.append(L"\n").append(strData);
 
+		_snwprintf_s(strData, MAXSTRDATA, _TRUNCATE, L"Compression profile %s%s",
+			(g_compressionProfile == pngProfileFast) ? L"fast" : (g_compressionProfile == pngProfileSmallest) ? L"smallest" : L"balanced",
+			g_bCompressionProfileGPO ? L" (GPO)" : L"");
+		sDisplayInfos.append(L"\n").append(strData);
+
 		_snwprintf_s(strData, MAXSTRDATA, _TRUNCATE, L"Alternative colors %s", g_useAlternativeColors ? L"On" : L"Off");
 		sDisplayInfos.append(L"\n").append(strData);
 
@@ -2695,8 +3973,8 @@ BOOL OnPaint(HWND hWindow) {
 		RECT rectWindow = { 0 };
 		GetWindowRect(hWindow, &rectWindow);
 
-		if ((rectWindow.left != screenX) || (rectWindow.top != screenY)) {
-			_snwprintf_s(strData, MAXSTRDATA, _TRUNCATE, L" ([%d,%d]!=[%d,%d])", rectWindow.left, rectWindow.top, screenX, screenY);
+		if ((rectWindow.left != g_captureRect.left) || (rectWindow.top != g_captureRect.top)) {
+			_snwprintf_s(strData, MAXSTRDATA, _TRUNCATE, L" ([%d,%d]!=[%d,%d])", rectWindow.left, rectWindow.top, g_captureRect.left, g_captureRect.top);
 			sDisplayInfos.append(strData);
 		}
 
@@ -2736,11 +4014,20 @@ BOOL OnPaint(HWND hWindow) {
 		textFormat = 0;
 		POINT pos = { rectTextArea.left, rectTextArea.top };
 		HMONITOR hMonitor = MonitorFromPoint(pos, MONITOR_DEFAULTTONULL);
+
+		// Store both possible areas for the information (with monitor layout below), to invalidate them on changes
+		LONG informationHeight = height + 10 + (LONG)((g_captureRect.bottom - g_captureRect.top - 1) * (float)(width + 1) / (g_captureRect.right - g_captureRect.left)) + 2;
+		g_rectInformation[0] = { rectTextArea.left, rectTextArea.top, rectTextArea.left + width + 1, rectTextArea.top + informationHeight };
+		g_rectInformation[1] = { 0 };
+		InflateRect(&g_rectInformation[0], OVERLAYMARGIN, OVERLAYMARGIN);
+
 		if (hMonitor != NULL)
 		{
 			MONITORINFO mi;
 			mi.cbSize = sizeof(mi);
 			if (GetMonitorInfo(hMonitor, &mi)) {
+				g_rectInformation[1] = { mi.rcMonitor.right - width - 10, rectTextArea.top, mi.rcMonitor.right - 10 + 1, rectTextArea.top + informationHeight };
+				InflateRect(&g_rectInformation[1], OVERLAYMARGIN, OVERLAYMARGIN);
 				switch (g_appState)
 				{
 				case stateFirstPoint:
@@ -2771,12 +4058,12 @@ BOOL OnPaint(HWND hWindow) {
 		DrawText(hdcOutputBuffer, sDisplayInfos.c_str(), -1, &rectText, DT_NOCLIP | textFormat);
 
 		// Draw monitor layout
-		float scale = (float)(rectTextArea.right - rectTextArea.left) / GetSystemMetrics(SM_CXVIRTUALSCREEN);
+		float scale = (float)(rectTextArea.right - rectTextArea.left) / (g_captureRect.right - g_captureRect.left);
 		RECT virtualDesktop;
 		virtualDesktop.left = rectTextArea.left;
 		virtualDesktop.top = rectTextArea.bottom + 10;
-		virtualDesktop.right = virtualDesktop.left + (LONG)((GetSystemMetrics(SM_CXVIRTUALSCREEN) - 1) * scale) + 1;
-		virtualDesktop.bottom = virtualDesktop.top + (LONG)((GetSystemMetrics(SM_CYVIRTUALSCREEN) - 1) * scale) + 1;
+		virtualDesktop.right = virtualDesktop.left + (LONG)((g_captureRect.right - g_captureRect.left - 1) * scale) + 1;
+		virtualDesktop.bottom = virtualDesktop.top + (LONG)((g_captureRect.bottom - g_captureRect.top - 1) * scale) + 1;
 		FrameRect(hdcOutputBuffer, &virtualDesktop, hBrushDisplayForeground); // Virtual desktop frame
 
 		if (g_useAlternativeColors)
@@ -2836,8 +4123,14 @@ BOOL OnPaint(HWND hWindow) {
 		}
 	}
 
-	// Copy memory buffer to display
-	if (!BitBlt(hdc, 0, 0, iWidth, iHeight, hdcOutputBuffer, 0, 0, SRCCOPY))
+	// Remember drawn overlay for the next invalidateOverlay
+	resetPaintedOverlay();
+	g_hPaintedOverlay = createOverlayRegion();
+	g_paintedInner = getSelectionInner();
+
+	// Copy memory buffer to display (only the invalidated area)
+	if (!BitBlt(hdc, ps.rcPaint.left, ps.rcPaint.top, ps.rcPaint.right - ps.rcPaint.left, ps.rcPaint.bottom - ps.rcPaint.top,
+		hdcOutputBuffer, ps.rcPaint.left, ps.rcPaint.top, SRCCOPY))
 	{
 		_snwprintf_s(szHex, _MAX_ITOSTR_BASE16_COUNT + 2, _TRUNCATE, L"0x%08X", GetLastError());
 		sMessage.assign(L"BitBlt@OnPaint ")
@@ -2857,25 +4150,21 @@ FAIL:
 
 CLEANUP:
 	// Free resources/Cleanup
-	if (hBrushForeground != NULL) DeleteObject(hBrushForeground);
-	if (hBrushBackground != NULL) DeleteObject(hBrushBackground);
-
 	if (hbmScreenshotOld != NULL) SelectObject(hdcScreenshot, hbmScreenshotOld);
-	if (hdcOutputBuffer != NULL)
-	{
-		// Restore memory device context state
-		if (hfntPrev != NULL) SelectObject(hdcOutputBuffer, hfntPrev);
-		if (iBackupOutputDC != 0) RestoreDC(hdcOutputBuffer, iBackupOutputDC);
-	}
-	if (hfnt != NULL) DeleteObject(hfnt);
-	if (plf != NULL) LocalFree((LOCALHANDLE)plf);
-	if (bmOutputBuffer != NULL) DeleteObject(bmOutputBuffer);
+	// Restore memory device context state (font, clipping, colors)
+	if ((hdcOutputBuffer != NULL) && (iBackupOutputDC != 0)) RestoreDC(hdcOutputBuffer, iBackupOutputDC);
+	if (hUpdateRegion != NULL) DeleteObject(hUpdateRegion);
 
-	if (hdcOutputBuffer != NULL) DeleteDC(hdcOutputBuffer);
 	if (hdcScreenshot != NULL) DeleteDC(hdcScreenshot);
 
 	EndPaint(hWindow, &ps);
 
+	QueryPerformanceCounter(&paintEnd);
+	if (QueryPerformanceFrequency(&frequency) && (frequency.QuadPart > 0))
+		g_paintTime = (double)(paintEnd.QuadPart - paintStart.QuadPart) * 1000 / frequency.QuadPart;
+
+	if (g_latencyStamps[latencyStarted].QuadPart != 0) markLatencyStage(latencyFirstFrame); // First frame after the capture
+
 	return bResult;
 }
 
@@ -2940,14 +4229,15 @@ void resizeSelection(HWND hWindow, int stepSize)
 	if (g_appState == statePointA) MySetCursorPos(g_selection.left, g_selection.top);
 	if (g_appState == statePointB) MySetCursorPos(g_selection.right, g_selection.bottom);
 
-	InvalidateRect(hWindow, NULL, TRUE);
+	invalidateOverlay(hWindow);
 }
 
 /*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
   Function: setBeforeColorChange
 
   Summary:   Set x/y position in screenshot to the pixel before the next color change
-			 (direction depends on virtual key code)
+			 (direction depends on virtual key code). Colors within g_colorTolerance
+			 per channel count as the same color.
 
   Args:     WPARAM virtualKeyCode
 			  Virtual key code
@@ -2963,24 +4253,16 @@ void resizeSelection(HWND hWindow, int stepSize)
 -----------------------------------------------------------------F-F*/
 BOOL setBeforeColorChange(WPARAM virtualKeyCode, LONG& x, LONG& y)
 {
-	BITMAP bm;
 	int directionX = 0;
 	int directionY = 0;
-	COLORREF referenceColor;
+	int position = 0;
+	const EDGEINDEX* pEdgeIndex = NULL;
 	BOOL bResult = TRUE;
-	HDC hdcScreenshot = NULL;
-	HGDIOBJ hbmScreenshotOld = NULL;
 	std::wstring sMessage = L"";
 
-	if (g_hBitmap == NULL) goto FAIL;
-
-	if (GetObject(g_hBitmap, sizeof(bm), &bm) == 0) goto FAIL;
-	hdcScreenshot = CreateCompatibleDC(NULL);
-	if (hdcScreenshot == NULL) goto FAIL;
-	hbmScreenshotOld = SelectObject(hdcScreenshot, g_hBitmap);
-	if (hbmScreenshotOld == NULL) goto FAIL;
+	if (!isImageValid(g_screenshot)) goto FAIL;
+	if ((x < 0) || (x > g_screenshot.width - 1) || (y < 0) || (y > g_screenshot.height - 1)) goto FAIL;
 
-	referenceColor = GetPixel(hdcScreenshot, x, y);
 	switch (virtualKeyCode)
 	{
 	case VK_UP:
@@ -3000,17 +4282,15 @@ BOOL setBeforeColorChange(WPARAM virtualKeyCode, LONG& x, LONG& y)
 		goto FAIL;
 	}
 
-	while (true) {
-		if (GetPixel(hdcScreenshot, x + directionX, y + directionY) != referenceColor) break;
-
-		if (x + directionX < 0) break;
-		if (x + directionX > bm.bmWidth - 1) break;
-		if (y + directionY < 0) break;
-		if (y + directionY > bm.bmHeight - 1) break;
-
-		x = limitXtoBitmap(x + directionX);
-		y = limitYtoBitmap(y + directionY);
+	// Use edge index when the background build is finished, otherwise scan the screenshot
+	pEdgeIndex = getEdgeIndex();
+	if (pEdgeIndex != NULL)
+		position = findEdge(*pEdgeIndex, x, y, directionX, directionY);
+	else {
+		GdiFlush(); // Finish GDI drawing before accessing the pixels
+		position = findEdgeByScan(g_screenshot, g_colorTolerance, x, y, directionX, directionY);
 	}
+	if (directionX != 0) x = position; else y = position;
 	goto CLEANUP;
 FAIL:
 	bResult = FALSE;
@@ -3020,9 +4300,6 @@ FAIL:
 	MessageBox(g_hWindow, sMessage.c_str(), LoadStringAsWstr(g_hInst, IDS_APP_TITLE).c_str(), MB_OK | MB_ICONERROR);
 
 CLEANUP:
-	if (hbmScreenshotOld != NULL) SelectObject(hdcScreenshot, hbmScreenshotOld);
-	if (hdcScreenshot != NULL) DeleteDC(hdcScreenshot);
-
 	return bResult;
 }
 
@@ -3073,7 +4350,7 @@ void checkCursorButtons(HWND hWindow, WPARAM wParam, int step)
 			}
 			break;
 		}
-		InvalidateRect(hWindow, NULL, TRUE);
+		invalidateOverlay(hWindow);
 		break;
 	case VK_DOWN:
 		switch (g_appState)
@@ -3104,7 +4381,7 @@ void checkCursorButtons(HWND hWindow, WPARAM wParam, int step)
 			}
 			break;
 		}
-		InvalidateRect(hWindow, NULL, TRUE);
+		invalidateOverlay(hWindow);
 		break;
 	case VK_LEFT:
 		switch (g_appState)
@@ -3135,7 +4412,7 @@ void checkCursorButtons(HWND hWindow, WPARAM wParam, int step)
 			}
 			break;
 		}
-		InvalidateRect(hWindow, NULL, TRUE);
+		invalidateOverlay(hWindow);
 		break;
 	case VK_RIGHT:
 		switch (g_appState)
@@ -3166,38 +4443,207 @@ void checkCursorButtons(HWND hWindow, WPARAM wParam, int step)
 			}
 			break;
 		}
-		InvalidateRect(hWindow, NULL, TRUE);
-		break;
+		invalidateOverlay(hWindow);
+		break;
+	}
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: isCaptureMonitorOnly
+
+  Summary:   Checks, if only the monitor under the mouse cursor is captured
+			 (captureMonitorOnly or /m, when captureMonitorOnly is not set by
+			 a GPO)
+
+  Args:
+
+  Returns:	BOOL
+
+-----------------------------------------------------------------F-F*/
+BOOL isCaptureMonitorOnly()
+{
+	if (g_bCaptureMonitorOnlyGPO) return g_captureMonitorOnly;
+	return g_captureMonitorOnly || g_bCaptureMonitorOnlyArgument;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: MonitorEnumProc
+
+  Summary:   Callback function for EnumDisplayMonitors to add the virtual screen rectangle coordinates for the monitor to a vector
+
+  Args:     HMONITOR hMonitor
+			  Handle to monitor
+			HDC hdcMonitor
+			  Handle to device context
+			LPRECT lprcMonitor
+			  Pointer to a RECT for the virtual screen rectangle coordinates
+			LPARAM dwData
+			  Pointer to std::vector<CAPTURERECT> for the monitors
+
+  Returns:	BOOL
+			  Is always TRUE
+
+-----------------------------------------------------------------F-F*/
+BOOL CALLBACK MonitorEnumProc(HMONITOR hMonitor, HDC hdcMonitor, LPRECT lprcMonitor, LPARAM dwData) {
+	std::vector<CAPTURERECT>* pMonitors = (std::vector<CAPTURERECT>*)dwData;
+	pMonitors->push_back({ lprcMonitor->left, lprcMonitor->top, lprcMonitor->right, lprcMonitor->bottom });
+	return TRUE;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: captureGDIMonitor
+
+  Summary:   Copies one monitor with BitBlt into its area of the frame. Runs on
+			 its own thread, so it uses its own DCs and bitmap and records the
+			 duration as trace event.
+
+  Args:     const IMAGEBUFFER &image
+			  Frame
+			const CAPTURELAYOUT &layout
+			  Layout of the frame
+			size_t monitor
+			  Index of the monitor in layout.monitors
+
+  Returns:	BOOL
+			  TRUE = success
+			  FALSE = failure
+
+-----------------------------------------------------------------F-F*/
+BOOL captureGDIMonitor(const IMAGEBUFFER& image, const CAPTURELAYOUT& layout, size_t monitor)
+{
+	int64_t traceStart = isTraceEnabled() ? getTraceMicroseconds() : -1;
+	HDC hdcScreen = NULL;
+	HDC hdcMonitor = NULL;
+	HBITMAP hbmMonitor = NULL;
+	HGDIOBJ hbmMonitorOld = NULL;
+	IMAGEBUFFER monitorImage = { 0 };
+	IMAGEBUFFER target = { 0 };
+	BOOL bResult = TRUE;
+
+	// Part of the monitor inside the frame
+	const CAPTURERECT& rect = layout.monitors[monitor];
+	int left = (rect.left > layout.bounds.left) ? rect.left : layout.bounds.left;
+	int top = (rect.top > layout.bounds.top) ? rect.top : layout.bounds.top;
+	int width = ((rect.right < layout.bounds.right) ? rect.right : layout.bounds.right) - left;
+	int height = ((rect.bottom < layout.bounds.bottom) ? rect.bottom : layout.bounds.bottom) - top;
+	if (!getImageView(image, left - layout.bounds.left, top - layout.bounds.top, width, height, target)) goto CLEANUP; // Nothing to do
+
+	hdcScreen = GetDC(NULL);
+	if (hdcScreen == NULL) goto FAIL;
+	hdcMonitor = CreateCompatibleDC(hdcScreen);
+	if (hdcMonitor == NULL) goto FAIL;
+	hbmMonitor = createImageBitmap(NULL, width, height, monitorImage);
+	if (hbmMonitor == NULL) goto FAIL;
+	hbmMonitorOld = SelectObject(hdcMonitor, hbmMonitor);
+	if (hbmMonitorOld == NULL) goto FAIL;
+
+	if (!BitBlt(hdcMonitor, 0, 0, width, height, hdcScreen, left, top, SRCCOPY)) goto FAIL;
+	GdiFlush(); // Finish BitBlt before the pixels are accessed
+	copyImage(target, monitorImage);
+	goto CLEANUP;
+FAIL:
+	bResult = FALSE;
+CLEANUP:
+	if (hbmMonitorOld != NULL) SelectObject(hdcMonitor, hbmMonitorOld);
+	if (hbmMonitor != NULL) DeleteObject(hbmMonitor);
+	if (hdcMonitor != NULL) DeleteDC(hdcMonitor);
+	if (hdcScreen != NULL) ReleaseDC(NULL, hdcScreen);
+
+	if (traceStart >= 0)
+	{
+		char szName[MAX_PATH];
+		_snprintf_s(szName, MAX_PATH, _TRUNCATE, "Capture monitor %u [%d,%d] %dx%d", (unsigned int)monitor + 1, left, top, width, height);
+		addTraceEvent(szName, TRACEDEFAULTCATEGORY, traceStart, getTraceMicroseconds() - traceStart);
+	}
+	return bResult;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: captureGDIMonitors
+
+  Summary:   Captures all monitors in parallel. The first monitor is captured
+			 by the calling thread, each other monitor by its own thread,
+			 because the driver can serialize a BitBlt over all monitors.
+
+  Args:     const IMAGEBUFFER &image
+			  Frame
+			const CAPTURELAYOUT &layout
+			  Layout of the frame
+
+  Returns:	BOOL
+			  TRUE = success
+			  FALSE = failure of at least one monitor
+
+-----------------------------------------------------------------F-F*/
+BOOL captureGDIMonitors(const IMAGEBUFFER& image, const CAPTURELAYOUT& layout)
+{
+	TRACESCOPE traceScope("captureGDIMonitors");
+	std::vector<BOOL> results(layout.monitors.size(), FALSE);
+	std::vector<std::thread> threads;
+
+	for (size_t i = 1; i < layout.monitors.size(); i++)
+	{
+		try {
+			threads.push_back(std::thread([&image, &layout, &results, i] { results[i] = captureGDIMonitor(image, layout, i); }));
+		}
+		catch (...) { // No thread => capture by the calling thread
+			results[i] = captureGDIMonitor(image, layout, i);
+		}
 	}
+	if (!layout.monitors.empty()) results[0] = captureGDIMonitor(image, layout, 0);
+	for (std::thread& thread : threads) thread.join();
+
+	for (BOOL bResult : results) if (!bResult) return FALSE;
+	return TRUE;
 }
 
 /*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-  Function: CaptureScreen
+  Function: captureGDIScreen
 
-  Summary:   Capture screen to a bitmap
+  Summary:   Capture function of the GDI capture source. Enumerates the
+			 monitors and copies the virtual screen (or only the monitor under
+			 the mouse cursor with captureMonitorOnly) with one BitBlt or each
+			 monitor by its own thread (parallelMonitorCapture).
 
-  Args:     HWND hWindow
-			  Handle to window
+  Args:     const CAPTUREALLOCATEFUNCTION &allocate
+			  Provides the target image (has to be the DIB section g_hBitmap)
+			IMAGEBUFFER &image
+			  Target image (call by ref)
+			CAPTURELAYOUT &layout
+			  Layout of the frame (call by ref)
 
-  Returns:	BOOL
-			  TRUE = success
-			  FALSE = failure
+  Returns:	bool
+			  true = success
+			  false = failure (message in g_sCaptureError)
 
 -----------------------------------------------------------------F-F*/
-BOOL CaptureScreen(HWND hWindow)
+bool captureGDIScreen(const CAPTUREALLOCATEFUNCTION& allocate, IMAGEBUFFER& image, CAPTURELAYOUT& layout)
 {
 	HDC hdcScreen = NULL;
 	HDC hdcScreenshot = NULL;
 	HGDIOBJ hbmScreenshotOld = NULL;
-	BOOL bResult = TRUE;
-	std::wstring sMessage = L"";
+	bool bResult = true;
 	wchar_t szHex[_MAX_ITOSTR_BASE16_COUNT + 2];
 
+	POINT cursor;
 	int screenX = GetSystemMetrics(SM_XVIRTUALSCREEN);
 	int screenY = GetSystemMetrics(SM_YVIRTUALSCREEN);
 	int screenWidth = GetSystemMetrics(SM_CXVIRTUALSCREEN);
 	int screenHeight = GetSystemMetrics(SM_CYVIRTUALSCREEN);
 
+	layout.bounds = { screenX, screenY, screenX + screenWidth, screenY + screenHeight };
+	layout.monitors.clear();
+	EnumDisplayMonitors(NULL, NULL, MonitorEnumProc, (LPARAM)&layout.monitors);
+
+	// Only the monitor under the mouse cursor
+	if (isCaptureMonitorOnly() && GetCursorPos(&cursor) && selectCaptureMonitor(layout, cursor.x, cursor.y))
+	{
+		screenX = layout.bounds.left;
+		screenY = layout.bounds.top;
+		screenWidth = layout.bounds.right - layout.bounds.left;
+		screenHeight = layout.bounds.bottom - layout.bounds.top;
+	}
+
 	// Retrieve the handle to a display device context for the client
 	// area of the window.
 	hdcScreen = GetDC(NULL);
@@ -3208,79 +4654,325 @@ BOOL CaptureScreen(HWND hWindow)
 
 	if (!hdcScreenshot)
 	{
-		sMessage.assign(L"CreateCompatibleDC@CaptureScreen ").append(LoadStringAsWstr(g_hInst, IDS_HASFAILED));
+		g_sCaptureError.assign(L"CreateCompatibleDC@CaptureScreen ").append(LoadStringAsWstr(g_hInst, IDS_HASFAILED));
 		goto FAIL;
 	}
 
-	if (g_hBitmap != NULL) { // Delete previous screenshot
-		DeleteObject(g_hBitmap);
-		g_hBitmap = NULL;
-	}
-
-	// Create a compatible bitmap from the Window DC.
-	g_hBitmap = CreateCompatibleBitmap(hdcScreen, screenWidth, screenHeight);
-	if (g_hBitmap == NULL)
+	if (!allocate(screenWidth, screenHeight, image))
 	{
-		sMessage.assign(L"CreateCompatibleBitmap@CaptureScreen ")
+		g_sCaptureError.assign(L"CreateDIBSection@CaptureScreen ")
 			.append(LoadStringAsWstr(g_hInst, IDS_HASFAILED));
 		goto FAIL;
 	}
-	// Select the compatible bitmap into the compatible memory DC.
-	hbmScreenshotOld = SelectObject(hdcScreenshot, g_hBitmap);
-	if (hbmScreenshotOld == NULL) goto FAIL;
+	if (g_parallelMonitorCapture && (layout.monitors.size() > 1))
+	{
+		// Each monitor by its own thread
+		if (!captureGDIMonitors(image, layout))
+		{
+			g_sCaptureError.assign(L"captureGDIMonitors@CaptureScreen ").append(LoadStringAsWstr(g_hInst, IDS_HASFAILED));
+			goto FAIL;
+		}
+	}
+	else
+	{
+		// Select the compatible bitmap into the compatible memory DC.
+		hbmScreenshotOld = SelectObject(hdcScreenshot, g_hBitmap);
+		if (hbmScreenshotOld == NULL) goto FAIL;
+
+		// Bit block transfer into our compatible memory DC.
+		if (!BitBlt(hdcScreenshot,
+			0, 0,
+			screenWidth, screenHeight,
+			hdcScreen,
+			screenX, screenY,
+			SRCCOPY))
+		{
+			_snwprintf_s(szHex, _MAX_ITOSTR_BASE16_COUNT + 2, _TRUNCATE, L"0x%08X", GetLastError());
+			g_sCaptureError.assign(L"BitBlt@CaptureScreen ")
+				.append(LoadStringAsWstr(g_hInst, IDS_HASFAILED))
+				.append(L" ")
+				.append(szHex);
+			goto FAIL;
+		}
+		GdiFlush(); // Finish BitBlt before the pixels are accessed
+	}
 
-	// Bit block transfer into our compatible memory DC.
-	if (!BitBlt(hdcScreenshot,
-		0, 0,
-		screenWidth, screenHeight,
-		hdcScreen,
-		screenX, screenY,
-		SRCCOPY))
+	// Areas without monitor
+	fillCaptureGaps(image, layout, MONITORGAPCOLOR);
+	goto CLEANUP;
+FAIL:
+	bResult = false;
+CLEANUP:
+	// Free resources/Clean up
+	if (hbmScreenshotOld != NULL) SelectObject(hdcScreenshot, hbmScreenshotOld);
+	if (hdcScreenshot != NULL) DeleteDC(hdcScreenshot);
+	if (hdcScreen != NULL) ReleaseDC(NULL, hdcScreen);
+	return bResult;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: createGDICaptureSource
+
+  Summary:   Creates the capture source for the desktop
+
+  Args:
+
+  Returns:	CAPTURESOURCE
+
+-----------------------------------------------------------------F-F*/
+CAPTURESOURCE createGDICaptureSource()
+{
+	CAPTURESOURCE source;
+	source.name = "GDI";
+	source.capture = captureGDIScreen;
+	return source;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: loadReplayFile
+
+  Summary:   Uses the frames of a replay file as capture source
+
+  Args:     const std::wstring &sFile
+			  Replay file
+
+  Returns:	BOOL
+			  TRUE = success
+			  FALSE = file cannot be read or has no valid frames
+
+-----------------------------------------------------------------F-F*/
+BOOL loadReplayFile(const std::wstring& sFile)
+{
+	HANDLE hFile = CreateFile(sFile.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (hFile == INVALID_HANDLE_VALUE) return FALSE;
+
+	std::shared_ptr<CAPTUREREPLAY> pReplay = std::make_shared<CAPTUREREPLAY>();
+	BOOL bLoaded = loadCaptureReplay([hFile](void* pData, size_t size) {
+		DWORD dwRead = 0;
+		return ReadFile(hFile, pData, (DWORD)size, &dwRead, NULL) && (dwRead == size);
+	}, *pReplay);
+	CloseHandle(hFile);
+	if (!bLoaded) return FALSE;
+
+	g_captureSource = createReplayCaptureSource(pReplay);
+	return TRUE;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: recordCapture
+
+  Summary:   Appends the screenshot with its layout to the replay file g_sRecordFile
+
+  Args:     const CAPTURELAYOUT &layout
+			  Layout of the screenshot
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void recordCapture(const CAPTURELAYOUT& layout)
+{
+	HANDLE hFile = CreateFile(g_sRecordFile.c_str(), FILE_APPEND_DATA, FILE_SHARE_READ, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (hFile == INVALID_HANDLE_VALUE) return;
+
+	// Buffered, because the frame is written in 32 bit values
+	std::vector<uint8_t> buffer;
+	BOOL bWritten = writeCaptureFrame(g_screenshot, layout, [&buffer, hFile](const void* pData, size_t size) {
+		buffer.insert(buffer.end(), (const uint8_t*)pData, (const uint8_t*)pData + size);
+		if (buffer.size() < 65536) return true;
+		DWORD dwWritten = 0;
+		BOOL bResult = WriteFile(hFile, buffer.data(), (DWORD)buffer.size(), &dwWritten, NULL) && (dwWritten == buffer.size());
+		buffer.clear();
+		return bResult ? true : false;
+	});
+	DWORD dwWritten = 0;
+	if (bWritten && !buffer.empty()) bWritten = WriteFile(hFile, buffer.data(), (DWORD)buffer.size(), &dwWritten, NULL) && (dwWritten == buffer.size());
+	CloseHandle(hFile);
+	if (!bWritten) OutputDebugString(L"Recording of capture fails");
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: CaptureScreen
+
+  Summary:   Capture screen to a bitmap from the capture source g_captureSource
+			 and store the layout in g_captureRect and g_rectMonitor
+
+  Args:     HWND hWindow
+			  Handle to window
+
+  Returns:	BOOL
+			  TRUE = success
+			  FALSE = failure
+
+-----------------------------------------------------------------F-F*/
+BOOL CaptureScreen(HWND hWindow)
+{
+	TRACESCOPE traceScope("CaptureScreen");
+	BOOL bResult = TRUE;
+	std::wstring sMessage = L"";
+	CAPTURELAYOUT layout;
+	LARGE_INTEGER captureStart, captureEnd, frequency;
+
+	QueryPerformanceCounter(&captureStart);
+
+	g_sCaptureError.clear();
+	g_bCaptureSurfaceReused = FALSE;
+	getDWORDSettingFromRegistry(parallelMonitorCapture);
+	getDWORDSettingFromRegistry(captureMonitorOnly);
+	if (!g_captureSource.capture) g_captureSource = createGDICaptureSource();
+
+	// Get a DIB section (reused from the pool, when the virtual screen size is unchanged), so the pixels of the screenshot can be accessed directly
+	if (!g_captureSource.capture([](int width, int height, IMAGEBUFFER& image) {
+		freeScreenshot(); // Return previous screenshot to the surface pool
+		g_hBitmap = acquireCaptureSurface(width, height, image, &g_bCaptureSurfaceReused);
+		return g_hBitmap != NULL;
+	}, g_screenshot, layout)) goto FAIL;
+
+	// Store layout of the capture
+	g_captureRect = { layout.bounds.left, layout.bounds.top, layout.bounds.right, layout.bounds.bottom };
+	g_rectMonitor.clear();
+	for (const CAPTURERECT& monitor : layout.monitors) g_rectMonitor.push_back({ monitor.left, monitor.top, monitor.right, monitor.bottom });
+
+	QueryPerformanceCounter(&captureEnd);
+	if (QueryPerformanceFrequency(&frequency) && (frequency.QuadPart > 0))
 	{
-		_snwprintf_s(szHex, _MAX_ITOSTR_BASE16_COUNT + 2, _TRUNCATE, L"0x%08X", GetLastError());
-		sMessage.assign(L"BitBlt@CaptureScreen ")
-			.append(LoadStringAsWstr(g_hInst, IDS_HASFAILED))
-			.append(L" ")
-			.append(szHex);
-		goto FAIL;
+		g_captureTime = (double)(captureEnd.QuadPart - captureStart.QuadPart) * 1000 / frequency.QuadPart;
+
+		wchar_t szDebug[MAX_PATH];
+		_snwprintf_s(szDebug, MAX_PATH, _TRUNCATE, L"CaptureScreen %dx%d in %.2f ms (%hs, %s surface)\n",
+			g_screenshot.width, g_screenshot.height, g_captureTime, g_captureSource.name, g_bCaptureSurfaceReused ? L"reused" : L"new");
+		OutputDebugString(szDebug);
 	}
+
+	if (!g_sRecordFile.empty()) recordCapture(layout);
 	goto CLEANUP;
 FAIL:
 	bResult = FALSE;
 	OutputDebugString(L"CaptureScreen fails");
+	sMessage.assign(g_sCaptureError);
 	if (sMessage.length() == 0)
 		sMessage.assign(L"CaptureScreen ").append(LoadStringAsWstr(g_hInst, IDS_HASFAILED));
 	MessageBox(hWindow, sMessage.c_str(), LoadStringAsWstr(g_hInst, IDS_APP_TITLE).c_str(), MB_OK | MB_ICONERROR);
 CLEANUP:
-	// Free resources/Clean up
-	if (hbmScreenshotOld != NULL) SelectObject(hdcScreenshot, hbmScreenshotOld);
-	if (hdcScreenshot != NULL) DeleteDC(hdcScreenshot);
-	if (hdcScreen != NULL) ReleaseDC(NULL, hdcScreen);
 	return bResult;
 }
 
 /*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-  Function: MonitorEnumProc
+  Function: updateCaptureHistoryTimer
 
-  Summary:   Callback function for EnumDisplayMonitors to add the virtual screen rectangle coordinates for the monitor to a global vector
+  Summary:   Reads the settings of the capture history and starts or stops
+			 the background captures. Is called, when the program goes to the
+			 tray or the settings have changed.
 
-  Args:     HMONITOR hMonitor
-			  Handle to monitor
-			HDC hdcMonitor
-			  Handle to device context
-			LPRECT lprcMonitor
-			  Pointer to a RECT for the virtual screen rectangle coordinates
-			LPARAM dwData
+  Args:     HWND hWindow
+			  Handle to window
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void updateCaptureHistoryTimer(HWND hWindow)
+{
+	getDWORDSettingFromRegistry(captureHistory);
+	getDWORDSettingFromRegistry(captureHistoryInterval);
+	getDWORDSettingFromRegistry(captureHistoryMemory);
+	g_captureHistory.maxAge = (int64_t)g_captureHistorySeconds * 1000;
+	g_captureHistory.maxBytes = (size_t)g_captureHistoryMemory * 1024 * 1024;
+
+	if ((g_captureHistorySeconds == 0) || g_onetimeCapture)
+	{
+		KillTimer(hWindow, IDT_TIMERCAPTUREHISTORY);
+		clearCaptureHistory(g_captureHistory);
+		return;
+	}
+	SetTimer(hWindow, IDT_TIMERCAPTUREHISTORY, g_captureHistoryInterval, (TIMERPROC)NULL);
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: captureHistoryFrame
+
+  Summary:   Adds a background capture to the capture history, while the
+			 program waits in the tray. The capture uses a surface of the pool,
+			 which is returned afterwards, so the next capture reuses it.
+
+  Args:
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void captureHistoryFrame()
+{
+	TRACESCOPE traceScope("captureHistoryFrame");
+	CAPTURELAYOUT layout;
+
+	if ((g_appState != stateTrayIcon) || (g_hBitmap != NULL)) return; // Screenshot selection is running
+	if (isLowMemory())
+	{
+		clearCaptureHistory(g_captureHistory);
+		return;
+	}
+
+	getDWORDSettingFromRegistry(parallelMonitorCapture);
+	getDWORDSettingFromRegistry(captureMonitorOnly);
+	if (!g_captureSource.capture) g_captureSource = createGDICaptureSource();
+
+	if (g_captureSource.capture([](int width, int height, IMAGEBUFFER& image) {
+		g_hBitmap = acquireCaptureSurface(width, height, image);
+		return g_hBitmap != NULL;
+	}, g_screenshot, layout))
+	{
+		if (!addCaptureHistoryFrame(g_captureHistory, g_screenshot, layout, (int64_t)GetTickCount64())) OutputDebugString(L"Capture history frame was not stored\n");
+	}
+	freeScreenshot(); // Surface back to the pool
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: showCaptureHistoryFrame
+
+  Summary:   Replaces the screenshot by an earlier or later frame of the
+			 capture history. Before the first step back, the current capture
+			 is added to the history, so it can be shown again. Only frames
+			 with the virtual screen of the current capture are shown.
+
+  Args:     HWND hWindow
+			  Handle to window
+			int step
+			  -1 = earlier frame, 1 = later frame
 
   Returns:	BOOL
-			  Is always TRUE
+			  TRUE = frame is shown
+			  FALSE = no earlier/later frame
 
 -----------------------------------------------------------------F-F*/
-BOOL CALLBACK MonitorEnumProc(HMONITOR hMonitor, HDC hdcMonitor, LPRECT lprcMonitor, LPARAM dwData) {
-	RECT info;
-	info = *lprcMonitor;
-	g_rectMonitor.push_back(info);
-	return TRUE;
+BOOL showCaptureHistoryFrame(HWND hWindow, int step)
+{
+	TRACESCOPE traceScope("showCaptureHistoryFrame");
+	if (g_captureHistory.frames.empty() || !isImageValid(g_screenshot)) return FALSE;
+
+	if (g_historyFrame < 0)
+	{
+		if (step > 0) return FALSE;
+
+		CAPTURELAYOUT layout;
+		layout.bounds = { g_captureRect.left, g_captureRect.top, g_captureRect.right, g_captureRect.bottom };
+		for (const RECT& monitor : g_rectMonitor) layout.monitors.push_back({ monitor.left, monitor.top, monitor.right, monitor.bottom });
+		GdiFlush(); // Finish GDI drawing before accessing the pixels
+		if (!addCaptureHistoryFrame(g_captureHistory, g_screenshot, layout, (int64_t)GetTickCount64())) return FALSE;
+		g_historyFrame = (int)g_captureHistory.frames.size() - 1;
+	}
+
+	int frame = g_historyFrame + step;
+	if ((frame < 0) || (frame >= (int)g_captureHistory.frames.size())) return FALSE;
+	const CAPTURERECT& bounds = g_captureHistory.frames[frame].layout.bounds;
+	if ((bounds.left != g_captureRect.left) || (bounds.top != g_captureRect.top) ||
+		(bounds.right != g_captureRect.right) || (bounds.bottom != g_captureRect.bottom)) return FALSE; // Other monitor layout
+
+	stopEdgeIndexBuild();
+	GdiFlush(); // Finish GDI drawing before accessing the pixels
+	BOOL bResult = restoreCaptureHistoryFrame(g_captureHistory, frame, g_screenshot);
+	if (bResult) g_historyFrame = frame;
+	startEdgeIndexBuild(g_screenshot, g_colorTolerance);
+	if (g_hDimmedBitmap != NULL) updateDimmedScreenshot(NULL);
+	InvalidateRect(hWindow, NULL, TRUE);
+	return bResult;
 }
 
 /*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -3290,11 +4982,13 @@ BOOL CALLBACK MonitorEnumProc(HMONITOR hMonitor, HDC hdcMonitor, LPRECT lprcMoni
 
   Args:     HWND hWindow
 			  Handle to window
+			BOOL bReopenLastCapture
+			  TRUE = Use the kept copy of the last capture instead of a new capture
 
   Returns:
 
 -----------------------------------------------------------------F-F*/
-void startCaptureGUI(HWND hWindow) {
+void startCaptureGUI(HWND hWindow, BOOL bReopenLastCapture) {
 	// Store current window style
 	long prevStyle = GetWindowLong(hWindow, GWL_EXSTYLE);
 	COLORREF crKey;
@@ -3302,6 +4996,11 @@ void startCaptureGUI(HWND hWindow) {
 	DWORD    dwFlags;
 
 	KillTimer(hWindow, IDT_TIMERSCREENSHOTDELAYED);
+	KillTimer(hWindow, IDT_TIMERSURFACEPOOL);
+	KillTimer(hWindow, IDT_TIMERCAPTUREHISTORY);
+	g_historyFrame = -1;
+
+	markLatencyStage(latencyStarted);
 
 	g_activeWindow = GetForegroundWindow();
 	GetLayeredWindowAttributes(hWindow, &crKey, &bAlpha, &dwFlags);
@@ -3310,17 +5009,15 @@ void startCaptureGUI(HWND hWindow) {
 	SetWindowLong(hWindow, GWL_EXSTYLE, WS_EX_LAYERED);
 	SetLayeredWindowAttributes(hWindow, 0, 0, LWA_ALPHA);
 
-	CaptureScreen(hWindow);
-
-	// Stores monitor coordinates
-	g_rectMonitor.clear();
-	EnumDisplayMonitors(NULL, NULL, MonitorEnumProc, 0);
+	if (!bReopenLastCapture || !restoreLastCapture()) CaptureScreen(hWindow); // Stores monitor coordinates too
+	markLatencyStage(latencyCaptured);
 
 	// Restore window style
 	SetLayeredWindowAttributes(hWindow, crKey, bAlpha, dwFlags);
 	SetWindowLong(hWindow, GWL_EXSTYLE, prevStyle);
 
-	// Refresh settings from registry
+	// Refresh settings from snapshot of the registry
+	updateSettingsSnapshot();
 	getDWORDSettingFromRegistry(defaultZoomScale);
 	getDWORDSettingFromRegistry(screenshotDelay);
 	getDWORDSettingFromRegistry(saveToFile);
@@ -3331,11 +5028,20 @@ void startCaptureGUI(HWND hWindow) {
 	getDWORDSettingFromRegistry(storedSelectionTop);
 	getDWORDSettingFromRegistry(storedSelectionRight);
 	getDWORDSettingFromRegistry(storedSelectionBottom);
+	getDWORDSettingFromRegistry(colorTolerance);
+	getDWORDSettingFromRegistry(compressionProfile);
+	getDWORDSettingFromRegistry(keepLastCapture);
+	getDWORDSettingFromRegistry(latencyLog);
 	getScreenshotPathFromRegistry();
+	markLatencyStage(latencySettings);
+
+	// Build edge index for Shift+cursor keys in the background
+	startEdgeIndexBuild(g_screenshot, g_colorTolerance);
 
 	enterFullScreen(hWindow);
 	ShowWindow(hWindow, SW_NORMAL);
 	ShowCursor(false);
+	markLatencyStage(latencyFullScreen);
 
 	if (isSelectionValid(g_storedSelection))
 	{
@@ -3362,10 +5068,8 @@ void startCaptureGUI(HWND hWindow) {
 	// Final FIX01: Check window position, which is sometimes wrong (perhaps a timing problem or caused by Omnissa Horizon Client)
 	RECT rectWindow = { 0 };
 	GetWindowRect(hWindow, &rectWindow);
-	int screenX = GetSystemMetrics(SM_XVIRTUALSCREEN);
-	int screenY = GetSystemMetrics(SM_YVIRTUALSCREEN);
 
-	if ((rectWindow.left != screenX) || (rectWindow.top != screenY)) { // Reapply fullscreen, if window position is not correct
+	if ((rectWindow.left != g_captureRect.left) || (rectWindow.top != g_captureRect.top)) { // Reapply fullscreen, if window position is not correct
 		Sleep(500);
 		enterFullScreen(hWindow);
 	}
@@ -3374,6 +5078,7 @@ void startCaptureGUI(HWND hWindow) {
 	SetForegroundWindowInternal(hWindow);
 	Sleep(10);
 	if (hWindow != GetForegroundWindow()) forceFocus(hWindow);
+	markLatencyStage(latencyFocused);
 }
 
 /*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -3410,6 +5115,100 @@ ATOM MyRegisterClass(HINSTANCE hInstance)
 	return RegisterClassExW(&wcex);
 }
 
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: saveWholeScreenshot
+
+  Summary:   Saves the whole screenshot without window (/ac, /af, /interval=)
+
+  Args:
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void saveWholeScreenshot()
+{
+	if (!isImageValid(g_screenshot)) return;
+
+	g_selection.left = limitXtoBitmap(0);
+	g_selection.top = limitYtoBitmap(0);
+	g_selection.right = limitXtoBitmap(g_screenshot.width - 1);
+	g_selection.bottom = limitYtoBitmap(g_screenshot.height - 1);
+	saveSelection(NULL);
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: captureByInterval
+
+  Summary:   Captures the screen every g_captureInterval milliseconds
+			 (/interval=) and saves each capture like /af or /ac. A capture
+			 equal to the previous capture (same hash) is not saved. The PNG
+			 files are encoded by the writer thread of the save queue, while
+			 the next capture runs.
+
+  Args:     DWORD dwCount
+			  Number of captures (0 = unlimited)
+			DWORD dwDuration
+			  Seconds from the first capture, after which no capture is started (0 = unlimited)
+
+  Returns:	BOOL
+			  TRUE = success
+			  FALSE = failure
+
+-----------------------------------------------------------------F-F*/
+BOOL captureByInterval(DWORD dwCount, DWORD dwDuration)
+{
+	TRACESCOPE traceScope("captureByInterval");
+	BOOL bResult = TRUE;
+	DWORD dwCaptures = 0;
+	DWORD dwSkipped = 0;
+	uint64_t lastHash = 0;
+	ULONGLONG start = GetTickCount64();
+	ULONGLONG next = start;
+
+	while (true)
+	{
+		if ((dwCount > 0) && (dwCaptures >= dwCount)) break;
+		if ((dwDuration > 0) && (next - start >= dwDuration * 1000ULL)) break;
+
+		ULONGLONG now = GetTickCount64();
+		if (next > now) Sleep((DWORD)(next - now));
+
+		if (!CaptureScreen(NULL))
+		{
+			bResult = FALSE;
+			break;
+		}
+		dwCaptures++;
+
+		uint64_t hash = hashImage(g_screenshot);
+		if ((dwCaptures > 1) && (hash == lastHash)) dwSkipped++; // Unchanged screen
+		else saveWholeScreenshot();
+		lastHash = hash;
+
+		// Next capture time (without catching up, when capture and save took longer than the interval)
+		next += g_captureInterval;
+		now = GetTickCount64();
+		if (next < now) next = now;
+	}
+
+	stopSaveQueue(); // Finish pending files
+	freeScreenshot();
+
+	wchar_t szDebug[MAX_PATH];
+	_snwprintf_s(szDebug, MAX_PATH, _TRUNCATE, L"captureByInterval %u captures, %u skipped, %u failed files\n", dwCaptures, dwSkipped, (unsigned int)g_failedSaveJobs);
+	OutputDebugString(szDebug);
+
+	if (g_failedSaveJobs > 0)
+	{
+		_snwprintf_s(szDebug, MAX_PATH, _TRUNCATE, L" (%u/%u)", (unsigned int)g_failedSaveJobs, dwCaptures - dwSkipped);
+		std::wstring sMessage(L"writePNGFile@captureByInterval ");
+		sMessage.append(LoadStringAsWstr(g_hInst, IDS_HASFAILED)).append(szDebug).append(L" ").append(g_screenshotPath);
+		MessageBox(NULL, sMessage.c_str(), LoadStringAsWstr(g_hInst, IDS_APP_TITLE).c_str(), MB_OK | MB_ICONERROR);
+		bResult = FALSE;
+	}
+	return bResult;
+}
+
 /*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
   Function: checkArguments
 
@@ -3435,7 +5234,11 @@ BOOL checkArguments()
 
 	bool bAutoSaveToClipboard = FALSE;
 	bool bAutoSaveToFile = FALSE;
+	std::wstring sReplayFile = L"";
+	DWORD dwCount = 0;
+	DWORD dwDuration = 0;
 	getScreenshotPathFromRegistry();
+	getDWORDSettingFromRegistry(trace);
 
 	for (int i = 0; i < argc; i++)
 	{
@@ -3457,6 +5260,13 @@ BOOL checkArguments()
 			break;
 		}
 		if (_wcsicmp(argv[i], L"/s") == 0) g_onetimeCapture = TRUE; // Enable onetimeCapture mode (Program will exit afterwards automatically)
+		if (_wcsicmp(argv[i], L"/trace") == 0) g_trace = TRUE; // Write Chrome trace-event JSON to TRACEFILE
+		if (_wcsicmp(argv[i], L"/m") == 0) g_bCaptureMonitorOnlyArgument = TRUE; // Capture only the monitor under the mouse cursor
+		if (_wcsnicmp(argv[i], L"/interval=", 10) == 0) g_captureInterval = wcstoul(argv[i] + 10, NULL, 10); // Repeated captures
+		if (_wcsnicmp(argv[i], L"/count=", 7) == 0) dwCount = wcstoul(argv[i] + 7, NULL, 10); // Number of repeated captures
+		if (_wcsnicmp(argv[i], L"/duration=", 10) == 0) dwDuration = wcstoul(argv[i] + 10, NULL, 10); // Seconds of repeated captures
+		if (_wcsnicmp(argv[i], L"/replay=", 8) == 0) sReplayFile.assign(argv[i] + 8); // Capture frames from replay file
+		if (_wcsnicmp(argv[i], L"/record=", 8) == 0) g_sRecordFile.assign(argv[i] + 8); // Append captures to replay file
 		if (_wcsicmp(argv[i], L"/v") == 0)
 		{
 			showProgramInformation(NULL);
@@ -3475,6 +5285,24 @@ BOOL checkArguments()
 
 	if (bExit) return FALSE; // Exit wWinMain afterwards
 
+	if (g_trace) enableTrace(true);
+
+	// Capture source
+	g_captureSource = createGDICaptureSource();
+	if (!sReplayFile.empty() && !loadReplayFile(sReplayFile))
+	{
+		std::wstring sMessage(L"loadReplayFile@checkArguments ");
+		sMessage.append(LoadStringAsWstr(g_hInst, IDS_HASFAILED)).append(L" ").append(sReplayFile);
+		MessageBox(NULL, sMessage.c_str(), LoadStringAsWstr(g_hInst, IDS_APP_TITLE).c_str(), MB_OK | MB_ICONERROR);
+		return FALSE; // Exit wWinMain afterwards
+	}
+
+	if (g_captureInterval > 0)
+	{
+		if (g_captureInterval < MINCAPTUREINTERVAL) g_captureInterval = MINCAPTUREINTERVAL;
+		if (!bAutoSaveToClipboard) bAutoSaveToFile = TRUE; // Files are the default target of repeated captures
+	}
+
 	if (bAutoSaveToClipboard || bAutoSaveToFile)
 	{
 		// Enable only target passed by arguments
@@ -3482,17 +5310,13 @@ BOOL checkArguments()
 		g_saveToClipboard = FALSE;
 		if (bAutoSaveToClipboard) g_saveToClipboard = TRUE;
 		if (bAutoSaveToFile) g_saveToFile = TRUE;
-		CaptureScreen(NULL);
-		if (g_hBitmap == NULL) return FALSE; // Error => Exit wWinMain afterwards
-		BITMAP bm;
-		if (GetObject(g_hBitmap, sizeof(bm), &bm) != 0)
+		if (g_captureInterval > 0) captureByInterval(dwCount, dwDuration);
+		else
 		{
-			g_selection.left = limitXtoBitmap(0);
-			g_selection.top = limitYtoBitmap(0);
-			g_selection.right = limitXtoBitmap(bm.bmWidth - 1);
-			g_selection.bottom = limitYtoBitmap(bm.bmHeight - 1);
-			saveSelection(NULL);
+			if (!CaptureScreen(NULL)) return FALSE; // Error => Exit wWinMain afterwards
+			saveWholeScreenshot();
 		}
+		writeTraceFile();
 		return FALSE; // Finished => Exit wWinMain afterwards
 	}
 	return TRUE; // Keep wWinMain running
@@ -3576,7 +5400,8 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
 		return 1;
 	}
 
-	// Get settings from registry
+	// Get settings from registry and watch for changes
+	if (!g_onetimeCapture) startSettingsNotification();
 	getDWORDSettingFromRegistry(saveToClipboard);
 	getDWORDSettingFromRegistry(saveToFile);
 	checkScreenshotTargets(g_hWindow);
@@ -3599,6 +5424,7 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
 		checkPrintScreenKeyForSnipping(g_hWindow);
 
 		SetHook();
+		updateCaptureHistoryTimer(g_hWindow);
 	}
 
 	// Main message loop:
@@ -3622,6 +5448,25 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
 		}
 	}
 
+	// Stop background build of the edge index
+	stopEdgeIndexBuild();
+
+	// Finish pending screenshot files
+	stopSaveQueue();
+	writeTraceFile();
+
+	// Stop registry change notifications
+	stopSettingsNotification();
+
+	// Free screenshot and capture surfaces
+	freeScreenshot();
+	freeCaptureSurfacePool();
+	clearCaptureHistory(g_captureHistory);
+	if (g_hLowMemoryNotification != NULL) CloseHandle(g_hLowMemoryNotification);
+
+	// Free cached GDI resources for painting
+	freePaintResources();
+
 	// Close semaphore handles
 	if (g_hSemaphoreModalBlocked != NULL) CloseHandle(g_hSemaphoreModalBlocked);
 
@@ -3665,29 +5510,60 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 		if (g_zoomScale <= 1) g_zoomScale = 1;
 		InvalidateRect(hWnd, NULL, TRUE);
 		break;
+	case WM_SETTINGSCHANGED: // Watched registry keys have changed
+		refreshSettingsSnapshot(InterlockedExchange(&g_settingsChangedSources, 0));
+		if (g_appState == stateTrayIcon) updateCaptureHistoryTimer(hWnd);
+		break;
+	case WM_SAVEFINISHED: // Writer thread has finished a screenshot file
+	{
+		SAVEJOB* pJob = (SAVEJOB*)lParam;
+		if (pJob == NULL) break;
+
+		if (pJob->dwError == ERROR_SUCCESS)
+		{
+			g_sLastScreenshotFile = pJob->sFullPath;
+
+			SAVEQUEUESTATISTICS saveQueue = getSaveQueueStatistics();
+			wchar_t szLatency[MAX_PATH];
+			_snwprintf_s(szLatency, MAX_PATH, _TRUNCATE, L"Saved %s in %.0f ms (waiting %.0f ms, queue %d)\n",
+				pJob->sFileName.c_str(), saveQueue.lastLatency, saveQueue.lastWaitTime, saveQueue.depth);
+			OutputDebugString(szLatency);
+
+			freeSaveJob(pJob);
+		}
+		else if (!showSaveError(pJob->sFullPath, pJob->dwError, pJob->bFileError)) freeSaveJob(pJob);
+		else if (!enqueueSaveJobForScreenshotPath(pJob)) // Retry in new folder, synchronously when the save queue is full
+		{
+			saveImageAsPNG(pJob->image, pJob->sFileName.c_str());
+			freeSaveJob(pJob);
+		}
+		break;
+	}
 	case WM_SELECTALL: // Select area over all monitors
 	{
-		if (g_hBitmap == NULL) break;
-		BITMAP bm;
-		if (GetObject(g_hBitmap, sizeof(bm), &bm) != 0)
+		if (isImageValid(g_screenshot))
 		{
 			g_appState = statePointB;
 			g_selection.left = limitXtoBitmap(0);
 			g_selection.top = limitYtoBitmap(0);
-			g_selection.right = limitXtoBitmap(bm.bmWidth - 1);
-			g_selection.bottom = limitYtoBitmap(bm.bmHeight - 1);
+			g_selection.right = limitXtoBitmap(g_screenshot.width - 1);
+			g_selection.bottom = limitYtoBitmap(g_screenshot.height - 1);
 			InvalidateRect(hWnd, NULL, TRUE);
 			// Do not SetCursorPos, because this can make trouble on multimonitor systems with different resolutions
 		}
 		break;
 	}
-	case WM_STARTED: // Start new capture
+	case WM_STARTED: // Start new capture (wParam TRUE = reopen last capture)
 	{
 		// Skip capture, when a modal dialog is running
-		if (WaitForSingleObject(g_hSemaphoreModalBlocked, 0) != WAIT_OBJECT_0) break;
+		if (WaitForSingleObject(g_hSemaphoreModalBlocked, 0) != WAIT_OBJECT_0)
+		{
+			resetLatencyStages();
+			break;
+		}
 		ReleaseSemaphore(g_hSemaphoreModalBlocked, 1, NULL);
 
-		startCaptureGUI(hWnd);
+		startCaptureGUI(hWnd, (BOOL)wParam);
 		break;
 	}
 	case WM_GOTOTRAY: // Hide window and goto tray icon
@@ -3698,6 +5574,12 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 		ShowCursor(true);
 		ShowWindow(hWnd, SW_HIDE);
 		g_appState = stateTrayIcon;
+		resetPaintedOverlay();
+		freePaintResources(); // Output buffer is not needed until the next capture
+		// Screenshot is not needed until the next capture (pending files have their own copy)
+		if (wParam == 0) releaseScreenshotInTray(hWnd); // wParam != 0 => Caller saves the selection first and releases afterwards
+		updateCaptureHistoryTimer(hWnd);
+		writeTraceFile();
 		SetActiveWindow(g_activeWindow);
 		break;
 	}
@@ -3727,8 +5609,9 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 			{
 				if ((g_selection.left != g_selection.right) && (g_selection.top != g_selection.bottom))
 				{
-					SendMessage(hWnd, WM_GOTOTRAY, 0, 0);
+					SendMessage(hWnd, WM_GOTOTRAY, TRUE, 0); // Keep screenshot for saveSelection
 					saveSelection(hWnd);
+					releaseScreenshotInTray(hWnd);
 				}
 			}
 		}
@@ -3747,6 +5630,7 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 			ReleaseSemaphore(g_hSemaphoreModalBlocked, 1, NULL);
 
 			// Update some vars from registry
+			updateSettingsSnapshot();
 			getDWORDSettingFromRegistry(saveToFile);
 			getDWORDSettingFromRegistry(saveToClipboard);
 			getDWORDSettingFromRegistry(screenshotDelay);
@@ -3759,6 +5643,7 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 			wchar_t szMenuEntry[MAX_PATH] = L"";
 			_snwprintf_s(szMenuEntry, MAX_PATH, _TRUNCATE, LoadStringAsWstr(g_hInst, IDS_SCREENSHOTDELAYED).c_str(), g_screenshotDelay);
 			AppendMenu(hMenu, MF_STRING, IDM_CAPTURE, szMenuEntry);
+			if (isLastCaptureAvailable()) AppendMenu(hMenu, MF_STRING, IDM_REOPENLAST, LoadStringAsWstr(g_hInst, IDS_REOPENLAST).c_str());
 			if (!g_sLastScreenshotFile.empty() && PathFileExists(g_sLastScreenshotFile.c_str()) ) {
 				AppendMenu(hMenu, MF_STRING, IDM_OPENLAST, LoadStringAsWstr(g_hInst, IDS_OPENLAST).c_str());
 				if (IsWindows11_24H2OrNewer()) AppendMenu(hMenu, MF_STRING, IDM_EDITLAST, LoadStringAsWstr(g_hInst, IDS_EDITLAST).c_str());
@@ -3929,6 +5814,12 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 		case '-': // Decrease selection
 			resizeSelection(hWnd, -1);
 			break;
+		case ',': // Earlier frame of the capture history
+			showCaptureHistoryFrame(hWnd, -1);
+			break;
+		case '.': // Later frame of the capture history
+			showCaptureHistoryFrame(hWnd, 1);
+			break;
 		}
 		break;
 	case WM_ERASEBKGND: // Skip WM_ERASEBKGND (and prevents flickering), because we fill the hole client area every WM_PAINT
@@ -3970,17 +5861,27 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 				RECT rectWindow = { 0 };
 				GetWindowRect(hWnd, &rectWindow);
 				// Reapply fullscreen, if window position/size is not correct
-				if ((rectWindow.left != GetSystemMetrics(SM_XVIRTUALSCREEN)) ||
-					(rectWindow.top != GetSystemMetrics(SM_YVIRTUALSCREEN)) ||
-					(abs(rectWindow.left - rectWindow.left) != GetSystemMetrics(SM_CXVIRTUALSCREEN)) || 
-					(abs(rectWindow.bottom - rectWindow.top) != GetSystemMetrics(SM_CYVIRTUALSCREEN))) 
+				if ((rectWindow.left != g_captureRect.left) ||
+					(rectWindow.top != g_captureRect.top) ||
+					(rectWindow.right != g_captureRect.right) ||
+					(rectWindow.bottom != g_captureRect.bottom))
 				{
 					enterFullScreen(hWnd);
 				}
 
-				InvalidateRect(hWnd, NULL, TRUE);
+				invalidateOverlay(hWnd); // Blinking labels and internal information
 				break;
 			}
+		case IDT_TIMERSURFACEPOOL: // Release surface pool, when the program is idle in the tray or memory is low
+			if (g_surfacePool.empty() || isLowMemory() || (GetTickCount64() - g_surfacePoolReleaseTime >= SURFACEPOOLIDLETIME * 1000ULL))
+			{
+				KillTimer(hWnd, IDT_TIMERSURFACEPOOL);
+				freeCaptureSurfacePool();
+			}
+			break;
+		case IDT_TIMERCAPTUREHISTORY: // Background capture for the capture history
+			captureHistoryFrame();
+			break;
 		case IDT_TIMERSCREENSHOTDELAYED: // Onetime 5s timer
 			KillTimer(hWnd, IDT_TIMERSCREENSHOTDELAYED); // Only one time
 			SendMessage(hWnd, WM_STARTED, 0, 0);
@@ -3996,6 +5897,9 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 					ReleaseSemaphore(g_hSemaphoreModalBlocked, 1, NULL);
 				}
 				break;
+			case IDM_REOPENLAST:
+				SendMessage(hWnd, WM_STARTED, TRUE, 0);
+				break;
 			case IDM_EXIT:
 				PostQuitMessage(0);
 				break;
@@ -4062,6 +5966,7 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 			case IDM_ALTERNATIVECOLORS: // Toggle colors
 				g_useAlternativeColors = !g_useAlternativeColors;
 				storeDWORDSettingInRegistry(useAlternativeColors, g_useAlternativeColors);
+				freePaintResources();
 				InvalidateRect(hWnd, NULL, TRUE);
 				break;
 			case IDM_DISPLAYINFORMATION: // Toggle display information
@@ -4084,6 +5989,9 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 	case WM_DISPLAYCHANGE:
 		// Goto tray icon, when display changed, to prevent problems when connecting/disconnecting monitors
 		if (g_appState != stateTrayIcon) SendMessage(hWnd, WM_GOTOTRAY, 0, 0);
+		freePaintResources();
+		freeCaptureSurfacePool(); // Surfaces have the size of the old virtual screen
+		clearCaptureHistory(g_captureHistory); // Frames have the old monitor layout
 		break;
 	default:
 		if ((WM_TASKBARCREATED != 0) && (message == WM_TASKBARCREATED)) // Recreate tray icon if explorer was restarted
@@ -0,0 +1,344 @@
+/*+===================================================================
+  File:      captureHistory.cpp
+
+  Summary:   Rolling history of background captures. A new frame is compared
+             tile by tile with the previous frame. Only the changed tiles are
+             stored (delta), unless a keyframe is needed, because the layout
+             has changed, most tiles have changed or CAPTUREHISTORYMAXDELTAS
+             deltas follow the last keyframe. A keyframe with its deltas is
+             removed as a whole, when it is older than maxAge or the memory
+             budget is exceeded.
+
+             Has no dependencies to the Win32-API and can be compiled on other
+             platforms to test and benchmark the history with replayed frames.
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "captureHistory.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <utility>
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: isSameLayout
+
+  Summary:   Compares the virtual screen and the monitors of two layouts
+
+  Args:     const CAPTURELAYOUT &first
+            const CAPTURELAYOUT &second
+
+  Returns:  bool
+
+-----------------------------------------------------------------F-F*/
+static bool isSameLayout(const CAPTURELAYOUT& first, const CAPTURELAYOUT& second)
+{
+	if (memcmp(&first.bounds, &second.bounds, sizeof(CAPTURERECT)) != 0) return false;
+	if (first.monitors.size() != second.monitors.size()) return false;
+	return first.monitors.empty() || (memcmp(first.monitors.data(), second.monitors.data(), first.monitors.size() * sizeof(CAPTURERECT)) == 0);
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: findChangedTiles
+
+  Summary:   Finds the tiles, which differ between two images of the same
+             size. Each row is compared only for tiles, which are not
+             already known as changed.
+
+  Args:     const IMAGEBUFFER &image
+              New image
+            const IMAGEBUFFER &previous
+              Previous image
+            std::vector<std::pair<int, int>> &tiles
+              Upper left corner of the changed tiles (call by ref)
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+static void findChangedTiles(const IMAGEBUFFER& image, const IMAGEBUFFER& previous, std::vector<std::pair<int, int>>& tiles)
+{
+	int columns = (image.width + CAPTUREHISTORYTILESIZE - 1) / CAPTUREHISTORYTILESIZE;
+	std::vector<char> changed(columns);
+
+	tiles.clear();
+	for (int top = 0; top < image.height; top += CAPTUREHISTORYTILESIZE)
+	{
+		int bottom = (top + CAPTUREHISTORYTILESIZE < image.height) ? top + CAPTUREHISTORYTILESIZE : image.height;
+		std::fill(changed.begin(), changed.end(), 0);
+		for (int y = top; y < bottom; y++)
+		{
+			const IMAGEPIXEL* pRow = imageRow(image, y);
+			const IMAGEPIXEL* pPreviousRow = imageRow(previous, y);
+			for (int column = 0; column < columns; column++)
+			{
+				if (changed[column]) continue;
+				int left = column * CAPTUREHISTORYTILESIZE;
+				int width = (left + CAPTUREHISTORYTILESIZE < image.width) ? CAPTUREHISTORYTILESIZE : image.width - left;
+				if (memcmp(pRow + left, pPreviousRow + left, (size_t)width * IMAGEBYTESPERPIXEL) != 0) changed[column] = 1;
+			}
+		}
+		for (int column = 0; column < columns; column++)
+		{
+			if (changed[column]) tiles.push_back({ column * CAPTUREHISTORYTILESIZE, top });
+		}
+	}
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getTileView
+
+  Summary:   Gets the view to a tile (tiles at the right and bottom edge can
+             be smaller than CAPTUREHISTORYTILESIZE)
+
+  Args:     const IMAGEBUFFER &image
+            int x, int y
+              Upper left corner of the tile
+            IMAGEBUFFER &view
+              View to the tile (call by ref)
+
+  Returns:  bool
+              true = success
+              false = tile is outside of the image
+
+-----------------------------------------------------------------F-F*/
+static bool getTileView(const IMAGEBUFFER& image, int x, int y, IMAGEBUFFER& view)
+{
+	return getImageView(image, x, y, CAPTUREHISTORYTILESIZE, CAPTUREHISTORYTILESIZE, view);
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: removeOldestKeyframe
+
+  Summary:   Removes the oldest keyframe with its deltas
+
+  Args:     CAPTUREHISTORY &history
+              History (call by ref)
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+static void removeOldestKeyframe(CAPTUREHISTORY& history)
+{
+	do {
+		history.bytes -= history.frames.front().bytes;
+		history.frames.pop_front();
+	} while (!history.frames.empty() && !history.frames.front().bKeyframe);
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: trimCaptureHistory
+
+  Summary:   Removes keyframes with their deltas, which were replaced by a
+             later keyframe before maxAge or which exceed the memory budget.
+             The newest keyframe is kept, as long as it fits in the budget.
+             When its deltas exceed the budget, the next frame is a keyframe
+             and the older frames are removed then.
+
+  Args:     CAPTUREHISTORY &history
+              History (call by ref)
+            int64_t time
+              Current time in milliseconds
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+static void trimCaptureHistory(CAPTUREHISTORY& history, int64_t time)
+{
+	while (!history.frames.empty())
+	{
+		// Start of the next keyframe
+		size_t next = 1;
+		while ((next < history.frames.size()) && !history.frames[next].bKeyframe) next++;
+
+		if (next < history.frames.size())
+		{
+			if ((history.frames[next].time < time - history.maxAge) || (history.bytes > history.maxBytes)) removeOldestKeyframe(history);
+			else break;
+		}
+		else
+		{
+			if ((history.bytes > history.maxBytes) && (history.frames.size() == 1)) clearCaptureHistory(history); // Newest keyframe alone exceeds the budget
+			break;
+		}
+	}
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getFrameBytes
+
+  Summary:   Gets the memory used by a frame
+
+  Args:     const CAPTUREHISTORYFRAME &frame
+
+  Returns:  size_t
+              Bytes
+
+-----------------------------------------------------------------F-F*/
+static size_t getFrameBytes(const CAPTUREHISTORYFRAME& frame)
+{
+	size_t bytes = sizeof(CAPTUREHISTORYFRAME) + frame.layout.monitors.capacity() * sizeof(CAPTURERECT);
+	bytes += getRLEImageBytes(frame.keyframe) + frame.tiles.capacity() * sizeof(CAPTUREHISTORYTILE);
+	for (const CAPTUREHISTORYTILE& tile : frame.tiles) bytes += getRLEImageBytes(tile.image);
+	return bytes;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: addCaptureHistoryFrame
+
+  Summary:   Adds a frame to the history and removes old frames. A frame
+             equal to the previous frame is not stored.
+
+  Args:     CAPTUREHISTORY &history
+              History (call by ref)
+            const IMAGEBUFFER &image
+              Frame
+            const CAPTURELAYOUT &layout
+              Layout of the frame
+            int64_t time
+              Capture time in milliseconds
+
+  Returns:  bool
+              true = success (frame is stored or equal to the previous frame)
+              false = failure (invalid frame, out of memory or frame exceeds the memory budget)
+
+-----------------------------------------------------------------F-F*/
+bool addCaptureHistoryFrame(CAPTUREHISTORY& history, const IMAGEBUFFER& image, const CAPTURELAYOUT& layout, int64_t time)
+{
+	if (!isImageValid(image)) return false;
+
+	try {
+		CAPTUREHISTORYFRAME frame;
+		std::vector<std::pair<int, int>> changedTiles;
+		bool bKeyframe = history.frames.empty() || !isSameLayout(history.frames.back().layout, layout) ||
+			(history.lastFrame.width != image.width) || (history.lastFrame.height != image.height);
+
+		if (!bKeyframe)
+		{
+			findChangedTiles(image, history.lastFrame, changedTiles);
+			if (changedTiles.empty()) return true; // Equal to the previous frame
+
+			size_t deltas = 0;
+			for (size_t i = history.frames.size(); (i > 0) && !history.frames[i - 1].bKeyframe; i--) deltas++;
+			size_t columns = (image.width + CAPTUREHISTORYTILESIZE - 1) / CAPTUREHISTORYTILESIZE;
+			size_t rows = (image.height + CAPTUREHISTORYTILESIZE - 1) / CAPTUREHISTORYTILESIZE;
+
+			bKeyframe = (deltas >= CAPTUREHISTORYMAXDELTAS) || // Restore time is limited
+				(changedTiles.size() * 2 > columns * rows) || // Most of the frame has changed
+				(history.bytes > history.maxBytes); // Older keyframes can only be removed, when a new keyframe exists
+		}
+
+		frame.time = time;
+		frame.layout = layout;
+		frame.bKeyframe = bKeyframe;
+		if (bKeyframe)
+		{
+			if (!compressImageRLE(image, frame.keyframe)) return false;
+		}
+		else
+		{
+			frame.tiles.resize(changedTiles.size());
+			for (size_t i = 0; i < changedTiles.size(); i++)
+			{
+				IMAGEBUFFER tile;
+				CAPTUREHISTORYTILE& target = frame.tiles[i];
+				target.x = changedTiles[i].first;
+				target.y = changedTiles[i].second;
+				if (!getTileView(image, target.x, target.y, tile) || !compressImageRLE(tile, target.image)) return false;
+			}
+		}
+		frame.bytes = getFrameBytes(frame);
+
+		// Copy of the frame for the next comparison
+		if ((history.lastFrame.width != image.width) || (history.lastFrame.height != image.height))
+		{
+			history.bytes -= (size_t)history.lastFrame.width * history.lastFrame.height * IMAGEBYTESPERPIXEL;
+			freeImageBuffer(history.lastFrame);
+			if (!createImageBuffer(history.lastFrame, image.width, image.height))
+			{
+				clearCaptureHistory(history);
+				return false;
+			}
+			history.bytes += (size_t)image.width * image.height * IMAGEBYTESPERPIXEL;
+		}
+		if (bKeyframe) copyImage(history.lastFrame, image);
+		else
+		{
+			for (const CAPTUREHISTORYTILE& tile : frame.tiles)
+			{
+				IMAGEBUFFER source, target;
+				if (getTileView(image, tile.x, tile.y, source) && getTileView(history.lastFrame, tile.x, tile.y, target)) copyImage(target, source);
+			}
+		}
+
+		history.bytes += frame.bytes;
+		history.frames.push_back(std::move(frame));
+	}
+	catch (const std::bad_alloc&) {
+		clearCaptureHistory(history);
+		return false;
+	}
+
+	trimCaptureHistory(history, time);
+	return !history.frames.empty();
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: restoreCaptureHistoryFrame
+
+  Summary:   Restores a frame of the history from its keyframe and the
+             following deltas
+
+  Args:     const CAPTUREHISTORY &history
+              History
+            size_t index
+              Index of the frame in history.frames
+            const IMAGEBUFFER &image
+              Target image or view with the size of the frame
+
+  Returns:  bool
+              true = success
+              false = failure (invalid index, size mismatch or corrupt data)
+
+-----------------------------------------------------------------F-F*/
+bool restoreCaptureHistoryFrame(const CAPTUREHISTORY& history, size_t index, const IMAGEBUFFER& image)
+{
+	if (index >= history.frames.size()) return false;
+
+	size_t keyframe = index;
+	while ((keyframe > 0) && !history.frames[keyframe].bKeyframe) keyframe--;
+	if (!history.frames[keyframe].bKeyframe) return false;
+
+	if (!decompressImageRLE(history.frames[keyframe].keyframe, image)) return false;
+	for (size_t i = keyframe + 1; i <= index; i++)
+	{
+		for (const CAPTUREHISTORYTILE& tile : history.frames[i].tiles)
+		{
+			IMAGEBUFFER target;
+			if (!getImageView(image, tile.x, tile.y, tile.image.width, tile.image.height, target)) return false;
+			if (!decompressImageRLE(tile.image, target)) return false;
+		}
+	}
+	return true;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: clearCaptureHistory
+
+  Summary:   Removes all frames and frees the memory of the history (the
+             limits are kept)
+
+  Args:     CAPTUREHISTORY &history
+              History (call by ref)
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void clearCaptureHistory(CAPTUREHISTORY& history)
+{
+	std::deque<CAPTUREHISTORYFRAME>().swap(history.frames);
+	freeImageBuffer(history.lastFrame);
+	history.bytes = 0;
+}
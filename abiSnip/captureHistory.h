@@ -0,0 +1,55 @@
+/*+===================================================================
+  File:      captureHistory.h
+
+  Summary:   Rolling history of background captures, so a screenshot of a few
+             seconds ago can be selected (for example of a tooltip or menu,
+             which has already disappeared). Frames are stored as run-length
+             encoded keyframes followed by deltas of the changed tiles.
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#pragma once
+
+#include "captureSource.h"
+#include "imageBuffer.h"
+#include "imageRLE.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#define CAPTUREHISTORYTILESIZE 64 // Width and height in pixels of the tiles, which are compared and stored for a delta
+#define CAPTUREHISTORYMAXDELTAS 30 // Max delta frames after a keyframe (limits the time to restore a frame)
+
+// Changed tile of a delta frame
+struct CAPTUREHISTORYTILE {
+	int x; // Left in pixels
+	int y; // Top in pixels
+	RLEIMAGE image; // Run-length encoded pixels of the tile
+};
+
+// Frame of the history
+struct CAPTUREHISTORYFRAME {
+	int64_t time = 0; // Capture time in milliseconds (clock of the caller)
+	CAPTURELAYOUT layout; // Layout of the frame
+	bool bKeyframe = false; // true = keyframe has all pixels, false = tiles changed since the previous frame
+	RLEIMAGE keyframe; // Run-length encoded pixels of a keyframe
+	std::vector<CAPTUREHISTORYTILE> tiles; // Changed tiles of a delta frame
+	size_t bytes = 0; // Memory used by the frame
+};
+
+// History of frames. Frames equal to the previous frame are not stored.
+struct CAPTUREHISTORY {
+	std::deque<CAPTUREHISTORYFRAME> frames; // Frames, oldest first (the first frame is always a keyframe)
+	IMAGEBUFFER lastFrame = { 0 }; // Copy of the newest frame to find the changed tiles of the next frame
+	size_t bytes = 0; // Memory used by frames and lastFrame
+	size_t maxBytes = 0; // Memory budget for frames and lastFrame
+	int64_t maxAge = 0; // Milliseconds, after which a replaced frame is removed
+};
+
+bool addCaptureHistoryFrame(CAPTUREHISTORY& history, const IMAGEBUFFER& image, const CAPTURELAYOUT& layout, int64_t time);
+bool restoreCaptureHistoryFrame(const CAPTUREHISTORY& history, size_t index, const IMAGEBUFFER& image);
+void clearCaptureHistory(CAPTUREHISTORY& history);
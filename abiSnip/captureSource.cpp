@@ -0,0 +1,345 @@
+/*+===================================================================
+  File:      captureSource.cpp
+
+  Summary:   Replay files and the replay capture source. A replay file is a
+             sequence of frames. Each frame has the following little endian
+             32 bit fields:
+               magic (CAPTUREFRAMEMAGIC), version (CAPTUREFRAMEVERSION),
+               left, top, width, height of the virtual screen,
+               number of monitors, left, top, right, bottom per monitor,
+               flags (CAPTUREFRAMERAW, not in version 1),
+               number of RLE values, RLE values (see imageRLE.h)
+
+             Has no dependencies to the Win32-API and can be compiled on other
+             platforms to run the capture pipeline without a desktop.
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "captureSource.h"
+#include <algorithm>
+#include <new>
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: writeUInt32
+
+  Summary:   Writes a 32 bit value in little endian byte order
+
+  Args:     const CAPTUREWRITEFUNCTION &write
+              Output function
+            uint32_t value
+
+  Returns:  bool
+              true = success
+              false = write error
+
+-----------------------------------------------------------------F-F*/
+static bool writeUInt32(const CAPTUREWRITEFUNCTION& write, uint32_t value)
+{
+	uint8_t data[4] = { (uint8_t)value, (uint8_t)(value >> 8), (uint8_t)(value >> 16), (uint8_t)(value >> 24) };
+	return write(data, sizeof(data));
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: readUInt32
+
+  Summary:   Reads a 32 bit value in little endian byte order
+
+  Args:     const CAPTUREREADFUNCTION &read
+              Input function
+            uint32_t &value
+              Value (call by ref)
+
+  Returns:  bool
+              true = success
+              false = read error or end of file
+
+-----------------------------------------------------------------F-F*/
+static bool readUInt32(const CAPTUREREADFUNCTION& read, uint32_t& value)
+{
+	uint8_t data[4];
+	if (!read(data, sizeof(data))) return false;
+	value = (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+	return true;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: isCaptureLayoutValid
+
+  Summary:   Checks size of the virtual screen and the monitors of a layout
+
+  Args:     const CAPTURELAYOUT &layout
+
+  Returns:  bool
+
+-----------------------------------------------------------------F-F*/
+bool isCaptureLayoutValid(const CAPTURELAYOUT& layout)
+{
+	const CAPTURERECT& bounds = layout.bounds;
+	if ((bounds.right <= bounds.left) || (bounds.bottom <= bounds.top)) return false;
+	if (((int64_t)bounds.right - bounds.left > CAPTUREMAXSIZE) || ((int64_t)bounds.bottom - bounds.top > CAPTUREMAXSIZE)) return false;
+	if (layout.monitors.size() > CAPTUREMAXMONITORS) return false;
+	for (const CAPTURERECT& monitor : layout.monitors)
+	{
+		if ((monitor.right <= monitor.left) || (monitor.bottom <= monitor.top)) return false;
+	}
+	return true;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: fillCaptureGaps
+
+  Summary:   Fills the areas of a frame, which are not covered by a monitor
+             (for example below a smaller monitor next to a larger one). The
+             frame is split into horizontal bands at the upper and lower
+             monitor edges and the uncovered parts of each band are filled.
+
+  Args:     const IMAGEBUFFER &image
+              Frame with the size of the virtual screen of the layout
+            const CAPTURELAYOUT &layout
+              Layout of the frame
+            IMAGEPIXEL color
+              Color for the gaps
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void fillCaptureGaps(const IMAGEBUFFER& image, const CAPTURELAYOUT& layout, IMAGEPIXEL color)
+{
+	if (!isImageValid(image)) return;
+
+	try {
+		// Band edges in frame coordinates
+		std::vector<int> edges = { 0, image.height };
+		for (const CAPTURERECT& monitor : layout.monitors)
+		{
+			edges.push_back(std::min(std::max(monitor.top - layout.bounds.top, 0), image.height));
+			edges.push_back(std::min(std::max(monitor.bottom - layout.bounds.top, 0), image.height));
+		}
+		std::sort(edges.begin(), edges.end());
+		edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+		std::vector<std::pair<int, int>> covered; // Horizontal parts of a band covered by monitors (start, end)
+		for (size_t band = 0; band + 1 < edges.size(); band++)
+		{
+			int top = edges[band];
+			int bottom = edges[band + 1];
+
+			covered.clear();
+			for (const CAPTURERECT& monitor : layout.monitors)
+			{
+				if ((monitor.top - layout.bounds.top > top) || (monitor.bottom - layout.bounds.top < bottom)) continue; // Not in this band
+				int left = std::max(monitor.left - layout.bounds.left, 0);
+				int right = std::min(monitor.right - layout.bounds.left, image.width);
+				if (right > left) covered.push_back({ left, right });
+			}
+			std::sort(covered.begin(), covered.end());
+
+			IMAGEBUFFER gap;
+			int x = 0;
+			for (const std::pair<int, int>& part : covered)
+			{
+				if ((part.first > x) && getImageView(image, x, top, part.first - x, bottom - top, gap)) fillImage(gap, color);
+				x = std::max(x, part.second);
+			}
+			if ((x < image.width) && getImageView(image, x, top, image.width - x, bottom - top, gap)) fillImage(gap, color);
+		}
+	}
+	catch (const std::bad_alloc&) { // Out of memory, fill the whole frame
+		fillImage(image, color);
+	}
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: selectCaptureMonitor
+
+  Summary:   Reduces a layout to one monitor, so only this monitor is
+             captured. The monitor contains the point or, when the point is
+             outside of all monitors, is the nearest monitor.
+
+  Args:     CAPTURELAYOUT &layout
+              Layout of the virtual screen (call by ref)
+            int x
+              Point in virtual screen coordinates, for example the cursor
+            int y
+
+  Returns:  bool
+              true = success
+              false = layout has no monitors (layout is unchanged)
+
+-----------------------------------------------------------------F-F*/
+bool selectCaptureMonitor(CAPTURELAYOUT& layout, int x, int y)
+{
+	if (layout.monitors.empty()) return false;
+
+	size_t selected = 0;
+	int64_t selectedDistance = INT64_MAX;
+	for (size_t i = 0; i < layout.monitors.size(); i++)
+	{
+		const CAPTURERECT& monitor = layout.monitors[i];
+		// Squared distance from the point to the monitor (0 = point is on the monitor)
+		int64_t dx = (x < monitor.left) ? (int64_t)monitor.left - x : ((x >= monitor.right) ? (int64_t)x - monitor.right + 1 : 0);
+		int64_t dy = (y < monitor.top) ? (int64_t)monitor.top - y : ((y >= monitor.bottom) ? (int64_t)y - monitor.bottom + 1 : 0);
+		int64_t distance = dx * dx + dy * dy;
+		if (distance < selectedDistance)
+		{
+			selected = i;
+			selectedDistance = distance;
+		}
+	}
+
+	CAPTURERECT monitor = layout.monitors[selected];
+	layout.bounds = monitor;
+	layout.monitors.assign(1, monitor);
+	return true;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: writeCaptureFrame
+
+  Summary:   Appends a frame to a replay file
+
+  Args:     const IMAGEBUFFER &image
+              Frame with the size of the virtual screen of the layout
+            const CAPTURELAYOUT &layout
+              Layout of the frame
+            const CAPTUREWRITEFUNCTION &write
+              Output function
+
+  Returns:  bool
+              true = success
+              false = invalid frame, out of memory or write error
+
+-----------------------------------------------------------------F-F*/
+bool writeCaptureFrame(const IMAGEBUFFER& image, const CAPTURELAYOUT& layout, const CAPTUREWRITEFUNCTION& write)
+{
+	if (!isCaptureLayoutValid(layout)) return false;
+	if ((image.width != layout.bounds.right - layout.bounds.left) || (image.height != layout.bounds.bottom - layout.bounds.top)) return false;
+
+	RLEIMAGE rle;
+	if (!compressImageRLE(image, rle)) return false;
+
+	if (!writeUInt32(write, CAPTUREFRAMEMAGIC)) return false;
+	if (!writeUInt32(write, CAPTUREFRAMEVERSION)) return false;
+	if (!writeUInt32(write, (uint32_t)layout.bounds.left)) return false;
+	if (!writeUInt32(write, (uint32_t)layout.bounds.top)) return false;
+	if (!writeUInt32(write, (uint32_t)image.width)) return false;
+	if (!writeUInt32(write, (uint32_t)image.height)) return false;
+	if (!writeUInt32(write, (uint32_t)layout.monitors.size())) return false;
+	for (const CAPTURERECT& monitor : layout.monitors)
+	{
+		if (!writeUInt32(write, (uint32_t)monitor.left)) return false;
+		if (!writeUInt32(write, (uint32_t)monitor.top)) return false;
+		if (!writeUInt32(write, (uint32_t)monitor.right)) return false;
+		if (!writeUInt32(write, (uint32_t)monitor.bottom)) return false;
+	}
+	if (!writeUInt32(write, rle.raw ? CAPTUREFRAMERAW : 0)) return false;
+	if (!writeUInt32(write, (uint32_t)rle.data.size())) return false;
+	for (uint32_t value : rle.data)
+	{
+		if (!writeUInt32(write, value)) return false;
+	}
+	return true;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: loadCaptureReplay
+
+  Summary:   Loads all frames of a replay file
+
+  Args:     const CAPTUREREADFUNCTION &read
+              Input function
+            CAPTUREREPLAY &replay
+              Frames (call by ref)
+
+  Returns:  bool
+              true = success (at least one frame)
+              false = no frames, invalid data or out of memory (replay is empty)
+
+-----------------------------------------------------------------F-F*/
+bool loadCaptureReplay(const CAPTUREREADFUNCTION& read, CAPTUREREPLAY& replay)
+{
+	replay.frames.clear();
+	replay.nextFrame = 0;
+
+	try {
+		uint32_t magic;
+		while (readUInt32(read, magic)) // Until end of file
+		{
+			uint32_t version, left, top, width, height, monitors, values, flags = 0;
+			if (magic != CAPTUREFRAMEMAGIC) goto FAIL;
+			if (!readUInt32(read, version) || (version == 0) || (version > CAPTUREFRAMEVERSION)) goto FAIL;
+			if (!readUInt32(read, left) || !readUInt32(read, top) || !readUInt32(read, width) || !readUInt32(read, height)) goto FAIL;
+			if ((width == 0) || (width > CAPTUREMAXSIZE) || (height == 0) || (height > CAPTUREMAXSIZE)) goto FAIL;
+			if (!readUInt32(read, monitors) || (monitors > CAPTUREMAXMONITORS)) goto FAIL;
+
+			// Frame must stay in the virtual screen coordinates (int)
+			int64_t right = (int64_t)(int32_t)left + width;
+			int64_t bottom = (int64_t)(int32_t)top + height;
+			if ((right > INT32_MAX) || (bottom > INT32_MAX)) goto FAIL;
+
+			CAPTURERECORDEDFRAME frame;
+			frame.layout.bounds = { (int32_t)left, (int32_t)top, (int)right, (int)bottom };
+			for (uint32_t i = 0; i < monitors; i++)
+			{
+				uint32_t monitor[4];
+				for (int j = 0; j < 4; j++) if (!readUInt32(read, monitor[j])) goto FAIL;
+				CAPTURERECT rect = { (int32_t)monitor[0], (int32_t)monitor[1], (int32_t)monitor[2], (int32_t)monitor[3] };
+				if ((rect.left < frame.layout.bounds.left) || (rect.top < frame.layout.bounds.top) ||
+					(rect.right > frame.layout.bounds.right) || (rect.bottom > frame.layout.bounds.bottom)) goto FAIL; // Monitor outside of the frame
+				frame.layout.monitors.push_back(rect);
+			}
+			if (!isCaptureLayoutValid(frame.layout)) goto FAIL;
+			if ((version >= 2) && (!readUInt32(read, flags) || (flags & ~CAPTUREFRAMERAW))) goto FAIL;
+			frame.image.raw = (flags & CAPTUREFRAMERAW) != 0;
+
+			// Every pixel needs at least a half RLE value, so larger counts are corrupt
+			if (!readUInt32(read, values) || ((uint64_t)values > 2ULL * width * height)) goto FAIL;
+			if (frame.image.raw && ((uint64_t)values != (uint64_t)width * height)) goto FAIL;
+			frame.image.data.resize(values);
+			for (uint32_t i = 0; i < values; i++) if (!readUInt32(read, frame.image.data[i])) goto FAIL;
+			frame.image.width = (int)width;
+			frame.image.height = (int)height;
+
+			replay.frames.push_back(std::move(frame));
+		}
+	}
+	catch (const std::bad_alloc&) {
+		goto FAIL;
+	}
+	return !replay.frames.empty();
+FAIL:
+	replay.frames.clear();
+	return false;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: createReplayCaptureSource
+
+  Summary:   Creates a capture source, which delivers the frames of a replay
+             file in order and starts again after the last frame
+
+  Args:     const std::shared_ptr<CAPTUREREPLAY> &pReplay
+              Loaded frames (shared with the capture source)
+
+  Returns:  CAPTURESOURCE
+
+-----------------------------------------------------------------F-F*/
+CAPTURESOURCE createReplayCaptureSource(const std::shared_ptr<CAPTUREREPLAY>& pReplay)
+{
+	CAPTURESOURCE source;
+	source.name = "Replay";
+	source.capture = [pReplay](const CAPTUREALLOCATEFUNCTION& allocate, IMAGEBUFFER& image, CAPTURELAYOUT& layout) {
+		if (!pReplay || pReplay->frames.empty()) return false;
+		const CAPTURERECORDEDFRAME& frame = pReplay->frames[pReplay->nextFrame % pReplay->frames.size()];
+		pReplay->nextFrame = (pReplay->nextFrame + 1) % pReplay->frames.size();
+
+		if (!allocate(frame.image.width, frame.image.height, image)) return false;
+		if (!decompressImageRLE(frame.image, image)) return false;
+		layout = frame.layout;
+		return true;
+	};
+	return source;
+}
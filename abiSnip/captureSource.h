@@ -0,0 +1,77 @@
+/*+===================================================================
+  File:      captureSource.h
+
+  Summary:   Capture sources, which deliver a frame of the virtual screen
+             together with its monitor layout. The GDI source for the
+             desktop is in abiSnip.cpp, the replay source in this module
+             delivers frames recorded in a file, so the selection, crop and
+             encode path can run without a desktop.
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#pragma once
+
+#include "imageBuffer.h"
+#include "imageRLE.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#define CAPTUREFRAMEMAGIC 0x46534241u // "ABSF" at the start of each frame in a replay file
+#define CAPTUREFRAMEVERSION 2 // Version of the frame format (version 1 has no flags)
+#define CAPTUREFRAMERAW 0x1u // Flag for uncompressed pixels (see RLEIMAGE.raw)
+#define CAPTUREMAXMONITORS 64 // Max monitors per frame in a replay file
+#define CAPTUREMAXSIZE 65536 // Max width and height in pixels of a frame in a replay file
+
+// Rectangle in virtual screen coordinates like a Win32 RECT (right and bottom are exclusive, left and top can be negative)
+struct CAPTURERECT {
+	int left;
+	int top;
+	int right;
+	int bottom;
+};
+
+// Position of a frame on the virtual screen and the monitors
+struct CAPTURELAYOUT {
+	CAPTURERECT bounds = { 0 }; // Virtual screen of the frame
+	std::vector<CAPTURERECT> monitors; // Monitors in virtual screen coordinates
+};
+
+// Provides the target image for a frame (returns false on failure)
+typedef std::function<bool(int width, int height, IMAGEBUFFER& image)> CAPTUREALLOCATEFUNCTION;
+// Captures a frame into an image from the allocate function and returns its layout (returns false on failure)
+typedef std::function<bool(const CAPTUREALLOCATEFUNCTION& allocate, IMAGEBUFFER& image, CAPTURELAYOUT& layout)> CAPTUREFUNCTION;
+// Reads exactly size bytes (returns false on a read error or end of file)
+typedef std::function<bool(void* pData, size_t size)> CAPTUREREADFUNCTION;
+// Writes size bytes (returns false on a write error)
+typedef std::function<bool(const void* pData, size_t size)> CAPTUREWRITEFUNCTION;
+
+// Capture source
+struct CAPTURESOURCE {
+	const char* name = ""; // Name for internal information and trace events
+	CAPTUREFUNCTION capture; // Captures the next frame
+};
+
+// Frame of a replay file
+struct CAPTURERECORDEDFRAME {
+	CAPTURELAYOUT layout;
+	RLEIMAGE image; // Run-length encoded pixels
+};
+
+// Frames of a replay file, which are delivered in order and repeated after the last frame
+struct CAPTUREREPLAY {
+	std::vector<CAPTURERECORDEDFRAME> frames;
+	size_t nextFrame = 0; // Index of the next delivered frame
+};
+
+bool isCaptureLayoutValid(const CAPTURELAYOUT& layout);
+void fillCaptureGaps(const IMAGEBUFFER& image, const CAPTURELAYOUT& layout, IMAGEPIXEL color);
+bool selectCaptureMonitor(CAPTURELAYOUT& layout, int x, int y);
+bool writeCaptureFrame(const IMAGEBUFFER& image, const CAPTURELAYOUT& layout, const CAPTUREWRITEFUNCTION& write);
+bool loadCaptureReplay(const CAPTUREREADFUNCTION& read, CAPTUREREPLAY& replay);
+CAPTURESOURCE createReplayCaptureSource(const std::shared_ptr<CAPTUREREPLAY>& pReplay);
@@ -0,0 +1,216 @@
+/*+===================================================================
+  File:      colorScan.cpp
+
+  Summary:   Search for color changes in image buffers. Horizontal runs are compared
+             4 (SSE2) or 8 (AVX2) pixels at a time against the reference color.
+             Vertical runs gather 4 (SSE2) or 8 (AVX2) pixels from consecutive
+             rows with the row stride and compare them the same way.
+
+             Has no dependencies to the Win32-API and can be compiled on other
+             platforms to test and benchmark the kernels.
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "colorScan.h"
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: findColorChangeScalar
+
+  Summary:   Searches color change pixel by pixel (reference kernel)
+
+  Args:     const IMAGEBUFFER &image
+              Image buffer
+            int x
+            int y
+              Start position
+            int directionX
+            int directionY
+              Direction (-1, 0 or 1)
+            int position
+              Current position in direction (x for horizontal, y for vertical search)
+            IMAGEPIXEL referenceColor
+              Color of the start position
+
+  Returns:  int
+              Last position in direction with the reference color
+
+-----------------------------------------------------------------F-F*/
+static int findColorChangeScalar(const IMAGEBUFFER& image, int x, int y, int directionX, int directionY, int position, IMAGEPIXEL referenceColor)
+{
+	if (directionX != 0)
+	{
+		while ((position + directionX >= 0) && (position + directionX < image.width)
+			&& (getImagePixel(image, position + directionX, y) == referenceColor)) position += directionX;
+	}
+	else
+	{
+		while ((position + directionY >= 0) && (position + directionY < image.height)
+			&& (getImagePixel(image, x, position + directionY) == referenceColor)) position += directionY;
+	}
+	return position;
+}
+
+#ifdef SIMDX86
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: lastEqualPosition
+
+  Summary:   Gets last position with the reference color from the compare result of a group
+
+  Args:     int equalLanes
+              Bitmask of lanes with the reference color (bit n = lane n)
+            int lanes
+              Lanes in the group
+            int firstPosition
+              Position of lane 0
+            int direction
+              Direction (-1 or 1). For -1 the last lane is the nearest to the start position.
+
+  Returns:  int
+
+-----------------------------------------------------------------F-F*/
+static inline int lastEqualPosition(int equalLanes, int lanes, int firstPosition, int direction)
+{
+	if (direction > 0)
+	{
+		int lane = 0;
+		while ((equalLanes >> lane) & 1) lane++;
+		return firstPosition + lane - 1;
+	}
+	int lane = lanes - 1;
+	while ((equalLanes >> lane) & 1) lane--;
+	return firstPosition + lane + 1;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: findColorChangeSSE2
+
+  Summary:   Searches color change 4 pixels at a time
+
+  Args:     See findColorChangeScalar
+
+  Returns:  int
+              Last position in direction with the reference color
+
+-----------------------------------------------------------------F-F*/
+SIMDSSE2FUNCTION static int findColorChangeSSE2(const IMAGEBUFFER& image, int x, int y, int directionX, int directionY, int position, IMAGEPIXEL referenceColor)
+{
+	const __m128i reference = _mm_set1_epi32((int)referenceColor);
+	const __m128i colorMask = _mm_set1_epi32(IMAGEPIXELCOLORMASK);
+	int direction = (directionX != 0) ? directionX : directionY;
+	int size = (directionX != 0) ? image.width : image.height;
+
+	while (true)
+	{
+		// Lane 0 is the group pixel with the lowest position
+		int first = (direction > 0) ? position + 1 : position - 4;
+		if ((first < 0) || (first + 4 > size)) break;
+
+		__m128i pixels;
+		if (directionX != 0)
+		{
+			pixels = _mm_loadu_si128((const __m128i*)(imageRow(image, y) + first));
+		}
+		else
+		{
+			const uint8_t* pPixel = (const uint8_t*)(imageRow(image, first) + x);
+			pixels = _mm_set_epi32(*(const int*)(pPixel + 3 * image.stride), *(const int*)(pPixel + 2 * image.stride),
+				*(const int*)(pPixel + image.stride), *(const int*)pPixel);
+		}
+		int equal = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(pixels, colorMask), reference)));
+		if (equal != 0xf) return lastEqualPosition(equal, 4, first, direction);
+		position += 4 * direction;
+	}
+	return findColorChangeScalar(image, x, y, directionX, directionY, position, referenceColor);
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: findColorChangeAVX2
+
+  Summary:   Searches color change 8 pixels at a time
+
+  Args:     See findColorChangeScalar
+
+  Returns:  int
+              Last position in direction with the reference color
+
+-----------------------------------------------------------------F-F*/
+SIMDAVX2FUNCTION static int findColorChangeAVX2(const IMAGEBUFFER& image, int x, int y, int directionX, int directionY, int position, IMAGEPIXEL referenceColor)
+{
+	const __m256i reference = _mm256_set1_epi32((int)referenceColor);
+	const __m256i colorMask = _mm256_set1_epi32(IMAGEPIXELCOLORMASK);
+	int direction = (directionX != 0) ? directionX : directionY;
+	int size = (directionX != 0) ? image.width : image.height;
+	int pixelStride = (int)(image.stride / IMAGEBYTESPERPIXEL);
+	const __m256i rowOffsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(pixelStride));
+
+	while (true)
+	{
+		// Lane 0 is the group pixel with the lowest position
+		int first = (direction > 0) ? position + 1 : position - 8;
+		if ((first < 0) || (first + 8 > size)) break;
+
+		__m256i pixels;
+		if (directionX != 0)
+			pixels = _mm256_loadu_si256((const __m256i*)(imageRow(image, y) + first));
+		else
+			pixels = _mm256_i32gather_epi32((const int*)(imageRow(image, first) + x), rowOffsets, IMAGEBYTESPERPIXEL);
+
+		int equal = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(pixels, colorMask), reference)));
+		if (equal != 0xff) return lastEqualPosition(equal, 8, first, direction);
+		position += 8 * direction;
+	}
+	return findColorChangeSSE2(image, x, y, directionX, directionY, position, referenceColor);
+}
+#endif
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: findColorChange
+
+  Summary:   Searches from a start position in one direction for the last pixel
+             before the color changes or the border of the image is reached
+
+  Args:     const IMAGEBUFFER &image
+              Image buffer
+            int x
+            int y
+              Start position (must be inside the image)
+            int directionX
+            int directionY
+              Direction (one of them must be -1 or 1, the other 0)
+            SIMDLEVEL maxLevel
+              Best instruction set extension to be used (default simdLevelAVX2)
+
+  Returns:  int
+              Last x (horizontal search) or y (vertical search) with the color of the start position
+
+-----------------------------------------------------------------F-F*/
+int findColorChange(const IMAGEBUFFER& image, int x, int y, int directionX, int directionY, SIMDLEVEL maxLevel)
+{
+	int position = (directionX != 0) ? x : y;
+
+	if (!isImageValid(image) || (x < 0) || (x >= image.width) || (y < 0) || (y >= image.height)) return position;
+	if (((directionX != 0) == (directionY != 0)) || (directionX < -1) || (directionX > 1) || (directionY < -1) || (directionY > 1)) return position;
+
+	IMAGEPIXEL referenceColor = getImagePixel(image, x, y);
+	SIMDLEVEL level = getSIMDLevel();
+	if (maxLevel < level) level = maxLevel;
+
+#ifdef SIMDX86
+	// Gather offsets are 32 bit
+	if ((level == simdLevelAVX2) && (image.stride / IMAGEBYTESPERPIXEL * 8 > INT32_MAX)) level = simdLevelSSE2;
+
+	switch (level)
+	{
+	case simdLevelAVX2:
+		return findColorChangeAVX2(image, x, y, directionX, directionY, position, referenceColor);
+	case simdLevelSSE2:
+		return findColorChangeSSE2(image, x, y, directionX, directionY, position, referenceColor);
+	default:
+		break;
+	}
+#endif
+	return findColorChangeScalar(image, x, y, directionX, directionY, position, referenceColor);
+}
@@ -0,0 +1,16 @@
+/*+===================================================================
+  File:      colorScan.h
+
+  Summary:   Search for color changes in image buffers with SSE2/AVX2 kernels.
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#pragma once
+
+#include "imageBuffer.h"
+#include "simd.h"
+
+int findColorChange(const IMAGEBUFFER& image, int x, int y, int directionX, int directionY, SIMDLEVEL maxLevel = simdLevelAVX2);
@@ -0,0 +1,926 @@
+/*+===================================================================
+  File:      deflate.cpp
+
+  Summary:   Deflate compressor (RFC 1951) and zlib stream format (RFC 1950).
+             Matches are searched with hash chains over a 32K window (lazy
+             matching for higher levels). Every block of symbols is written as
+             stored, fixed Huffman or dynamic Huffman block, whichever is smallest.
+
+             The data before the compressed range can be used as dictionary and
+             a not final range ends with a sync flush (empty stored block), so
+             ranges compressed independently can be concatenated to one stream.
+             compressZlib uses this to compress large data in chunks on the
+             worker pool (like pigz): Every chunk is primed with the last 32K of
+             the previous chunk, so only matches crossing a chunk border are lost.
+
+             Has no dependencies to the Win32-API and can be compiled on other
+             platforms to test and benchmark the compressor.
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "deflate.h"
+#include "workerPool.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#define DEFLATEHASHBITS 15 // Bits of the hash for the first 3 bytes of a match
+#define DEFLATEHASHSIZE (1 << DEFLATEHASHBITS) // Entries in the hash table
+#define DEFLATEMINMATCH 3 // Shortest match
+#define DEFLATEMAXMATCH 258 // Longest match
+#define DEFLATETOOFAR 4096 // Matches with min length and a longer distance are not used (coded as literals they need less bits)
+#define DEFLATEBLOCKSYMBOLS 32768 // Symbols per block (Huffman codes are adapted for every block)
+#define DEFLATEMAXSTOREDSIZE 65535 // Max bytes in a stored block
+#define DEFLATELITLENCODES 286 // Literal/length codes (0-255 literals, 256 end of block, 257-285 lengths)
+#define DEFLATEFIXEDLITLENCODES 288 // Literal/length codes of the fixed Huffman code (286 and 287 are not used, but part of the code)
+#define DEFLATEENDOFBLOCK 256 // End of block code
+#define DEFLATEDISTANCECODES 30 // Distance codes
+#define DEFLATECODELENGTHCODES 19 // Code length codes for dynamic Huffman blocks
+#define DEFLATEMAXBITS 15 // Max bits of a literal/length or distance code
+#define DEFLATEMAXCODELENGTHBITS 7 // Max bits of a code length code
+#define ADLER32BASE 65521 // Largest prime smaller than 65536
+#define ADLER32NMAX 5552 // Max bytes before the Adler-32 sums must be reduced
+
+// Search parameters of a compression level (same values as zlib)
+struct DEFLATELEVEL {
+	int goodLength; // Check only a quarter of the chain, when the previous match has at least this length
+	int maxLazy; // Lazy: No search at the next position for a match with at least this length
+	             // Greedy: Positions inside of longer matches are not added to the hash chains
+	int niceLength; // Stop search, when a match has at least this length
+	int maxChain; // Max candidates checked for a match
+	bool bLazy; // Check for a longer match at the next position before a match is used
+};
+
+static const DEFLATELEVEL g_levels[DEFLATEMAXLEVEL + 1] = {
+	{ 0, 0, 0, 0, false }, // 0 = Stored blocks
+	{ 4, 4, 8, 4, false },
+	{ 4, 5, 16, 8, false },
+	{ 4, 6, 32, 32, false },
+	{ 4, 4, 16, 16, true },
+	{ 8, 16, 32, 32, true },
+	{ 8, 16, 128, 128, true },
+	{ 8, 32, 128, 256, true },
+	{ 32, 128, DEFLATEMAXMATCH, 1024, true },
+	{ 32, DEFLATEMAXMATCH, DEFLATEMAXMATCH, 4096, true }
+};
+
+static const uint16_t g_lengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t g_lengthExtraBits[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint16_t g_distanceBase[DEFLATEDISTANCECODES] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const uint8_t g_distanceExtraBits[DEFLATEDISTANCECODES] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+static const uint8_t g_codeLengthOrder[DEFLATECODELENGTHCODES] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+// Lookup tables for length and distance codes
+struct DEFLATETABLES {
+	uint8_t lengthCode[DEFLATEMAXMATCH + 1]; // Index to g_lengthBase for a match length
+	uint8_t distanceCode[512]; // Index to g_distanceBase for distance-1 (<256) or 256+((distance-1)>>7)
+
+	DEFLATETABLES()
+	{
+		for (int code = 0; code < 29; code++)
+			for (int length = g_lengthBase[code]; (length < g_lengthBase[code] + (1 << g_lengthExtraBits[code])) && (length <= DEFLATEMAXMATCH); length++)
+				lengthCode[length] = (uint8_t)code;
+		lengthCode[DEFLATEMAXMATCH] = 28; // 258 has its own code
+		for (int code = 0; code < DEFLATEDISTANCECODES; code++)
+		{
+			for (int distance = g_distanceBase[code]; distance < g_distanceBase[code] + (1 << g_distanceExtraBits[code]); distance++)
+			{
+				if (distance <= 256) distanceCode[distance - 1] = (uint8_t)code;
+				else distanceCode[256 + ((distance - 1) >> 7)] = (uint8_t)code;
+			}
+		}
+	}
+};
+static const DEFLATETABLES g_tables;
+
+// Literal or match found by the LZ77 search
+struct DEFLATESYMBOL {
+	uint16_t litLen; // Literal (0-255) or match length (3-258)
+	uint16_t distance; // Match distance (0 for literals)
+};
+
+// LSB first bit output
+struct BITWRITER {
+	std::vector<uint8_t>* pOutput;
+	uint64_t bits; // Pending bits
+	int count; // Number of pending bits
+};
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: putBits
+
+  Summary:   Appends bits to the output
+
+  Args:     BITWRITER &writer
+              Bit output
+            uint32_t value
+              Bits (LSB first)
+            int count
+              Number of bits (0-32)
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+static inline void putBits(BITWRITER& writer, uint32_t value, int count)
+{
+	writer.bits |= (uint64_t)value << writer.count;
+	writer.count += count;
+	while (writer.count >= 8)
+	{
+		writer.pOutput->push_back((uint8_t)writer.bits);
+		writer.bits >>= 8;
+		writer.count -= 8;
+	}
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: alignBits
+
+  Summary:   Fills the last byte with zero bits
+
+  Args:     BITWRITER &writer
+              Bit output
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+static void alignBits(BITWRITER& writer)
+{
+	if (writer.count > 0) writer.pOutput->push_back((uint8_t)writer.bits);
+	writer.bits = 0;
+	writer.count = 0;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: buildCodeLengths
+
+  Summary:   Builds length limited Huffman code lengths. When the Huffman tree
+             is too deep, the frequencies are flattened and the tree is rebuilt.
+             At least two symbols get a code, because some decoders reject
+             codes with only one symbol.
+
+  Args:     const uint32_t *pFrequencies
+              Frequency of each symbol
+            int count
+              Number of symbols
+            int maxBits
+              Max code length
+            uint8_t *pLengths
+              Code length of each symbol (0 for unused symbols)
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+static void buildCodeLengths(const uint32_t* pFrequencies, int count, int maxBits, uint8_t* pLengths)
+{
+	std::vector<uint64_t> frequencies(pFrequencies, pFrequencies + count);
+	std::vector<int> symbols;
+
+	for (int i = 0; i < count; i++) if (frequencies[i] > 0) symbols.push_back(i);
+	for (int i = 0; (symbols.size() < 2) && (i < count); i++)
+	{
+		if (frequencies[i] == 0)
+		{
+			frequencies[i] = 1;
+			symbols.push_back(i);
+		}
+	}
+
+	int leaves = (int)symbols.size();
+	std::vector<uint64_t> weight(2 * leaves);
+	std::vector<int> left(2 * leaves), right(2 * leaves), depth(2 * leaves);
+
+	while (true)
+	{
+		std::sort(symbols.begin(), symbols.end(), [&frequencies](int a, int b) {
+			return (frequencies[a] < frequencies[b]) || ((frequencies[a] == frequencies[b]) && (a < b));
+		});
+		for (int i = 0; i < leaves; i++) weight[i] = frequencies[symbols[i]];
+
+		// Two queue Huffman algorithm: Leaves are sorted and internal nodes are created in ascending weight order
+		int nextLeaf = 0;
+		int nextNode = leaves;
+		int nodes = leaves;
+		auto takeLightest = [&]() {
+			if ((nextLeaf < leaves) && ((nextNode >= nodes) || (weight[nextLeaf] <= weight[nextNode]))) return nextLeaf++;
+			return nextNode++;
+		};
+		while (nodes < 2 * leaves - 1)
+		{
+			left[nodes] = takeLightest();
+			right[nodes] = takeLightest();
+			weight[nodes] = weight[left[nodes]] + weight[right[nodes]];
+			nodes++;
+		}
+
+		// Children have lower indexes than their parent
+		int maxDepth = 0;
+		depth[nodes - 1] = 0;
+		for (int i = nodes - 1; i >= leaves; i--)
+		{
+			depth[left[i]] = depth[i] + 1;
+			depth[right[i]] = depth[i] + 1;
+		}
+		for (int i = 0; i < leaves; i++) maxDepth = std::max(maxDepth, depth[i]);
+
+		if (maxDepth <= maxBits)
+		{
+			for (int i = 0; i < count; i++) pLengths[i] = 0;
+			for (int i = 0; i < leaves; i++) pLengths[symbols[i]] = (uint8_t)depth[i];
+			return;
+		}
+
+		// Too deep => Flatten frequencies
+		for (int symbol : symbols) frequencies[symbol] = (frequencies[symbol] >> 1) | 1;
+	}
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: buildCodes
+
+  Summary:   Builds canonical Huffman codes from code lengths. The codes are
+             bit reversed, because Huffman codes are written MSB first.
+
+  Args:     const uint8_t *pLengths
+              Code length of each symbol
+            int count
+              Number of symbols
+            uint16_t *pCodes
+              Bit reversed code of each symbol
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+static void buildCodes(const uint8_t* pLengths, int count, uint16_t* pCodes)
+{
+	int lengthCount[DEFLATEMAXBITS + 1] = { 0 };
+	uint32_t nextCode[DEFLATEMAXBITS + 1] = { 0 };
+
+	for (int i = 0; i < count; i++) lengthCount[pLengths[i]]++;
+	lengthCount[0] = 0;
+	uint32_t code = 0;
+	for (int bits = 1; bits <= DEFLATEMAXBITS; bits++)
+	{
+		code = (code + lengthCount[bits - 1]) << 1;
+		nextCode[bits] = code;
+	}
+	for (int i = 0; i < count; i++)
+	{
+		int length = pLengths[i];
+		if (length == 0)
+		{
+			pCodes[i] = 0;
+			continue;
+		}
+		uint32_t value = nextCode[length]++;
+		uint32_t reversed = 0;
+		for (int bit = 0; bit < length; bit++) reversed |= ((value >> bit) & 1) << (length - 1 - bit);
+		pCodes[i] = (uint16_t)reversed;
+	}
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getSymbolBits
+
+  Summary:   Gets the size of the symbols of a block for the given code lengths
+
+  Args:     const uint32_t *pLitLenFrequencies
+            const uint32_t *pDistanceFrequencies
+              Frequencies of the codes
+            const uint8_t *pLitLenLengths
+            const uint8_t *pDistanceLengths
+              Code lengths
+
+  Returns:  uint64_t
+              Bits including extra bits
+
+-----------------------------------------------------------------F-F*/
+static uint64_t getSymbolBits(const uint32_t* pLitLenFrequencies, const uint32_t* pDistanceFrequencies, const uint8_t* pLitLenLengths, const uint8_t* pDistanceLengths)
+{
+	uint64_t bits = 0;
+	for (int i = 0; i < DEFLATELITLENCODES; i++)
+	{
+		bits += (uint64_t)pLitLenFrequencies[i] * pLitLenLengths[i];
+		if (i > DEFLATEENDOFBLOCK) bits += (uint64_t)pLitLenFrequencies[i] * g_lengthExtraBits[i - DEFLATEENDOFBLOCK - 1];
+	}
+	for (int i = 0; i < DEFLATEDISTANCECODES; i++)
+		bits += (uint64_t)pDistanceFrequencies[i] * (pDistanceLengths[i] + g_distanceExtraBits[i]);
+	return bits;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: writeSymbols
+
+  Summary:   Writes the Huffman coded symbols of a block and the end of block code
+
+  Args:     BITWRITER &writer
+              Bit output
+            const std::vector<DEFLATESYMBOL> &symbols
+              Literals and matches
+            const uint16_t *pLitLenCodes
+            const uint8_t *pLitLenLengths
+            const uint16_t *pDistanceCodes
+            const uint8_t *pDistanceLengths
+              Huffman codes
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+static void writeSymbols(BITWRITER& writer, const std::vector<DEFLATESYMBOL>& symbols,
+	const uint16_t* pLitLenCodes, const uint8_t* pLitLenLengths, const uint16_t* pDistanceCodes, const uint8_t* pDistanceLengths)
+{
+	for (const DEFLATESYMBOL& symbol : symbols)
+	{
+		if (symbol.distance == 0)
+		{
+			putBits(writer, pLitLenCodes[symbol.litLen], pLitLenLengths[symbol.litLen]);
+			continue;
+		}
+		int lengthCode = g_tables.lengthCode[symbol.litLen];
+		int code = DEFLATEENDOFBLOCK + 1 + lengthCode;
+		putBits(writer, pLitLenCodes[code], pLitLenLengths[code]);
+		putBits(writer, symbol.litLen - g_lengthBase[lengthCode], g_lengthExtraBits[lengthCode]);
+
+		int distance = symbol.distance;
+		int distanceCode = (distance <= 256) ? g_tables.distanceCode[distance - 1] : g_tables.distanceCode[256 + ((distance - 1) >> 7)];
+		putBits(writer, pDistanceCodes[distanceCode], pDistanceLengths[distanceCode]);
+		putBits(writer, distance - g_distanceBase[distanceCode], g_distanceExtraBits[distanceCode]);
+	}
+	putBits(writer, pLitLenCodes[DEFLATEENDOFBLOCK], pLitLenLengths[DEFLATEENDOFBLOCK]);
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: writeStoredBlocks
+
+  Summary:   Writes data as stored (uncompressed) blocks
+
+  Args:     BITWRITER &writer
+              Bit output
+            const uint8_t *pData
+              Data
+            size_t size
+              Bytes
+            bool bFinal
+              true, when the last block is the final block of the stream
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+static void writeStoredBlocks(BITWRITER& writer, const uint8_t* pData, size_t size, bool bFinal)
+{
+	do
+	{
+		size_t blockSize = std::min(size, (size_t)DEFLATEMAXSTOREDSIZE);
+		putBits(writer, (bFinal && (blockSize == size)) ? 1 : 0, 1);
+		putBits(writer, 0, 2); // BTYPE 00 = Stored
+		alignBits(writer);
+		putBits(writer, (uint32_t)blockSize, 16);
+		putBits(writer, (uint32_t)blockSize ^ 0xffff, 16);
+		writer.pOutput->insert(writer.pOutput->end(), pData, pData + blockSize);
+		pData += blockSize;
+		size -= blockSize;
+	} while (size > 0);
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: writeBlock
+
+  Summary:   Writes the symbols of a block as stored, fixed Huffman or dynamic
+             Huffman block, whichever is smallest
+
+  Args:     BITWRITER &writer
+              Bit output
+            const std::vector<DEFLATESYMBOL> &symbols
+              Literals and matches of the block
+            const uint8_t *pData
+              Uncompressed data of the block (for stored blocks)
+            size_t size
+              Uncompressed bytes of the block
+            bool bFinal
+              true, when this is the final block of the stream
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+static void writeBlock(BITWRITER& writer, const std::vector<DEFLATESYMBOL>& symbols, const uint8_t* pData, size_t size, bool bFinal)
+{
+	uint32_t litLenFrequencies[DEFLATELITLENCODES] = { 0 };
+	uint32_t distanceFrequencies[DEFLATEDISTANCECODES] = { 0 };
+	uint8_t litLenLengths[DEFLATELITLENCODES];
+	uint8_t distanceLengths[DEFLATEDISTANCECODES];
+	uint16_t litLenCodes[DEFLATEFIXEDLITLENCODES];
+	uint16_t distanceCodes[DEFLATEDISTANCECODES];
+
+	for (const DEFLATESYMBOL& symbol : symbols)
+	{
+		if (symbol.distance == 0)
+		{
+			litLenFrequencies[symbol.litLen]++;
+			continue;
+		}
+		litLenFrequencies[DEFLATEENDOFBLOCK + 1 + g_tables.lengthCode[symbol.litLen]]++;
+		int distance = symbol.distance;
+		distanceFrequencies[(distance <= 256) ? g_tables.distanceCode[distance - 1] : g_tables.distanceCode[256 + ((distance - 1) >> 7)]]++;
+	}
+	litLenFrequencies[DEFLATEENDOFBLOCK] = 1;
+
+	// Fixed Huffman codes
+	uint8_t fixedLitLenLengths[DEFLATEFIXEDLITLENCODES];
+	uint8_t fixedDistanceLengths[DEFLATEDISTANCECODES];
+	for (int i = 0; i < DEFLATEFIXEDLITLENCODES; i++) fixedLitLenLengths[i] = (i < 144) ? 8 : (i < 256) ? 9 : (i < 280) ? 7 : 8;
+	for (int i = 0; i < DEFLATEDISTANCECODES; i++) fixedDistanceLengths[i] = 5;
+	uint64_t fixedBits = 3 + getSymbolBits(litLenFrequencies, distanceFrequencies, fixedLitLenLengths, fixedDistanceLengths);
+
+	// Dynamic Huffman codes
+	buildCodeLengths(litLenFrequencies, DEFLATELITLENCODES, DEFLATEMAXBITS, litLenLengths);
+	buildCodeLengths(distanceFrequencies, DEFLATEDISTANCECODES, DEFLATEMAXBITS, distanceLengths);
+
+	int litLenCount = DEFLATELITLENCODES;
+	while ((litLenCount > 257) && (litLenLengths[litLenCount - 1] == 0)) litLenCount--;
+	int distanceCount = DEFLATEDISTANCECODES;
+	while ((distanceCount > 1) && (distanceLengths[distanceCount - 1] == 0)) distanceCount--;
+
+	// Run length encoding of the code lengths (16 = repeat previous 3-6 times, 17 = 3-10 zeros, 18 = 11-138 zeros)
+	uint8_t lengths[DEFLATELITLENCODES + DEFLATEDISTANCECODES];
+	int lengthCount = litLenCount + distanceCount;
+	std::copy(litLenLengths, litLenLengths + litLenCount, lengths);
+	std::copy(distanceLengths, distanceLengths + distanceCount, lengths + litLenCount);
+
+	std::vector<uint8_t> codeLengthSymbols;
+	std::vector<uint8_t> codeLengthExtra;
+	uint32_t codeLengthFrequencies[DEFLATECODELENGTHCODES] = { 0 };
+	auto addCodeLength = [&](int symbol, int extra) {
+		codeLengthSymbols.push_back((uint8_t)symbol);
+		codeLengthExtra.push_back((uint8_t)extra);
+		codeLengthFrequencies[symbol]++;
+	};
+	for (int i = 0; i < lengthCount;)
+	{
+		int length = lengths[i];
+		int run = 1;
+		while ((i + run < lengthCount) && (lengths[i + run] == length)) run++;
+		i += run;
+		if (length == 0)
+		{
+			while (run >= 11)
+			{
+				int repeat = std::min(run, 138);
+				addCodeLength(18, repeat - 11);
+				run -= repeat;
+			}
+			if (run >= 3)
+			{
+				addCodeLength(17, run - 3);
+				run = 0;
+			}
+		}
+		else
+		{
+			addCodeLength(length, 0);
+			run--;
+			while (run >= 3)
+			{
+				int repeat = std::min(run, 6);
+				addCodeLength(16, repeat - 3);
+				run -= repeat;
+			}
+		}
+		while (run-- > 0) addCodeLength(length, 0);
+	}
+
+	uint8_t codeLengthLengths[DEFLATECODELENGTHCODES];
+	uint16_t codeLengthCodes[DEFLATECODELENGTHCODES];
+	buildCodeLengths(codeLengthFrequencies, DEFLATECODELENGTHCODES, DEFLATEMAXCODELENGTHBITS, codeLengthLengths);
+	buildCodes(codeLengthLengths, DEFLATECODELENGTHCODES, codeLengthCodes);
+	int codeLengthCount = DEFLATECODELENGTHCODES;
+	while ((codeLengthCount > 4) && (codeLengthLengths[g_codeLengthOrder[codeLengthCount - 1]] == 0)) codeLengthCount--;
+
+	uint64_t dynamicBits = 3 + 5 + 5 + 4 + 3 * (uint64_t)codeLengthCount;
+	for (size_t i = 0; i < codeLengthSymbols.size(); i++)
+	{
+		int symbol = codeLengthSymbols[i];
+		dynamicBits += codeLengthLengths[symbol] + ((symbol == 16) ? 2 : (symbol == 17) ? 3 : (symbol == 18) ? 7 : 0);
+	}
+	dynamicBits += getSymbolBits(litLenFrequencies, distanceFrequencies, litLenLengths, distanceLengths);
+
+	// Stored blocks (header, alignment, length and data)
+	uint64_t storedBlocks = std::max((size + DEFLATEMAXSTOREDSIZE - 1) / DEFLATEMAXSTOREDSIZE, (size_t)1);
+	uint64_t storedBits = storedBlocks * (3 + 7 + 32) + 8 * (uint64_t)size;
+
+	if ((storedBits < fixedBits) && (storedBits < dynamicBits))
+	{
+		writeStoredBlocks(writer, pData, size, bFinal);
+	}
+	else if (fixedBits <= dynamicBits)
+	{
+		putBits(writer, bFinal ? 1 : 0, 1);
+		putBits(writer, 1, 2); // BTYPE 01 = Fixed Huffman codes
+		buildCodes(fixedLitLenLengths, DEFLATEFIXEDLITLENCODES, litLenCodes);
+		buildCodes(fixedDistanceLengths, DEFLATEDISTANCECODES, distanceCodes);
+		writeSymbols(writer, symbols, litLenCodes, fixedLitLenLengths, distanceCodes, fixedDistanceLengths);
+	}
+	else
+	{
+		putBits(writer, bFinal ? 1 : 0, 1);
+		putBits(writer, 2, 2); // BTYPE 10 = Dynamic Huffman codes
+		putBits(writer, litLenCount - 257, 5);
+		putBits(writer, distanceCount - 1, 5);
+		putBits(writer, codeLengthCount - 4, 4);
+		for (int i = 0; i < codeLengthCount; i++) putBits(writer, codeLengthLengths[g_codeLengthOrder[i]], 3);
+		for (size_t i = 0; i < codeLengthSymbols.size(); i++)
+		{
+			int symbol = codeLengthSymbols[i];
+			putBits(writer, codeLengthCodes[symbol], codeLengthLengths[symbol]);
+			if (symbol == 16) putBits(writer, codeLengthExtra[i], 2);
+			else if (symbol == 17) putBits(writer, codeLengthExtra[i], 3);
+			else if (symbol == 18) putBits(writer, codeLengthExtra[i], 7);
+		}
+		buildCodes(litLenLengths, DEFLATELITLENCODES, litLenCodes);
+		buildCodes(distanceLengths, DEFLATEDISTANCECODES, distanceCodes);
+		writeSymbols(writer, symbols, litLenCodes, litLenLengths, distanceCodes, distanceLengths);
+	}
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getHash
+
+  Summary:   Hash of the 3 bytes at a position
+
+  Args:     const uint8_t *pData
+              Position (3 bytes must be readable)
+
+  Returns:  uint32_t
+              Hash (0 to DEFLATEHASHSIZE-1)
+
+-----------------------------------------------------------------F-F*/
+static inline uint32_t getHash(const uint8_t* pData)
+{
+	uint32_t value = (uint32_t)pData[0] | ((uint32_t)pData[1] << 8) | ((uint32_t)pData[2] << 16);
+	return (value * 2654435761u) >> (32 - DEFLATEHASHBITS);
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getMatchLength
+
+  Summary:   Compares two byte sequences 8 bytes at a time
+
+  Args:     const uint8_t *pCandidate
+            const uint8_t *pCurrent
+              Byte sequences
+            int maxLength
+              Max bytes to compare (both sequences must have this size)
+
+  Returns:  int
+              Number of equal bytes at the start
+
+-----------------------------------------------------------------F-F*/
+static inline int getMatchLength(const uint8_t* pCandidate, const uint8_t* pCurrent, int maxLength)
+{
+	int length = 0;
+	while (length + 8 <= maxLength)
+	{
+		uint64_t candidate, current;
+		memcpy(&candidate, pCandidate + length, 8);
+		memcpy(&current, pCurrent + length, 8);
+		if (candidate != current) break;
+		length += 8;
+	}
+	while ((length < maxLength) && (pCandidate[length] == pCurrent[length])) length++;
+	return length;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: deflateRaw
+
+  Summary:   Compresses data to raw deflate blocks (without zlib header)
+
+  Args:     const uint8_t *pData
+              Data to compress
+            size_t size
+              Bytes to compress
+            size_t dictionarySize
+              Bytes before pData, which can be referenced by matches
+              (only the last bytes of the window are used)
+            int level
+              Compression level (DEFLATEMINLEVEL-DEFLATEMAXLEVEL)
+            bool bFinal
+              true = Last block gets the final flag and the output is padded to a full byte
+              false = Output ends with a sync flush (empty stored block) and further
+                      blocks can be appended
+            std::vector<uint8_t> &output
+              Compressed data is appended
+            int windowBits
+              Max distance of a match is 2^windowBits (DEFLATEMINWINDOWBITS-DEFLATEMAXWINDOWBITS).
+              A smaller window needs less memory for the hash chains, but finds fewer matches
+
+  Returns:  bool
+              true = success
+              false = failure (out of memory)
+
+-----------------------------------------------------------------F-F*/
+bool deflateRaw(const uint8_t* pData, size_t size, size_t dictionarySize, int level, bool bFinal, std::vector<uint8_t>& output, int windowBits)
+{
+	BITWRITER writer = { &output, 0, 0 };
+
+	if (level < DEFLATEMINLEVEL) level = DEFLATEMINLEVEL;
+	if (level > DEFLATEMAXLEVEL) level = DEFLATEMAXLEVEL;
+	if (windowBits < DEFLATEMINWINDOWBITS) windowBits = DEFLATEMINWINDOWBITS;
+	if (windowBits > DEFLATEMAXWINDOWBITS) windowBits = DEFLATEMAXWINDOWBITS;
+	const int64_t windowSize = (int64_t)1 << windowBits;
+	if (dictionarySize > (size_t)windowSize) dictionarySize = (size_t)windowSize;
+	if (size > (size_t)INT32_MAX - dictionarySize) return false; // Positions in the hash chains are 32 bit
+
+	try {
+		if (level == DEFLATEMINLEVEL)
+		{
+			if ((size > 0) || bFinal) writeStoredBlocks(writer, pData, size, bFinal);
+		}
+		else
+		{
+			const DEFLATELEVEL& parameters = g_levels[level];
+			const uint8_t* pBase = pData - dictionarySize;
+			const int64_t end = (int64_t)(dictionarySize + size);
+			std::vector<int32_t> head(DEFLATEHASHSIZE, -1); // Last position for each hash
+			std::vector<int32_t> previous((size_t)windowSize, -1); // Previous position with the same hash (hash chains)
+			std::vector<DEFLATESYMBOL> symbols;
+			symbols.reserve(DEFLATEBLOCKSYMBOLS + 1);
+
+			// Adds position to the hash chains and returns the previous position with the same hash
+			auto insertHash = [&](int64_t position) {
+				if (position + DEFLATEMINMATCH > end) return (int64_t)-1;
+				uint32_t hash = getHash(pBase + position);
+				int64_t candidate = head[hash];
+				previous[position & (windowSize - 1)] = (int32_t)candidate;
+				head[hash] = (int32_t)position;
+				return candidate;
+			};
+
+			// Searches the longest match longer than minLength in the hash chain
+			auto findMatch = [&](int64_t position, int64_t candidate, int minLength, int& distance) {
+				int maxLength = (int)std::min((int64_t)DEFLATEMAXMATCH, end - position);
+				int bestLength = minLength;
+				int chain = (minLength >= parameters.goodLength) ? parameters.maxChain >> 2 : parameters.maxChain;
+				const uint8_t* pCurrent = pBase + position;
+
+				if (bestLength >= maxLength) return 0;
+				while ((candidate >= 0) && (position - candidate <= windowSize) && (chain-- > 0))
+				{
+					const uint8_t* pCandidate = pBase + candidate;
+					if ((pCandidate[bestLength] == pCurrent[bestLength]) && (pCandidate[bestLength - 1] == pCurrent[bestLength - 1])
+						&& (pCandidate[0] == pCurrent[0]) && (pCandidate[1] == pCurrent[1]))
+					{
+						int length = getMatchLength(pCandidate, pCurrent, maxLength);
+						if ((length > bestLength) && ((length > DEFLATEMINMATCH) || (position - candidate <= DEFLATETOOFAR)))
+						{
+							bestLength = length;
+							distance = (int)(position - candidate);
+							if ((length >= parameters.niceLength) || (length >= maxLength)) break;
+						}
+					}
+					int64_t next = previous[candidate & (windowSize - 1)];
+					if (next >= candidate) break; // Entry was overwritten by a newer position
+					candidate = next;
+				}
+				return (bestLength > minLength) ? bestLength : 0;
+			};
+
+			for (int64_t position = 0; position < (int64_t)dictionarySize; position++) insertHash(position);
+
+			int64_t position = (int64_t)dictionarySize;
+			int64_t blockStart = position;
+			int previousLength = 0;
+			int previousDistance = 0;
+			bool bLiteralPending = false; // Byte before position is not yet coded (lazy matching)
+
+			while (position < end)
+			{
+				int length = 0;
+				int distance = 0;
+				int64_t candidate = insertHash(position);
+
+				if (parameters.bLazy)
+				{
+					if (previousLength < parameters.maxLazy)
+						length = findMatch(position, candidate, std::max(previousLength, DEFLATEMINMATCH - 1), distance);
+
+					if ((previousLength >= DEFLATEMINMATCH) && (length == 0))
+					{
+						// Match at previous position is better
+						symbols.push_back({ (uint16_t)previousLength, (uint16_t)previousDistance });
+						int64_t matchEnd = position - 1 + previousLength;
+						for (int64_t i = position + 1; i < matchEnd; i++) insertHash(i);
+						position = matchEnd;
+						previousLength = 0;
+						bLiteralPending = false;
+					}
+					else
+					{
+						if (bLiteralPending) symbols.push_back({ pBase[position - 1], 0 });
+						bLiteralPending = true;
+						previousLength = length;
+						previousDistance = distance;
+						position++;
+					}
+				}
+				else
+				{
+					length = findMatch(position, candidate, DEFLATEMINMATCH - 1, distance);
+					if (length >= DEFLATEMINMATCH)
+					{
+						symbols.push_back({ (uint16_t)length, (uint16_t)distance });
+						if (length <= parameters.maxLazy)
+						{
+							for (int64_t i = position + 1; i < position + length; i++) insertHash(i);
+						}
+						position += length;
+					}
+					else
+					{
+						symbols.push_back({ pBase[position], 0 });
+						position++;
+					}
+				}
+
+				if (symbols.size() >= DEFLATEBLOCKSYMBOLS)
+				{
+					int64_t blockEnd = position - (bLiteralPending ? 1 : 0);
+					writeBlock(writer, symbols, pBase + blockStart, (size_t)(blockEnd - blockStart), false);
+					symbols.clear();
+					blockStart = blockEnd;
+				}
+			}
+			if (bLiteralPending) symbols.push_back({ pBase[end - 1], 0 });
+
+			if (!symbols.empty() || bFinal) writeBlock(writer, symbols, pBase + blockStart, (size_t)(end - blockStart), bFinal);
+		}
+
+		if (bFinal) alignBits(writer);
+		else
+		{
+			// Sync flush
+			putBits(writer, 0, 1);
+			putBits(writer, 0, 2);
+			alignBits(writer);
+			putBits(writer, 0x0000, 16);
+			putBits(writer, 0xffff, 16);
+		}
+	}
+	catch (...) { // Out of memory
+		return false;
+	}
+	return true;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: updateAdler32
+
+  Summary:   Updates an Adler-32 checksum
+
+  Args:     uint32_t adler
+              Checksum of the previous data (1 for no data)
+            const uint8_t *pData
+              Data
+            size_t size
+              Bytes
+
+  Returns:  uint32_t
+              Checksum
+
+-----------------------------------------------------------------F-F*/
+uint32_t updateAdler32(uint32_t adler, const uint8_t* pData, size_t size)
+{
+	uint32_t a = adler & 0xffff;
+	uint32_t b = adler >> 16;
+
+	while (size > 0)
+	{
+		size_t count = std::min(size, (size_t)ADLER32NMAX);
+		size -= count;
+		while (count-- > 0)
+		{
+			a += *pData++;
+			b += a;
+		}
+		a %= ADLER32BASE;
+		b %= ADLER32BASE;
+	}
+	return (b << 16) | a;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: combineAdler32
+
+  Summary:   Combines the Adler-32 checksums of two consecutive data blocks
+
+  Args:     uint32_t adler1
+              Checksum of the first block
+            uint32_t adler2
+              Checksum of the second block
+            size_t size2
+              Bytes of the second block
+
+  Returns:  uint32_t
+              Checksum of both blocks
+
+-----------------------------------------------------------------F-F*/
+uint32_t combineAdler32(uint32_t adler1, uint32_t adler2, size_t size2)
+{
+	uint32_t remainder = (uint32_t)(size2 % ADLER32BASE);
+	uint32_t sum1 = adler1 & 0xffff;
+	uint32_t sum2 = (uint32_t)(((uint64_t)remainder * sum1) % ADLER32BASE);
+
+	sum1 += (adler2 & 0xffff) + ADLER32BASE - 1;
+	sum2 += (adler1 >> 16) + (adler2 >> 16) + ADLER32BASE - remainder;
+	if (sum1 >= ADLER32BASE) sum1 -= ADLER32BASE;
+	if (sum1 >= ADLER32BASE) sum1 -= ADLER32BASE;
+	if (sum2 >= (ADLER32BASE << 1)) sum2 -= (ADLER32BASE << 1);
+	if (sum2 >= ADLER32BASE) sum2 -= ADLER32BASE;
+	return (sum2 << 16) | sum1;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: compressZlib
+
+  Summary:   Compresses data to a zlib stream. Data larger than DEFLATEPARALLELCHUNKSIZE
+             is compressed in chunks by the worker pool, when more than one thread
+             is allowed. The decompressed stream is the same in both cases.
+
+  Args:     const uint8_t *pData
+              Data to compress
+            size_t size
+              Bytes
+            int level
+              Compression level (DEFLATEMINLEVEL-DEFLATEMAXLEVEL)
+            std::vector<uint8_t> &output
+              zlib stream is appended
+            int maxThreads
+              Max threads for the compression (0 = all threads of the worker pool, 1 = calling thread only)
+            int windowBits
+              Window size of the compressor (DEFLATEMINWINDOWBITS-DEFLATEMAXWINDOWBITS)
+
+  Returns:  bool
+              true = success
+              false = failure (out of memory)
+
+-----------------------------------------------------------------F-F*/
+bool compressZlib(const uint8_t* pData, size_t size, int level, std::vector<uint8_t>& output, int maxThreads, int windowBits)
+{
+	if (windowBits < DEFLATEMINWINDOWBITS) windowBits = DEFLATEMINWINDOWBITS;
+	if (windowBits > DEFLATEMAXWINDOWBITS) windowBits = DEFLATEMAXWINDOWBITS;
+
+	try {
+		// Header: Deflate with window size, compression level hint and check bits
+		uint32_t header = ((((windowBits - 8) << 4) | 8) << 8) | (((level <= 1) ? 0 : (level <= 5) ? 1 : (level == 6) ? 2 : 3) << 6);
+		header += (31 - header % 31) % 31;
+		output.push_back((uint8_t)(header >> 8));
+		output.push_back((uint8_t)header);
+
+		int threads = (maxThreads > 0) ? maxThreads : getWorkerThreadCount();
+		size_t chunks = (size + DEFLATEPARALLELCHUNKSIZE - 1) / DEFLATEPARALLELCHUNKSIZE;
+		uint32_t adler = 1;
+
+		if ((threads <= 1) || (chunks <= 1))
+		{
+			if (!deflateRaw(pData, size, 0, level, true, output, windowBits)) return false;
+			adler = updateAdler32(1, pData, size);
+		}
+		else
+		{
+			// Compress chunks in parallel, each chunk uses the end of the previous chunk as dictionary
+			std::vector<std::vector<uint8_t>> chunkOutputs(chunks);
+			std::vector<uint32_t> chunkAdlers(chunks);
+			std::atomic<size_t> nextChunk{ 0 };
+			std::atomic<bool> bFailed{ false };
+
+			if ((size_t)threads > chunks) threads = (int)chunks;
+			runWorkerTasks(threads, [&](int) {
+				size_t chunk;
+				while (((chunk = nextChunk.fetch_add(1)) < chunks) && !bFailed)
+				{
+					size_t offset = chunk * DEFLATEPARALLELCHUNKSIZE;
+					size_t chunkSize = std::min(size - offset, (size_t)DEFLATEPARALLELCHUNKSIZE);
+					if (!deflateRaw(pData + offset, chunkSize, std::min(offset, (size_t)1 << windowBits), level, chunk == chunks - 1, chunkOutputs[chunk], windowBits)) bFailed = true;
+					chunkAdlers[chunk] = updateAdler32(1, pData + offset, chunkSize);
+				}
+			});
+			if (bFailed) return false;
+
+			// Stitch chunks to one stream
+			for (size_t chunk = 0; chunk < chunks; chunk++)
+			{
+				output.insert(output.end(), chunkOutputs[chunk].begin(), chunkOutputs[chunk].end());
+				std::vector<uint8_t>().swap(chunkOutputs[chunk]);
+				size_t chunkSize = std::min(size - chunk * DEFLATEPARALLELCHUNKSIZE, (size_t)DEFLATEPARALLELCHUNKSIZE);
+				adler = (chunk == 0) ? chunkAdlers[0] : combineAdler32(adler, chunkAdlers[chunk], chunkSize);
+			}
+		}
+		for (int shift = 24; shift >= 0; shift -= 8) output.push_back((uint8_t)(adler >> shift));
+	}
+	catch (...) { // Out of memory
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,29 @@
+/*+===================================================================
+  File:      deflate.h
+
+  Summary:   Deflate compressor (RFC 1951) and zlib stream format (RFC 1950)
+             for the PNG encoder.
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#define DEFLATEWINDOWSIZE 32768 // Max distance of a match (and max useful dictionary size)
+#define DEFLATEMINWINDOWBITS 9 // Smallest window (512 bytes)
+#define DEFLATEMAXWINDOWBITS 15 // Largest window (DEFLATEWINDOWSIZE)
+#define DEFLATEMINLEVEL 0 // Stored blocks only
+#define DEFLATEMAXLEVEL 9 // Best compression
+#define DEFLATEDEFAULTLEVEL 6 // Default compression level
+#define DEFLATEPARALLELCHUNKSIZE (1024 * 1024) // Bytes per chunk for the parallel compression (smaller data is compressed by the calling thread only)
+
+bool deflateRaw(const uint8_t* pData, size_t size, size_t dictionarySize, int level, bool bFinal, std::vector<uint8_t>& output, int windowBits = DEFLATEMAXWINDOWBITS);
+bool compressZlib(const uint8_t* pData, size_t size, int level, std::vector<uint8_t>& output, int maxThreads = 1, int windowBits = DEFLATEMAXWINDOWBITS);
+uint32_t updateAdler32(uint32_t adler, const uint8_t* pData, size_t size);
+uint32_t combineAdler32(uint32_t adler1, uint32_t adler2, size_t size2);
@@ -0,0 +1,413 @@
+/*+===================================================================
+  File:      edgeIndex.cpp
+
+  Summary:   Index of color edges for each row and column of an image buffer.
+             Two neighbor pixels form an edge, when at least one color channel
+             differs by more than the tolerance. With tolerance 0 every color
+             change is an edge.
+
+             The index is built once per screenshot by a background thread (rows
+             with SSE2 compares in one pass, columns in a counting and a filling
+             pass) and answers "last pixel before the next edge" with a binary
+             search in the edges of one row or column.
+
+             Has no dependencies to the Win32-API and can be compiled on other
+             platforms to test and benchmark the index.
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "edgeIndex.h"
+#include "colorScan.h"
+#include "simd.h"
+#include <algorithm>
+#include <thread>
+
+// Background build of the edge index
+static std::thread g_buildThread; // Thread building g_edgeIndex
+static std::atomic<bool> g_cancelBuild{ false }; // true, when the build should be canceled
+static std::atomic<bool> g_edgeIndexReady{ false }; // true, when g_edgeIndex is complete
+static EDGEINDEX g_edgeIndex; // Edge index of the last started build
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: isColorEdge
+
+  Summary:   Checks if two colors differ by more than the tolerance in at least one channel
+
+  Args:     IMAGEPIXEL color1
+            IMAGEPIXEL color2
+              Colors
+            int tolerance
+              Max difference per color channel (0-255)
+
+  Returns:  bool
+
+-----------------------------------------------------------------F-F*/
+bool isColorEdge(IMAGEPIXEL color1, IMAGEPIXEL color2, int tolerance)
+{
+	for (int shift = 0; shift < 24; shift += 8)
+	{
+		int difference = (int)((color1 >> shift) & 0xff) - (int)((color2 >> shift) & 0xff);
+		if ((difference > tolerance) || (-difference > tolerance)) return true;
+	}
+	return false;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getEdgeMaskScalar
+
+  Summary:   Compares pixels of two pixel arrays
+
+  Args:     const IMAGEPIXEL *pPixels1
+            const IMAGEPIXEL *pPixels2
+              Pixel arrays
+            int count
+              Pixels to compare (1-32)
+            int tolerance
+              Max difference per color channel (0-255)
+
+  Returns:  uint32_t
+              Bit n is set, when pPixels1[n] and pPixels2[n] form an edge
+
+-----------------------------------------------------------------F-F*/
+static uint32_t getEdgeMaskScalar(const IMAGEPIXEL* pPixels1, const IMAGEPIXEL* pPixels2, int count, int tolerance)
+{
+	uint32_t mask = 0;
+	for (int i = 0; i < count; i++)
+	{
+		if (isColorEdge(pPixels1[i], pPixels2[i], tolerance)) mask |= 1u << i;
+	}
+	return mask;
+}
+
+#ifdef SIMDX86
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getEdgeMaskSSE2
+
+  Summary:   Compares pixels of two pixel arrays 4 pixels at a time
+
+  Args:     See getEdgeMaskScalar
+
+  Returns:  uint32_t
+              Bit n is set, when pPixels1[n] and pPixels2[n] form an edge
+
+-----------------------------------------------------------------F-F*/
+SIMDSSE2FUNCTION static uint32_t getEdgeMaskSSE2(const IMAGEPIXEL* pPixels1, const IMAGEPIXEL* pPixels2, int count, int tolerance)
+{
+	const __m128i toleranceBytes = _mm_set1_epi8((char)tolerance);
+	const __m128i colorMask = _mm_set1_epi32(IMAGEPIXELCOLORMASK);
+	const __m128i zero = _mm_setzero_si128();
+	uint32_t mask = 0;
+	int i = 0;
+
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i pixels1 = _mm_loadu_si128((const __m128i*)(pPixels1 + i));
+		__m128i pixels2 = _mm_loadu_si128((const __m128i*)(pPixels2 + i));
+		// Absolute difference per byte, bytes above the tolerance are not zero
+		__m128i difference = _mm_or_si128(_mm_subs_epu8(pixels1, pixels2), _mm_subs_epu8(pixels2, pixels1));
+		__m128i aboveTolerance = _mm_and_si128(_mm_subs_epu8(difference, toleranceBytes), colorMask);
+		int equalLanes = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(aboveTolerance, zero)));
+		mask |= (uint32_t)(~equalLanes & 0xf) << i;
+	}
+	if (i < count) mask |= getEdgeMaskScalar(pPixels1 + i, pPixels2 + i, count - i, tolerance) << i;
+	return mask;
+}
+#endif
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getEdgeMask
+
+  Summary:   Compares pixels of two pixel arrays with the best supported kernel
+
+  Args:     See getEdgeMaskScalar
+            SIMDLEVEL level
+              Supported instruction set extension
+
+  Returns:  uint32_t
+              Bit n is set, when pPixels1[n] and pPixels2[n] form an edge
+
+-----------------------------------------------------------------F-F*/
+static inline uint32_t getEdgeMask(const IMAGEPIXEL* pPixels1, const IMAGEPIXEL* pPixels2, int count, int tolerance, SIMDLEVEL level)
+{
+#ifdef SIMDX86
+	if (level != simdLevelNone) return getEdgeMaskSSE2(pPixels1, pPixels2, count, tolerance);
+#endif
+	return getEdgeMaskScalar(pPixels1, pPixels2, count, tolerance);
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: buildEdgeIndex
+
+  Summary:   Builds the edge index for an image
+
+  Args:     const IMAGEBUFFER &image
+              Image buffer
+            int tolerance
+              Max difference per color channel for pixels without an edge (0-255)
+            EDGEINDEX &index
+              Edge index (call by ref)
+            const std::atomic<bool> *pCancel
+              Build will be canceled, when *pCancel gets true (default NULL)
+
+  Returns:  bool
+              true = success
+              false = failure, canceled or image has too many edges
+
+-----------------------------------------------------------------F-F*/
+bool buildEdgeIndex(const IMAGEBUFFER& image, int tolerance, EDGEINDEX& index, const std::atomic<bool>* pCancel)
+{
+	SIMDLEVEL level = getSIMDLevel();
+
+	index = EDGEINDEX();
+	if (!isImageValid(image) || (image.width > EDGEINDEXMAXSIZE) || (image.height > EDGEINDEXMAXSIZE)) return false;
+	if (tolerance < 0) tolerance = 0;
+	if (tolerance > 255) tolerance = 255;
+
+	index.width = image.width;
+	index.height = image.height;
+	index.tolerance = tolerance;
+
+	try {
+		// Rows in one pass, because the rows are processed in index order
+		index.rowStart.resize((size_t)image.height + 1);
+		for (int y = 0; y < image.height; y++)
+		{
+			if ((pCancel != NULL) && pCancel->load(std::memory_order_relaxed)) return false;
+			index.rowStart[y] = (uint32_t)index.rowEdges.size();
+			const IMAGEPIXEL* pRow = imageRow(image, y);
+			for (int x = 0; x < image.width - 1; x += 32)
+			{
+				int count = std::min(32, image.width - 1 - x);
+				uint32_t mask = getEdgeMask(pRow + x, pRow + x + 1, count, tolerance, level);
+				for (int bit = 0; mask != 0; bit++, mask >>= 1)
+				{
+					if (mask & 1) index.rowEdges.push_back((uint16_t)(x + bit));
+				}
+			}
+			if (index.rowEdges.size() > EDGEINDEXMAXEDGES) return false;
+		}
+		index.rowStart[image.height] = (uint32_t)index.rowEdges.size();
+		index.rowEdges.shrink_to_fit();
+
+		// Columns in two passes: Count edges per column, then fill in row order
+		std::vector<uint32_t> columnCount((size_t)image.width, 0);
+		size_t totalCount = 0;
+		for (int y = 0; y < image.height - 1; y++)
+		{
+			if ((pCancel != NULL) && pCancel->load(std::memory_order_relaxed)) return false;
+			const IMAGEPIXEL* pRow = imageRow(image, y);
+			const IMAGEPIXEL* pNextRow = imageRow(image, y + 1);
+			for (int x = 0; x < image.width; x += 32)
+			{
+				int count = std::min(32, image.width - x);
+				uint32_t mask = getEdgeMask(pRow + x, pNextRow + x, count, tolerance, level);
+				for (int bit = 0; mask != 0; bit++, mask >>= 1)
+				{
+					if (mask & 1)
+					{
+						columnCount[(size_t)x + bit]++;
+						totalCount++;
+					}
+				}
+			}
+			if (totalCount > EDGEINDEXMAXEDGES) return false;
+		}
+
+		index.columnStart.resize((size_t)image.width + 1);
+		uint32_t start = 0;
+		for (int x = 0; x < image.width; x++)
+		{
+			index.columnStart[x] = start;
+			start += columnCount[x];
+			columnCount[x] = index.columnStart[x]; // Reused as fill position
+		}
+		index.columnStart[image.width] = start;
+		index.columnEdges.resize(totalCount);
+
+		for (int y = 0; y < image.height - 1; y++)
+		{
+			if ((pCancel != NULL) && pCancel->load(std::memory_order_relaxed)) return false;
+			const IMAGEPIXEL* pRow = imageRow(image, y);
+			const IMAGEPIXEL* pNextRow = imageRow(image, y + 1);
+			for (int x = 0; x < image.width; x += 32)
+			{
+				int count = std::min(32, image.width - x);
+				uint32_t mask = getEdgeMask(pRow + x, pNextRow + x, count, tolerance, level);
+				for (int bit = 0; mask != 0; bit++, mask >>= 1)
+				{
+					if (mask & 1) index.columnEdges[columnCount[(size_t)x + bit]++] = (uint16_t)y;
+				}
+			}
+		}
+	}
+	catch (...) { // Out of memory
+		index = EDGEINDEX();
+		return false;
+	}
+	return true;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: findEdge
+
+  Summary:   Searches from a start position in one direction for the last pixel
+             before the next edge or the border of the image
+
+  Args:     const EDGEINDEX &index
+              Edge index
+            int x
+            int y
+              Start position (must be inside the image)
+            int directionX
+            int directionY
+              Direction (one of them must be -1 or 1, the other 0)
+
+  Returns:  int
+              Last x (horizontal search) or y (vertical search) before the next edge
+
+-----------------------------------------------------------------F-F*/
+int findEdge(const EDGEINDEX& index, int x, int y, int directionX, int directionY)
+{
+	int position = (directionX != 0) ? x : y;
+	if ((x < 0) || (x >= index.width) || (y < 0) || (y >= index.height)) return position;
+
+	const uint16_t* pFirst;
+	const uint16_t* pLast;
+	int size;
+	int direction;
+	if (directionX != 0)
+	{
+		pFirst = index.rowEdges.data() + index.rowStart[y];
+		pLast = index.rowEdges.data() + index.rowStart[(size_t)y + 1];
+		size = index.width;
+		direction = directionX;
+	}
+	else
+	{
+		pFirst = index.columnEdges.data() + index.columnStart[x];
+		pLast = index.columnEdges.data() + index.columnStart[(size_t)x + 1];
+		size = index.height;
+		direction = directionY;
+	}
+
+	if (direction > 0)
+	{
+		// First edge e >= position (between pixel e and e+1)
+		const uint16_t* pEdge = std::lower_bound(pFirst, pLast, (uint16_t)position);
+		return (pEdge == pLast) ? size - 1 : *pEdge;
+	}
+	if (position == 0) return 0;
+	// Last edge e < position (between pixel e and e+1 <= position)
+	const uint16_t* pEdge = std::lower_bound(pFirst, pLast, (uint16_t)position);
+	return (pEdge == pFirst) ? 0 : *(pEdge - 1) + 1;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: findEdgeByScan
+
+  Summary:   Same as findEdge, but without index by scanning the image
+
+  Args:     const IMAGEBUFFER &image
+              Image buffer
+            int tolerance
+              Max difference per color channel for pixels without an edge (0-255)
+            int x
+            int y
+              Start position (must be inside the image)
+            int directionX
+            int directionY
+              Direction (one of them must be -1 or 1, the other 0)
+
+  Returns:  int
+              Last x (horizontal search) or y (vertical search) before the next edge
+
+-----------------------------------------------------------------F-F*/
+int findEdgeByScan(const IMAGEBUFFER& image, int tolerance, int x, int y, int directionX, int directionY)
+{
+	if (tolerance <= 0) return findColorChange(image, x, y, directionX, directionY);
+
+	int position = (directionX != 0) ? x : y;
+	if (!isImageValid(image) || (x < 0) || (x >= image.width) || (y < 0) || (y >= image.height)) return position;
+
+	while (true)
+	{
+		int nextX = (directionX != 0) ? position + directionX : x;
+		int nextY = (directionX != 0) ? y : position + directionY;
+		if ((nextX < 0) || (nextX >= image.width) || (nextY < 0) || (nextY >= image.height)) break;
+		int currentX = (directionX != 0) ? position : x;
+		int currentY = (directionX != 0) ? y : position;
+		if (isColorEdge(getImagePixel(image, currentX, currentY), getImagePixel(image, nextX, nextY), tolerance)) break;
+		position += (directionX != 0) ? directionX : directionY;
+	}
+	return position;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: stopEdgeIndexBuild
+
+  Summary:   Cancels a running background build and discards the edge index.
+             Must be called before the pixels of the image are changed or freed.
+
+  Args:
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void stopEdgeIndexBuild()
+{
+	g_cancelBuild = true;
+	if (g_buildThread.joinable()) g_buildThread.join();
+	g_edgeIndexReady = false;
+	g_edgeIndex = EDGEINDEX();
+	g_cancelBuild = false;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: startEdgeIndexBuild
+
+  Summary:   Starts building the edge index for an image in a background thread.
+             The image must not be changed or freed until stopEdgeIndexBuild is called.
+
+  Args:     const IMAGEBUFFER &image
+              Image buffer
+            int tolerance
+              Max difference per color channel for pixels without an edge (0-255)
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void startEdgeIndexBuild(const IMAGEBUFFER& image, int tolerance)
+{
+	stopEdgeIndexBuild();
+	if (!isImageValid(image)) return;
+
+	try {
+		g_buildThread = std::thread([image, tolerance] {
+			if (buildEdgeIndex(image, tolerance, g_edgeIndex, &g_cancelBuild))
+				g_edgeIndexReady = true;
+			else
+				g_edgeIndex = EDGEINDEX(); // Free memory of an incomplete index
+		});
+	}
+	catch (...) { // No thread => Callers fall back to findEdgeByScan
+	}
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getEdgeIndex
+
+  Summary:   Gets the edge index of the last started background build
+
+  Args:
+
+  Returns:  const EDGEINDEX*
+              NULL = Build is not finished, failed or was canceled
+
+-----------------------------------------------------------------F-F*/
+const EDGEINDEX* getEdgeIndex()
+{
+	return g_edgeIndexReady ? &g_edgeIndex : NULL;
+}
@@ -0,0 +1,39 @@
+/*+===================================================================
+  File:      edgeIndex.h
+
+  Summary:   Index of color edges for each row and column of an image buffer to
+             find the next color change with a binary search.
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#pragma once
+
+#include "imageBuffer.h"
+#include <atomic>
+#include <vector>
+
+#define EDGEINDEXMAXSIZE 65536 // Max width and height of an image for the edge index (positions are stored as 16 bit values)
+#define EDGEINDEXMAXEDGES (16 * 1024 * 1024) // Max edges per direction (limits memory usage to 32 MB per direction)
+
+// Edge positions of all rows and columns in compressed sparse row format.
+// Edge e in a row means pixel e and pixel e+1 have different colors (same for columns).
+struct EDGEINDEX {
+	int width = 0; // Width of the image
+	int height = 0; // Height of the image
+	int tolerance = 0; // Max difference per color channel for pixels without an edge
+	std::vector<uint32_t> rowStart; // First entry in rowEdges for each row (height + 1 entries)
+	std::vector<uint16_t> rowEdges; // Sorted x positions of the edges of all rows
+	std::vector<uint32_t> columnStart; // First entry in columnEdges for each column (width + 1 entries)
+	std::vector<uint16_t> columnEdges; // Sorted y positions of the edges of all columns
+};
+
+bool isColorEdge(IMAGEPIXEL color1, IMAGEPIXEL color2, int tolerance);
+bool buildEdgeIndex(const IMAGEBUFFER& image, int tolerance, EDGEINDEX& index, const std::atomic<bool>* pCancel = NULL);
+int findEdge(const EDGEINDEX& index, int x, int y, int directionX, int directionY);
+int findEdgeByScan(const IMAGEBUFFER& image, int tolerance, int x, int y, int directionX, int directionY);
+void startEdgeIndexBuild(const IMAGEBUFFER& image, int tolerance);
+void stopEdgeIndexBuild();
+const EDGEINDEX* getEdgeIndex();
@@ -0,0 +1,415 @@
+/*+===================================================================
+  File:      imageBuffer.cpp
+
+  Summary:   Platform independent 32bpp image buffer with stride aware sub-rect views.
+             Has no dependencies to the Win32-API and can be compiled on other
+             platforms to test and benchmark the image functions.
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "imageBuffer.h"
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#define IMAGEBUFFERALIGNMENT 64 // Alignment in bytes for the first pixel of allocated image buffers
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: createImageBuffer
+
+  Summary:   Allocates memory for an image buffer
+
+  Args:     IMAGEBUFFER &image
+              Image buffer (call by ref)
+            int width
+              Width in pixels
+            int height
+              Height in pixels
+
+  Returns:  bool
+              true = success
+              false = failure
+
+-----------------------------------------------------------------F-F*/
+bool createImageBuffer(IMAGEBUFFER& image, int width, int height)
+{
+	image = { 0 };
+	if ((width <= 0) || (height <= 0)) return false;
+
+	ptrdiff_t stride = (ptrdiff_t)width * IMAGEBYTESPERPIXEL;
+	size_t size = (size_t)stride * height + IMAGEBUFFERALIGNMENT;
+	void* pAllocation = malloc(size);
+	if (pAllocation == NULL) return false;
+
+	image.pAllocation = pAllocation;
+	image.pBits = (uint8_t*)(((uintptr_t)pAllocation + IMAGEBUFFERALIGNMENT - 1) & ~(uintptr_t)(IMAGEBUFFERALIGNMENT - 1));
+	image.width = width;
+	image.height = height;
+	image.stride = stride;
+	return true;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: freeImageBuffer
+
+  Summary:   Frees memory of an image buffer created by createImageBuffer and
+             resets the buffer (views and attached buffers are only reset)
+
+  Args:     IMAGEBUFFER &image
+              Image buffer (call by ref)
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void freeImageBuffer(IMAGEBUFFER& image)
+{
+	if (image.pAllocation != NULL) free(image.pAllocation);
+	image = { 0 };
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: attachImageBuffer
+
+  Summary:   Uses existing memory (for example the bits of a DIB section) as image buffer
+
+  Args:     IMAGEBUFFER &image
+              Image buffer (call by ref)
+            void *pBits
+              Upper left pixel
+            int width
+              Width in pixels
+            int height
+              Height in pixels
+            ptrdiff_t stride
+              Bytes from one row to the next row
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void attachImageBuffer(IMAGEBUFFER& image, void* pBits, int width, int height, ptrdiff_t stride)
+{
+	image = { 0 };
+	if ((pBits == NULL) || (width <= 0) || (height <= 0)) return;
+	image.pBits = (uint8_t*)pBits;
+	image.width = width;
+	image.height = height;
+	image.stride = stride;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getImageView
+
+  Summary:   Gets a view to a rectangle of an image (the rectangle will be clipped to the image).
+             The view shares the pixels with the image.
+
+  Args:     const IMAGEBUFFER &image
+              Image buffer
+            int x
+            int y
+              Upper left position of the rectangle
+            int width
+            int height
+              Size of the rectangle
+            IMAGEBUFFER &view
+              View (call by ref)
+
+  Returns:  bool
+              true = success
+              false = rectangle is outside of the image
+
+-----------------------------------------------------------------F-F*/
+bool getImageView(const IMAGEBUFFER& image, int x, int y, int width, int height, IMAGEBUFFER& view)
+{
+	view = { 0 };
+	if (!isImageValid(image)) return false;
+
+	if (x < 0) { width += x; x = 0; }
+	if (y < 0) { height += y; y = 0; }
+	if (x + width > image.width) width = image.width - x;
+	if (y + height > image.height) height = image.height - y;
+	if ((width <= 0) || (height <= 0)) return false;
+
+	view.pBits = image.pBits + (ptrdiff_t)y * image.stride + (ptrdiff_t)x * IMAGEBYTESPERPIXEL;
+	view.width = width;
+	view.height = height;
+	view.stride = image.stride;
+	return true;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: normalizeImageRect
+
+  Summary:   "normalize" rectangle to ensure, that .left is the left side and .top is on the upper side
+
+  Args:     IMAGERECT rect
+              Rectangle to be normalized
+
+  Returns:  IMAGERECT
+              Normalized rectangle
+
+-----------------------------------------------------------------F-F*/
+IMAGERECT normalizeImageRect(IMAGERECT rect)
+{
+	IMAGERECT result = rect;
+	if (rect.right < rect.left)
+	{
+		result.left = rect.right;
+		result.right = rect.left;
+	}
+	if (rect.bottom < rect.top)
+	{
+		result.top = rect.bottom;
+		result.bottom = rect.top;
+	}
+	return result;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getImageViewFromRect
+
+  Summary:   Gets a view to a rectangle with inclusive coordinates (like a selection)
+
+  Args:     const IMAGEBUFFER &image
+              Image buffer
+            IMAGERECT rect
+              Rectangle with inclusive coordinates (need not to be normalized)
+            IMAGEBUFFER &view
+              View (call by ref)
+
+  Returns:  bool
+              true = success
+              false = rectangle is outside of the image
+
+-----------------------------------------------------------------F-F*/
+bool getImageViewFromRect(const IMAGEBUFFER& image, IMAGERECT rect, IMAGEBUFFER& view)
+{
+	rect = normalizeImageRect(rect);
+	return getImageView(image, rect.left, rect.top, rect.right - rect.left + 1, rect.bottom - rect.top + 1, view);
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: copyImage
+
+  Summary:   Copies pixels from source to target (the common upper left area of both)
+
+  Args:     const IMAGEBUFFER &target
+              Target image buffer or view
+            const IMAGEBUFFER &source
+              Source image buffer or view
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void copyImage(const IMAGEBUFFER& target, const IMAGEBUFFER& source)
+{
+	if (!isImageValid(target) || !isImageValid(source)) return;
+
+	int width = (target.width < source.width) ? target.width : source.width;
+	int height = (target.height < source.height) ? target.height : source.height;
+	size_t rowSize = (size_t)width * IMAGEBYTESPERPIXEL;
+
+	for (int y = 0; y < height; y++)
+	{
+		memmove(imageRow(target, y), imageRow(source, y), rowSize);
+	}
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: fillImage
+
+  Summary:   Fills all pixels with a color
+
+  Args:     const IMAGEBUFFER &image
+              Image buffer or view
+            IMAGEPIXEL color
+              Color
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void fillImage(const IMAGEBUFFER& image, IMAGEPIXEL color)
+{
+	if (!isImageValid(image)) return;
+
+	for (int y = 0; y < image.height; y++)
+	{
+		IMAGEPIXEL* pRow = imageRow(image, y);
+		for (int x = 0; x < image.width; x++) pRow[x] = color;
+	}
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: blendImage
+
+  Summary:   Blends a color with a constant alpha over all pixels
+             (same as AlphaBlend with SourceConstantAlpha and a filled source)
+
+  Args:     const IMAGEBUFFER &image
+              Image buffer or view
+            IMAGEPIXEL color
+              Color
+            uint8_t alpha
+              Alpha value for the color (0 = transparent, 255 = opaque)
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void blendImage(const IMAGEBUFFER& image, IMAGEPIXEL color, uint8_t alpha)
+{
+	if (!isImageValid(image)) return;
+
+	uint32_t inverseAlpha = 255 - alpha;
+	uint32_t blendR = ((color >> 16) & 0xff) * alpha + 127;
+	uint32_t blendG = ((color >> 8) & 0xff) * alpha + 127;
+	uint32_t blendB = (color & 0xff) * alpha + 127;
+
+	for (int y = 0; y < image.height; y++)
+	{
+		IMAGEPIXEL* pRow = imageRow(image, y);
+		for (int x = 0; x < image.width; x++)
+		{
+			IMAGEPIXEL pixel = pRow[x];
+			uint32_t r = (((pixel >> 16) & 0xff) * inverseAlpha + blendR) / 255;
+			uint32_t g = (((pixel >> 8) & 0xff) * inverseAlpha + blendG) / 255;
+			uint32_t b = ((pixel & 0xff) * inverseAlpha + blendB) / 255;
+			pRow[x] = IMAGEPIXELRGB(r, g, b);
+		}
+	}
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: frameImageRect
+
+  Summary:   Blends a color over the frame between an outer and an inner rectangle
+
+  Args:     const IMAGEBUFFER &image
+              Image buffer
+            IMAGERECT outer
+              Outer rectangle with inclusive coordinates
+            IMAGERECT inner
+              Inner rectangle with inclusive coordinates (stays unchanged, can be empty)
+            IMAGEPIXEL color
+              Color
+            uint8_t alpha
+              Alpha value for the color
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void frameImageRect(const IMAGEBUFFER& image, IMAGERECT outer, IMAGERECT inner, IMAGEPIXEL color, uint8_t alpha)
+{
+	IMAGEBUFFER view;
+
+	outer = normalizeImageRect(outer);
+	if ((inner.right < inner.left) || (inner.bottom < inner.top)) // No inner area
+	{
+		if (getImageViewFromRect(image, outer, view)) blendImage(view, color, alpha);
+		return;
+	}
+
+	// Top and bottom
+	if (getImageView(image, outer.left, outer.top, outer.right - outer.left + 1, inner.top - outer.top, view)) blendImage(view, color, alpha);
+	if (getImageView(image, outer.left, inner.bottom + 1, outer.right - outer.left + 1, outer.bottom - inner.bottom, view)) blendImage(view, color, alpha);
+	// Left and right
+	if (getImageView(image, outer.left, inner.top, inner.left - outer.left, inner.bottom - inner.top + 1, view)) blendImage(view, color, alpha);
+	if (getImageView(image, inner.right + 1, inner.top, outer.right - inner.right, inner.bottom - inner.top + 1, view)) blendImage(view, color, alpha);
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: zoomImage
+
+  Summary:   Enlarges an area of an image by an integer scale (nearest neighbor) to
+             another position of the same image. Source pixels outside of the image
+             are black and target pixels outside of the image will be clipped.
+
+  Args:     const IMAGEBUFFER &image
+              Image buffer
+            int sourceX
+            int sourceY
+              Upper left position of the source area
+            int sourceWidth
+            int sourceHeight
+              Size of the source area
+            int targetX
+            int targetY
+              Upper left position of the enlarged area
+            int scale
+              Zoom scale
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void zoomImage(const IMAGEBUFFER& image, int sourceX, int sourceY, int sourceWidth, int sourceHeight, int targetX, int targetY, int scale)
+{
+	if (!isImageValid(image) || (sourceWidth <= 0) || (sourceHeight <= 0) || (scale < 1)) return;
+
+	// Copy source area first, because source and target can overlap
+	std::vector<IMAGEPIXEL> source((size_t)sourceWidth * sourceHeight, 0);
+	for (int y = 0; y < sourceHeight; y++)
+	{
+		if ((sourceY + y < 0) || (sourceY + y >= image.height)) continue;
+		IMAGEPIXEL* pRow = imageRow(image, sourceY + y);
+		for (int x = 0; x < sourceWidth; x++)
+		{
+			if ((sourceX + x < 0) || (sourceX + x >= image.width)) continue;
+			source[(size_t)y * sourceWidth + x] = pRow[sourceX + x];
+		}
+	}
+
+	IMAGEBUFFER target;
+	if (!getImageView(image, targetX, targetY, sourceWidth * scale, sourceHeight * scale, target)) return;
+	int offsetX = (targetX < 0) ? -targetX : 0; // Clipped pixels on the left side
+	int offsetY = (targetY < 0) ? -targetY : 0; // Clipped pixels on the upper side
+
+	for (int y = 0; y < target.height; y++)
+	{
+		const IMAGEPIXEL* pSourceRow = &source[(size_t)((y + offsetY) / scale) * sourceWidth];
+		IMAGEPIXEL* pRow = imageRow(target, y);
+		for (int x = 0; x < target.width; x++) pRow[x] = pSourceRow[(x + offsetX) / scale];
+	}
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: hashImage
+
+  Summary:   Gets a 64 bit FNV-1a based hash of the size and the pixel colors
+             (ignoring the upper byte) to find equal images. Four pixels are
+             hashed in parallel lanes, which are combined at the end.
+
+  Args:     const IMAGEBUFFER &image
+              Image buffer or view
+
+  Returns:  uint64_t
+              Hash (0 for an invalid image)
+
+-----------------------------------------------------------------F-F*/
+uint64_t hashImage(const IMAGEBUFFER& image)
+{
+	const uint64_t prime = 0x100000001B3ull;
+	const uint64_t offset = 0xCBF29CE484222325ull;
+	if (!isImageValid(image)) return 0;
+
+	uint64_t lanes[4] = { offset, offset ^ 1, offset ^ 2, offset ^ 3 };
+	for (int y = 0; y < image.height; y++)
+	{
+		const IMAGEPIXEL* pRow = imageRow(image, y);
+		int x = 0;
+		for (; x + 4 <= image.width; x += 4)
+		{
+			lanes[0] = (lanes[0] ^ (pRow[x] & IMAGEPIXELCOLORMASK)) * prime;
+			lanes[1] = (lanes[1] ^ (pRow[x + 1] & IMAGEPIXELCOLORMASK)) * prime;
+			lanes[2] = (lanes[2] ^ (pRow[x + 2] & IMAGEPIXELCOLORMASK)) * prime;
+			lanes[3] = (lanes[3] ^ (pRow[x + 3] & IMAGEPIXELCOLORMASK)) * prime;
+		}
+		for (; x < image.width; x++) lanes[0] = (lanes[0] ^ (pRow[x] & IMAGEPIXELCOLORMASK)) * prime;
+	}
+
+	uint64_t hash = offset;
+	hash = (hash ^ (uint32_t)image.width) * prime;
+	hash = (hash ^ (uint32_t)image.height) * prime;
+	for (uint64_t lane : lanes) hash = (hash ^ lane ^ (lane >> 32)) * prime;
+	return hash;
+}
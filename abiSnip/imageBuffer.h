@@ -0,0 +1,107 @@
+/*+===================================================================
+  File:      imageBuffer.h
+
+  Summary:   Platform independent 32bpp image buffer with stride aware sub-rect views.
+             Pixels are stored as 32 bit values with the byte order B,G,R,X
+             (same as a 32bpp top-down Windows DIB section), so a buffer can be
+             attached directly to the bits of a DIB section.
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Pixel value 0x00RRGGBB (the upper byte is undefined in screenshots and will be ignored)
+typedef uint32_t IMAGEPIXEL;
+
+#define IMAGEPIXELRGB(r,g,b) ((IMAGEPIXEL)((((uint32_t)(r) & 0xff) << 16) | (((uint32_t)(g) & 0xff) << 8) | ((uint32_t)(b) & 0xff)))
+#define IMAGEPIXELCOLORMASK 0x00FFFFFF // Mask for the color bytes of a pixel
+#define IMAGEBYTESPERPIXEL 4 // Bytes per pixel
+
+// Image buffer or view to a rectangle of an image buffer
+struct IMAGEBUFFER {
+	uint8_t* pBits; // Upper left pixel
+	int width; // Width in pixels
+	int height; // Height in pixels
+	ptrdiff_t stride; // Bytes from one row to the next row
+	void* pAllocation; // Memory allocated by createImageBuffer (NULL for views and attached memory)
+};
+
+// Rectangle with inclusive coordinates like the selections in abiSnip.cpp
+struct IMAGERECT {
+	int left;
+	int top;
+	int right;
+	int bottom;
+};
+
+bool createImageBuffer(IMAGEBUFFER& image, int width, int height);
+void freeImageBuffer(IMAGEBUFFER& image);
+void attachImageBuffer(IMAGEBUFFER& image, void* pBits, int width, int height, ptrdiff_t stride);
+bool getImageView(const IMAGEBUFFER& image, int x, int y, int width, int height, IMAGEBUFFER& view);
+bool getImageViewFromRect(const IMAGEBUFFER& image, IMAGERECT rect, IMAGEBUFFER& view);
+IMAGERECT normalizeImageRect(IMAGERECT rect);
+void copyImage(const IMAGEBUFFER& target, const IMAGEBUFFER& source);
+void fillImage(const IMAGEBUFFER& image, IMAGEPIXEL color);
+void blendImage(const IMAGEBUFFER& image, IMAGEPIXEL color, uint8_t alpha);
+void frameImageRect(const IMAGEBUFFER& image, IMAGERECT outer, IMAGERECT inner, IMAGEPIXEL color, uint8_t alpha);
+void zoomImage(const IMAGEBUFFER& image, int sourceX, int sourceY, int sourceWidth, int sourceHeight, int targetX, int targetY, int scale);
+uint64_t hashImage(const IMAGEBUFFER& image);
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: imageRow
+
+  Summary:   Gets pointer to the first pixel of a row (without range check)
+
+  Args:     const IMAGEBUFFER &image
+              Image buffer
+            int y
+              Row
+
+  Returns:  IMAGEPIXEL*
+
+-----------------------------------------------------------------F-F*/
+inline IMAGEPIXEL* imageRow(const IMAGEBUFFER& image, int y)
+{
+	return (IMAGEPIXEL*)(image.pBits + (ptrdiff_t)y * image.stride);
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getImagePixel
+
+  Summary:   Gets color of a pixel without the undefined upper byte
+
+  Args:     const IMAGEBUFFER &image
+              Image buffer
+            int x
+            int y
+              Pixel position (must be inside the image)
+
+  Returns:  IMAGEPIXEL
+
+-----------------------------------------------------------------F-F*/
+inline IMAGEPIXEL getImagePixel(const IMAGEBUFFER& image, int x, int y)
+{
+	return imageRow(image, y)[x] & IMAGEPIXELCOLORMASK;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: isImageValid
+
+  Summary:   Checks if image buffer has pixels
+
+  Args:     const IMAGEBUFFER &image
+              Image buffer
+
+  Returns:  bool
+
+-----------------------------------------------------------------F-F*/
+inline bool isImageValid(const IMAGEBUFFER& image)
+{
+	return (image.pBits != NULL) && (image.width > 0) && (image.height > 0);
+}
@@ -0,0 +1,241 @@
+/*+===================================================================
+  File:      imageRLE.cpp
+
+  Summary:   Run-length encoding for image buffers. Screenshots of desktops,
+             dialogs and editors have long runs of equal pixels and shrink
+             to a fraction of the raw size, photos are stored uncompressed.
+
+             Has no dependencies to the Win32-API and can be compiled on other
+             platforms to test the encoding.
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "imageRLE.h"
+#include <new>
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getRunLength
+
+  Summary:   Gets number of equal pixels (ignoring the upper byte) starting
+             at a position of a row
+
+  Args:     const IMAGEPIXEL* pRow
+              First pixel of the row
+            int x
+              Start position
+            int width
+              Width of the row
+
+  Returns:  int
+
+-----------------------------------------------------------------F-F*/
+static int getRunLength(const IMAGEPIXEL* pRow, int x, int width)
+{
+	IMAGEPIXEL color = pRow[x] & IMAGEPIXELCOLORMASK;
+	int end = x + 1;
+	while ((end < width) && ((pRow[end] & IMAGEPIXELCOLORMASK) == color)) end++;
+	return end - x;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: encodeImageRLE
+
+  Summary:   Encodes the rows of an image to packets or counts the size of
+             the packets
+
+  Args:     const IMAGEBUFFER &image
+              Image or view
+            uint32_t* pData
+              Target for the packets or NULL to count only
+
+  Returns:  size_t
+              Number of uint32_t values of the packets
+
+-----------------------------------------------------------------F-F*/
+static size_t encodeImageRLE(const IMAGEBUFFER& image, uint32_t* pData)
+{
+	size_t pos = 0;
+	for (int y = 0; y < image.height; y++)
+	{
+		const IMAGEPIXEL* pRow = imageRow(image, y);
+		int x = 0;
+		while (x < image.width)
+		{
+			int run = getRunLength(pRow, x, image.width);
+			if (run >= IMAGERLEMINRUN)
+			{
+				if (pData != NULL)
+				{
+					pData[pos] = IMAGERLERUNFLAG | (uint32_t)run;
+					pData[pos + 1] = pRow[x] & IMAGEPIXELCOLORMASK;
+				}
+				pos += 2;
+				x += run;
+				continue;
+			}
+
+			// Literal pixels until the next run
+			size_t header = pos++;
+			int start = x;
+			while ((x < image.width) && (getRunLength(pRow, x, image.width) < IMAGERLEMINRUN))
+			{
+				if (pData != NULL) pData[pos] = pRow[x] & IMAGEPIXELCOLORMASK;
+				pos++;
+				x++;
+			}
+			if (pData != NULL) pData[header] = (uint32_t)(x - start);
+		}
+	}
+	return pos;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: compressImageRLE
+
+  Summary:   Creates a run-length encoded copy of an image or view. The
+             size of the packets is counted first, so the data is allocated
+             once. When the packets would not be smaller than the pixels,
+             the pixels are stored uncompressed.
+
+  Args:     const IMAGEBUFFER &image
+              Image or view
+            RLEIMAGE &rle
+              Encoded image (call by ref)
+
+  Returns:  bool
+              true = success
+              false = failure (invalid image or out of memory, rle is empty)
+
+-----------------------------------------------------------------F-F*/
+bool compressImageRLE(const IMAGEBUFFER& image, RLEIMAGE& rle)
+{
+	freeRLEImage(rle);
+	if (!isImageValid(image)) return false;
+
+	size_t rawSize = (size_t)image.width * image.height;
+	size_t size = encodeImageRLE(image, NULL);
+	try {
+		if (size < rawSize)
+		{
+			rle.data.resize(size);
+			encodeImageRLE(image, rle.data.data());
+		}
+		else
+		{ // Packets would not save memory
+			rle.data.resize(rawSize);
+			uint32_t* pData = rle.data.data();
+			for (int y = 0; y < image.height; y++)
+			{
+				const IMAGEPIXEL* pRow = imageRow(image, y);
+				for (int x = 0; x < image.width; x++) *pData++ = pRow[x] & IMAGEPIXELCOLORMASK;
+			}
+			rle.raw = true;
+		}
+	}
+	catch (const std::bad_alloc&) {
+		freeRLEImage(rle);
+		return false;
+	}
+
+	rle.width = image.width;
+	rle.height = image.height;
+	return true;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: decompressImageRLE
+
+  Summary:   Restores a run-length encoded image
+
+  Args:     const RLEIMAGE &rle
+              Encoded image
+            const IMAGEBUFFER &image
+              Target image or view with the size of the encoded image
+
+  Returns:  bool
+              true = success
+              false = failure (size mismatch or corrupt data)
+
+-----------------------------------------------------------------F-F*/
+bool decompressImageRLE(const RLEIMAGE& rle, const IMAGEBUFFER& image)
+{
+	if (!isImageValid(image) || (image.width != rle.width) || (image.height != rle.height)) return false;
+
+	size_t pos = 0;
+	size_t size = rle.data.size();
+	if (rle.raw)
+	{
+		if (size != (size_t)image.width * image.height) return false;
+		for (int y = 0; y < image.height; y++)
+		{
+			IMAGEPIXEL* pRow = imageRow(image, y);
+			for (int x = 0; x < image.width; x++) pRow[x] = rle.data[pos++];
+		}
+		return true;
+	}
+
+	for (int y = 0; y < image.height; y++)
+	{
+		IMAGEPIXEL* pRow = imageRow(image, y);
+		int x = 0;
+		while (x < image.width)
+		{
+			if (pos >= size) return false;
+			uint32_t header = rle.data[pos++];
+			uint32_t count = header & IMAGERLEMAXCOUNT;
+			if ((count == 0) || (count > (uint32_t)(image.width - x))) return false;
+
+			if (header & IMAGERLERUNFLAG)
+			{
+				if (pos >= size) return false;
+				IMAGEPIXEL color = rle.data[pos++];
+				for (uint32_t i = 0; i < count; i++) pRow[x++] = color;
+			}
+			else
+			{
+				if (count > size - pos) return false;
+				for (uint32_t i = 0; i < count; i++) pRow[x++] = rle.data[pos++];
+			}
+		}
+	}
+	return pos == size;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: freeRLEImage
+
+  Summary:   Frees memory of an encoded image
+
+  Args:     RLEIMAGE &rle
+              Encoded image (call by ref)
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void freeRLEImage(RLEIMAGE& rle)
+{
+	std::vector<uint32_t>().swap(rle.data);
+	rle.width = 0;
+	rle.height = 0;
+	rle.raw = false;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getRLEImageBytes
+
+  Summary:   Gets memory used by an encoded image
+
+  Args:     const RLEIMAGE &rle
+              Encoded image
+
+  Returns:  size_t
+              Bytes
+
+-----------------------------------------------------------------F-F*/
+size_t getRLEImageBytes(const RLEIMAGE& rle)
+{
+	return rle.data.capacity() * sizeof(uint32_t);
+}
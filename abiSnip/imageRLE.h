@@ -0,0 +1,34 @@
+/*+===================================================================
+  File:      imageRLE.h
+
+  Summary:   Run-length encoded copy of an image buffer, used to keep the last
+             capture with less memory while the program waits in the tray.
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#pragma once
+
+#include "imageBuffer.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#define IMAGERLERUNFLAG 0x80000000u // Packet header flag for a run (one pixel follows), otherwise literal pixels follow
+#define IMAGERLEMAXCOUNT 0x7FFFFFFFu // Max pixels per packet
+#define IMAGERLEMINRUN 3 // Min equal pixels for a run packet
+
+// Run-length encoded image. Packets do not cross rows and pixels are stored without the undefined upper byte.
+struct RLEIMAGE {
+	std::vector<uint32_t> data; // Packets: header (pixel count | IMAGERLERUNFLAG for runs) followed by the pixels, or the pixels when raw is true
+	int width = 0; // Width in pixels
+	int height = 0; // Height in pixels
+	bool raw = false; // true = pixels are stored uncompressed, because the packets would not be smaller
+};
+
+bool compressImageRLE(const IMAGEBUFFER& image, RLEIMAGE& rle);
+bool decompressImageRLE(const RLEIMAGE& rle, const IMAGEBUFFER& image);
+void freeRLEImage(RLEIMAGE& rle);
+size_t getRLEImageBytes(const RLEIMAGE& rle);
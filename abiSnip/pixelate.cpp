@@ -0,0 +1,436 @@
+/*+===================================================================
+  File:      pixelate.cpp
+
+  Summary:   Pixelation engine for image buffers. Each block of blockSize x blockSize
+             pixels is replaced in place by its rounded average color. Blocks at
+             the right and bottom border can be smaller than blockSize.
+
+             The SIMD kernels sum each block row column wise into 16 bit values
+             (in registers over a strip of pixels), reduce the column sums per
+             block and fill the block rows with the average color. All kernels
+             use integer arithmetic and give identical results.
+
+             Large images are split into bands of whole block rows, which are
+             pixelated in parallel by the worker pool. Bands never share a block,
+             so the result does not depend on the number of threads.
+
+             Has no dependencies to the Win32-API and can be compiled on other
+             platforms to test and benchmark the kernels.
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "pixelate.h"
+#include "simd.h"
+#include "workerPool.h"
+#include <vector>
+
+// Functions of a SIMD kernel
+struct PIXELATEFUNCTIONS {
+	void (*sumBlockRow)(const IMAGEBUFFER& image, int blockY, int blockHeight, uint16_t* pColumnSums); // Column wise sums of a block row
+	void (*fillPixels)(IMAGEPIXEL* pPixels, int count, IMAGEPIXEL color); // Fill pixels with a color
+};
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: averageColor
+
+  Summary:   Gets rounded average color from the channel sums of a block
+
+  Args:     const uint32_t sums[4]
+              Sums of the channels B,G,R,X
+            uint32_t count
+              Pixels in the block
+
+  Returns:  IMAGEPIXEL
+
+-----------------------------------------------------------------F-F*/
+static inline IMAGEPIXEL averageColor(const uint32_t sums[4], uint32_t count)
+{
+	return IMAGEPIXELRGB((sums[2] + count / 2) / count, (sums[1] + count / 2) / count, (sums[0] + count / 2) / count);
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: pixelateBlockRowScalar
+
+  Summary:   Pixelates one block row with plain C++ (reference kernel)
+
+  Args:     const IMAGEBUFFER &image
+              Image buffer or view
+            int blockSize
+              Width of a block in pixels
+            int blockY
+              First row of the block row
+            int blockHeight
+              Rows in the block row
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+static void pixelateBlockRowScalar(const IMAGEBUFFER& image, int blockSize, int blockY, int blockHeight)
+{
+	for (int blockX = 0; blockX < image.width; blockX += blockSize)
+	{
+		int blockWidth = (blockX + blockSize > image.width) ? image.width - blockX : blockSize;
+		uint32_t sums[4] = { 0 };
+
+		for (int y = blockY; y < blockY + blockHeight; y++)
+		{
+			IMAGEPIXEL* pRow = imageRow(image, y);
+			for (int x = blockX; x < blockX + blockWidth; x++)
+			{
+				sums[0] += pRow[x] & 0xff;
+				sums[1] += (pRow[x] >> 8) & 0xff;
+				sums[2] += (pRow[x] >> 16) & 0xff;
+			}
+		}
+
+		IMAGEPIXEL average = averageColor(sums, (uint32_t)(blockWidth * blockHeight));
+		for (int y = blockY; y < blockY + blockHeight; y++)
+		{
+			IMAGEPIXEL* pRow = imageRow(image, y);
+			for (int x = blockX; x < blockX + blockWidth; x++) pRow[x] = average;
+		}
+	}
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: sumColumnsScalar
+
+  Summary:   Sums channels of column sums for one block
+
+  Args:     const uint16_t *pColumnSums
+              First column sum (4 channels per column)
+            int count
+              Columns
+            uint32_t sums[4]
+              Sums of the channels B,G,R,X
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+static void sumColumnsScalar(const uint16_t* pColumnSums, int count, uint32_t sums[4])
+{
+	for (int i = 0; i < count; i++)
+	{
+		for (int channel = 0; channel < 4; channel++) sums[channel] += pColumnSums[i * 4 + channel];
+	}
+}
+
+#ifdef SIMDX86
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: sumBlockRowSSE2
+
+  Summary:   Sums the channels of each column over the rows of a block row.
+             Sums are accumulated in registers for a strip of 8 pixels.
+
+  Args:     const IMAGEBUFFER &image
+              Image buffer or view
+            int blockY
+              First row of the block row
+            int blockHeight
+              Rows in the block row (<= PIXELATEMAXBLOCKSIZE)
+            uint16_t *pColumnSums
+              Column sums with 4 channels for each pixel of a row
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+SIMDSSE2FUNCTION static void sumBlockRowSSE2(const IMAGEBUFFER& image, int blockY, int blockHeight, uint16_t* pColumnSums)
+{
+	const __m128i zero = _mm_setzero_si128();
+	int x = 0;
+
+	for (; x + 8 <= image.width; x += 8)
+	{
+		__m128i sum0 = zero, sum1 = zero, sum2 = zero, sum3 = zero;
+		const uint8_t* pPixels = image.pBits + (ptrdiff_t)blockY * image.stride + (ptrdiff_t)x * IMAGEBYTESPERPIXEL;
+		for (int y = 0; y < blockHeight; y++)
+		{
+			__m128i pixelsLow = _mm_loadu_si128((const __m128i*)pPixels);
+			__m128i pixelsHigh = _mm_loadu_si128((const __m128i*)(pPixels + 16));
+			sum0 = _mm_add_epi16(sum0, _mm_unpacklo_epi8(pixelsLow, zero));
+			sum1 = _mm_add_epi16(sum1, _mm_unpackhi_epi8(pixelsLow, zero));
+			sum2 = _mm_add_epi16(sum2, _mm_unpacklo_epi8(pixelsHigh, zero));
+			sum3 = _mm_add_epi16(sum3, _mm_unpackhi_epi8(pixelsHigh, zero));
+			pPixels += image.stride;
+		}
+		__m128i* pSums = (__m128i*)(pColumnSums + (ptrdiff_t)x * 4);
+		_mm_storeu_si128(pSums, sum0);
+		_mm_storeu_si128(pSums + 1, sum1);
+		_mm_storeu_si128(pSums + 2, sum2);
+		_mm_storeu_si128(pSums + 3, sum3);
+	}
+
+	// Remaining pixels
+	for (; x < image.width; x++)
+	{
+		uint16_t* pSums = pColumnSums + (ptrdiff_t)x * 4;
+		pSums[0] = pSums[1] = pSums[2] = pSums[3] = 0;
+		for (int y = blockY; y < blockY + blockHeight; y++)
+		{
+			IMAGEPIXEL pixel = imageRow(image, y)[x];
+			pSums[0] += pixel & 0xff;
+			pSums[1] += (pixel >> 8) & 0xff;
+			pSums[2] += (pixel >> 16) & 0xff;
+		}
+	}
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: sumColumnsSSE2
+
+  Summary:   Sums channels of column sums for one block
+
+  Args:     const uint16_t *pColumnSums
+              First column sum (4 channels per column)
+            int count
+              Columns
+            uint32_t sums[4]
+              Sums of the channels B,G,R,X
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+SIMDSSE2FUNCTION static void sumColumnsSSE2(const uint16_t* pColumnSums, int count, uint32_t sums[4])
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i sum = zero;
+	int i = 0;
+
+	for (; i + 2 <= count; i += 2)
+	{
+		__m128i columns = _mm_loadu_si128((const __m128i*)(pColumnSums + (ptrdiff_t)i * 4));
+		sum = _mm_add_epi32(sum, _mm_unpacklo_epi16(columns, zero));
+		sum = _mm_add_epi32(sum, _mm_unpackhi_epi16(columns, zero));
+	}
+	_mm_storeu_si128((__m128i*)sums, sum);
+	sumColumnsScalar(pColumnSums + (ptrdiff_t)i * 4, count - i, sums);
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: fillPixelsSSE2
+
+  Summary:   Fills pixels with a color
+
+  Args:     IMAGEPIXEL *pPixels
+              First pixel
+            int count
+              Pixels
+            IMAGEPIXEL color
+              Color
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+SIMDSSE2FUNCTION static void fillPixelsSSE2(IMAGEPIXEL* pPixels, int count, IMAGEPIXEL color)
+{
+	const __m128i colors = _mm_set1_epi32((int)color);
+	int i = 0;
+
+	for (; i + 4 <= count; i += 4) _mm_storeu_si128((__m128i*)(pPixels + i), colors);
+	for (; i < count; i++) pPixels[i] = color;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: sumBlockRowAVX2
+
+  Summary:   Sums the channels of each column over the rows of a block row.
+             Sums are accumulated in registers for a strip of 16 pixels.
+
+  Args:     const IMAGEBUFFER &image
+              Image buffer or view
+            int blockY
+              First row of the block row
+            int blockHeight
+              Rows in the block row (<= PIXELATEMAXBLOCKSIZE)
+            uint16_t *pColumnSums
+              Column sums with 4 channels for each pixel of a row
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+SIMDAVX2FUNCTION static void sumBlockRowAVX2(const IMAGEBUFFER& image, int blockY, int blockHeight, uint16_t* pColumnSums)
+{
+	int x = 0;
+
+	for (; x + 16 <= image.width; x += 16)
+	{
+		__m256i sum0 = _mm256_setzero_si256(), sum1 = sum0, sum2 = sum0, sum3 = sum0;
+		const uint8_t* pPixels = image.pBits + (ptrdiff_t)blockY * image.stride + (ptrdiff_t)x * IMAGEBYTESPERPIXEL;
+		for (int y = 0; y < blockHeight; y++)
+		{
+			// Zero extend 4 pixels to 16 channel values in pixel order
+			sum0 = _mm256_add_epi16(sum0, _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)pPixels)));
+			sum1 = _mm256_add_epi16(sum1, _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(pPixels + 16))));
+			sum2 = _mm256_add_epi16(sum2, _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(pPixels + 32))));
+			sum3 = _mm256_add_epi16(sum3, _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(pPixels + 48))));
+			pPixels += image.stride;
+		}
+		__m256i* pSums = (__m256i*)(pColumnSums + (ptrdiff_t)x * 4);
+		_mm256_storeu_si256(pSums, sum0);
+		_mm256_storeu_si256(pSums + 1, sum1);
+		_mm256_storeu_si256(pSums + 2, sum2);
+		_mm256_storeu_si256(pSums + 3, sum3);
+	}
+
+	// Remaining pixels
+	if (x < image.width)
+	{
+		IMAGEBUFFER remaining;
+		if (getImageView(image, x, 0, image.width - x, image.height, remaining))
+			sumBlockRowSSE2(remaining, blockY, blockHeight, pColumnSums + (ptrdiff_t)x * 4);
+	}
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: fillPixelsAVX2
+
+  Summary:   Fills pixels with a color
+
+  Args:     IMAGEPIXEL *pPixels
+              First pixel
+            int count
+              Pixels
+            IMAGEPIXEL color
+              Color
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+SIMDAVX2FUNCTION static void fillPixelsAVX2(IMAGEPIXEL* pPixels, int count, IMAGEPIXEL color)
+{
+	const __m256i colors = _mm256_set1_epi32((int)color);
+	int i = 0;
+
+	for (; i + 8 <= count; i += 8) _mm256_storeu_si256((__m256i*)(pPixels + i), colors);
+	for (; i < count; i++) pPixels[i] = color;
+}
+#endif
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getBestPixelateKernel
+
+  Summary:   Gets fastest kernel supported by the CPU
+
+  Args:
+
+  Returns:  PIXELATEKERNEL
+
+-----------------------------------------------------------------F-F*/
+PIXELATEKERNEL getBestPixelateKernel()
+{
+	switch (getSIMDLevel())
+	{
+	case simdLevelAVX2:
+		return pixelateKernelAVX2;
+	case simdLevelSSE2:
+		return pixelateKernelSSE2;
+	default:
+		return pixelateKernelScalar;
+	}
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: pixelateImageBlockRows
+
+  Summary:   Pixelates some block rows of an image. Block rows are independent, so
+             different block rows of the same image can be pixelated in parallel.
+
+  Args:     const IMAGEBUFFER &image
+              Image buffer or view
+            int blockSize
+              Width and height of a block in pixels
+            int firstBlockRow
+              First block row (block row n starts at image row n * blockSize)
+            int blockRowCount
+              Number of block rows
+            PIXELATEKERNEL kernel
+              Kernel (unsupported kernels fall back to the best supported kernel)
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void pixelateImageBlockRows(const IMAGEBUFFER& image, int blockSize, int firstBlockRow, int blockRowCount, PIXELATEKERNEL kernel)
+{
+	if (!isImageValid(image) || (blockSize < 1) || (firstBlockRow < 0) || (blockRowCount < 1)) return;
+
+	PIXELATEKERNEL bestKernel = getBestPixelateKernel();
+	if ((kernel == pixelateKernelAuto) || (kernel > bestKernel)) kernel = bestKernel;
+	if (blockSize > PIXELATEMAXBLOCKSIZE) kernel = pixelateKernelScalar; // Column sums would overflow 16 bit
+
+	int64_t firstY = (int64_t)firstBlockRow * blockSize;
+	int64_t lastY = ((int64_t)firstBlockRow + blockRowCount) * blockSize;
+	if (lastY > image.height) lastY = image.height;
+	if (firstY >= lastY) return;
+
+	if (kernel == pixelateKernelScalar)
+	{
+		for (int blockY = (int)firstY; blockY < (int)lastY; blockY += blockSize)
+			pixelateBlockRowScalar(image, blockSize, blockY, (blockY + blockSize > image.height) ? image.height - blockY : blockSize);
+		return;
+	}
+
+#ifdef SIMDX86
+	PIXELATEFUNCTIONS functions = { sumBlockRowSSE2, fillPixelsSSE2 };
+	if (kernel == pixelateKernelAVX2) functions = { sumBlockRowAVX2, fillPixelsAVX2 };
+
+	std::vector<uint16_t> columnSums((size_t)image.width * 4);
+	for (int blockY = (int)firstY; blockY < (int)lastY; blockY += blockSize)
+	{
+		int blockHeight = (blockY + blockSize > image.height) ? image.height - blockY : blockSize;
+		functions.sumBlockRow(image, blockY, blockHeight, columnSums.data());
+
+		for (int blockX = 0; blockX < image.width; blockX += blockSize)
+		{
+			int blockWidth = (blockX + blockSize > image.width) ? image.width - blockX : blockSize;
+			uint32_t sums[4] = { 0 };
+
+			sumColumnsSSE2(columnSums.data() + (ptrdiff_t)blockX * 4, blockWidth, sums);
+			IMAGEPIXEL average = averageColor(sums, (uint32_t)(blockWidth * blockHeight));
+			for (int y = blockY; y < blockY + blockHeight; y++) functions.fillPixels(imageRow(image, y) + blockX, blockWidth, average);
+		}
+	}
+#endif
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: pixelateImage
+
+  Summary:   Pixelates an image by replacing each block with its average color.
+             Blocks at the right and bottom border can be smaller than blockSize.
+
+  Args:     const IMAGEBUFFER &image
+              Image buffer or view
+            int blockSize
+              Width and height of a block in pixels
+            PIXELATEKERNEL kernel
+              Kernel (default pixelateKernelAuto)
+            int maxThreads
+              Maximum number of bands pixelated in parallel (default 0 = all threads of the worker pool)
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void pixelateImage(const IMAGEBUFFER& image, int blockSize, PIXELATEKERNEL kernel, int maxThreads)
+{
+	if (!isImageValid(image) || (blockSize < 1)) return;
+
+	int blockRows = (int)(((int64_t)image.height + blockSize - 1) / blockSize);
+	int bands = (maxThreads > 0) ? maxThreads : getWorkerThreadCount();
+	if ((int64_t)image.width * image.height < PIXELATEPARALLELMINPIXELS) bands = 1;
+	if (bands > blockRows) bands = blockRows;
+
+	if (bands <= 1)
+	{
+		pixelateImageBlockRows(image, blockSize, 0, blockRows, kernel);
+		return;
+	}
+
+	runWorkerTasks(bands, [&](int band) {
+		int firstBlockRow = (int)((int64_t)blockRows * band / bands);
+		int nextBlockRow = (int)((int64_t)blockRows * (band + 1) / bands);
+		pixelateImageBlockRows(image, blockSize, firstBlockRow, nextBlockRow - firstBlockRow, kernel);
+	});
+}
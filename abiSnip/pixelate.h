@@ -0,0 +1,28 @@
+/*+===================================================================
+  File:      pixelate.h
+
+  Summary:   Pixelation engine for image buffers with scalar, SSE2 and AVX2 kernels.
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#pragma once
+
+#include "imageBuffer.h"
+
+// Kernels for pixelating
+enum PIXELATEKERNEL {
+	pixelateKernelAuto, // Best kernel supported by the CPU
+	pixelateKernelScalar, // Plain C++
+	pixelateKernelSSE2, // SSE2 intrinsics
+	pixelateKernelAVX2 // AVX2 intrinsics
+};
+
+#define PIXELATEMAXBLOCKSIZE 257 // Largest block size for the SIMD kernels (column sums must fit into 16 bit)
+#define PIXELATEPARALLELMINPIXELS (1 << 20) // Smaller images are pixelated by the calling thread only
+
+void pixelateImage(const IMAGEBUFFER& image, int blockSize, PIXELATEKERNEL kernel = pixelateKernelAuto, int maxThreads = 0);
+void pixelateImageBlockRows(const IMAGEBUFFER& image, int blockSize, int firstBlockRow, int blockRowCount, PIXELATEKERNEL kernel = pixelateKernelAuto);
+PIXELATEKERNEL getBestPixelateKernel();
@@ -0,0 +1,421 @@
+/*+===================================================================
+  File:      pngEncoder.cpp
+
+  Summary:   PNG encoder for image buffers. The pixel rows are converted from
+             B,G,R,X to 8 bit RGB (or to 1, 2, 4 or 8 bit palette indexes for
+             images with max. 256 colors), filtered (one filter for all rows
+             or selected per row), compressed to one zlib stream and written
+             as IHDR, (PLTE,) IDAT and IEND chunks. The output goes to a write
+             function (file, memory, ...), so the encoder does not depend on
+             GDI+ or the Win32-API.
+
+             Has no dependencies to the Win32-API and can be compiled on other
+             platforms to test and benchmark the encoder.
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "pngEncoder.h"
+#include <algorithm>
+#include <cstring>
+
+#define PNGBYTESPERPIXEL 3 // 8 bit RGB
+#define PNGCOLORTYPERGB 2 // Color type for RGB without alpha
+#define PNGCOLORTYPEPALETTE 3 // Color type for indexed colors with PLTE chunk
+#define PNGPALETTEEMPTYKEY 0xFFFFFFFF // Unused entry in the palette hash table (colors have no upper byte)
+
+static const uint8_t g_pngSignature[8] = { 137, 'P', 'N', 'G', '\r', '\n', 26, '\n' };
+
+// CRC-32 lookup table for the PNG chunks
+struct CRC32TABLE {
+	uint32_t value[256];
+
+	CRC32TABLE()
+	{
+		for (uint32_t i = 0; i < 256; i++)
+		{
+			uint32_t crc = i;
+			for (int bit = 0; bit < 8; bit++) crc = (crc & 1) ? (0xedb88320u ^ (crc >> 1)) : (crc >> 1);
+			value[i] = crc;
+		}
+	}
+};
+static const CRC32TABLE g_crc32Table;
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: updateCRC32
+
+  Summary:   Updates a CRC-32 checksum
+
+  Args:     uint32_t crc
+              Checksum of the previous data (0 for no data)
+            const uint8_t *pData
+              Data
+            size_t size
+              Bytes
+
+  Returns:  uint32_t
+              Checksum
+
+-----------------------------------------------------------------F-F*/
+uint32_t updateCRC32(uint32_t crc, const uint8_t* pData, size_t size)
+{
+	crc = ~crc;
+	while (size-- > 0) crc = g_crc32Table.value[(crc ^ *pData++) & 0xff] ^ (crc >> 8);
+	return ~crc;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: storeUInt32
+
+  Summary:   Stores a value in network byte order (big endian)
+
+  Args:     uint8_t *pTarget
+              Target (4 bytes)
+            uint32_t value
+              Value
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+static void storeUInt32(uint8_t* pTarget, uint32_t value)
+{
+	pTarget[0] = (uint8_t)(value >> 24);
+	pTarget[1] = (uint8_t)(value >> 16);
+	pTarget[2] = (uint8_t)(value >> 8);
+	pTarget[3] = (uint8_t)value;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: writeChunk
+
+  Summary:   Writes a PNG chunk (length, type, data and CRC)
+
+  Args:     const PNGWRITEFUNCTION &write
+              Output function
+            const char *pType
+              Chunk type (4 characters)
+            const uint8_t *pData
+              Chunk data
+            size_t size
+              Bytes of chunk data
+
+  Returns:  bool
+              true = success
+              false = failure
+
+-----------------------------------------------------------------F-F*/
+static bool writeChunk(const PNGWRITEFUNCTION& write, const char* pType, const uint8_t* pData, size_t size)
+{
+	uint8_t header[8];
+	uint8_t footer[4];
+
+	storeUInt32(header, (uint32_t)size);
+	memcpy(header + 4, pType, 4);
+	uint32_t crc = updateCRC32(0, header + 4, 4);
+	if (size > 0) crc = updateCRC32(crc, pData, size);
+	storeUInt32(footer, crc);
+
+	if (!write(header, sizeof(header))) return false;
+	if ((size > 0) && !write(pData, size)) return false;
+	return write(footer, sizeof(footer));
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getPNGOptionsForProfile
+
+  Summary:   Gets the encoder options for a compression profile
+
+  Args:     PNGCOMPRESSIONPROFILE profile
+              Compression profile
+
+  Returns:  PNGOPTIONS
+              Deflate level, filter and window size of the profile
+
+-----------------------------------------------------------------F-F*/
+PNGOPTIONS getPNGOptionsForProfile(PNGCOMPRESSIONPROFILE profile)
+{
+	PNGOPTIONS options;
+
+	switch (profile)
+	{
+	case pngProfileFast: // Greedy matching and a small window, which fits in the CPU cache
+		options.compressionLevel = 1;
+		options.filter = pngFilterAdaptiveSampled;
+		options.windowBits = 12;
+		break;
+	case pngProfileSmallest: // Longest hash chains
+		options.compressionLevel = DEFLATEMAXLEVEL;
+		options.filter = pngFilterAdaptive;
+		options.windowBits = DEFLATEMAXWINDOWBITS;
+		break;
+	default: // Balanced
+		options.compressionLevel = DEFLATEDEFAULTLEVEL;
+		options.filter = pngFilterAdaptive;
+		options.windowBits = DEFLATEMAXWINDOWBITS;
+		break;
+	}
+	return options;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getPaletteHashPosition
+
+  Summary:   Gets the position of a color in the palette hash table (linear probing)
+
+  Args:     const PNGPALETTE &palette
+              Palette
+            IMAGEPIXEL color
+              Color (without upper byte)
+
+  Returns:  uint32_t
+              Position of the color or of the empty entry for the color
+
+-----------------------------------------------------------------F-F*/
+static inline uint32_t getPaletteHashPosition(const PNGPALETTE& palette, IMAGEPIXEL color)
+{
+	uint32_t position = (color * 2654435761u) >> 22; // Multiplicative hash to 10 bit
+	while ((palette.keys[position] != color) && (palette.keys[position] != PNGPALETTEEMPTYKEY)) position = (position + 1) & (PNGPALETTEHASHSIZE - 1);
+	return position;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getPNGPalette
+
+  Summary:   Collects the colors of an image, when the image has max.
+             PNGMAXPALETTECOLORS colors. Stops at the first color exceeding
+             the limit. Pixels with the same color as the left pixel are
+             skipped without hash lookup (typical for screenshots).
+
+  Args:     const IMAGEBUFFER &image
+              Image buffer (or view)
+            PNGPALETTE &palette
+              Colors sorted ascending and hash table for the color to index lookup
+
+  Returns:  bool
+              true = image has max. PNGMAXPALETTECOLORS colors
+              false = more colors or invalid image
+
+-----------------------------------------------------------------F-F*/
+bool getPNGPalette(const IMAGEBUFFER& image, PNGPALETTE& palette)
+{
+	palette.count = 0;
+	if (!isImageValid(image)) return false;
+
+	std::fill(palette.keys, palette.keys + PNGPALETTEHASHSIZE, PNGPALETTEEMPTYKEY);
+	for (int y = 0; y < image.height; y++)
+	{
+		const IMAGEPIXEL* pPixel = imageRow(image, y);
+		IMAGEPIXEL lastColor = PNGPALETTEEMPTYKEY;
+		for (int x = 0; x < image.width; x++)
+		{
+			IMAGEPIXEL color = pPixel[x] & IMAGEPIXELCOLORMASK;
+			if (color == lastColor) continue;
+			lastColor = color;
+
+			uint32_t position = getPaletteHashPosition(palette, color);
+			if (palette.keys[position] == PNGPALETTEEMPTYKEY)
+			{
+				if (palette.count == PNGMAXPALETTECOLORS) return false; // Too many colors
+				palette.keys[position] = color;
+				palette.colors[palette.count++] = color;
+			}
+		}
+	}
+
+	// Sorted palette for reproducible files
+	std::sort(palette.colors, palette.colors + palette.count);
+	for (int i = 0; i < palette.count; i++) palette.indexes[getPaletteHashPosition(palette, palette.colors[i])] = (uint8_t)i;
+	return true;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getPaletteBitDepth
+
+  Summary:   Gets the smallest PNG bit depth for the number of palette colors
+
+  Args:     int count
+              Number of colors
+
+  Returns:  int
+              1, 2, 4 or 8
+
+-----------------------------------------------------------------F-F*/
+static int getPaletteBitDepth(int count)
+{
+	if (count <= 2) return 1;
+	if (count <= 4) return 2;
+	if (count <= 16) return 4;
+	return 8;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: convertRowToIndexes
+
+  Summary:   Converts a row of pixels to packed palette indexes (first pixel in the high bits)
+
+  Args:     const IMAGEPIXEL *pPixel
+              Pixels of the row
+            int width
+              Pixels
+            const PNGPALETTE &palette
+              Palette with all colors of the row
+            int bitDepth
+              Bits per index (1, 2, 4 or 8)
+            uint8_t *pRow
+              Packed indexes
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+static void convertRowToIndexes(const IMAGEPIXEL* pPixel, int width, const PNGPALETTE& palette, int bitDepth, uint8_t* pRow)
+{
+	IMAGEPIXEL lastColor = PNGPALETTEEMPTYKEY;
+	uint8_t index = 0;
+	uint8_t packed = 0;
+	int bits = 0;
+
+	for (int x = 0; x < width; x++)
+	{
+		IMAGEPIXEL color = pPixel[x] & IMAGEPIXELCOLORMASK;
+		if (color != lastColor)
+		{
+			lastColor = color;
+			index = palette.indexes[getPaletteHashPosition(palette, color)];
+		}
+		packed = (uint8_t)((packed << bitDepth) | index);
+		bits += bitDepth;
+		if (bits == 8)
+		{
+			*pRow++ = packed;
+			packed = 0;
+			bits = 0;
+		}
+	}
+	if (bits > 0) *pRow = (uint8_t)(packed << (8 - bits));
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: encodePNG
+
+  Summary:   Encodes an image buffer as PNG. Images with max. PNGMAXPALETTECOLORS
+             colors are stored as indexed PNG (if enabled by the options).
+
+  Args:     const IMAGEBUFFER &image
+              Image buffer (or view)
+            const PNGWRITEFUNCTION &write
+              Output function for the PNG data
+            const PNGOPTIONS &options
+              Compression level, filter and window size
+
+  Returns:  bool
+              true = success
+              false = failure (invalid image, out of memory or write error)
+
+-----------------------------------------------------------------F-F*/
+bool encodePNG(const IMAGEBUFFER& image, const PNGWRITEFUNCTION& write, const PNGOPTIONS& options)
+{
+	if (!isImageValid(image)) return false;
+
+	try {
+		PNGPALETTE palette;
+		bool bPalette = options.bPalette && getPNGPalette(image, palette);
+		int bitDepth = bPalette ? getPaletteBitDepth(palette.count) : 8;
+		int bytesPerPixel = bPalette ? 1 : PNGBYTESPERPIXEL; // Distance to the left neighbor byte for the filters
+		size_t rowSize = bPalette ? ((size_t)image.width * bitDepth + 7) / 8 : (size_t)image.width * PNGBYTESPERPIXEL;
+		std::vector<uint8_t> filtered((rowSize + 1) * image.height);
+		std::vector<uint8_t> rows[2] = { std::vector<uint8_t>(rowSize), std::vector<uint8_t>(rowSize) };
+		std::vector<uint8_t> compressed;
+
+		// Convert and filter rows
+		PNGFILTER filter = options.filter;
+		for (int y = 0; y < image.height; y++)
+		{
+			const IMAGEPIXEL* pPixel = imageRow(image, y);
+			uint8_t* pRow = rows[y & 1].data();
+			if (bPalette) convertRowToIndexes(pPixel, image.width, palette, bitDepth, pRow);
+			else
+			{
+				for (int x = 0; x < image.width; x++)
+				{
+					IMAGEPIXEL color = pPixel[x];
+					pRow[3 * x] = (uint8_t)(color >> 16);
+					pRow[3 * x + 1] = (uint8_t)(color >> 8);
+					pRow[3 * x + 2] = (uint8_t)color;
+				}
+			}
+			const uint8_t* pPreviousRow = (y > 0) ? rows[(y - 1) & 1].data() : NULL;
+			if ((options.filter == pngFilterAdaptive) || ((options.filter == pngFilterAdaptiveSampled) && (y % PNGFILTERSAMPLEDISTANCE == 0)))
+				filter = selectPNGFilter(pRow, pPreviousRow, rowSize, bytesPerPixel);
+
+			uint8_t* pFiltered = filtered.data() + (rowSize + 1) * y;
+			pFiltered[0] = (uint8_t)filter;
+			filterPNGRow(filter, pRow, pPreviousRow, rowSize, bytesPerPixel, pFiltered + 1);
+		}
+
+		if (!compressZlib(filtered.data(), filtered.size(), options.compressionLevel, compressed, options.maxThreads, options.windowBits)) return false;
+		filtered.clear();
+		filtered.shrink_to_fit();
+
+		// Signature and chunks
+		uint8_t header[13];
+		storeUInt32(header, (uint32_t)image.width);
+		storeUInt32(header + 4, (uint32_t)image.height);
+		header[8] = (uint8_t)bitDepth;
+		header[9] = bPalette ? PNGCOLORTYPEPALETTE : PNGCOLORTYPERGB;
+		header[10] = 0; // Compression method deflate
+		header[11] = 0; // Filter method adaptive
+		header[12] = 0; // No interlace
+
+		if (!write(g_pngSignature, sizeof(g_pngSignature))) return false;
+		if (!writeChunk(write, "IHDR", header, sizeof(header))) return false;
+		if (bPalette)
+		{
+			uint8_t colors[3 * PNGMAXPALETTECOLORS];
+			for (int i = 0; i < palette.count; i++)
+			{
+				colors[3 * i] = (uint8_t)(palette.colors[i] >> 16);
+				colors[3 * i + 1] = (uint8_t)(palette.colors[i] >> 8);
+				colors[3 * i + 2] = (uint8_t)palette.colors[i];
+			}
+			if (!writeChunk(write, "PLTE", colors, 3 * (size_t)palette.count)) return false;
+		}
+		for (size_t offset = 0; offset < compressed.size(); offset += PNGMAXIDATSIZE)
+		{
+			if (!writeChunk(write, "IDAT", compressed.data() + offset, std::min(compressed.size() - offset, (size_t)PNGMAXIDATSIZE))) return false;
+		}
+		if (!writeChunk(write, "IEND", NULL, 0)) return false;
+	}
+	catch (...) { // Out of memory
+		return false;
+	}
+	return true;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: encodePNGToMemory
+
+  Summary:   Encodes an image buffer as PNG into memory
+
+  Args:     const IMAGEBUFFER &image
+              Image buffer (or view)
+            std::vector<uint8_t> &png
+              PNG data
+            const PNGOPTIONS &options
+              Compression level, filter and window size
+
+  Returns:  bool
+              true = success
+              false = failure
+
+-----------------------------------------------------------------F-F*/
+bool encodePNGToMemory(const IMAGEBUFFER& image, std::vector<uint8_t>& png, const PNGOPTIONS& options)
+{
+	png.clear();
+	return encodePNG(image, [&png](const uint8_t* pData, size_t size) {
+		png.insert(png.end(), pData, pData + size);
+		return true;
+	}, options);
+}
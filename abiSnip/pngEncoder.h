@@ -0,0 +1,54 @@
+/*+===================================================================
+  File:      pngEncoder.h
+
+  Summary:   PNG encoder for image buffers (8 bit RGB or indexed colors, no GDI+ needed).
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#pragma once
+
+#include "imageBuffer.h"
+#include "deflate.h"
+#include "pngFilter.h"
+#include <functional>
+#include <vector>
+
+#define PNGMAXIDATSIZE (1024 * 1024) // Max data bytes per IDAT chunk
+#define PNGMAXPALETTECOLORS 256 // Max colors for an indexed PNG
+#define PNGPALETTEHASHSIZE 1024 // Entries of the hash table for the color count (power of 2, at least 4 * PNGMAXPALETTECOLORS)
+
+// Compression profiles (value of the registry setting compressionProfile)
+enum PNGCOMPRESSIONPROFILE {
+	pngProfileFast, // Near-instant saving
+	pngProfileBalanced, // Default
+	pngProfileSmallest // Smallest files for archival, slow
+};
+
+// Options for the PNG encoder
+struct PNGOPTIONS {
+	int compressionLevel = DEFLATEDEFAULTLEVEL; // Deflate compression level (DEFLATEMINLEVEL-DEFLATEMAXLEVEL)
+	PNGFILTER filter = pngFilterAdaptive; // Filter used for all rows or pngFilterAdaptive/pngFilterAdaptiveSampled for a selection per row
+	int windowBits = DEFLATEMAXWINDOWBITS; // Deflate window size (DEFLATEMINWINDOWBITS-DEFLATEMAXWINDOWBITS)
+	int maxThreads = 0; // Max threads for the compression (0 = all threads of the worker pool, 1 = calling thread only)
+	bool bPalette = true; // Indexed PNG (bit depth 1, 2, 4 or 8 with PLTE chunk), when the image has max. PNGMAXPALETTECOLORS colors
+};
+
+// Colors of an image with max. PNGMAXPALETTECOLORS colors and a hash table for the color to index lookup
+struct PNGPALETTE {
+	IMAGEPIXEL colors[PNGMAXPALETTECOLORS]; // Colors sorted ascending
+	int count; // Number of colors
+	uint32_t keys[PNGPALETTEHASHSIZE]; // Color or PNGPALETTEEMPTYKEY
+	uint8_t indexes[PNGPALETTEHASHSIZE]; // Index in colors for the key
+};
+
+// Receives the PNG data. Returns false to cancel encoding (e.g. on write errors).
+typedef std::function<bool(const uint8_t* pData, size_t size)> PNGWRITEFUNCTION;
+
+PNGOPTIONS getPNGOptionsForProfile(PNGCOMPRESSIONPROFILE profile);
+bool getPNGPalette(const IMAGEBUFFER& image, PNGPALETTE& palette);
+bool encodePNG(const IMAGEBUFFER& image, const PNGWRITEFUNCTION& write, const PNGOPTIONS& options = PNGOPTIONS());
+bool encodePNGToMemory(const IMAGEBUFFER& image, std::vector<uint8_t>& png, const PNGOPTIONS& options = PNGOPTIONS());
+uint32_t updateCRC32(uint32_t crc, const uint8_t* pData, size_t size);
@@ -0,0 +1,621 @@
+/*+===================================================================
+  File:      pngFilter.cpp
+
+  Summary:   PNG row filters (None, Sub, Up, Average and Paeth). The predictors
+             are calculated from the unfiltered bytes, so the filters have no
+             dependency between neighbor bytes and are calculated for 16 (SSE2)
+             or 32 (AVX2) bytes at a time. The Paeth distances are calculated
+             with 16 bit lanes and compared with 8 bit lanes.
+
+             For the per-row filter selection all filters are applied to a row
+             without storing the result and the filter with the smallest sum of
+             absolute (signed) values is used (heuristic from the PNG
+             specification).
+
+             Has no dependencies to the Win32-API and can be compiled on other
+             platforms to test and benchmark the kernels.
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "pngFilter.h"
+#include <cstdlib>
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getPaethPredictor
+
+  Summary:   Gets the Paeth predictor of a byte
+
+  Args:     int left
+              Byte of the left pixel
+            int up
+              Byte of the pixel above
+            int upLeft
+              Byte of the pixel above the left pixel
+
+  Returns:  int
+              The neighbor byte nearest to left + up - upLeft
+
+-----------------------------------------------------------------F-F*/
+static inline int getPaethPredictor(int left, int up, int upLeft)
+{
+	int estimate = left + up - upLeft;
+	int distanceLeft = abs(estimate - left);
+	int distanceUp = abs(estimate - up);
+	int distanceUpLeft = abs(estimate - upLeft);
+	if ((distanceLeft <= distanceUp) && (distanceLeft <= distanceUpLeft)) return left;
+	if (distanceUp <= distanceUpLeft) return up;
+	return upLeft;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getPredictor
+
+  Summary:   Gets the predictor of a byte for a filter
+
+  Args:     PNGFILTER filter
+              Filter type
+            int left
+            int up
+            int upLeft
+              Neighbor bytes (see getPaethPredictor)
+
+  Returns:  int
+
+-----------------------------------------------------------------F-F*/
+static inline int getPredictor(PNGFILTER filter, int left, int up, int upLeft)
+{
+	switch (filter)
+	{
+	case pngFilterSub: return left;
+	case pngFilterUp: return up;
+	case pngFilterAverage: return (left + up) / 2;
+	case pngFilterPaeth: return getPaethPredictor(left, up, upLeft);
+	default: return 0;
+	}
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: filterPNGRowScalar
+
+  Summary:   Filters bytes of a row one at a time (reference kernel)
+
+  Args:     PNGFILTER filter
+              Filter type (pngFilterNone-pngFilterPaeth)
+            const uint8_t *pRow
+              Bytes of the row
+            const uint8_t *pPreviousRow
+              Bytes of the previous row (NULL for the first row)
+            size_t first
+              First byte to filter
+            size_t size
+              Bytes per row
+            int bytesPerPixel
+              Bytes per pixel (distance to the left neighbor byte)
+            uint8_t *pFiltered
+              Filtered bytes (without filter type byte)
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+static void filterPNGRowScalar(PNGFILTER filter, const uint8_t* pRow, const uint8_t* pPreviousRow, size_t first, size_t size, int bytesPerPixel, uint8_t* pFiltered)
+{
+	for (size_t i = first; i < size; i++)
+	{
+		int left = (i >= (size_t)bytesPerPixel) ? pRow[i - bytesPerPixel] : 0;
+		int up = (pPreviousRow != NULL) ? pPreviousRow[i] : 0;
+		int upLeft = ((pPreviousRow != NULL) && (i >= (size_t)bytesPerPixel)) ? pPreviousRow[i - bytesPerPixel] : 0;
+		pFiltered[i] = (uint8_t)(pRow[i] - getPredictor(filter, left, up, upLeft));
+	}
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: sumPNGFiltersScalar
+
+  Summary:   Adds the absolute values of the filtered bytes for all filters
+             one byte at a time (reference kernel)
+
+  Args:     const uint8_t *pRow
+            const uint8_t *pPreviousRow
+            size_t first
+            size_t size
+            int bytesPerPixel
+              See filterPNGRowScalar
+            uint64_t sums[PNGFILTERTYPES]
+              Sums per filter type (values are added)
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+static void sumPNGFiltersScalar(const uint8_t* pRow, const uint8_t* pPreviousRow, size_t first, size_t size, int bytesPerPixel, uint64_t sums[PNGFILTERTYPES])
+{
+	for (size_t i = first; i < size; i++)
+	{
+		int left = (i >= (size_t)bytesPerPixel) ? pRow[i - bytesPerPixel] : 0;
+		int up = (pPreviousRow != NULL) ? pPreviousRow[i] : 0;
+		int upLeft = ((pPreviousRow != NULL) && (i >= (size_t)bytesPerPixel)) ? pPreviousRow[i - bytesPerPixel] : 0;
+		for (int filter = pngFilterNone; filter <= pngFilterPaeth; filter++)
+		{
+			uint8_t filtered = (uint8_t)(pRow[i] - getPredictor((PNGFILTER)filter, left, up, upLeft));
+			sums[filter] += (filtered < 128) ? filtered : 256 - filtered;
+		}
+	}
+}
+
+#ifdef SIMDX86
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getAveragePredictorSSE2
+
+  Summary:   Gets (left + up) / 2 for 16 bytes (_mm_avg_epu8 rounds up)
+
+  Args:     __m128i left
+            __m128i up
+
+  Returns:  __m128i
+
+-----------------------------------------------------------------F-F*/
+SIMDSSE2FUNCTION static inline __m128i getAveragePredictorSSE2(__m128i left, __m128i up)
+{
+	return _mm_sub_epi8(_mm_avg_epu8(left, up), _mm_and_si128(_mm_xor_si128(left, up), _mm_set1_epi8(1)));
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getPaethDistancesSSE2
+
+  Summary:   Gets the Paeth distances for 8 bytes in 16 bit lanes
+
+  Args:     __m128i left
+            __m128i up
+            __m128i upLeft
+              Neighbor bytes zero extended to 16 bit
+            __m128i &distanceLeft
+            __m128i &distanceUp
+            __m128i &distanceUpLeft
+              Distances (0-510)
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+SIMDSSE2FUNCTION static inline void getPaethDistancesSSE2(__m128i left, __m128i up, __m128i upLeft, __m128i& distanceLeft, __m128i& distanceUp, __m128i& distanceUpLeft)
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i upDelta = _mm_sub_epi16(up, upLeft); // estimate - left
+	__m128i leftDelta = _mm_sub_epi16(left, upLeft); // estimate - up
+	__m128i sumDelta = _mm_add_epi16(upDelta, leftDelta); // estimate - upLeft
+	distanceLeft = _mm_max_epi16(upDelta, _mm_sub_epi16(zero, upDelta));
+	distanceUp = _mm_max_epi16(leftDelta, _mm_sub_epi16(zero, leftDelta));
+	distanceUpLeft = _mm_max_epi16(sumDelta, _mm_sub_epi16(zero, sumDelta));
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getPaethPredictorSSE2
+
+  Summary:   Gets the Paeth predictor for 16 bytes. The distances are packed
+             with unsigned saturation to 8 bit. Only the distance to upLeft can
+             exceed 255 and the result of its compares is the same with 255.
+
+  Args:     __m128i left
+            __m128i up
+            __m128i upLeft
+              Neighbor bytes
+
+  Returns:  __m128i
+
+-----------------------------------------------------------------F-F*/
+SIMDSSE2FUNCTION static inline __m128i getPaethPredictorSSE2(__m128i left, __m128i up, __m128i upLeft)
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i distanceLeftLow, distanceUpLow, distanceUpLeftLow, distanceLeftHigh, distanceUpHigh, distanceUpLeftHigh;
+
+	getPaethDistancesSSE2(_mm_unpacklo_epi8(left, zero), _mm_unpacklo_epi8(up, zero), _mm_unpacklo_epi8(upLeft, zero), distanceLeftLow, distanceUpLow, distanceUpLeftLow);
+	getPaethDistancesSSE2(_mm_unpackhi_epi8(left, zero), _mm_unpackhi_epi8(up, zero), _mm_unpackhi_epi8(upLeft, zero), distanceLeftHigh, distanceUpHigh, distanceUpLeftHigh);
+	__m128i distanceLeft = _mm_packus_epi16(distanceLeftLow, distanceLeftHigh);
+	__m128i distanceUp = _mm_packus_epi16(distanceUpLow, distanceUpHigh);
+	__m128i distanceUpLeft = _mm_packus_epi16(distanceUpLeftLow, distanceUpLeftHigh);
+
+	// a <= b is min(a, b) == a for unsigned bytes
+	__m128i useLeft = _mm_and_si128(_mm_cmpeq_epi8(_mm_min_epu8(distanceLeft, distanceUp), distanceLeft),
+		_mm_cmpeq_epi8(_mm_min_epu8(distanceLeft, distanceUpLeft), distanceLeft));
+	__m128i useUp = _mm_cmpeq_epi8(_mm_min_epu8(distanceUp, distanceUpLeft), distanceUp);
+	__m128i upOrUpLeft = _mm_or_si128(_mm_and_si128(useUp, up), _mm_andnot_si128(useUp, upLeft));
+	return _mm_or_si128(_mm_and_si128(useLeft, left), _mm_andnot_si128(useLeft, upOrUpLeft));
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: addAbsoluteSSE2
+
+  Summary:   Adds the absolute values of 16 filtered bytes (as signed bytes)
+
+  Args:     __m128i sum
+              Sum in two 64 bit lanes
+            __m128i filtered
+              Filtered bytes
+
+  Returns:  __m128i
+              New sum
+
+-----------------------------------------------------------------F-F*/
+SIMDSSE2FUNCTION static inline __m128i addAbsoluteSSE2(__m128i sum, __m128i filtered)
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i absolute = _mm_min_epu8(filtered, _mm_sub_epi8(zero, filtered));
+	return _mm_add_epi64(sum, _mm_sad_epu8(absolute, zero));
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: filterPNGRowSSE2
+
+  Summary:   Filters bytes of a row 16 at a time
+
+  Args:     See filterPNGRowScalar (pPreviousRow must not be NULL)
+
+  Returns:  size_t
+              First byte, which is not filtered
+
+-----------------------------------------------------------------F-F*/
+SIMDSSE2FUNCTION static size_t filterPNGRowSSE2(PNGFILTER filter, const uint8_t* pRow, const uint8_t* pPreviousRow, size_t first, size_t size, int bytesPerPixel, uint8_t* pFiltered)
+{
+	size_t i = first;
+	for (; i + 16 <= size; i += 16)
+	{
+		__m128i current = _mm_loadu_si128((const __m128i*)(pRow + i));
+		__m128i left = _mm_loadu_si128((const __m128i*)(pRow + i - bytesPerPixel));
+		__m128i up = _mm_loadu_si128((const __m128i*)(pPreviousRow + i));
+		__m128i predictor;
+
+		switch (filter)
+		{
+		case pngFilterSub: predictor = left; break;
+		case pngFilterUp: predictor = up; break;
+		case pngFilterAverage: predictor = getAveragePredictorSSE2(left, up); break;
+		case pngFilterPaeth: predictor = getPaethPredictorSSE2(left, up, _mm_loadu_si128((const __m128i*)(pPreviousRow + i - bytesPerPixel))); break;
+		default: predictor = _mm_setzero_si128(); break;
+		}
+		_mm_storeu_si128((__m128i*)(pFiltered + i), _mm_sub_epi8(current, predictor));
+	}
+	return i;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: sumPNGFiltersSSE2
+
+  Summary:   Adds the absolute values of the filtered bytes for all filters 16 bytes at a time
+
+  Args:     See sumPNGFiltersScalar (pPreviousRow must not be NULL)
+
+  Returns:  size_t
+              First byte, which is not added
+
+-----------------------------------------------------------------F-F*/
+SIMDSSE2FUNCTION static size_t sumPNGFiltersSSE2(const uint8_t* pRow, const uint8_t* pPreviousRow, size_t first, size_t size, int bytesPerPixel, uint64_t sums[PNGFILTERTYPES])
+{
+	__m128i sum[PNGFILTERTYPES];
+	for (int filter = 0; filter < PNGFILTERTYPES; filter++) sum[filter] = _mm_setzero_si128();
+
+	size_t i = first;
+	for (; i + 16 <= size; i += 16)
+	{
+		__m128i current = _mm_loadu_si128((const __m128i*)(pRow + i));
+		__m128i left = _mm_loadu_si128((const __m128i*)(pRow + i - bytesPerPixel));
+		__m128i up = _mm_loadu_si128((const __m128i*)(pPreviousRow + i));
+		__m128i upLeft = _mm_loadu_si128((const __m128i*)(pPreviousRow + i - bytesPerPixel));
+
+		sum[pngFilterNone] = addAbsoluteSSE2(sum[pngFilterNone], current);
+		sum[pngFilterSub] = addAbsoluteSSE2(sum[pngFilterSub], _mm_sub_epi8(current, left));
+		sum[pngFilterUp] = addAbsoluteSSE2(sum[pngFilterUp], _mm_sub_epi8(current, up));
+		sum[pngFilterAverage] = addAbsoluteSSE2(sum[pngFilterAverage], _mm_sub_epi8(current, getAveragePredictorSSE2(left, up)));
+		sum[pngFilterPaeth] = addAbsoluteSSE2(sum[pngFilterPaeth], _mm_sub_epi8(current, getPaethPredictorSSE2(left, up, upLeft)));
+	}
+
+	for (int filter = 0; filter < PNGFILTERTYPES; filter++)
+	{
+		uint64_t lanes[2];
+		_mm_storeu_si128((__m128i*)lanes, sum[filter]);
+		sums[filter] += lanes[0] + lanes[1];
+	}
+	return i;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getAveragePredictorAVX2
+
+  Summary:   Gets (left + up) / 2 for 32 bytes
+
+  Args:     __m256i left
+            __m256i up
+
+  Returns:  __m256i
+
+-----------------------------------------------------------------F-F*/
+SIMDAVX2FUNCTION static inline __m256i getAveragePredictorAVX2(__m256i left, __m256i up)
+{
+	return _mm256_sub_epi8(_mm256_avg_epu8(left, up), _mm256_and_si256(_mm256_xor_si256(left, up), _mm256_set1_epi8(1)));
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getPaethDistancesAVX2
+
+  Summary:   Gets the Paeth distances for 16 bytes in 16 bit lanes
+
+  Args:     See getPaethDistancesSSE2
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+SIMDAVX2FUNCTION static inline void getPaethDistancesAVX2(__m256i left, __m256i up, __m256i upLeft, __m256i& distanceLeft, __m256i& distanceUp, __m256i& distanceUpLeft)
+{
+	__m256i upDelta = _mm256_sub_epi16(up, upLeft);
+	__m256i leftDelta = _mm256_sub_epi16(left, upLeft);
+	distanceLeft = _mm256_abs_epi16(upDelta);
+	distanceUp = _mm256_abs_epi16(leftDelta);
+	distanceUpLeft = _mm256_abs_epi16(_mm256_add_epi16(upDelta, leftDelta));
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getPaethPredictorAVX2
+
+  Summary:   Gets the Paeth predictor for 32 bytes (see getPaethPredictorSSE2).
+             Unpack and pack work within the 128 bit lanes, so the byte order
+             is restored by the pack.
+
+  Args:     __m256i left
+            __m256i up
+            __m256i upLeft
+              Neighbor bytes
+
+  Returns:  __m256i
+
+-----------------------------------------------------------------F-F*/
+SIMDAVX2FUNCTION static inline __m256i getPaethPredictorAVX2(__m256i left, __m256i up, __m256i upLeft)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	__m256i distanceLeftLow, distanceUpLow, distanceUpLeftLow, distanceLeftHigh, distanceUpHigh, distanceUpLeftHigh;
+
+	getPaethDistancesAVX2(_mm256_unpacklo_epi8(left, zero), _mm256_unpacklo_epi8(up, zero), _mm256_unpacklo_epi8(upLeft, zero), distanceLeftLow, distanceUpLow, distanceUpLeftLow);
+	getPaethDistancesAVX2(_mm256_unpackhi_epi8(left, zero), _mm256_unpackhi_epi8(up, zero), _mm256_unpackhi_epi8(upLeft, zero), distanceLeftHigh, distanceUpHigh, distanceUpLeftHigh);
+	__m256i distanceLeft = _mm256_packus_epi16(distanceLeftLow, distanceLeftHigh);
+	__m256i distanceUp = _mm256_packus_epi16(distanceUpLow, distanceUpHigh);
+	__m256i distanceUpLeft = _mm256_packus_epi16(distanceUpLeftLow, distanceUpLeftHigh);
+
+	__m256i useLeft = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_min_epu8(distanceLeft, distanceUp), distanceLeft),
+		_mm256_cmpeq_epi8(_mm256_min_epu8(distanceLeft, distanceUpLeft), distanceLeft));
+	__m256i useUp = _mm256_cmpeq_epi8(_mm256_min_epu8(distanceUp, distanceUpLeft), distanceUp);
+	return _mm256_blendv_epi8(_mm256_blendv_epi8(upLeft, up, useUp), left, useLeft);
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: addAbsoluteAVX2
+
+  Summary:   Adds the absolute values of 32 filtered bytes (as signed bytes)
+
+  Args:     __m256i sum
+              Sum in four 64 bit lanes
+            __m256i filtered
+              Filtered bytes
+
+  Returns:  __m256i
+              New sum
+
+-----------------------------------------------------------------F-F*/
+SIMDAVX2FUNCTION static inline __m256i addAbsoluteAVX2(__m256i sum, __m256i filtered)
+{
+	return _mm256_add_epi64(sum, _mm256_sad_epu8(_mm256_abs_epi8(filtered), _mm256_setzero_si256()));
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: filterPNGRowAVX2
+
+  Summary:   Filters bytes of a row 32 at a time
+
+  Args:     See filterPNGRowScalar (pPreviousRow must not be NULL)
+
+  Returns:  size_t
+              First byte, which is not filtered
+
+-----------------------------------------------------------------F-F*/
+SIMDAVX2FUNCTION static size_t filterPNGRowAVX2(PNGFILTER filter, const uint8_t* pRow, const uint8_t* pPreviousRow, size_t first, size_t size, int bytesPerPixel, uint8_t* pFiltered)
+{
+	size_t i = first;
+	for (; i + 32 <= size; i += 32)
+	{
+		__m256i current = _mm256_loadu_si256((const __m256i*)(pRow + i));
+		__m256i left = _mm256_loadu_si256((const __m256i*)(pRow + i - bytesPerPixel));
+		__m256i up = _mm256_loadu_si256((const __m256i*)(pPreviousRow + i));
+		__m256i predictor;
+
+		switch (filter)
+		{
+		case pngFilterSub: predictor = left; break;
+		case pngFilterUp: predictor = up; break;
+		case pngFilterAverage: predictor = getAveragePredictorAVX2(left, up); break;
+		case pngFilterPaeth: predictor = getPaethPredictorAVX2(left, up, _mm256_loadu_si256((const __m256i*)(pPreviousRow + i - bytesPerPixel))); break;
+		default: predictor = _mm256_setzero_si256(); break;
+		}
+		_mm256_storeu_si256((__m256i*)(pFiltered + i), _mm256_sub_epi8(current, predictor));
+	}
+	return filterPNGRowSSE2(filter, pRow, pPreviousRow, i, size, bytesPerPixel, pFiltered);
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: sumPNGFiltersAVX2
+
+  Summary:   Adds the absolute values of the filtered bytes for all filters 32 bytes at a time
+
+  Args:     See sumPNGFiltersScalar (pPreviousRow must not be NULL)
+
+  Returns:  size_t
+              First byte, which is not added
+
+-----------------------------------------------------------------F-F*/
+SIMDAVX2FUNCTION static size_t sumPNGFiltersAVX2(const uint8_t* pRow, const uint8_t* pPreviousRow, size_t first, size_t size, int bytesPerPixel, uint64_t sums[PNGFILTERTYPES])
+{
+	__m256i sum[PNGFILTERTYPES];
+	for (int filter = 0; filter < PNGFILTERTYPES; filter++) sum[filter] = _mm256_setzero_si256();
+
+	size_t i = first;
+	for (; i + 32 <= size; i += 32)
+	{
+		__m256i current = _mm256_loadu_si256((const __m256i*)(pRow + i));
+		__m256i left = _mm256_loadu_si256((const __m256i*)(pRow + i - bytesPerPixel));
+		__m256i up = _mm256_loadu_si256((const __m256i*)(pPreviousRow + i));
+		__m256i upLeft = _mm256_loadu_si256((const __m256i*)(pPreviousRow + i - bytesPerPixel));
+
+		sum[pngFilterNone] = addAbsoluteAVX2(sum[pngFilterNone], current);
+		sum[pngFilterSub] = addAbsoluteAVX2(sum[pngFilterSub], _mm256_sub_epi8(current, left));
+		sum[pngFilterUp] = addAbsoluteAVX2(sum[pngFilterUp], _mm256_sub_epi8(current, up));
+		sum[pngFilterAverage] = addAbsoluteAVX2(sum[pngFilterAverage], _mm256_sub_epi8(current, getAveragePredictorAVX2(left, up)));
+		sum[pngFilterPaeth] = addAbsoluteAVX2(sum[pngFilterPaeth], _mm256_sub_epi8(current, getPaethPredictorAVX2(left, up, upLeft)));
+	}
+
+	for (int filter = 0; filter < PNGFILTERTYPES; filter++)
+	{
+		uint64_t lanes[4];
+		_mm256_storeu_si256((__m256i*)lanes, sum[filter]);
+		sums[filter] += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+	}
+	return sumPNGFiltersSSE2(pRow, pPreviousRow, i, size, bytesPerPixel, sums);
+}
+#endif
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getFilterSIMDLevel
+
+  Summary:   Gets the instruction set extension for filtering a row
+
+  Args:     const uint8_t *pPreviousRow
+              Bytes of the previous row (SIMD kernels are not used for NULL)
+            SIMDLEVEL maxLevel
+              Best instruction set extension to be used
+
+  Returns:  SIMDLEVEL
+
+-----------------------------------------------------------------F-F*/
+static SIMDLEVEL getFilterSIMDLevel(const uint8_t* pPreviousRow, SIMDLEVEL maxLevel)
+{
+	if (pPreviousRow == NULL) return simdLevelNone;
+	SIMDLEVEL level = getSIMDLevel();
+	return (maxLevel < level) ? maxLevel : level;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: filterPNGRow
+
+  Summary:   Filters a row of pixel bytes
+
+  Args:     PNGFILTER filter
+              Filter type (pngFilterNone-pngFilterPaeth)
+            const uint8_t *pRow
+              Bytes of the row
+            const uint8_t *pPreviousRow
+              Bytes of the previous row (NULL or zeros for the first row)
+            size_t size
+              Bytes per row
+            int bytesPerPixel
+              Bytes per pixel (distance to the left neighbor byte)
+            uint8_t *pFiltered
+              Filtered bytes (without filter type byte)
+            SIMDLEVEL maxLevel
+              Best instruction set extension to be used (default simdLevelAVX2)
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void filterPNGRow(PNGFILTER filter, const uint8_t* pRow, const uint8_t* pPreviousRow, size_t size, int bytesPerPixel, uint8_t* pFiltered, SIMDLEVEL maxLevel)
+{
+	size_t first = ((size_t)bytesPerPixel < size) ? (size_t)bytesPerPixel : size;
+
+	// Bytes of the first pixel have no left neighbor
+	filterPNGRowScalar(filter, pRow, pPreviousRow, 0, first, bytesPerPixel, pFiltered);
+
+#ifdef SIMDX86
+	switch (getFilterSIMDLevel(pPreviousRow, maxLevel))
+	{
+	case simdLevelAVX2:
+		first = filterPNGRowAVX2(filter, pRow, pPreviousRow, first, size, bytesPerPixel, pFiltered);
+		break;
+	case simdLevelSSE2:
+		first = filterPNGRowSSE2(filter, pRow, pPreviousRow, first, size, bytesPerPixel, pFiltered);
+		break;
+	default:
+		break;
+	}
+#endif
+	filterPNGRowScalar(filter, pRow, pPreviousRow, first, size, bytesPerPixel, pFiltered);
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: sumPNGFilters
+
+  Summary:   Gets for each filter the sum of the absolute values of the filtered
+             bytes (interpreted as signed bytes). Smaller sums are usually
+             compressed better.
+
+  Args:     const uint8_t *pRow
+              Bytes of the row
+            const uint8_t *pPreviousRow
+              Bytes of the previous row (NULL or zeros for the first row)
+            size_t size
+              Bytes per row
+            int bytesPerPixel
+              Bytes per pixel (distance to the left neighbor byte)
+            uint64_t sums[PNGFILTERTYPES]
+              Sums per filter type
+            SIMDLEVEL maxLevel
+              Best instruction set extension to be used (default simdLevelAVX2)
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void sumPNGFilters(const uint8_t* pRow, const uint8_t* pPreviousRow, size_t size, int bytesPerPixel, uint64_t sums[PNGFILTERTYPES], SIMDLEVEL maxLevel)
+{
+	size_t first = ((size_t)bytesPerPixel < size) ? (size_t)bytesPerPixel : size;
+
+	for (int filter = 0; filter < PNGFILTERTYPES; filter++) sums[filter] = 0;
+	sumPNGFiltersScalar(pRow, pPreviousRow, 0, first, bytesPerPixel, sums);
+
+#ifdef SIMDX86
+	switch (getFilterSIMDLevel(pPreviousRow, maxLevel))
+	{
+	case simdLevelAVX2:
+		first = sumPNGFiltersAVX2(pRow, pPreviousRow, first, size, bytesPerPixel, sums);
+		break;
+	case simdLevelSSE2:
+		first = sumPNGFiltersSSE2(pRow, pPreviousRow, first, size, bytesPerPixel, sums);
+		break;
+	default:
+		break;
+	}
+#endif
+	sumPNGFiltersScalar(pRow, pPreviousRow, first, size, bytesPerPixel, sums);
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: selectPNGFilter
+
+  Summary:   Selects the filter with the smallest sum of absolute differences for a row
+
+  Args:     const uint8_t *pRow
+            const uint8_t *pPreviousRow
+            size_t size
+            int bytesPerPixel
+            SIMDLEVEL maxLevel
+              See sumPNGFilters
+
+  Returns:  PNGFILTER
+              Filter type (pngFilterNone-pngFilterPaeth)
+
+-----------------------------------------------------------------F-F*/
+PNGFILTER selectPNGFilter(const uint8_t* pRow, const uint8_t* pPreviousRow, size_t size, int bytesPerPixel, SIMDLEVEL maxLevel)
+{
+	uint64_t sums[PNGFILTERTYPES];
+	PNGFILTER bestFilter = pngFilterNone;
+
+	sumPNGFilters(pRow, pPreviousRow, size, bytesPerPixel, sums, maxLevel);
+	for (int filter = pngFilterSub; filter <= pngFilterPaeth; filter++)
+	{
+		if (sums[filter] < sums[bestFilter]) bestFilter = (PNGFILTER)filter;
+	}
+	return bestFilter;
+}
@@ -0,0 +1,34 @@
+/*+===================================================================
+  File:      pngFilter.h
+
+  Summary:   PNG row filters with scalar, SSE2 and AVX2 kernels and the
+             per-row filter selection for the PNG encoder.
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#pragma once
+
+#include "simd.h"
+#include <cstddef>
+#include <cstdint>
+
+#define PNGFILTERTYPES 5 // None, Sub, Up, Average and Paeth
+#define PNGFILTERSAMPLEDISTANCE 8 // Rows between two filter selections for pngFilterAdaptiveSampled
+
+// PNG filter types (pngFilterNone-pngFilterPaeth are stored as first byte of each filtered row)
+enum PNGFILTER {
+	pngFilterNone,
+	pngFilterSub,
+	pngFilterUp,
+	pngFilterAverage,
+	pngFilterPaeth,
+	pngFilterAdaptive, // Encoder option: Filter with the smallest sum of absolute differences for each row
+	pngFilterAdaptiveSampled // Encoder option: Like pngFilterAdaptive, but the filter is selected only every PNGFILTERSAMPLEDISTANCE rows
+};
+
+void filterPNGRow(PNGFILTER filter, const uint8_t* pRow, const uint8_t* pPreviousRow, size_t size, int bytesPerPixel, uint8_t* pFiltered, SIMDLEVEL maxLevel = simdLevelAVX2);
+void sumPNGFilters(const uint8_t* pRow, const uint8_t* pPreviousRow, size_t size, int bytesPerPixel, uint64_t sums[PNGFILTERTYPES], SIMDLEVEL maxLevel = simdLevelAVX2);
+PNGFILTER selectPNGFilter(const uint8_t* pRow, const uint8_t* pPreviousRow, size_t size, int bytesPerPixel, SIMDLEVEL maxLevel = simdLevelAVX2);
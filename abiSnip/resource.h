@@ -5,6 +5,8 @@
 
 #define IDT_TIMER1000MS                  1015
 #define IDT_TIMERSCREENSHOTDELAYED       1016
+#define IDT_TIMERSURFACEPOOL             1017
+#define IDT_TIMERCAPTUREHISTORY          1018
 
 // Strings
 #define IDS_APP_TITLE 6000
@@ -31,6 +33,9 @@
 #define IDS_YES 6022
 #define IDS_NO 6023
 #define IDS_YESALWAYS 6024
+#define IDS_REOPENLAST 6025
+#define IDS_WORKINGSET 6026
+#define IDS_LASTCAPTURESIZE 6027
 
 
 #define WM_TRAYICON (WM_USER + 1)
@@ -40,6 +45,8 @@
 #define WM_NEXTSTATE (WM_USER + 5)
 #define WM_ZOOMIN (WM_USER + 6)
 #define WM_ZOOMOUT (WM_USER + 7)
+#define WM_SAVEFINISHED (WM_USER + 8)
+#define WM_SETTINGSCHANGED (WM_USER + 9)
 
 #define IDM_EXIT 1001
 #define IDM_CAPTURE 1002
@@ -54,6 +61,7 @@
 #define IDM_AUTORUN 1011
 #define IDM_OPENLAST 1012
 #define IDM_EDITLAST 1013
+#define IDM_REOPENLAST 1014
 
 #ifndef IDC_STATIC
 #define IDC_STATIC              -1
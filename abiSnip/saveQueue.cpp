@@ -0,0 +1,193 @@
+/*+===================================================================
+  File:      saveQueue.cpp
+
+  Summary:   Bounded queue of save jobs. The jobs are processed in order by one
+             writer thread, which is started on first use. When the queue is
+             full, enqueueSaveJob rejects the job without waiting, so the
+             memory of the pending jobs is limited and the caller (the UI
+             thread) is never blocked. The caller can save synchronously.
+
+             Has no dependencies to the Win32-API and can be compiled on other
+             platforms to test the queue.
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "saveQueue.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+// Job with enqueue time for the latency statistics
+struct SAVEQUEUEENTRY {
+	SAVEJOBFUNCTION job;
+	std::chrono::steady_clock::time_point enqueued;
+};
+
+// Shared state of the save queue
+struct SAVEQUEUE {
+	std::mutex mutex; // Protects the members below
+	std::condition_variable jobAvailable; // Signaled when a job is added or the queue is stopped
+	std::condition_variable jobFinished; // Signaled when a job is finished
+	std::deque<SAVEQUEUEENTRY> entries; // Waiting jobs
+	std::thread writerThread; // Writer thread (not joinable until the first job)
+	bool bStop = false; // true, when the writer thread should end after the waiting jobs
+	SAVEQUEUESTATISTICS statistics;
+};
+
+static SAVEQUEUE g_saveQueue;
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getMilliseconds
+
+  Summary:   Gets milliseconds between two points in time
+
+  Args:     std::chrono::steady_clock::time_point start
+            std::chrono::steady_clock::time_point end
+
+  Returns:  double
+
+-----------------------------------------------------------------F-F*/
+static double getMilliseconds(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+{
+	return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: writerThread
+
+  Summary:   Main function of the writer thread
+
+  Args:
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+static void writerThread()
+{
+	while (true)
+	{
+		SAVEQUEUEENTRY entry;
+		double waitTime;
+		{
+			std::unique_lock<std::mutex> lock(g_saveQueue.mutex);
+			g_saveQueue.jobAvailable.wait(lock, [] { return !g_saveQueue.entries.empty() || g_saveQueue.bStop; });
+			if (g_saveQueue.entries.empty()) return; // Stopped and nothing to do
+			entry = std::move(g_saveQueue.entries.front());
+			g_saveQueue.entries.pop_front();
+			waitTime = getMilliseconds(entry.enqueued, std::chrono::steady_clock::now());
+		}
+
+		try {
+			entry.job();
+		}
+		catch (...) { // Job has to report its own errors
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(g_saveQueue.mutex);
+			SAVEQUEUESTATISTICS& statistics = g_saveQueue.statistics;
+			statistics.depth--;
+			statistics.finishedJobs++;
+			statistics.lastWaitTime = waitTime;
+			statistics.lastLatency = getMilliseconds(entry.enqueued, std::chrono::steady_clock::now());
+			if (statistics.lastLatency > statistics.maxLatency) statistics.maxLatency = statistics.lastLatency;
+		}
+		g_saveQueue.jobFinished.notify_all();
+	}
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: enqueueSaveJob
+
+  Summary:   Adds a job to the save queue without waiting
+
+  Args:     const SAVEJOBFUNCTION &job
+              Job (runs in the writer thread)
+
+  Returns:  bool
+              true = success
+              false = failure (SAVEQUEUEMAXJOBS jobs are waiting or running, writer
+                      thread could not be started or queue is stopped)
+
+-----------------------------------------------------------------F-F*/
+bool enqueueSaveJob(const SAVEJOBFUNCTION& job)
+{
+	try {
+		std::unique_lock<std::mutex> lock(g_saveQueue.mutex);
+		if (g_saveQueue.bStop) return false;
+		if (!g_saveQueue.writerThread.joinable()) g_saveQueue.writerThread = std::thread(writerThread);
+
+		SAVEQUEUESTATISTICS& statistics = g_saveQueue.statistics;
+		if (statistics.depth >= SAVEQUEUEMAXJOBS)
+		{
+			statistics.rejectedJobs++;
+			return false;
+		}
+		g_saveQueue.entries.push_back({ job, std::chrono::steady_clock::now() });
+		statistics.depth++;
+		if (statistics.depth > statistics.maxDepth) statistics.maxDepth = statistics.depth;
+	}
+	catch (...) { // No thread or out of memory
+		return false;
+	}
+	g_saveQueue.jobAvailable.notify_one();
+	return true;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: waitForSaveJobs
+
+  Summary:   Waits until all jobs of the save queue are finished
+
+  Args:
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void waitForSaveJobs()
+{
+	std::unique_lock<std::mutex> lock(g_saveQueue.mutex);
+	g_saveQueue.jobFinished.wait(lock, [] { return g_saveQueue.statistics.depth == 0; });
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: stopSaveQueue
+
+  Summary:   Finishes all waiting jobs and ends the writer thread. Later jobs
+             are rejected.
+
+  Args:
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void stopSaveQueue()
+{
+	{
+		std::lock_guard<std::mutex> lock(g_saveQueue.mutex);
+		g_saveQueue.bStop = true;
+	}
+	g_saveQueue.jobAvailable.notify_one();
+	if (g_saveQueue.writerThread.joinable()) g_saveQueue.writerThread.join();
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getSaveQueueStatistics
+
+  Summary:   Gets depth and latencies of the save queue
+
+  Args:
+
+  Returns:  SAVEQUEUESTATISTICS
+
+-----------------------------------------------------------------F-F*/
+SAVEQUEUESTATISTICS getSaveQueueStatistics()
+{
+	std::lock_guard<std::mutex> lock(g_saveQueue.mutex);
+	return g_saveQueue.statistics;
+}
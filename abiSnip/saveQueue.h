@@ -0,0 +1,35 @@
+/*+===================================================================
+  File:      saveQueue.h
+
+  Summary:   Bounded queue of save jobs, which are processed one after another
+             by a background writer thread.
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#pragma once
+
+#include <functional>
+
+#define SAVEQUEUEMAXJOBS 4 // Max jobs waiting or running (enqueueSaveJob rejects jobs, when the queue is full)
+
+// Job for the writer thread
+typedef std::function<void()> SAVEJOBFUNCTION;
+
+// Statistics of the save queue
+struct SAVEQUEUESTATISTICS {
+	int depth = 0; // Jobs waiting or running
+	int maxDepth = 0; // Highest depth since program start
+	unsigned int finishedJobs = 0; // Finished jobs since program start
+	unsigned int rejectedJobs = 0; // Jobs rejected since program start, because the queue was full
+	double lastLatency = 0; // Milliseconds from enqueueing to the end of the last finished job
+	double maxLatency = 0; // Highest latency in milliseconds
+	double lastWaitTime = 0; // Milliseconds the last finished job was waiting in the queue
+};
+
+bool enqueueSaveJob(const SAVEJOBFUNCTION& job);
+void waitForSaveJobs();
+void stopSaveQueue();
+SAVEQUEUESTATISTICS getSaveQueueStatistics();
@@ -0,0 +1,116 @@
+/*+===================================================================
+  File:      settingsResolver.cpp
+
+  Summary:   Precedence of the registry locations for program settings:
+             1. GPO under HKCU, GPO under HKLM, user settings under HKCU
+             2. GPO recommended under HKCU, GPO recommended under HKLM
+             3. Program default
+             The first found value of a level is used, when it is valid.
+             Otherwise the next level is checked. Settings without GPO
+             support only use the user settings and the program default.
+
+             Has no dependencies to the Win32-API and can be compiled on other
+             platforms to test the precedence rules.
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "settingsResolver.h"
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: isPolicySettingSource
+
+  Summary:   Checks, if a registry location forces a setting by GPO
+
+  Args:     SETTINGSOURCE source
+              Registry location
+
+  Returns:  bool
+
+-----------------------------------------------------------------F-F*/
+bool isPolicySettingSource(SETTINGSOURCE source)
+{
+	return (source == settingSourceUserPolicy) || (source == settingSourceMachinePolicy);
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: resolveSettingSource
+
+  Summary:   Gets the registry location, which is used for a setting
+
+  Args:     const bool bFound[SETTINGSOURCES]
+              true, when the value exists in the registry location
+            bool bPolicyAllowed
+              true = setting supports GPO and GPO recommended values
+            const SETTINGVALIDATEFUNCTION &isValid
+              Optional check of a found value
+
+  Returns:  SETTINGRESOLUTION
+
+-----------------------------------------------------------------F-F*/
+SETTINGRESOLUTION resolveSettingSource(const bool bFound[SETTINGSOURCES], bool bPolicyAllowed, const SETTINGVALIDATEFUNCTION& isValid)
+{
+	static const SETTINGSOURCE levelPolicy[] = { settingSourceUserPolicy, settingSourceMachinePolicy, settingSourceUser };
+	static const SETTINGSOURCE levelUser[] = { settingSourceUser };
+	static const SETTINGSOURCE levelRecommended[] = { settingSourceUserRecommended, settingSourceMachineRecommended };
+
+	struct LEVEL {
+		const SETTINGSOURCE* pSources;
+		int count;
+	};
+	LEVEL levels[2];
+	int levelCount = 0;
+	if (bPolicyAllowed)
+	{
+		levels[levelCount++] = { levelPolicy, 3 };
+		levels[levelCount++] = { levelRecommended, 2 };
+	}
+	else levels[levelCount++] = { levelUser, 1 };
+
+	SETTINGRESOLUTION resolution;
+	for (int level = 0; level < levelCount; level++)
+	{
+		for (int i = 0; i < levels[level].count; i++)
+		{
+			SETTINGSOURCE source = levels[level].pSources[i];
+			if (!bFound[source]) continue;
+
+			// First found value of the level is used or rejected as a whole
+			if (isPolicySettingSource(source)) resolution.bPolicy = true;
+			if (!isValid || isValid(source))
+			{
+				resolution.source = source;
+				return resolution;
+			}
+			break;
+		}
+	}
+	return resolution;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: resolveDWORDSetting
+
+  Summary:   Gets the value of a DWORD setting without limit checks
+
+  Args:     const DWORDSETTINGCANDIDATES &candidates
+              Values found in the registry locations
+            bool bPolicyAllowed
+              true = setting supports GPO and GPO recommended values
+            uint32_t defaultValue
+              Program default
+            bool *pbPolicy
+              Optional, receives true, when the value is forced by a GPO
+
+  Returns:  uint32_t
+
+-----------------------------------------------------------------F-F*/
+uint32_t resolveDWORDSetting(const DWORDSETTINGCANDIDATES& candidates, bool bPolicyAllowed, uint32_t defaultValue, bool* pbPolicy)
+{
+	SETTINGRESOLUTION resolution = resolveSettingSource(candidates.bFound, bPolicyAllowed);
+	if (pbPolicy != nullptr) *pbPolicy = resolution.bPolicy;
+	if (resolution.source == settingSourceDefault) return defaultValue;
+	return candidates.value[resolution.source];
+}
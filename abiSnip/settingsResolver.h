@@ -0,0 +1,48 @@
+/*+===================================================================
+  File:      settingsResolver.h
+
+  Summary:   Precedence of the registry locations for program settings
+             (GPO, user settings, GPO recommended defaults, program default).
+             The registry values are read by the caller, so the rules can be
+             used with a cached snapshot of the registry.
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+// Registry locations of a setting in the order of precedence
+enum SETTINGSOURCE {
+	settingSourceUserPolicy, // GPO path under HKCU (forced)
+	settingSourceMachinePolicy, // GPO path under HKLM (forced)
+	settingSourceUser, // Program settings under HKCU
+	settingSourceUserRecommended, // GPO recommended path under HKCU (default)
+	settingSourceMachineRecommended, // GPO recommended path under HKLM (default)
+	settingSourceDefault // Not found in the registry, program default is used
+};
+#define SETTINGSOURCES 5 // Number of registry locations (without settingSourceDefault)
+#define SETTINGSOURCESALL ((1u << SETTINGSOURCES) - 1) // Bit mask of all registry locations
+
+// Registry values of a DWORD setting found in the registry locations
+struct DWORDSETTINGCANDIDATES {
+	bool bFound[SETTINGSOURCES] = {}; // true, when the value exists in the registry location
+	uint32_t value[SETTINGSOURCES] = {}; // Value of the registry location
+};
+
+// Result of the precedence rules
+struct SETTINGRESOLUTION {
+	SETTINGSOURCE source = settingSourceDefault; // Used registry location
+	bool bPolicy = false; // true, when the setting is forced by a GPO (even if the GPO value was rejected)
+};
+
+// Check of a found value, for example an existing folder (returns false to reject the value)
+typedef std::function<bool(SETTINGSOURCE source)> SETTINGVALIDATEFUNCTION;
+
+bool isPolicySettingSource(SETTINGSOURCE source);
+SETTINGRESOLUTION resolveSettingSource(const bool bFound[SETTINGSOURCES], bool bPolicyAllowed, const SETTINGVALIDATEFUNCTION& isValid = nullptr);
+uint32_t resolveDWORDSetting(const DWORDSETTINGCANDIDATES& candidates, bool bPolicyAllowed, uint32_t defaultValue, bool* pbPolicy = nullptr);
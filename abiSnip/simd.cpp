@@ -0,0 +1,86 @@
+/*+===================================================================
+  File:      simd.cpp
+
+  Summary:   Detection of the SSE2/AVX2 support of the CPU and operating system
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "simd.h"
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#ifdef SIMDX86
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: isAVX2Supported
+
+  Summary:   Checks if CPU and OS support AVX2
+
+  Args:
+
+  Returns:  bool
+
+-----------------------------------------------------------------F-F*/
+static bool isAVX2Supported()
+{
+#if defined(_MSC_VER)
+	int cpuInfo[4];
+	__cpuid(cpuInfo, 0);
+	if (cpuInfo[0] < 7) return false;
+	__cpuid(cpuInfo, 1);
+	if ((cpuInfo[2] & (1 << 27)) == 0) return false; // OSXSAVE
+	if ((cpuInfo[2] & (1 << 28)) == 0) return false; // AVX
+	if ((_xgetbv(0) & 6) != 6) return false; // OS saves XMM and YMM registers
+	__cpuidex(cpuInfo, 7, 0);
+	return (cpuInfo[1] & (1 << 5)) != 0; // AVX2
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: isSSE2Supported
+
+  Summary:   Checks if CPU supports SSE2 (always true on x64)
+
+  Args:
+
+  Returns:  bool
+
+-----------------------------------------------------------------F-F*/
+static bool isSSE2Supported()
+{
+#if defined(_M_X64) || defined(__x86_64__)
+	return true;
+#elif defined(_MSC_VER)
+	int cpuInfo[4];
+	__cpuid(cpuInfo, 1);
+	return (cpuInfo[3] & (1 << 26)) != 0;
+#else
+	return __builtin_cpu_supports("sse2");
+#endif
+}
+#endif
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getSIMDLevel
+
+  Summary:   Gets best instruction set extension supported by CPU and OS (detected once)
+
+  Args:
+
+  Returns:  SIMDLEVEL
+
+-----------------------------------------------------------------F-F*/
+SIMDLEVEL getSIMDLevel()
+{
+#ifdef SIMDX86
+	static const SIMDLEVEL level = isAVX2Supported() ? simdLevelAVX2 : (isSSE2Supported() ? simdLevelSSE2 : simdLevelNone);
+	return level;
+#else
+	return simdLevelNone;
+#endif
+}
@@ -0,0 +1,35 @@
+/*+===================================================================
+  File:      simd.h
+
+  Summary:   Compiler and CPU support for the SSE2/AVX2 kernels of the image functions.
+             SIMDX86 is defined for x86/x64 builds. Functions using AVX2 intrinsics
+             must be marked with SIMDAVX2FUNCTION and may only be called when
+             getSIMDLevel() returns simdLevelAVX2.
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#pragma once
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define SIMDX86 // x86/x64 CPU with SSE2/AVX2 kernels
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#define SIMDSSE2FUNCTION
+#define SIMDAVX2FUNCTION
+#else
+#define SIMDSSE2FUNCTION __attribute__((target("sse2")))
+#define SIMDAVX2FUNCTION __attribute__((target("avx2")))
+#endif
+#endif
+
+// Instruction set extensions
+enum SIMDLEVEL {
+	simdLevelNone, // Plain C++
+	simdLevelSSE2, // SSE2 intrinsics
+	simdLevelAVX2 // AVX2 intrinsics
+};
+
+SIMDLEVEL getSIMDLevel();
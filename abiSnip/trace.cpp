@@ -0,0 +1,314 @@
+/*+===================================================================
+  File:      trace.cpp
+
+  Summary:   Recording of complete events ("ph":"X") for the Chrome trace-event
+             JSON format. Events can be added from every thread. Each thread
+             gets a small thread id in the order of its first event.
+
+             Has no dependencies to the Win32-API and can be compiled on other
+             platforms to test the trace writer.
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "trace.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+// Recorded complete event
+struct TRACEEVENT {
+	std::string name; // Event name
+	const char* category; // Event category (string literal)
+	int64_t start; // Start in microseconds since enableTrace
+	int64_t duration; // Duration in microseconds
+	int threadId; // Small thread id
+};
+
+// Recorded events and state of the trace
+struct TRACE {
+	std::atomic<bool> bEnabled{ false }; // true, when events are recorded
+	std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now(); // Time of enableTrace (ts = 0)
+	std::mutex mutex; // Protects events and droppedEvents
+	std::vector<TRACEEVENT> events; // Recorded events
+	size_t droppedEvents = 0; // Events not recorded, because TRACEMAXEVENTS was reached
+	std::atomic<int> nextThreadId{ 1 }; // Next small thread id
+};
+
+static TRACE g_traceState;
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getTraceThreadId
+
+  Summary:   Gets the small thread id of the calling thread
+
+  Args:
+
+  Returns:  int
+
+-----------------------------------------------------------------F-F*/
+static int getTraceThreadId()
+{
+	thread_local int threadId = 0;
+	if (threadId == 0) threadId = g_traceState.nextThreadId++;
+	return threadId;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: appendJSONString
+
+  Summary:   Appends a string with JSON escaping and quotes
+
+  Args:     std::string &json
+              Target (call by ref)
+            const char* pText
+              Text (UTF-8)
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+static void appendJSONString(std::string& json, const char* pText)
+{
+	json.push_back('"');
+	for (const char* p = pText; *p != '\0'; p++)
+	{
+		unsigned char c = (unsigned char)*p;
+		switch (c)
+		{
+			case '"': json.append("\\\""); break;
+			case '\\': json.append("\\\\"); break;
+			case '\n': json.append("\\n"); break;
+			case '\r': json.append("\\r"); break;
+			case '\t': json.append("\\t"); break;
+			default:
+				if (c < 0x20) // Other control characters
+				{
+					char szEscape[8];
+					snprintf(szEscape, sizeof(szEscape), "\\u%04x", c);
+					json.append(szEscape);
+				}
+				else json.push_back((char)c);
+		}
+	}
+	json.push_back('"');
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: enableTrace
+
+  Summary:   Enables or disables the recording of events. Enabling clears the
+             recorded events and restarts the time at 0.
+
+  Args:     bool bEnabled
+              true = record events
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void enableTrace(bool bEnabled)
+{
+	if (bEnabled)
+	{
+		clearTrace();
+		g_traceState.origin = std::chrono::steady_clock::now();
+	}
+	g_traceState.bEnabled = bEnabled;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: isTraceEnabled
+
+  Summary:   Checks, if events are recorded
+
+  Args:
+
+  Returns:  bool
+
+-----------------------------------------------------------------F-F*/
+bool isTraceEnabled()
+{
+	return g_traceState.bEnabled;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getTraceMicroseconds
+
+  Summary:   Gets microseconds since the trace was enabled
+
+  Args:
+
+  Returns:  int64_t
+
+-----------------------------------------------------------------F-F*/
+int64_t getTraceMicroseconds()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - g_traceState.origin).count();
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: addTraceEvent
+
+  Summary:   Records a complete event for the calling thread (ignored, when
+             tracing is disabled)
+
+  Args:     const std::string &name
+              Event name
+            const char* category
+              Event category (string literal)
+            int64_t start
+              Start in microseconds since the trace was enabled
+            int64_t duration
+              Duration in microseconds
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void addTraceEvent(const std::string& name, const char* category, int64_t start, int64_t duration)
+{
+	if (!g_traceState.bEnabled) return;
+	int threadId = getTraceThreadId();
+
+	try {
+		std::lock_guard<std::mutex> lock(g_traceState.mutex);
+		if (g_traceState.events.size() >= TRACEMAXEVENTS)
+		{
+			g_traceState.droppedEvents++;
+			return;
+		}
+		g_traceState.events.push_back({ name, category, start, duration, threadId });
+	}
+	catch (...) { // Out of memory, drop event
+	}
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getTraceEventCount
+
+  Summary:   Gets number of recorded events
+
+  Args:
+
+  Returns:  size_t
+
+-----------------------------------------------------------------F-F*/
+size_t getTraceEventCount()
+{
+	std::lock_guard<std::mutex> lock(g_traceState.mutex);
+	return g_traceState.events.size();
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getDroppedTraceEventCount
+
+  Summary:   Gets number of events, which were dropped because
+             TRACEMAXEVENTS was reached
+
+  Args:
+
+  Returns:  size_t
+
+-----------------------------------------------------------------F-F*/
+size_t getDroppedTraceEventCount()
+{
+	std::lock_guard<std::mutex> lock(g_traceState.mutex);
+	return g_traceState.droppedEvents;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: clearTrace
+
+  Summary:   Removes all recorded events
+
+  Args:
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void clearTrace()
+{
+	std::lock_guard<std::mutex> lock(g_traceState.mutex);
+	std::vector<TRACEEVENT>().swap(g_traceState.events);
+	g_traceState.droppedEvents = 0;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: writeTraceJSON
+
+  Summary:   Writes the recorded events as Chrome trace-event JSON object
+             ({"traceEvents":[...]}). The events stay recorded, so the
+             output can be written again later with more events.
+
+  Args:     const TRACEWRITEFUNCTION &write
+              Output function
+
+  Returns:  bool
+              true = success
+              false = write error
+
+-----------------------------------------------------------------F-F*/
+bool writeTraceJSON(const TRACEWRITEFUNCTION& write)
+{
+	std::lock_guard<std::mutex> lock(g_traceState.mutex);
+	std::string json;
+	char szData[160];
+
+	json.assign("{\"traceEvents\":[\n");
+	for (size_t i = 0; i < g_traceState.events.size(); i++)
+	{
+		const TRACEEVENT& event = g_traceState.events[i];
+		json.append("{\"name\":");
+		appendJSONString(json, event.name.c_str());
+		json.append(",\"cat\":");
+		appendJSONString(json, event.category);
+		snprintf(szData, sizeof(szData), ",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":1,\"tid\":%d}%s\n",
+			(long long)event.start, (long long)event.duration, event.threadId, (i + 1 < g_traceState.events.size()) ? "," : "");
+		json.append(szData);
+
+		if (json.size() >= 65536) // Write in blocks
+		{
+			if (!write(json.data(), json.size())) return false;
+			json.clear();
+		}
+	}
+	snprintf(szData, sizeof(szData), "],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":%llu}}\n", (unsigned long long)g_traceState.droppedEvents);
+	json.append(szData);
+	return write(json.data(), json.size());
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: TRACESCOPE::TRACESCOPE
+
+  Summary:   Starts a scoped timer
+
+  Args:     const char* pName
+              Event name
+            const char* pCategory
+              Event category
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+TRACESCOPE::TRACESCOPE(const char* pName, const char* pCategory) : name(pName), category(pCategory)
+{
+	start = g_traceState.bEnabled ? getTraceMicroseconds() : -1;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: TRACESCOPE::~TRACESCOPE
+
+  Summary:   Ends a scoped timer and records the event
+
+  Args:
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+TRACESCOPE::~TRACESCOPE()
+{
+	if (start < 0) return;
+	addTraceEvent(name, category, start, getTraceMicroseconds() - start);
+}
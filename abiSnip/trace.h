@@ -0,0 +1,45 @@
+/*+===================================================================
+  File:      trace.h
+
+  Summary:   Scoped timers, which record complete events in the Chrome
+             trace-event JSON format (chrome://tracing, ui.perfetto.dev).
+             Tracing is off by default and costs only a flag check per scope.
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#define TRACEMAXEVENTS 100000 // Max recorded events (later events are dropped and counted)
+#define TRACEDEFAULTCATEGORY "abiSnip" // Category for events without an explicit category
+
+// Output function for the JSON data (returns false on a write error)
+typedef std::function<bool(const char* pData, size_t size)> TRACEWRITEFUNCTION;
+
+// Scoped timer, records a complete event from construction to destruction when tracing is enabled
+struct TRACESCOPE {
+	TRACESCOPE(const char* pName, const char* pCategory = TRACEDEFAULTCATEGORY);
+	~TRACESCOPE();
+	TRACESCOPE(const TRACESCOPE&) = delete;
+	TRACESCOPE& operator=(const TRACESCOPE&) = delete;
+
+	const char* name; // Event name (must be valid until destruction)
+	const char* category; // Event category (must be valid until destruction)
+	int64_t start; // Start in microseconds since enableTrace or -1, when tracing was disabled at construction
+};
+
+void enableTrace(bool bEnabled);
+bool isTraceEnabled();
+int64_t getTraceMicroseconds();
+void addTraceEvent(const std::string& name, const char* category, int64_t start, int64_t duration);
+size_t getTraceEventCount();
+size_t getDroppedTraceEventCount();
+void clearTrace();
+bool writeTraceJSON(const TRACEWRITEFUNCTION& write);
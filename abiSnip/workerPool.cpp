@@ -0,0 +1,211 @@
+/*+===================================================================
+  File:      workerPool.cpp
+
+  Summary:   Small pool of worker threads to split CPU heavy image operations into
+             independent tasks. The threads are started on first use, wait for
+             work and are never stopped (they end with the process).
+
+             Has no dependencies to the Win32-API and can be compiled on other
+             platforms to test and benchmark the image functions.
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "workerPool.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+// Tasks of one runWorkerTasks call (on the stack of the caller)
+struct WORKERTASKGROUP {
+	const std::function<void(int)>* pTask; // Task function
+	int taskCount; // Number of tasks
+	int nextTask; // Next task to be processed
+	int finishedTasks; // Tasks already processed
+};
+
+// Shared state of the worker pool
+struct WORKERPOOL {
+	std::mutex mutex; // Protects the members below and the members of the task groups
+	std::condition_variable workAvailable; // Signaled when a new task group is added
+	std::condition_variable workDone; // Signaled when the last task of a task group is finished
+	std::deque<WORKERTASKGROUP*> groups; // Task groups with unprocessed tasks, oldest first
+	int workers = 0; // Worker threads (without the calling thread)
+};
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: takeTask
+
+  Summary:   Takes the next task of a task group and removes the group from
+             the pool, when it was the last task (pool.mutex must be locked)
+
+  Args:     WORKERPOOL &pool
+              Worker pool
+            WORKERTASKGROUP &group
+              Task group with unprocessed tasks
+
+  Returns:  int
+              Task
+
+-----------------------------------------------------------------F-F*/
+static int takeTask(WORKERPOOL& pool, WORKERTASKGROUP& group)
+{
+	int task = group.nextTask++;
+	if (group.nextTask >= group.taskCount) pool.groups.erase(std::find(pool.groups.begin(), pool.groups.end(), &group));
+	return task;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: processTask
+
+  Summary:   Processes a task and counts it as finished. The group must not
+             be used afterwards, because its caller can return as soon as
+             the last task is counted.
+
+  Args:     WORKERPOOL &pool
+              Worker pool
+            WORKERTASKGROUP &group
+              Task group
+            int task
+              Task taken with takeTask
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+static void processTask(WORKERPOOL& pool, WORKERTASKGROUP& group, int task)
+{
+	(*group.pTask)(task);
+
+	bool bGroupDone;
+	{
+		std::lock_guard<std::mutex> lock(pool.mutex);
+		bGroupDone = ++group.finishedTasks == group.taskCount;
+	}
+	if (bGroupDone) pool.workDone.notify_all();
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: workerThread
+
+  Summary:   Main function of a worker thread
+
+  Args:     WORKERPOOL *pPool
+              Worker pool
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+static void workerThread(WORKERPOOL* pPool)
+{
+	while (true)
+	{
+		WORKERTASKGROUP* pGroup;
+		int task;
+		{
+			std::unique_lock<std::mutex> lock(pPool->mutex);
+			pPool->workAvailable.wait(lock, [&] { return !pPool->groups.empty(); });
+			pGroup = pPool->groups.front();
+			task = takeTask(*pPool, *pGroup);
+		}
+		processTask(*pPool, *pGroup, task);
+	}
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getWorkerPool
+
+  Summary:   Gets worker pool and starts the worker threads on first use
+
+  Args:
+
+  Returns:  WORKERPOOL&
+
+-----------------------------------------------------------------F-F*/
+static WORKERPOOL& getWorkerPool()
+{
+	// Never deleted, because the detached threads use the pool until the process ends
+	static WORKERPOOL* pPool = [] {
+		WORKERPOOL* pNewPool = new WORKERPOOL;
+		int threads = (int)std::thread::hardware_concurrency();
+		if (threads > WORKERPOOLMAXTHREADS) threads = WORKERPOOLMAXTHREADS;
+		for (int i = 0; i < threads - 1; i++)
+		{
+			try {
+				std::thread(workerThread, pNewPool).detach();
+				pNewPool->workers++;
+			}
+			catch (...) { // No more threads => use the threads started so far
+				break;
+			}
+		}
+		return pNewPool;
+	}();
+	return *pPool;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getWorkerThreadCount
+
+  Summary:   Gets number of threads used by runWorkerTasks (including the calling thread)
+
+  Args:
+
+  Returns:  int
+
+-----------------------------------------------------------------F-F*/
+int getWorkerThreadCount()
+{
+	return getWorkerPool().workers + 1;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: runWorkerTasks
+
+  Summary:   Runs tasks 0...taskCount-1 on the worker threads and the calling thread
+             and returns when all tasks are finished. The order of the tasks is
+             undefined, so tasks must be independent. Several threads can call
+             runWorkerTasks at the same time: each call is a task group of its
+             own and the calling thread processes its own tasks, so a call never
+             waits for the tasks of another call (for example the pixelation on
+             the UI thread for the compression on the save writer thread).
+
+  Args:     int taskCount
+              Number of tasks
+            const std::function<void(int task)> &task
+              Function called once for each task
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+void runWorkerTasks(int taskCount, const std::function<void(int task)>& task)
+{
+	if (taskCount <= 0) return;
+
+	WORKERPOOL& pool = getWorkerPool();
+	if ((taskCount == 1) || (pool.workers == 0))
+	{
+		for (int i = 0; i < taskCount; i++) task(i);
+		return;
+	}
+
+	WORKERTASKGROUP group = { &task, taskCount, 0, 0 };
+	{
+		std::lock_guard<std::mutex> lock(pool.mutex);
+		pool.groups.push_back(&group);
+	}
+	pool.workAvailable.notify_all();
+
+	std::unique_lock<std::mutex> lock(pool.mutex);
+	while (group.nextTask < group.taskCount)
+	{
+		int currentTask = takeTask(pool, group);
+		lock.unlock();
+		processTask(pool, group, currentTask);
+		lock.lock();
+	}
+	pool.workDone.wait(lock, [&] { return group.finishedTasks == group.taskCount; }); // Tasks still processed by workers
+}
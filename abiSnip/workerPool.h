@@ -0,0 +1,19 @@
+/*+===================================================================
+  File:      workerPool.h
+
+  Summary:   Small pool of worker threads to split CPU heavy image operations into
+             independent tasks.
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#pragma once
+
+#include <functional>
+
+#define WORKERPOOLMAXTHREADS 16 // Maximum threads (including the calling thread) used by runWorkerTasks
+
+int getWorkerThreadCount();
+void runWorkerTasks(int taskCount, const std::function<void(int task)>& task);
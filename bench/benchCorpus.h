@@ -0,0 +1,139 @@
+/*+===================================================================
+  File:      benchCorpus.h
+
+  Summary:   Synthetic screenshots and timing helpers for the benchmarks.
+             The screenshots are generated with a fixed seed, so results of
+             different builds and machines can be compared.
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#pragma once
+
+#include "imageBuffer.h"
+#include <chrono>
+#include <cstdint>
+
+#define BENCHCORPUSSIZE 4 // Number of corpus screenshots
+
+// Screenshot types of the corpus
+enum BENCHCORPUS {
+	benchCorpusDesktop, // 4K desktop with text window, gradient window and taskbar
+	benchCorpusCodeEditor, // 4K dark code editor with colored text
+	benchCorpusPhoto, // 4K photo-like wallpaper with noise
+	benchCorpusDialogs // 1080p light dialogs with black and gray text
+};
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getBenchCorpusName
+
+  Summary:   Gets name of a corpus screenshot
+
+  Args:     int corpus
+              BENCHCORPUS
+
+  Returns:  const char*
+
+-----------------------------------------------------------------F-F*/
+inline const char* getBenchCorpusName(int corpus)
+{
+	switch (corpus)
+	{
+		case benchCorpusDesktop: return "4K mixed desktop";
+		case benchCorpusCodeEditor: return "4K dark code editor";
+		case benchCorpusPhoto: return "4K photo wallpaper";
+		default: return "1080p light dialogs";
+	}
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: nextBenchRandom
+
+  Summary:   Small pseudo random generator (same numbers on all platforms)
+
+  Args:     uint32_t &state
+              State (call by ref)
+
+  Returns:  uint32_t
+
+-----------------------------------------------------------------F-F*/
+inline uint32_t nextBenchRandom(uint32_t& state)
+{
+	state = state * 1664525u + 1013904223u;
+	return state >> 8;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: createBenchCorpus
+
+  Summary:   Creates a synthetic screenshot
+
+  Args:     int corpus
+              BENCHCORPUS
+            IMAGEBUFFER &image
+              Created image (call by ref, must be freed with freeImageBuffer)
+
+  Returns:  bool
+              true = success
+              false = out of memory
+
+-----------------------------------------------------------------F-F*/
+inline bool createBenchCorpus(int corpus, IMAGEBUFFER& image)
+{
+	int width = (corpus == benchCorpusDialogs) ? 1920 : 3840;
+	int height = (corpus == benchCorpusDialogs) ? 1080 : 2160;
+	if (!createImageBuffer(image, width, height)) return false;
+
+	uint32_t random = (uint32_t)corpus + 1;
+	for (int y = 0; y < height; y++)
+	{
+		IMAGEPIXEL* pRow = imageRow(image, y);
+		for (int x = 0; x < width; x++)
+		{
+			IMAGEPIXEL color;
+			switch (corpus)
+			{
+				case benchCorpusDesktop:
+					color = 0x1E1E1E;
+					if ((x > 200) && (x < 1800) && (y > 100) && (y < 1500))
+					{
+						color = 0xFFFFFF;
+						if (((y % 18) < 12) && ((x % 9) < 6) && (((x * 7 + y * 13) % 11) < 5)) color = 0x202020;
+					}
+					if ((x > 2000) && (x < 3400) && (y > 300) && (y < 1900)) color = IMAGEPIXELRGB(x / 7 + y / 11, (x * y) / 9000, (x + y) / 17) ^ (nextBenchRandom(random) % 4);
+					if (y > 2100) color = 0x303A48;
+					break;
+				case benchCorpusCodeEditor:
+					color = 0x1E1E1E;
+					if (x < 300) color = 0x252526;
+					if (y < 40) color = 0x3C3C3C;
+					if ((x > 320) && ((y % 22) > 5) && ((y % 22) < 18) && ((((x / 9) * 31 + (y / 22) * 17) % 7) < 5) && ((x / 9) % (40 + (y / 22) % 60) < 30 + (y / 22) % 50))
+					{
+						const IMAGEPIXEL colors[4] = { 0x569CD6, 0xCE9178, 0xD4D4D4, 0x6A9955 };
+						color = colors[((x / 45) + (y / 22)) % 4];
+						if (((x * 13 + y * 7) % 9) < 3) color = (color >> 1) & 0x7F7F7F; // Antialiasing
+					}
+					break;
+				case benchCorpusPhoto:
+					color = IMAGEPIXELRGB(x / 15 + y / 9 + nextBenchRandom(random) % 6, x * y / 30000 + nextBenchRandom(random) % 6, (x ^ y) / 20 + nextBenchRandom(random) % 6);
+					break;
+				default:
+					color = 0xF3F3F3;
+					if ((x / 480 + y / 270) % 3 == 0) color = 0xFFFFFF;
+					if ((x % 480 < 2) || (y % 270 < 2)) color = 0xD0D0D0;
+					if (((x % 480) > 40) && ((x % 480) < 400) && ((y % 270) > 40) && ((y % 270) < 230) && ((y % 16) < 11) && (((x / 7 + y / 16) % 5) < 4) && ((x % 7) < 5)) color = (((x + y) % 3) == 0) ? 0x808080 : 0x000000;
+			}
+			pRow[x] = color;
+		}
+	}
+	return true;
+}
+
+// Stopwatch in milliseconds
+struct BENCHTIMER {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now(); // Start time
+
+	double elapsed() const { return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(); }
+};
@@ -0,0 +1,201 @@
+/*+===================================================================
+  File:      captureHistoryBench.cpp
+
+  Summary:   Benchmark of the capture history (keyframes and tile deltas)
+             with replayed frames: 60 seconds of 4K background captures
+             every 500 ms with the default memory budget of 256 MB per
+             scenario. The frames are recorded into replay files in memory
+             (BENCHREPLAYFRAMES captures per file to limit the memory) and
+             delivered by the replay capture source like /replay=.
+             Each stored frame is restored and compared with the original.
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "benchCorpus.h"
+#include "captureHistory.h"
+#include <cstdio>
+#include <cstring>
+#include <map>
+
+#define BENCHFRAMES 120 // Captures per scenario
+#define BENCHREPLAYFRAMES 20 // Captures per replay file
+#define BENCHINTERVAL 500 // Milliseconds between two captures
+#define BENCHMAXAGE 30000 // Milliseconds of captures kept in the history
+#define BENCHMAXBYTES (256 * 1024 * 1024) // Memory budget of the history
+
+// Scenarios of changes between the captures
+enum BENCHSCENARIO {
+	benchScenarioClock, // Only the taskbar clock changes
+	benchScenarioTooltip, // Clock and a moving tooltip
+	benchScenarioWindow, // Clock and a large window, which opens and closes every 10 seconds
+	benchScenarioVideo, // Clock and a small video
+	benchScenarioScroll, // Code editor, which scrolls one line per capture
+	BENCHSCENARIOS
+};
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getBenchScenarioName
+
+  Summary:   Gets name of a scenario
+
+  Args:     int scenario
+              BENCHSCENARIO
+
+  Returns:  const char*
+
+-----------------------------------------------------------------F-F*/
+static const char* getBenchScenarioName(int scenario)
+{
+	switch (scenario)
+	{
+		case benchScenarioClock: return "clock";
+		case benchScenarioTooltip: return "moving tooltip";
+		case benchScenarioWindow: return "window switch";
+		case benchScenarioVideo: return "480x270 video";
+		default: return "scrolling editor";
+	}
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: createScenarioFrame
+
+  Summary:   Creates a capture of a scenario
+
+  Args:     int scenario
+              BENCHSCENARIO
+            int frame
+              Number of the capture
+            const IMAGEBUFFER &base
+              Desktop or code editor from the corpus
+            const IMAGEBUFFER &image
+              Capture with the size of base
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+static void createScenarioFrame(int scenario, int frame, const IMAGEBUFFER& base, const IMAGEBUFFER& image)
+{
+	IMAGEBUFFER view;
+	if (scenario == benchScenarioScroll)
+	{
+		int offset = (frame * 22) % base.height;
+		for (int y = 0; y < image.height; y++) memcpy(imageRow(image, y), imageRow(base, (y + offset) % base.height), (size_t)base.width * IMAGEBYTESPERPIXEL);
+		return;
+	}
+
+	copyImage(image, base);
+	if (getImageView(image, image.width - 100, image.height - 40, 60, 20, view)) fillImage(view, IMAGEPIXELRGB(frame, 255 - frame, 0xFF)); // Clock
+	switch (scenario)
+	{
+		case benchScenarioTooltip:
+			if (((frame % 10) < 6) && getImageView(image, 500 + frame * 7, 900 + (frame % 13) * 5, 320, 48, view)) fillImage(view, 0xFFFFC8);
+			break;
+		case benchScenarioWindow:
+			if ((((frame / 20) % 2) == 1) && getImageView(image, 1000, 300, 2000, 1400, view)) fillImage(view, 0xC8DCF0);
+			break;
+		case benchScenarioVideo:
+			if (getImageView(image, 2400, 1200, 480, 270, view))
+			{
+				uint32_t random = (uint32_t)frame + 1;
+				for (int y = 0; y < view.height; y++)
+					for (int x = 0; x < view.width; x++) imageRow(view, y)[x] = IMAGEPIXELRGB(x / 2 + frame, y + nextBenchRandom(random) % 8, 128);
+			}
+			break;
+	}
+}
+
+int main()
+{
+	printf("| Scenario | Recorded MB | Stored frames | Keyframes | Delta add ms | Keyframe add ms | History MB | Restore max ms |\n|---|---|---|---|---|---|---|---|\n");
+	for (int scenario = 0; scenario < BENCHSCENARIOS; scenario++)
+	{
+		IMAGEBUFFER base;
+		IMAGEBUFFER image;
+		if (!createBenchCorpus((scenario == benchScenarioScroll) ? benchCorpusCodeEditor : benchCorpusDesktop, base)) return 1;
+		if (!createImageBuffer(image, base.width, base.height)) return 1;
+		CAPTURELAYOUT layout;
+		layout.bounds = { 0, 0, base.width, base.height };
+		layout.monitors = { layout.bounds };
+		std::map<int64_t, uint64_t> hashes; // Hash of the original capture by time
+		CAPTUREHISTORY history;
+		history.maxAge = BENCHMAXAGE;
+		history.maxBytes = BENCHMAXBYTES;
+		size_t replayBytes = 0;
+		double deltaTime = 0;
+		double keyframeTime = 0;
+		int deltas = 0;
+		int keyframes = 0;
+		for (int firstFrame = 0; firstFrame < BENCHFRAMES; firstFrame += BENCHREPLAYFRAMES)
+		{
+			// Record the captures into a replay file
+			std::vector<uint8_t> file;
+			for (int frame = firstFrame; frame < firstFrame + BENCHREPLAYFRAMES; frame++)
+			{
+				createScenarioFrame(scenario, frame, base, image);
+				hashes[(int64_t)frame * BENCHINTERVAL] = hashImage(image);
+				if (!writeCaptureFrame(image, layout, [&file](const void* pData, size_t size) {
+					file.insert(file.end(), (const uint8_t*)pData, (const uint8_t*)pData + size);
+					return true;
+				})) return 1;
+			}
+			replayBytes += file.size();
+			size_t position = 0;
+			std::shared_ptr<CAPTUREREPLAY> pReplay = std::make_shared<CAPTUREREPLAY>();
+			if (!loadCaptureReplay([&file, &position](void* pData, size_t size) {
+				if (size > file.size() - position) return false;
+				memcpy(pData, file.data() + position, size);
+				position += size;
+				return true;
+			}, *pReplay)) return 1;
+			std::vector<uint8_t>().swap(file);
+
+			// Add the replayed captures to the history
+			CAPTURESOURCE source = createReplayCaptureSource(pReplay);
+			for (int frame = firstFrame; frame < firstFrame + BENCHREPLAYFRAMES; frame++)
+			{
+				if (!source.capture([](int width, int height, IMAGEBUFFER& target) { return (target.width == width) && (target.height == height); }, image, layout)) return 1;
+				BENCHTIMER timer;
+				if (!addCaptureHistoryFrame(history, image, layout, (int64_t)frame * BENCHINTERVAL)) return 1;
+				double elapsed = timer.elapsed();
+				if (history.frames.back().time != (int64_t)frame * BENCHINTERVAL) continue; // Equal to the previous capture
+				if (history.frames.back().bKeyframe)
+				{
+					keyframeTime += elapsed;
+					keyframes++;
+				}
+				else
+				{
+					deltaTime += elapsed;
+					deltas++;
+				}
+			}
+		}
+		freeImageBuffer(base);
+
+		// Restore and compare all stored frames
+		double restoreTime = 0;
+		int storedKeyframes = 0;
+		for (size_t i = 0; i < history.frames.size(); i++)
+		{
+			BENCHTIMER timer;
+			if (!restoreCaptureHistoryFrame(history, i, image)) return 1;
+			double elapsed = timer.elapsed();
+			if (elapsed > restoreTime) restoreTime = elapsed;
+			if (hashImage(image) != hashes[history.frames[i].time])
+			{
+				fprintf(stderr, "%s: restored frame %zu differs from the capture\n", getBenchScenarioName(scenario), i);
+				return 1;
+			}
+			if (history.frames[i].bKeyframe) storedKeyframes++;
+		}
+
+		printf("| %s | %.1f | %zu | %d | %.2f | %.2f | %.1f | %.1f |\n", getBenchScenarioName(scenario), (double)replayBytes / (1024 * 1024), history.frames.size(), storedKeyframes,
+			deltas ? deltaTime / deltas : 0.0, keyframes ? keyframeTime / keyframes : 0.0, (double)history.bytes / (1024 * 1024), restoreTime);
+		clearCaptureHistory(history);
+		freeImageBuffer(image);
+	}
+	return 0;
+}
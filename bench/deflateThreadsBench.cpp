@@ -0,0 +1,106 @@
+/*+===================================================================
+  File:      deflateThreadsBench.cpp
+
+  Summary:   Benchmark of the parallel chunk compression (PNG IDAT data of
+             a 3x4K virtual desktop) with 1 to N threads. Each stream is
+             decompressed and compared with the input. A second table shows
+             the pixelation time of a 4K area (P key on the UI thread), while
+             a parallel compression runs on another thread (save writer).
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "../tests/pngDecoder.h"
+#include "benchCorpus.h"
+#include "deflate.h"
+#include "pixelate.h"
+#include "workerPool.h"
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+#define BENCHREPEATS 3 // Runs per level and thread count, the fastest run is printed
+
+int main()
+{
+	// RGB rows with filter byte of three monitors with desktop, code editor and photo
+	IMAGEBUFFER monitors[3];
+	for (int corpus = 0; corpus < 3; corpus++)
+		if (!createBenchCorpus(corpus, monitors[corpus])) return 1;
+	std::vector<uint8_t> data;
+	data.reserve(((size_t)3 * 3840 * 3 + 1) * 2160);
+	for (int y = 0; y < 2160; y++)
+	{
+		data.push_back(0); // Filter type none
+		for (const IMAGEBUFFER& monitor : monitors)
+		{
+			for (int x = 0; x < monitor.width; x++)
+			{
+				IMAGEPIXEL pixel = imageRow(monitor, y)[x];
+				data.push_back((uint8_t)(pixel >> 16));
+				data.push_back((uint8_t)(pixel >> 8));
+				data.push_back((uint8_t)pixel);
+			}
+		}
+	}
+	for (IMAGEBUFFER& monitor : monitors) freeImageBuffer(monitor);
+	printf("Worker pool: %d threads, %.1f MB data\n\n", getWorkerThreadCount(), data.size() / 1048576.0);
+
+	printf("| Level | Threads | ms | MB/s | Size | Result |\n|---|---|---|---|---|---|\n");
+	for (int level : { 1, 6 })
+	{
+		for (int threads = 1; threads <= getWorkerThreadCount() || threads <= 2; threads++) // 2 threads on a single core show the costs of the chunks
+		{
+			double bestTime = 1e9;
+			std::vector<uint8_t> compressed;
+			for (int i = 0; i < BENCHREPEATS; i++)
+			{
+				compressed.clear();
+				BENCHTIMER timer;
+				if (!compressZlib(data.data(), data.size(), level, compressed, threads)) return 1;
+				double time = timer.elapsed();
+				if (time < bestTime) bestTime = time;
+			}
+			std::vector<uint8_t> decompressed;
+			bool bSame = inflateZlib(compressed.data(), compressed.size(), decompressed) && (decompressed == data);
+			printf("| %d | %d | %.0f | %.1f | %zu | %s |\n", level, threads, bestTime, data.size() / 1048576.0 / (bestTime / 1000), compressed.size(), bSame ? "identical" : "DIFFERENT");
+		}
+	}
+
+	// Pixelation on the calling thread with and without a compression of the writer thread
+	IMAGEBUFFER image;
+	if (!createBenchCorpus(benchCorpusDesktop, image)) return 1;
+	printf("\n| Pixelate 4K | ms |\n|---|---|\n");
+	for (int pass = 0; pass < 2; pass++)
+	{
+		std::atomic<bool> bStop{ false };
+		std::thread writer;
+		if (pass == 1)
+		{
+			writer = std::thread([&] {
+				while (!bStop)
+				{
+					std::vector<uint8_t> compressed;
+					compressZlib(data.data(), data.size(), 6, compressed, 0);
+				}
+			});
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		}
+		double bestTime = 1e9, worstTime = 0;
+		for (int i = 0; i < 10; i++)
+		{
+			BENCHTIMER timer;
+			pixelateImage(image, 8);
+			double time = timer.elapsed();
+			if (time < bestTime) bestTime = time;
+			if (time > worstTime) worstTime = time;
+		}
+		bStop = true;
+		if (writer.joinable()) writer.join();
+		printf("| %s | %.1f - %.1f |\n", (pass == 0) ? "Idle" : "During parallel compression", bestTime, worstTime);
+	}
+	freeImageBuffer(image);
+	return 0;
+}
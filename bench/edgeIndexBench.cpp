@@ -0,0 +1,97 @@
+/*+===================================================================
+  File:      edgeIndexBench.cpp
+
+  Summary:   Benchmark of the edge index for Shift+cursor keys: build time
+             for the screenshot corpus and a 3x4K virtual desktop, and the
+             time of a lookup compared with the scan of the screenshot
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "benchCorpus.h"
+#include "edgeIndex.h"
+#include <cstdio>
+
+#define BENCHREPEATS 3 // Builds per image and tolerance, the fastest build is printed
+#define BENCHQUERIES 100000 // Lookups per image and tolerance
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: benchEdgeIndex
+
+  Summary:   Builds the edge index of an image and prints a table row
+
+  Args:     const char* name
+              Name of the image
+            const IMAGEBUFFER &image
+              Image
+            int tolerance
+              Max difference per color channel
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+static void benchEdgeIndex(const char* name, const IMAGEBUFFER& image, int tolerance)
+{
+	const int directions[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+	EDGEINDEX index;
+	double buildTime = 1e9;
+	for (int i = 0; i < BENCHREPEATS; i++)
+	{
+		BENCHTIMER timer;
+		if (!buildEdgeIndex(image, tolerance, index)) return;
+		double time = timer.elapsed();
+		if (time < buildTime) buildTime = time;
+	}
+
+	uint32_t random = 1;
+	long long sum = 0;
+	BENCHTIMER timer;
+	for (int i = 0; i < BENCHQUERIES; i++)
+	{
+		const int* pDirection = directions[i % 4];
+		sum += findEdge(index, nextBenchRandom(random) % image.width, nextBenchRandom(random) % image.height, pDirection[0], pDirection[1]);
+	}
+	double indexTime = timer.elapsed() * 1000 / BENCHQUERIES;
+
+	random = 1;
+	timer = BENCHTIMER();
+	for (int i = 0; i < BENCHQUERIES / 100; i++)
+	{
+		const int* pDirection = directions[i % 4];
+		sum -= findEdgeByScan(image, tolerance, nextBenchRandom(random) % image.width, nextBenchRandom(random) % image.height, pDirection[0], pDirection[1]);
+	}
+	double scanTime = timer.elapsed() * 1000 / (BENCHQUERIES / 100);
+
+	printf("| %s | %d | %.1f | %zu | %.2f | %.2f |\n", name, tolerance, buildTime, index.rowEdges.size() + index.columnEdges.size(), indexTime, scanTime);
+	if (sum == 1) printf("\n"); // Keeps the lookups
+}
+
+int main()
+{
+	printf("| Image | Tolerance | Build ms | Edges | Lookup us | Scan us |\n|---|---|---|---|---|---|\n");
+	IMAGEBUFFER image, desktop;
+	for (int corpus = 0; corpus < BENCHCORPUSSIZE; corpus++)
+	{
+		if (!createBenchCorpus(corpus, image)) return 1;
+		benchEdgeIndex(getBenchCorpusName(corpus), image, 0);
+		benchEdgeIndex(getBenchCorpusName(corpus), image, 8);
+		freeImageBuffer(image);
+	}
+
+	// Three monitors with desktop, code editor and photo
+	if (!createImageBuffer(desktop, 11520, 2160)) return 1;
+	for (int corpus = 0; corpus < 3; corpus++)
+	{
+		IMAGEBUFFER view;
+		if (!createBenchCorpus(corpus, image)) return 1;
+		getImageView(desktop, corpus * 3840, 0, 3840, 2160, view);
+		copyImage(view, image);
+		freeImageBuffer(image);
+	}
+	benchEdgeIndex("3x4K desktop", desktop, 0);
+	benchEdgeIndex("3x4K desktop", desktop, 8);
+	freeImageBuffer(desktop);
+	return 0;
+}
@@ -0,0 +1,63 @@
+/*+===================================================================
+  File:      imageBufferBench.cpp
+
+  Summary:   Benchmark of the basic image buffer operations on a 4K
+             screenshot (copy of a sub-rect view, darkening, zoom and hash)
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "benchCorpus.h"
+#include <cstdio>
+
+#define BENCHREPEATS 10 // Runs per operation, the fastest run is printed
+
+int main()
+{
+	IMAGEBUFFER image, copy, view;
+	if (!createBenchCorpus(benchCorpusDesktop, image) || !createImageBuffer(copy, image.width, image.height)) return 1;
+
+	double copyTime = 1e9, viewTime = 1e9, blendTime = 1e9, zoomTime = 1e9, hashTime = 1e9;
+	uint64_t hash = 0;
+	for (int i = 0; i < BENCHREPEATS; i++)
+	{
+		BENCHTIMER timer;
+		copyImage(copy, image);
+		double time = timer.elapsed();
+		if (time < copyTime) copyTime = time;
+
+		timer = BENCHTIMER();
+		getImageView(image, 1000, 500, 1920, 1080, view);
+		copyImage(copy, view);
+		time = timer.elapsed();
+		if (time < viewTime) viewTime = time;
+
+		timer = BENCHTIMER();
+		blendImage(copy, 0, 128);
+		time = timer.elapsed();
+		if (time < blendTime) blendTime = time;
+
+		timer = BENCHTIMER();
+		zoomImage(copy, 100, 100, 64, 64, 200, 200, 8);
+		time = timer.elapsed();
+		if (time < zoomTime) zoomTime = time;
+
+		timer = BENCHTIMER();
+		hash ^= hashImage(image);
+		time = timer.elapsed();
+		if (time < hashTime) hashTime = time;
+	}
+
+	printf("| Operation (%dx%d) | ms |\n|---|---|\n", image.width, image.height);
+	printf("| copyImage full screenshot | %.2f |\n", copyTime);
+	printf("| copyImage 1920x1080 view | %.2f |\n", viewTime);
+	printf("| blendImage full screenshot | %.2f |\n", blendTime);
+	printf("| zoomImage 64x64 by 8 | %.2f |\n", zoomTime);
+	printf("| hashImage full screenshot | %.2f |\n", hashTime);
+	if (hash == 1) printf("\n"); // Keeps the hash calls
+	freeImageBuffer(image);
+	freeImageBuffer(copy);
+	return 0;
+}
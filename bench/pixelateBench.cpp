@@ -0,0 +1,70 @@
+/*+===================================================================
+  File:      pixelateBench.cpp
+
+  Summary:   Benchmark of the pixelation kernels (P key) on a 4K screenshot
+             and on a 3x4K virtual desktop (11520x2160) with one thread.
+             copyImage of the same image is printed as lower limit, because
+             a pixelation reads and writes each pixel once.
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "benchCorpus.h"
+#include "pixelate.h"
+#include <cstdio>
+
+#define BENCHREPEATS 9 // Runs per kernel, the fastest run is printed
+
+int main()
+{
+	const char* kernelNames[] = { "Auto", "Scalar", "SSE2", "AVX2" };
+	const int blockSizes[] = { 4, 8, 32 }; // 8 = PIXELATEFACTOR of the P key
+	IMAGEBUFFER corpus, image;
+	if (!createBenchCorpus(benchCorpusDesktop, corpus)) return 1;
+
+	printf("| Image | Kernel | Block size | ms |\n|---|---|---|---|\n");
+	for (int desks = 1; desks <= 3; desks += 2)
+	{
+		if (!createImageBuffer(image, corpus.width * desks, corpus.height)) return 1;
+		for (int kernel = pixelateKernelScalar; kernel <= getBestPixelateKernel(); kernel++)
+		{
+			for (int blockSize : blockSizes)
+			{
+				double bestTime = 1e9;
+				for (int i = 0; i < BENCHREPEATS; i++)
+				{
+					for (int desk = 0; desk < desks; desk++) // Same screenshot on each monitor
+					{
+						IMAGEBUFFER view;
+						getImageView(image, desk * corpus.width, 0, corpus.width, corpus.height, view);
+						copyImage(view, corpus);
+					}
+					BENCHTIMER timer;
+					pixelateImage(image, blockSize, (PIXELATEKERNEL)kernel, 1);
+					double time = timer.elapsed();
+					if (time < bestTime) bestTime = time;
+				}
+				printf("| %dx%d | %s | %d | %.2f |\n", image.width, image.height, kernelNames[kernel], blockSize, bestTime);
+			}
+		}
+
+		// Lower limit of one thread: each pixel is read and written once, like a copy of the image
+		IMAGEBUFFER copy;
+		if (!createImageBuffer(copy, image.width, image.height)) return 1;
+		double bestTime = 1e9;
+		for (int i = 0; i < BENCHREPEATS; i++)
+		{
+			BENCHTIMER timer;
+			copyImage(copy, image);
+			double time = timer.elapsed();
+			if (time < bestTime) bestTime = time;
+		}
+		printf("| %dx%d | copyImage | - | %.2f |\n", image.width, image.height, bestTime);
+		freeImageBuffer(copy);
+		freeImageBuffer(image);
+	}
+	freeImageBuffer(corpus);
+	return 0;
+}
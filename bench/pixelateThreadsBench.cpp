@@ -0,0 +1,57 @@
+/*+===================================================================
+  File:      pixelateThreadsBench.cpp
+
+  Summary:   Benchmark of the parallel pixelation (A then P on a 3x4K
+             virtual desktop) with 1 to N threads on a synthetic 11520x2160
+             image. Each result is compared with the single thread result.
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "benchCorpus.h"
+#include "pixelate.h"
+#include "workerPool.h"
+#include <cstdio>
+#include <cstring>
+
+#define BENCHREPEATS 5 // Runs per thread count, the fastest run is printed
+#define BENCHBLOCKSIZE 8 // PIXELATEFACTOR of the P key
+
+int main()
+{
+	IMAGEBUFFER source, expected, image;
+	if (!createImageBuffer(source, 11520, 2160) || !createImageBuffer(expected, 11520, 2160) || !createImageBuffer(image, 11520, 2160)) return 1;
+	uint32_t random = 1;
+	for (int y = 0; y < source.height; y++)
+		for (int x = 0; x < source.width; x++) imageRow(source, y)[x] = nextBenchRandom(random) * 0x01010101u;
+
+	copyImage(expected, source);
+	pixelateImage(expected, BENCHBLOCKSIZE, pixelateKernelAuto, 1);
+
+	int poolThreads = getWorkerThreadCount();
+	printf("Worker pool: %d threads\n\n| Threads | ms | Speedup | Result |\n|---|---|---|---|\n", poolThreads);
+	double singleTime = 0;
+	for (int threads = 1; threads <= poolThreads; threads++)
+	{
+		double bestTime = 1e9;
+		bool bSame = true;
+		for (int i = 0; i < BENCHREPEATS; i++)
+		{
+			copyImage(image, source);
+			BENCHTIMER timer;
+			pixelateImage(image, BENCHBLOCKSIZE, pixelateKernelAuto, threads);
+			double time = timer.elapsed();
+			if (time < bestTime) bestTime = time;
+			for (int y = 0; y < image.height; y++)
+				if (memcmp(imageRow(image, y), imageRow(expected, y), (size_t)image.width * IMAGEBYTESPERPIXEL) != 0) bSame = false;
+		}
+		if (threads == 1) singleTime = bestTime;
+		printf("| %d | %.2f | %.2f | %s |\n", threads, bestTime, singleTime / bestTime, bSame ? "identical" : "DIFFERENT");
+	}
+	freeImageBuffer(source);
+	freeImageBuffer(expected);
+	freeImageBuffer(image);
+	return 0;
+}
@@ -0,0 +1,72 @@
+/*+===================================================================
+  File:      pngPaletteBench.cpp
+
+  Summary:   Benchmark of indexed PNGs for screenshots with max. 256 colors:
+             time of the color count and file size and encoding time of
+             truecolor and indexed PNG per compression profile (one thread)
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "benchCorpus.h"
+#include "pngEncoder.h"
+#include <cstdio>
+
+#define BENCHREPEATS 5 // Color counts per image, the fastest run is printed
+
+int main()
+{
+	const char* profileNames[] = { "fast", "balanced", "smallest" };
+
+	printf("| Image | Colors | Color count ms |\n|---|---|---|\n");
+	for (int corpus = 0; corpus < BENCHCORPUSSIZE; corpus++)
+	{
+		IMAGEBUFFER image;
+		if (!createBenchCorpus(corpus, image)) return 1;
+		PNGPALETTE palette;
+		bool bPalette = false;
+		double bestTime = 1e9;
+		for (int i = 0; i < BENCHREPEATS; i++)
+		{
+			BENCHTIMER timer;
+			bPalette = getPNGPalette(image, palette);
+			double time = timer.elapsed();
+			if (time < bestTime) bestTime = time;
+		}
+		if (bPalette) printf("| %s | %d | %.2f |\n", getBenchCorpusName(corpus), palette.count, bestTime);
+		else printf("| %s | > %d | %.2f |\n", getBenchCorpusName(corpus), PNGMAXPALETTECOLORS, bestTime);
+		freeImageBuffer(image);
+	}
+
+	printf("\n| Image | Profile | Truecolor bytes | ms | Indexed bytes | ms |\n|---|---|---|---|---|---|\n");
+	for (int corpus = 0; corpus < BENCHCORPUSSIZE; corpus++)
+	{
+		IMAGEBUFFER image;
+		PNGPALETTE palette;
+		if (!createBenchCorpus(corpus, image)) return 1;
+		if (getPNGPalette(image, palette)) // Only images with max. 256 colors
+		{
+			for (int profile = pngProfileFast; profile <= pngProfileSmallest; profile++)
+			{
+				size_t sizes[2];
+				double times[2];
+				for (int indexed = 0; indexed < 2; indexed++)
+				{
+					PNGOPTIONS options = getPNGOptionsForProfile((PNGCOMPRESSIONPROFILE)profile);
+					options.maxThreads = 1;
+					options.bPalette = indexed == 1;
+					std::vector<uint8_t> png;
+					BENCHTIMER timer;
+					if (!encodePNGToMemory(image, png, options)) return 1;
+					times[indexed] = timer.elapsed();
+					sizes[indexed] = png.size();
+				}
+				printf("| %s | %s | %zu | %.0f | %zu | %.0f |\n", getBenchCorpusName(corpus), profileNames[profile], sizes[0], times[0], sizes[1], times[1]);
+			}
+		}
+		freeImageBuffer(image);
+	}
+	return 0;
+}
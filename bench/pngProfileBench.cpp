@@ -0,0 +1,39 @@
+/*+===================================================================
+  File:      pngProfileBench.cpp
+
+  Summary:   Benchmark of the PNG compression profiles (registry setting
+             compressionProfile) over the screenshot corpus: file size and
+             encoding time on one thread, truecolor only
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "benchCorpus.h"
+#include "pngEncoder.h"
+#include <cstdio>
+
+int main()
+{
+	const char* profileNames[] = { "fast", "balanced", "smallest" };
+	printf("| Image | Profile | Bytes | ms |\n|---|---|---|---|\n");
+	for (int corpus = 0; corpus < BENCHCORPUSSIZE; corpus++)
+	{
+		IMAGEBUFFER image;
+		if (!createBenchCorpus(corpus, image)) return 1;
+		for (int profile = pngProfileFast; profile <= pngProfileSmallest; profile++)
+		{
+			PNGOPTIONS options = getPNGOptionsForProfile((PNGCOMPRESSIONPROFILE)profile);
+			options.maxThreads = 1;
+			options.bPalette = false;
+			std::vector<uint8_t> png;
+			BENCHTIMER timer;
+			if (!encodePNGToMemory(image, png, options)) return 1;
+			double time = timer.elapsed();
+			printf("| %s | %s | %zu | %.0f |\n", getBenchCorpusName(corpus), profileNames[profile], png.size(), time);
+		}
+		freeImageBuffer(image);
+	}
+	return 0;
+}
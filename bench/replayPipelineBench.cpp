@@ -0,0 +1,204 @@
+/*+===================================================================
+  File:      replayPipelineBench.cpp
+
+  Summary:   Headless driver of the screenshot pipeline without a desktop:
+             replay file -> capture source -> selection view -> encodePNG.
+             Without argument a replay file with two frames of a virtual
+             screen with three monitors and a negative origin is created in
+             memory, otherwise the frames of the given replay file (/record=)
+             are used. Each PNG is decoded and compared with the selection.
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "../tests/pngDecoder.h"
+#include "benchCorpus.h"
+#include "captureSource.h"
+#include "pngEncoder.h"
+#include <cstdio>
+#include <cstring>
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: createReplayFile
+
+  Summary:   Creates a replay file with two frames of a virtual screen with
+             three monitors (left 4K at -3840,-200, main 4K at 0,0 and right
+             1080p at 3840,500). The second frame has a changed window.
+
+  Args:     std::vector<uint8_t> &file
+              Replay file (call by ref)
+
+  Returns:  bool
+              true = success
+              false = out of memory
+
+-----------------------------------------------------------------F-F*/
+static bool createReplayFile(std::vector<uint8_t>& file)
+{
+	const int corpus[3] = { benchCorpusDesktop, benchCorpusCodeEditor, benchCorpusDialogs };
+	CAPTURELAYOUT layout;
+	layout.bounds = { -3840, -200, 5760, 2160 };
+	layout.monitors = { { -3840, -200, 0, 1960 }, { 0, 0, 3840, 2160 }, { 3840, 500, 5760, 1580 } };
+
+	IMAGEBUFFER frame;
+	if (!createImageBuffer(frame, layout.bounds.right - layout.bounds.left, layout.bounds.bottom - layout.bounds.top)) return false;
+	fillCaptureGaps(frame, layout, 0);
+	for (size_t i = 0; i < layout.monitors.size(); i++)
+	{
+		IMAGEBUFFER monitor;
+		IMAGEBUFFER view;
+		if (!createBenchCorpus(corpus[i], monitor)) return false;
+		if (getImageView(frame, layout.monitors[i].left - layout.bounds.left, layout.monitors[i].top - layout.bounds.top, monitor.width, monitor.height, view)) copyImage(view, monitor);
+		freeImageBuffer(monitor);
+	}
+
+	auto write = [&file](const void* pData, size_t size) {
+		file.insert(file.end(), (const uint8_t*)pData, (const uint8_t*)pData + size);
+		return true;
+	};
+	bool bResult = writeCaptureFrame(frame, layout, write);
+	IMAGEBUFFER window;
+	if (getImageView(frame, 4000, 600, 1800, 1200, window)) blendImage(window, 0x0078D4, 96);
+	bResult = bResult && writeCaptureFrame(frame, layout, write);
+	freeImageBuffer(frame);
+	return bResult;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: loadReplayFile
+
+  Summary:   Reads a replay file into memory
+
+  Args:     const char* szFile
+              Replay file
+            std::vector<uint8_t> &file
+              Content (call by ref)
+
+  Returns:  bool
+              true = success
+              false = read error
+
+-----------------------------------------------------------------F-F*/
+static bool loadReplayFile(const char* szFile, std::vector<uint8_t>& file)
+{
+	FILE* pFile = fopen(szFile, "rb");
+	if (pFile == NULL) return false;
+	uint8_t buffer[65536];
+	size_t size;
+	while ((size = fread(buffer, 1, sizeof(buffer), pFile)) > 0) file.insert(file.end(), buffer, buffer + size);
+	bool bResult = !ferror(pFile);
+	fclose(pFile);
+	return bResult;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: encodeSelection
+
+  Summary:   Encodes a selection of a frame like the save of abiSnip.cpp,
+             decodes the PNG and compares it with the selection. Prints a
+             table row.
+
+  Args:     const IMAGEBUFFER &frame
+              Captured frame
+            const CAPTURELAYOUT &layout
+              Layout of the frame
+            CAPTURERECT selection
+              Selection in virtual screen coordinates
+            const char* szName
+              Name of the selection
+            size_t frameIndex
+              Frame in the replay file
+            double captureTime
+              Time in ms of the capture
+
+  Returns:  bool
+              true = success
+              false = selection outside of the frame, encoder error or PNG differs
+
+-----------------------------------------------------------------F-F*/
+static bool encodeSelection(const IMAGEBUFFER& frame, const CAPTURELAYOUT& layout, CAPTURERECT selection, const char* szName, size_t frameIndex, double captureTime)
+{
+	IMAGERECT rect = { selection.left - layout.bounds.left, selection.top - layout.bounds.top, selection.right - layout.bounds.left - 1, selection.bottom - layout.bounds.top - 1 };
+	IMAGEBUFFER view;
+	if (!getImageViewFromRect(frame, rect, view)) return false;
+
+	std::vector<uint8_t> png;
+	BENCHTIMER timer;
+	if (!encodePNGToMemory(view, png)) return false;
+	double encodeTime = timer.elapsed();
+
+	IMAGEBUFFER decoded;
+	PNGDECODEINFO info;
+	if (!decodePNG(png, decoded, info)) return false;
+	bool bEqual = (decoded.width == view.width) && (decoded.height == view.height);
+	for (int y = 0; bEqual && (y < view.height); y++)
+		for (int x = 0; bEqual && (x < view.width); x++)
+			bEqual = getImagePixel(decoded, x, y) == getImagePixel(view, x, y);
+	freeImageBuffer(decoded);
+
+	printf("| %zu | %s | %dx%d | %.1f | %.1f | %zu |\n", frameIndex, szName, view.width, view.height, captureTime, encodeTime, png.size());
+	return bEqual;
+}
+
+int main(int argc, char* argv[])
+{
+	std::vector<uint8_t> file;
+	if (!((argc > 1) ? loadReplayFile(argv[1], file) : createReplayFile(file)))
+	{
+		fprintf(stderr, "Replay file not available\n");
+		return 1;
+	}
+
+	size_t position = 0;
+	std::shared_ptr<CAPTUREREPLAY> pReplay = std::make_shared<CAPTUREREPLAY>();
+	BENCHTIMER loadTimer;
+	bool bLoaded = loadCaptureReplay([&file, &position](void* pData, size_t size) {
+		if (size > file.size() - position) return false;
+		memcpy(pData, file.data() + position, size);
+		position += size;
+		return true;
+	}, *pReplay);
+	if (!bLoaded)
+	{
+		fprintf(stderr, "Invalid replay file\n");
+		return 1;
+	}
+	printf("Replay file: %zu bytes, %zu frames, loaded in %.1f ms\n\n", file.size(), pReplay->frames.size(), loadTimer.elapsed());
+
+	CAPTURESOURCE source = createReplayCaptureSource(pReplay);
+	size_t frames = pReplay->frames.size();
+	IMAGEBUFFER frame = { 0 };
+	printf("| Frame | Selection | Pixels | Capture ms | Encode ms | PNG bytes |\n|---|---|---|---|---|---|\n");
+	for (size_t i = 0; i < frames; i++)
+	{
+		CAPTURELAYOUT layout;
+		BENCHTIMER captureTimer;
+		bool bCaptured = source.capture([](int width, int height, IMAGEBUFFER& image) {
+			if ((image.width == width) && (image.height == height)) return true;
+			freeImageBuffer(image);
+			return createImageBuffer(image, width, height);
+		}, frame, layout);
+		double captureTime = captureTimer.elapsed();
+		if (!bCaptured || !isCaptureLayoutValid(layout)) return 1;
+
+		// Whole virtual screen, each monitor (like /m with the cursor in the center) and a window across the first two monitors
+		bool bResult = encodeSelection(frame, layout, layout.bounds, "virtual screen", i, captureTime);
+		for (const CAPTURERECT& monitor : layout.monitors)
+		{
+			CAPTURELAYOUT monitorLayout = layout;
+			selectCaptureMonitor(monitorLayout, (monitor.left + monitor.right) / 2, (monitor.top + monitor.bottom) / 2);
+			bResult = bResult && encodeSelection(frame, layout, monitorLayout.bounds, "monitor", i, captureTime);
+		}
+		CAPTURERECT window = { layout.bounds.left + (layout.bounds.right - layout.bounds.left) / 4, layout.bounds.top + 100, layout.bounds.left + (layout.bounds.right - layout.bounds.left) / 2, layout.bounds.top + 1100 };
+		bResult = bResult && encodeSelection(frame, layout, window, "window", i, captureTime);
+		if (!bResult)
+		{
+			fprintf(stderr, "PNG of frame %zu differs from the selection\n", i);
+			return 1;
+		}
+	}
+	freeImageBuffer(frame);
+	return 0;
+}
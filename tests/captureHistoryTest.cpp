@@ -0,0 +1,176 @@
+/*+===================================================================
+  File:      captureHistoryTest.cpp
+
+  Summary:   Tests of the capture history: exact restore of keyframes and
+             tile deltas, equal frames, keyframe rules and removal of old
+             frames by age and memory budget
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "captureHistory.h"
+#include "testCheck.h"
+
+#define TESTWIDTH 300 // Width of the test frames (not a multiple of CAPTUREHISTORYTILESIZE)
+#define TESTHEIGHT 200 // Height of the test frames
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: drawTestFrame
+
+  Summary:   Draws a background with a small moving rectangle
+
+  Args:     const IMAGEBUFFER &image
+              Frame
+            int frame
+              Number of the frame
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+static void drawTestFrame(const IMAGEBUFFER& image, int frame)
+{
+	for (int y = 0; y < image.height; y++)
+		for (int x = 0; x < image.width; x++) imageRow(image, y)[x] = IMAGEPIXELRGB(x, y, (x / 10 + y / 10) % 2 ? 255 : 0);
+	IMAGEBUFFER view;
+	if (getImageView(image, (frame * 37) % (image.width - 20), (frame * 23) % (image.height - 10), 20, 10, view)) fillImage(view, IMAGEPIXELRGB(frame, 0, 0));
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getTestLayout
+
+  Summary:   Gets the layout of a single monitor with the size of an image
+
+  Args:     const IMAGEBUFFER &image
+
+  Returns:  CAPTURELAYOUT
+
+-----------------------------------------------------------------F-F*/
+static CAPTURELAYOUT getTestLayout(const IMAGEBUFFER& image)
+{
+	CAPTURELAYOUT layout;
+	layout.bounds = { 0, 0, image.width, image.height };
+	layout.monitors = { layout.bounds };
+	return layout;
+}
+
+// Every stored frame is restored with the original pixels, equal frames are not stored
+static void testRestore()
+{
+	IMAGEBUFFER image, restored;
+	CHECK(createImageBuffer(image, TESTWIDTH, TESTHEIGHT));
+	CHECK(createImageBuffer(restored, TESTWIDTH, TESTHEIGHT));
+	CAPTUREHISTORY history;
+	history.maxAge = 1000000;
+	history.maxBytes = 64 * 1024 * 1024;
+	std::vector<uint64_t> hashes;
+	for (int frame = 0; frame < 2 * CAPTUREHISTORYMAXDELTAS + 10; frame++)
+	{
+		drawTestFrame(image, frame);
+		CHECK(addCaptureHistoryFrame(history, image, getTestLayout(image), frame));
+		hashes.push_back(hashImage(image));
+		CHECK(addCaptureHistoryFrame(history, image, getTestLayout(image), frame + 1000)); // Equal frame
+	}
+	CHECKEQUAL(history.frames.size(), hashes.size());
+	size_t keyframes = 0;
+	for (size_t i = 0; i < history.frames.size(); i++)
+	{
+		CHECK(restoreCaptureHistoryFrame(history, i, restored));
+		CHECKEQUAL(hashImage(restored), hashes[i]);
+		if (history.frames[i].bKeyframe) keyframes++;
+		else CHECK(history.frames[i].tiles.size() <= 8); // Old and new position of the moving rectangle touch at most 8 tiles
+	}
+	CHECKEQUAL(keyframes, 3); // First frame and after CAPTUREHISTORYMAXDELTAS deltas
+	CHECK(history.frames[CAPTUREHISTORYMAXDELTAS + 1].bKeyframe);
+	CHECK(!restoreCaptureHistoryFrame(history, history.frames.size(), restored));
+
+	clearCaptureHistory(history);
+	CHECK(history.frames.empty());
+	CHECKEQUAL(history.bytes, 0);
+	freeImageBuffer(restored);
+	freeImageBuffer(image);
+}
+
+// New layout or size and a mostly changed frame need a keyframe
+static void testKeyframeRules()
+{
+	IMAGEBUFFER image, smaller;
+	CHECK(createImageBuffer(image, TESTWIDTH, TESTHEIGHT));
+	CHECK(createImageBuffer(smaller, TESTWIDTH / 2, TESTHEIGHT));
+	CAPTUREHISTORY history;
+	history.maxAge = 1000000;
+	history.maxBytes = 64 * 1024 * 1024;
+
+	drawTestFrame(image, 0);
+	CHECK(addCaptureHistoryFrame(history, image, getTestLayout(image), 0));
+	CAPTURELAYOUT moved = getTestLayout(image);
+	moved.bounds.left -= TESTWIDTH;
+	moved.bounds.right -= TESTWIDTH;
+	moved.monitors = { moved.bounds };
+	CHECK(addCaptureHistoryFrame(history, image, moved, 1));
+	CHECK(history.frames.back().bKeyframe);
+
+	drawTestFrame(smaller, 0);
+	CHECK(addCaptureHistoryFrame(history, smaller, getTestLayout(smaller), 2));
+	CHECK(history.frames.back().bKeyframe);
+
+	fillImage(smaller, 0x123456);
+	CHECK(addCaptureHistoryFrame(history, smaller, getTestLayout(smaller), 3));
+	CHECK(history.frames.back().bKeyframe);
+	CHECKEQUAL(history.frames.size(), 4);
+
+	CHECK(!addCaptureHistoryFrame(history, IMAGEBUFFER{ 0 }, getTestLayout(image), 4));
+	clearCaptureHistory(history);
+	freeImageBuffer(smaller);
+	freeImageBuffer(image);
+}
+
+// Keyframes with their deltas are removed after maxAge or when the budget is exceeded
+static void testTrim()
+{
+	IMAGEBUFFER image;
+	CHECK(createImageBuffer(image, TESTWIDTH, TESTHEIGHT));
+	CAPTUREHISTORY history;
+	history.maxAge = 1000;
+	history.maxBytes = 64 * 1024 * 1024;
+	for (int frame = 0; frame < 3 * CAPTUREHISTORYMAXDELTAS; frame++)
+	{
+		drawTestFrame(image, frame);
+		CHECK(addCaptureHistoryFrame(history, image, getTestLayout(image), (int64_t)frame * 100));
+	}
+	CHECK(history.frames.front().bKeyframe);
+	CHECK(history.frames[1].time >= history.frames.back().time - history.maxAge - CAPTUREHISTORYMAXDELTAS * 100); // Only replaced keyframes are removed
+	CHECK(history.frames.size() < 3 * CAPTUREHISTORYMAXDELTAS);
+
+	// Budget smaller than a keyframe
+	history.maxAge = 1000000;
+	history.maxBytes = 1000;
+	drawTestFrame(image, 0);
+	CHECK(!addCaptureHistoryFrame(history, image, getTestLayout(image), 100000));
+	CHECK(history.frames.empty());
+	CHECKEQUAL(history.bytes, 0);
+
+	// Budget for about two keyframes with their deltas
+	history.maxBytes = 64 * 1024 * 1024;
+	CHECK(addCaptureHistoryFrame(history, image, getTestLayout(image), 200000));
+	history.maxBytes = 2 * history.bytes;
+	for (int frame = 1; frame < 5 * CAPTUREHISTORYMAXDELTAS; frame++)
+	{
+		drawTestFrame(image, frame);
+		CHECK(addCaptureHistoryFrame(history, image, getTestLayout(image), 200000 + frame));
+		if (history.frames.empty()) break;
+		CHECK(history.bytes <= history.maxBytes + history.frames.back().bytes);
+	}
+	CHECK(!history.frames.empty() && history.frames.front().bKeyframe);
+	clearCaptureHistory(history);
+	freeImageBuffer(image);
+}
+
+int main()
+{
+	testRestore();
+	testKeyframeRules();
+	testTrim();
+	return testResult();
+}
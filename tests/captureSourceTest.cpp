@@ -0,0 +1,258 @@
+/*+===================================================================
+  File:      captureSourceTest.cpp
+
+  Summary:   Tests of the capture sources: replay file round trip with a
+             negative origin, uncompressed frames, damaged replay files and
+             corrupt frame headers, gaps between monitors and the monitor
+             selection
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "captureSource.h"
+#include "testCheck.h"
+#include <cstring>
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getTestLayout
+
+  Summary:   Gets a virtual screen with a negative origin (left monitor
+             1920x1080 at -1920,300, main 2560x1440 at 0,0 and right
+             1280x1024 at 2560,-200)
+
+  Args:
+
+  Returns:  CAPTURELAYOUT
+
+-----------------------------------------------------------------F-F*/
+static CAPTURELAYOUT getTestLayout()
+{
+	CAPTURELAYOUT layout;
+	layout.bounds = { -1920, -200, 3840, 1440 };
+	layout.monitors = { { -1920, 300, 0, 1380 }, { 0, 0, 2560, 1440 }, { 2560, -200, 3840, 824 } };
+	return layout;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: allocateTestImage
+
+  Summary:   Allocate function for the capture sources
+
+  Args:     int width
+            int height
+              Size of the frame
+            IMAGEBUFFER &image
+              Image buffer (call by ref)
+
+  Returns:  bool
+
+-----------------------------------------------------------------F-F*/
+static bool allocateTestImage(int width, int height, IMAGEBUFFER& image)
+{
+	freeImageBuffer(image);
+	return createImageBuffer(image, width, height);
+}
+
+// Frames are replayed in order with their layout and repeated after the last frame
+static void testReplayRoundTrip()
+{
+	CAPTURELAYOUT layout = getTestLayout();
+	IMAGEBUFFER frame;
+	CHECK(createImageBuffer(frame, layout.bounds.right - layout.bounds.left, layout.bounds.bottom - layout.bounds.top));
+	for (int y = 0; y < frame.height; y++)
+		for (int x = 0; x < frame.width; x++) imageRow(frame, y)[x] = ((x / 64) % 2) ? IMAGEPIXELRGB(x, y, 7) : IMAGEPIXELRGB(200, 200, 200);
+	IMAGEBUFFER small;
+	CHECK(createImageBuffer(small, 100, 50));
+	fillImage(small, IMAGEPIXELRGB(1, 2, 3));
+	CAPTURELAYOUT smallLayout;
+	smallLayout.bounds = { 0, 0, 100, 50 };
+	smallLayout.monitors = { smallLayout.bounds };
+
+	std::vector<uint8_t> file;
+	auto write = [&file](const void* pData, size_t size) {
+		file.insert(file.end(), (const uint8_t*)pData, (const uint8_t*)pData + size);
+		return true;
+	};
+	CHECK(writeCaptureFrame(frame, layout, write));
+	CHECK(writeCaptureFrame(small, smallLayout, write));
+	CHECK(!writeCaptureFrame(small, layout, write)); // Size does not match the layout
+
+	size_t position = 0;
+	auto read = [&file, &position](void* pData, size_t size) {
+		if (size > file.size() - position) return false;
+		memcpy(pData, file.data() + position, size);
+		position += size;
+		return true;
+	};
+	std::shared_ptr<CAPTUREREPLAY> pReplay = std::make_shared<CAPTUREREPLAY>();
+	CHECK(loadCaptureReplay(read, *pReplay));
+	CHECKEQUAL(pReplay->frames.size(), 2);
+
+	CAPTURESOURCE source = createReplayCaptureSource(pReplay);
+	IMAGEBUFFER image = { 0 };
+	CAPTURELAYOUT replayed;
+	CHECK(source.capture(allocateTestImage, image, replayed));
+	CHECKEQUAL(replayed.bounds.left, -1920);
+	CHECKEQUAL(replayed.bounds.top, -200);
+	CHECKEQUAL(replayed.monitors.size(), 3);
+	CHECKEQUAL(replayed.monitors[2].top, -200);
+	CHECKEQUAL(hashImage(image), hashImage(frame));
+	CHECK(source.capture(allocateTestImage, image, replayed));
+	CHECKEQUAL(image.width, 100);
+	CHECKEQUAL(hashImage(image), hashImage(small));
+	CHECK(source.capture(allocateTestImage, image, replayed));
+	CHECKEQUAL(image.width, frame.width);
+
+	// Damaged files
+	file[0] ^= 1;
+	position = 0;
+	CHECK(!loadCaptureReplay(read, *pReplay));
+	CHECK(pReplay->frames.empty());
+	CHECK(!source.capture(allocateTestImage, image, replayed));
+	file[0] ^= 1;
+
+	// Frame rectangle beyond the int range of the virtual screen (left + width overflows)
+	std::vector<uint8_t> original = file;
+	const uint32_t left = 0x7FFFFFF0;
+	memcpy(file.data() + 8, &left, sizeof(left));
+	position = 0;
+	CHECK(!loadCaptureReplay(read, *pReplay));
+	const uint32_t top = 0x7FFFFFFF;
+	file = original;
+	memcpy(file.data() + 12, &top, sizeof(top));
+	position = 0;
+	CHECK(!loadCaptureReplay(read, *pReplay));
+
+	// Monitor outside of the frame
+	const int32_t monitorRight = 3841;
+	file = original;
+	memcpy(file.data() + 4 * (7 + 4 * 2 + 2), &monitorRight, sizeof(monitorRight));
+	position = 0;
+	CHECK(!loadCaptureReplay(read, *pReplay));
+
+	file = original;
+	position = 0;
+	CHECK(loadCaptureReplay(read, *pReplay));
+	file.resize(file.size() - 3);
+	position = 0;
+	CHECK(!loadCaptureReplay(read, *pReplay));
+
+	freeImageBuffer(image);
+	freeImageBuffer(small);
+	freeImageBuffer(frame);
+}
+
+// Frames without runs are stored and replayed uncompressed
+static void testReplayUncompressed()
+{
+	IMAGEBUFFER noise;
+	CHECK(createImageBuffer(noise, 37, 21));
+	uint32_t value = 1;
+	for (int y = 0; y < noise.height; y++)
+		for (int x = 0; x < noise.width; x++) imageRow(noise, y)[x] = value = value * 1664525 + 1013904223;
+	CAPTURELAYOUT layout;
+	layout.bounds = { -37, 0, 0, 21 };
+	layout.monitors = { layout.bounds };
+
+	std::vector<uint8_t> file;
+	CHECK(writeCaptureFrame(noise, layout, [&file](const void* pData, size_t size) {
+		file.insert(file.end(), (const uint8_t*)pData, (const uint8_t*)pData + size);
+		return true;
+	}));
+	size_t position = 0;
+	auto read = [&file, &position](void* pData, size_t size) {
+		if (size > file.size() - position) return false;
+		memcpy(pData, file.data() + position, size);
+		position += size;
+		return true;
+	};
+	std::shared_ptr<CAPTUREREPLAY> pReplay = std::make_shared<CAPTUREREPLAY>();
+	CHECK(loadCaptureReplay(read, *pReplay));
+	CHECK(!pReplay->frames.empty() && pReplay->frames[0].image.raw);
+
+	CAPTURESOURCE source = createReplayCaptureSource(pReplay);
+	IMAGEBUFFER image = { 0 };
+	CAPTURELAYOUT replayed;
+	CHECK(source.capture(allocateTestImage, image, replayed));
+	CHECKEQUAL(hashImage(image), hashImage(noise));
+
+	// Uncompressed frame with a missing pixel
+	const size_t flagsPosition = 4 * (7 + 4);
+	CHECKEQUAL(file[flagsPosition], CAPTUREFRAMERAW);
+	file[flagsPosition + 4]--; // Number of values
+	file.resize(file.size() - 4);
+	position = 0;
+	CHECK(!loadCaptureReplay(read, *pReplay));
+
+	// Unknown flag
+	file[flagsPosition + 4]++;
+	file.resize(file.size() + 4);
+	file[flagsPosition] = 2;
+	position = 0;
+	CHECK(!loadCaptureReplay(read, *pReplay));
+
+	freeImageBuffer(image);
+	freeImageBuffer(noise);
+}
+
+// Only pixels outside of all monitors are filled
+static void testCaptureGaps()
+{
+	CAPTURELAYOUT layout = getTestLayout();
+	IMAGEBUFFER image;
+	CHECK(createImageBuffer(image, layout.bounds.right - layout.bounds.left, layout.bounds.bottom - layout.bounds.top));
+	fillImage(image, 0x123456);
+	fillCaptureGaps(image, layout, 0xABCDEF);
+	int errors = 0;
+	for (int y = 0; y < image.height; y++)
+	{
+		for (int x = 0; x < image.width; x++)
+		{
+			bool bOnMonitor = false;
+			for (const CAPTURERECT& monitor : layout.monitors)
+				if ((x + layout.bounds.left >= monitor.left) && (x + layout.bounds.left < monitor.right) && (y + layout.bounds.top >= monitor.top) && (y + layout.bounds.top < monitor.bottom)) bOnMonitor = true;
+			if (getImagePixel(image, x, y) != (bOnMonitor ? 0x123456u : 0xABCDEFu)) errors++;
+		}
+	}
+	CHECKEQUAL(errors, 0);
+
+	CAPTURELAYOUT noMonitors;
+	noMonitors.bounds = layout.bounds;
+	fillCaptureGaps(image, noMonitors, 0xABCDEF);
+	CHECKEQUAL(getImagePixel(image, 2000, 300), 0xABCDEFu);
+	freeImageBuffer(image);
+}
+
+// Monitor under the point or the nearest monitor
+static void testSelectMonitor()
+{
+	const struct {
+		int x;
+		int y;
+		int monitor;
+	} cases[] = { { 5, 5, 1 }, { -5, 400, 0 }, { 2560, -200, 2 }, { 5000, 0, 2 }, { -3000, 2000, 0 }, { 2559, 1439, 1 }, { -1, 299, 0 } };
+
+	for (const auto& test : cases)
+	{
+		CAPTURELAYOUT layout = getTestLayout();
+		CAPTURERECT expected = layout.monitors[test.monitor];
+		CHECK(selectCaptureMonitor(layout, test.x, test.y));
+		CHECKEQUAL(layout.bounds.left, expected.left);
+		CHECKEQUAL(layout.bounds.top, expected.top);
+		CHECKEQUAL(layout.bounds.right, expected.right);
+		CHECKEQUAL(layout.monitors.size(), 1);
+	}
+	CAPTURELAYOUT noMonitors;
+	CHECK(!selectCaptureMonitor(noMonitors, 0, 0));
+}
+
+int main()
+{
+	testReplayRoundTrip();
+	testReplayUncompressed();
+	testCaptureGaps();
+	testSelectMonitor();
+	return testResult();
+}
@@ -0,0 +1,171 @@
+/*+===================================================================
+  File:      colorScanTest.cpp
+
+  Summary:   Tests of the color change search (Shift+cursor keys): the
+             SSE2 and AVX2 kernels against a pixel by pixel reference in
+             all four directions, on views and on thin images
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "colorScan.h"
+#include "testCheck.h"
+#include <random>
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: findColorChangeReference
+
+  Summary:   Searches pixel by pixel for the last pixel before the color
+             changes (reference for the kernels)
+
+  Args:     const IMAGEBUFFER &image
+              Image buffer or view
+            int x
+            int y
+              Start position
+            int directionX
+            int directionY
+              Direction
+
+  Returns:  int
+              Last x (horizontal search) or y (vertical search) with the color of the start position
+
+-----------------------------------------------------------------F-F*/
+static int findColorChangeReference(const IMAGEBUFFER& image, int x, int y, int directionX, int directionY)
+{
+	IMAGEPIXEL color = getImagePixel(image, x, y);
+	while ((x + directionX >= 0) && (x + directionX < image.width) && (y + directionY >= 0) && (y + directionY < image.height) &&
+		(getImagePixel(image, x + directionX, y + directionY) == color))
+	{
+		x += directionX;
+		y += directionY;
+	}
+	return (directionX != 0) ? x : y;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: checkAllPositions
+
+  Summary:   Compares each SIMD level with the reference for every start
+             position and direction of an image
+
+  Args:     const IMAGEBUFFER &image
+              Image buffer or view
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+static void checkAllPositions(const IMAGEBUFFER& image)
+{
+	const int directions[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+	int errors = 0;
+	for (int y = 0; y < image.height; y++)
+	{
+		for (int x = 0; x < image.width; x++)
+		{
+			for (const auto& direction : directions)
+			{
+				int expected = findColorChangeReference(image, x, y, direction[0], direction[1]);
+				for (int level = simdLevelNone; level <= simdLevelAVX2; level++)
+				{
+					int result = findColorChange(image, x, y, direction[0], direction[1], (SIMDLEVEL)level);
+					if (result != expected)
+					{
+						if (errors++ < 10) fprintf(stderr, "%dx%d at %d,%d direction %d,%d level %d: %d != %d\n", image.width, image.height, x, y, direction[0], direction[1], level, result, expected);
+					}
+				}
+			}
+		}
+	}
+	CHECKEQUAL(errors, 0);
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: drawRectangles
+
+  Summary:   Fills an image with a background and random rectangles, so
+             colors change after runs of all lengths. The undefined upper
+             byte of the pixels is random.
+
+  Args:     const IMAGEBUFFER &image
+              Image buffer or view
+            std::mt19937 &random
+              Random generator (call by ref)
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+static void drawRectangles(const IMAGEBUFFER& image, std::mt19937& random)
+{
+	const IMAGEPIXEL colors[4] = { 0xFFFFFF, 0x000000, 0x0078D4, 0xFFFFFE };
+	fillImage(image, colors[0]);
+	for (int i = 0; i < 40; i++)
+	{
+		IMAGEBUFFER view;
+		int x = (int)(random() % image.width);
+		int y = (int)(random() % image.height);
+		if (getImageView(image, x, y, 1 + (int)(random() % image.width), 1 + (int)(random() % image.height), view)) fillImage(view, colors[random() % 4]);
+	}
+	for (int y = 0; y < image.height; y++)
+		for (int x = 0; x < image.width; x++) imageRow(image, y)[x] |= (IMAGEPIXEL)(random() & 0xff) << 24;
+}
+
+// Views with stride > width and sizes, which are not a multiple of the SIMD width
+static void testViews()
+{
+	std::mt19937 random(4);
+	IMAGEBUFFER image;
+	CHECK(createImageBuffer(image, 100, 80));
+	fillImage(image, 0x0078D4); // Same color outside of the views must not be found
+	const int sizes[][2] = { { 67, 45 }, { 8, 8 }, { 16, 17 }, { 33, 7 } };
+	for (const auto& size : sizes)
+	{
+		IMAGEBUFFER view;
+		CHECK(getImageView(image, 13, 9, size[0], size[1], view));
+		drawRectangles(view, random);
+		checkAllPositions(view);
+		fillImage(view, 0x0078D4); // Runs from each start position to the border
+		checkAllPositions(view);
+	}
+	freeImageBuffer(image);
+}
+
+// Images with one row or one column
+static void testThinImages()
+{
+	std::mt19937 random(5);
+	IMAGEBUFFER image;
+	const int sizes[][2] = { { 1, 1 }, { 1, 70 }, { 70, 1 }, { 2, 41 }, { 41, 2 } };
+	for (const auto& size : sizes)
+	{
+		CHECK(createImageBuffer(image, size[0], size[1]));
+		drawRectangles(image, random);
+		checkAllPositions(image);
+		freeImageBuffer(image);
+	}
+}
+
+// Invalid arguments return the start position
+static void testInvalidArguments()
+{
+	IMAGEBUFFER image;
+	CHECK(createImageBuffer(image, 20, 10));
+	fillImage(image, 0);
+	CHECKEQUAL(findColorChange(image, 5, 5, 1, 1), 5);
+	CHECKEQUAL(findColorChange(image, 5, 5, 0, 0), 5);
+	CHECKEQUAL(findColorChange(image, 5, 5, 2, 0), 5);
+	CHECKEQUAL(findColorChange(image, 20, 5, 1, 0), 20);
+	CHECKEQUAL(findColorChange(image, 5, -1, 0, 1), -1);
+	CHECKEQUAL(findColorChange(image, 5, 5, 1, 0), 19);
+	freeImageBuffer(image);
+}
+
+int main()
+{
+	testViews();
+	testThinImages();
+	testInvalidArguments();
+	return testResult();
+}
@@ -0,0 +1,134 @@
+/*+===================================================================
+  File:      deflateTest.cpp
+
+  Summary:   Round-trip tests of the deflate compressor and zlib stream with
+             the inflater of pngDecoder.h (single thread and parallel chunks),
+             and tests of the checksums
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "deflate.h"
+#include "pngDecoder.h"
+#include "testCheck.h"
+#include <random>
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: createTestData
+
+  Summary:   Creates data with repetitions, runs and noise
+
+  Args:     size_t size
+              Bytes
+            uint32_t seed
+              Seed of the random generator
+
+  Returns:  std::vector<uint8_t>
+
+-----------------------------------------------------------------F-F*/
+static std::vector<uint8_t> createTestData(size_t size, uint32_t seed)
+{
+	std::mt19937 random(seed);
+	std::vector<uint8_t> data(size);
+	int alphabet = 1 + random() % 8;
+	for (size_t i = 0; i < size; i++)
+	{
+		switch (random() % 4)
+		{
+			case 0: data[i] = (uint8_t)(random() % alphabet); break; // Small alphabet
+			case 1: data[i] = (uint8_t)random(); break; // Noise
+			default: data[i] = (i >= 300) ? data[i - 1 - random() % 300] : (uint8_t)i; // Repetitions
+		}
+	}
+	if (size > 1000) memset(&data[size / 2], 0x55, size / 10); // Long run
+	return data;
+}
+
+// Random data with all levels and window sizes
+static void testLevels()
+{
+	for (uint32_t seed = 0; seed < 60; seed++)
+	{
+		std::mt19937 random(seed);
+		size_t size = (seed == 0) ? 0 : 1 + random() % 70000;
+		std::vector<uint8_t> data = createTestData(size, seed);
+		int level = (int)(seed % (DEFLATEMAXLEVEL + 1));
+		int windowBits = DEFLATEMINWINDOWBITS + (int)(seed % (DEFLATEMAXWINDOWBITS - DEFLATEMINWINDOWBITS + 1));
+
+		std::vector<uint8_t> compressed, decompressed;
+		CHECK(compressZlib(data.data(), data.size(), level, compressed, 1, windowBits));
+		if (!inflateZlib(compressed.data(), compressed.size(), decompressed) || (decompressed != data))
+		{
+			fprintf(stderr, "size %zu, level %d, window bits %d\n", size, level, windowBits);
+			CHECK(false);
+		}
+		CHECKEQUAL(compressed[0] >> 4, windowBits - 8); // Window size in the zlib header
+	}
+}
+
+// Raw blocks with the end of the previous data as dictionary
+static void testDictionary()
+{
+	std::vector<uint8_t> data = createTestData(200000, 7);
+	for (int level : { 1, 6, 9 })
+	{
+		size_t split = 120000;
+		std::vector<uint8_t> compressed, decompressed;
+		compressed.push_back(0x78);
+		compressed.push_back(0x9C);
+		CHECK(deflateRaw(data.data(), split, 0, level, false, compressed));
+		CHECK(deflateRaw(data.data() + split, data.size() - split, DEFLATEWINDOWSIZE, level, true, compressed));
+		uint32_t adler = updateAdler32(1, data.data(), data.size());
+		for (int shift = 24; shift >= 0; shift -= 8) compressed.push_back((uint8_t)(adler >> shift));
+		CHECK(inflateZlib(compressed.data(), compressed.size(), decompressed));
+		CHECK(decompressed == data);
+	}
+}
+
+// Parallel chunks give one zlib stream with the same data as one thread
+static void testParallelChunks()
+{
+	const size_t sizes[] = { DEFLATEPARALLELCHUNKSIZE, DEFLATEPARALLELCHUNKSIZE + 1, 3 * DEFLATEPARALLELCHUNKSIZE + 12345 };
+	for (size_t size : sizes)
+	{
+		std::vector<uint8_t> data = createTestData(size, (uint32_t)size);
+		for (int threads : { 2, 3, 8 })
+		{
+			for (int level : { 0, 1, 6 })
+			{
+				std::vector<uint8_t> compressed, decompressed;
+				CHECK(compressZlib(data.data(), data.size(), level, compressed, threads, (threads == 3) ? 12 : DEFLATEMAXWINDOWBITS));
+				if (!inflateZlib(compressed.data(), compressed.size(), decompressed) || (decompressed != data))
+				{
+					fprintf(stderr, "size %zu, threads %d, level %d\n", size, threads, level);
+					CHECK(false);
+				}
+			}
+		}
+	}
+}
+
+// Adler-32 of known data and combination of two parts
+static void testAdler32()
+{
+	const char* pText = "Wikipedia";
+	CHECKEQUAL(updateAdler32(1, (const uint8_t*)pText, 9), 0x11E60398);
+	std::vector<uint8_t> data = createTestData(100000, 8);
+	for (size_t split : { (size_t)0, (size_t)1, (size_t)5552, (size_t)70001, data.size() })
+	{
+		uint32_t first = updateAdler32(1, data.data(), split);
+		uint32_t second = updateAdler32(1, data.data() + split, data.size() - split);
+		CHECKEQUAL(combineAdler32(first, second, data.size() - split), updateAdler32(1, data.data(), data.size()));
+	}
+}
+
+int main()
+{
+	testLevels();
+	testDictionary();
+	testParallelChunks();
+	testAdler32();
+	return testResult();
+}
@@ -0,0 +1,101 @@
+/*+===================================================================
+  File:      edgeIndexTest.cpp
+
+  Summary:   Tests of the edge index against the scan of the image with
+             different tolerances, views and the background build
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "edgeIndex.h"
+#include "testCheck.h"
+#include <chrono>
+#include <random>
+#include <thread>
+
+// Tolerance per color channel
+static void testIsColorEdge()
+{
+	CHECK(!isColorEdge(0x102030, 0xFF102030, 0)); // Upper byte is ignored
+	CHECK(isColorEdge(0x102030, 0x102031, 0));
+	CHECK(!isColorEdge(0x102030, 0x182838, 8));
+	CHECK(isColorEdge(0x102030, 0x102039, 8));
+	CHECK(isColorEdge(0x102030, 0x092030, 6));
+}
+
+// Index lookups give the same positions as the scan on random images
+static void testFindEdge()
+{
+	const int directions[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+	std::mt19937 random(5);
+
+	for (int i = 0; i < 500; i++)
+	{
+		int width = 1 + random() % 90;
+		int height = 1 + random() % 90;
+		int tolerance = (i % 3 == 0) ? 0 : random() % 40;
+		IMAGEBUFFER image, view;
+		createImageBuffer(image, width + 3, height + 2);
+		getImageView(image, 1, 1, width, height, view);
+		for (int y = 0; y < image.height; y++)
+		{
+			for (int x = 0; x < image.width; x++)
+			{
+				int base = (x / 7 + y / 5) * 13; // Areas with noise and a few outliers
+				imageRow(image, y)[x] = IMAGEPIXELRGB(base + random() % 8, base, base + ((random() % 25 == 0) ? 50 : 0)) | (random() << 24);
+			}
+		}
+
+		EDGEINDEX index;
+		CHECK(buildEdgeIndex(view, tolerance, index));
+		for (int query = 0; query < 200; query++)
+		{
+			int x = random() % width;
+			int y = random() % height;
+			for (const int* pDirection : directions)
+			{
+				int indexPosition = findEdge(index, x, y, pDirection[0], pDirection[1]);
+				int scanPosition = findEdgeByScan(view, tolerance, x, y, pDirection[0], pDirection[1]);
+				if (indexPosition != scanPosition)
+				{
+					fprintf(stderr, "tolerance %d, (%d,%d) direction (%d,%d): %d != %d\n", tolerance, x, y, pDirection[0], pDirection[1], indexPosition, scanPosition);
+					CHECK(false);
+				}
+			}
+		}
+		freeImageBuffer(image);
+	}
+}
+
+// Background build delivers the index and can be stopped
+static void testBackgroundBuild()
+{
+	IMAGEBUFFER image;
+	createImageBuffer(image, 640, 480);
+	for (int y = 0; y < image.height; y++)
+		for (int x = 0; x < image.width; x++) imageRow(image, y)[x] = (((x / 40) + (y / 30)) & 1) ? 0xFFFFFF : 0x202020;
+
+	startEdgeIndexBuild(image, 0);
+	for (int i = 0; (i < 5000) && (getEdgeIndex() == NULL); i++) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	const EDGEINDEX* pIndex = getEdgeIndex();
+	CHECK(pIndex != NULL);
+	if (pIndex != NULL)
+	{
+		CHECKEQUAL(findEdge(*pIndex, 5, 5, 1, 0), 39);
+		CHECKEQUAL(findEdge(*pIndex, 5, 5, 0, 1), 29);
+	}
+	startEdgeIndexBuild(image, 3);
+	stopEdgeIndexBuild();
+	CHECK(getEdgeIndex() == NULL);
+	freeImageBuffer(image);
+}
+
+int main()
+{
+	testIsColorEdge();
+	testFindEdge();
+	testBackgroundBuild();
+	return testResult();
+}
@@ -0,0 +1,197 @@
+/*+===================================================================
+  File:      imageBufferTest.cpp
+
+  Summary:   Tests of the image buffer, its sub-rect views and the basic
+             pixel operations
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "imageBuffer.h"
+#include "testCheck.h"
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: fillPattern
+
+  Summary:   Fills an image with a color depending on the pixel position
+
+  Args:     const IMAGEBUFFER &image
+              Image buffer
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+static void fillPattern(const IMAGEBUFFER& image)
+{
+	for (int y = 0; y < image.height; y++)
+		for (int x = 0; x < image.width; x++) imageRow(image, y)[x] = IMAGEPIXELRGB(x, y, x + y);
+}
+
+// Allocation, alignment and free
+static void testCreate()
+{
+	IMAGEBUFFER image;
+	CHECK(!createImageBuffer(image, 0, 5));
+	CHECK(!isImageValid(image));
+	CHECK(createImageBuffer(image, 13, 7));
+	CHECK(isImageValid(image));
+	CHECKEQUAL(image.stride, 13 * IMAGEBYTESPERPIXEL);
+	CHECKEQUAL((uintptr_t)image.pBits % 64, 0);
+	freeImageBuffer(image);
+	CHECK(!isImageValid(image));
+}
+
+// Sub-rect views, clipping at the borders and views of views
+static void testViews()
+{
+	IMAGEBUFFER image, view;
+	createImageBuffer(image, 10, 7);
+	fillPattern(image);
+
+	CHECK(getImageView(image, 2, 3, 4, 2, view));
+	CHECKEQUAL(view.width, 4);
+	CHECKEQUAL(view.height, 2);
+	CHECKEQUAL(view.stride, image.stride);
+	CHECK(view.pAllocation == NULL);
+	CHECKEQUAL(getImagePixel(view, 0, 0), IMAGEPIXELRGB(2, 3, 5));
+	CHECKEQUAL(getImagePixel(view, 3, 1), IMAGEPIXELRGB(5, 4, 9));
+
+	// Clipped at the borders
+	CHECK(getImageView(image, -3, -2, 5, 4, view));
+	CHECKEQUAL(view.width, 2);
+	CHECKEQUAL(view.height, 2);
+	CHECKEQUAL(getImagePixel(view, 0, 0), IMAGEPIXELRGB(0, 0, 0));
+	CHECK(getImageView(image, 8, 6, 10, 10, view));
+	CHECKEQUAL(view.width, 2);
+	CHECKEQUAL(view.height, 1);
+	CHECK(!getImageView(image, 10, 0, 1, 1, view));
+	CHECK(!isImageValid(view));
+
+	// Inclusive and reversed rectangles
+	CHECK(getImageViewFromRect(image, { 8, 6, 1, 1 }, view));
+	CHECKEQUAL(view.width, 8);
+	CHECKEQUAL(view.height, 6);
+	CHECKEQUAL(getImagePixel(view, 0, 0), IMAGEPIXELRGB(1, 1, 2));
+
+	// View of a view
+	IMAGEBUFFER inner;
+	CHECK(getImageView(view, 1, 1, 2, 2, inner));
+	CHECKEQUAL(getImagePixel(inner, 1, 1), IMAGEPIXELRGB(3, 3, 6));
+
+	// Operations on a view change only the view
+	fillImage(inner, 0xFFFFFF);
+	CHECKEQUAL(getImagePixel(image, 2, 2), 0xFFFFFF);
+	CHECKEQUAL(getImagePixel(image, 3, 3), 0xFFFFFF);
+	CHECKEQUAL(getImagePixel(image, 4, 3), IMAGEPIXELRGB(4, 3, 7));
+	CHECKEQUAL(getImagePixel(image, 1, 2), IMAGEPIXELRGB(1, 2, 3));
+	freeImageBuffer(image);
+}
+
+// Attached memory with a stride larger than the width
+static void testAttach()
+{
+	uint32_t pixels[4 * 3] = { 0 };
+	IMAGEBUFFER image, view;
+	attachImageBuffer(image, pixels, 3, 3, 4 * IMAGEBYTESPERPIXEL); // Stride larger than the width
+	CHECK(isImageValid(image));
+	fillImage(image, 0x123456);
+	CHECKEQUAL(pixels[2], 0x123456);
+	CHECKEQUAL(pixels[3], 0); // Padding of the row
+	CHECKEQUAL(pixels[8], 0x123456);
+	getImageView(image, 1, 1, 2, 2, view);
+	fillImage(view, 0x654321);
+	CHECKEQUAL(pixels[5], 0x654321);
+	CHECKEQUAL(pixels[7], 0);
+	freeImageBuffer(image); // Attached memory is not freed
+	CHECK(!isImageValid(image));
+}
+
+// Copy, blend and frame
+static void testCopyBlendFrame()
+{
+	IMAGEBUFFER source, target, view;
+	createImageBuffer(source, 6, 4);
+	createImageBuffer(target, 4, 6);
+	fillPattern(source);
+	fillImage(target, 0);
+	copyImage(target, source); // Copies the common size 4x4
+	CHECKEQUAL(getImagePixel(target, 3, 3), IMAGEPIXELRGB(3, 3, 6));
+	CHECKEQUAL(getImagePixel(target, 0, 4), 0);
+
+	// Overlapping copy inside the same buffer
+	getImageView(source, 1, 0, 5, 4, view);
+	copyImage(view, source);
+	CHECKEQUAL(getImagePixel(source, 1, 0), IMAGEPIXELRGB(0, 0, 0));
+	CHECKEQUAL(getImagePixel(source, 5, 2), IMAGEPIXELRGB(4, 2, 6));
+
+	fillImage(target, 0xFF000000 | IMAGEPIXELRGB(200, 100, 0)); // Upper byte is ignored
+	blendImage(target, IMAGEPIXELRGB(0, 0, 255), 128);
+	CHECKEQUAL(getImagePixel(target, 0, 0), IMAGEPIXELRGB(100, 50, 128));
+	blendImage(target, 0, 0);
+	CHECKEQUAL(getImagePixel(target, 0, 0), IMAGEPIXELRGB(100, 50, 128));
+
+	// Frame changes only the area between outer and inner rectangle
+	fillImage(target, 0);
+	frameImageRect(target, { 0, 0, 3, 5 }, { 1, 1, 2, 4 }, 0xFFFFFF, 255);
+	CHECKEQUAL(getImagePixel(target, 0, 0), 0xFFFFFF);
+	CHECKEQUAL(getImagePixel(target, 3, 5), 0xFFFFFF);
+	CHECKEQUAL(getImagePixel(target, 1, 1), 0);
+	CHECKEQUAL(getImagePixel(target, 2, 4), 0);
+	freeImageBuffer(source);
+	freeImageBuffer(target);
+}
+
+// Zoom with overlapping source and target
+static void testZoom()
+{
+	IMAGEBUFFER image;
+	createImageBuffer(image, 12, 12);
+	fillPattern(image);
+	zoomImage(image, 1, 1, 2, 2, 4, 4, 3); // 2x2 pixels from (1,1) to 6x6 pixels at (4,4)
+	CHECKEQUAL(getImagePixel(image, 4, 4), IMAGEPIXELRGB(1, 1, 2));
+	CHECKEQUAL(getImagePixel(image, 6, 6), IMAGEPIXELRGB(1, 1, 2));
+	CHECKEQUAL(getImagePixel(image, 7, 4), IMAGEPIXELRGB(2, 1, 3));
+	CHECKEQUAL(getImagePixel(image, 9, 9), IMAGEPIXELRGB(2, 2, 4));
+	CHECKEQUAL(getImagePixel(image, 10, 10), IMAGEPIXELRGB(10, 10, 20));
+
+	// Source outside the image is black, target is clipped
+	fillImage(image, 0x123456);
+	zoomImage(image, -1, -1, 4, 4, -1, -1, 3);
+	CHECKEQUAL(getImagePixel(image, 0, 0), 0);
+	CHECKEQUAL(getImagePixel(image, 8, 8), 0x123456);
+	freeImageBuffer(image);
+}
+
+// Hash of the colors
+static void testHash()
+{
+	IMAGEBUFFER a, b, view;
+	createImageBuffer(a, 37, 5);
+	createImageBuffer(b, 37, 5);
+	fillPattern(a);
+	fillPattern(b);
+	CHECK(hashImage(a) == hashImage(b));
+	imageRow(b, 2)[7] |= 0xFF000000; // Upper byte is ignored
+	CHECK(hashImage(a) == hashImage(b));
+	imageRow(b, 4)[36] ^= 1;
+	CHECK(hashImage(a) != hashImage(b));
+	getImageView(a, 0, 0, 5, 37 / 5, view);
+	CHECK(hashImage(view) != hashImage(a));
+	IMAGEBUFFER invalid = { 0 };
+	CHECK(hashImage(invalid) == 0);
+	freeImageBuffer(a);
+	freeImageBuffer(b);
+}
+
+int main()
+{
+	testCreate();
+	testViews();
+	testAttach();
+	testCopyBlendFrame();
+	testZoom();
+	testHash();
+	return testResult();
+}
@@ -0,0 +1,269 @@
+/*+===================================================================
+  File:      imageRLETest.cpp
+
+  Summary:   Tests of the run-length encoding for the last capture: packet
+             layout, views, thin images, the uncompressed fallback and the
+             rejection of corrupt data
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "imageRLE.h"
+#include "testCheck.h"
+#include <random>
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: isRoundTripEqual
+
+  Summary:   Encodes an image, restores it to a new image and compares the
+             colors
+
+  Args:     const IMAGEBUFFER &image
+              Image or view
+            RLEIMAGE &rle
+              Encoded image (call by ref)
+
+  Returns:  bool
+              true = restored image has the colors of the image
+
+-----------------------------------------------------------------F-F*/
+static bool isRoundTripEqual(const IMAGEBUFFER& image, RLEIMAGE& rle)
+{
+	IMAGEBUFFER restored;
+	if (!compressImageRLE(image, rle)) return false;
+	if (!createImageBuffer(restored, image.width, image.height)) return false;
+
+	bool bEqual = decompressImageRLE(rle, restored);
+	for (int y = 0; bEqual && (y < image.height); y++)
+		for (int x = 0; x < image.width; x++)
+			if (getImagePixel(restored, x, y) != getImagePixel(image, x, y)) bEqual = false;
+	freeImageBuffer(restored);
+	return bEqual;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: fillStripes
+
+  Summary:   Fills an image with horizontal stripes of random length and
+             color, some of them shorter than a run, and random upper bytes
+
+  Args:     const IMAGEBUFFER &image
+              Image buffer
+            std::mt19937 &random
+              Random generator (call by ref)
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+static void fillStripes(const IMAGEBUFFER& image, std::mt19937& random)
+{
+	for (int y = 0; y < image.height; y++)
+	{
+		IMAGEPIXEL* pRow = imageRow(image, y);
+		int x = 0;
+		while (x < image.width)
+		{
+			int length = 1 + (int)(random() % 12);
+			IMAGEPIXEL color = random() % 4; // Few colors, so neighbor stripes can have the same color
+			for (int i = 0; (i < length) && (x < image.width); i++) pRow[x++] = color | (random() << 24);
+		}
+	}
+}
+
+// Rows of one color are one run packet per row, the upper byte is ignored
+static void testRuns()
+{
+	IMAGEBUFFER image;
+	RLEIMAGE rle;
+	createImageBuffer(image, 20, 3);
+	for (int y = 0; y < image.height; y++)
+		for (int x = 0; x < image.width; x++) imageRow(image, y)[x] = IMAGEPIXELRGB(y, 2, 3) | ((IMAGEPIXEL)x << 24);
+
+	CHECK(isRoundTripEqual(image, rle));
+	CHECK(!rle.raw);
+	CHECKEQUAL(rle.width, 20);
+	CHECKEQUAL(rle.height, 3);
+	CHECKEQUAL(rle.data.size(), 6);
+	CHECKEQUAL(rle.data[0], IMAGERLERUNFLAG | 20);
+	CHECKEQUAL(rle.data[5], IMAGEPIXELRGB(2, 2, 3));
+	freeRLEImage(rle);
+	CHECKEQUAL(rle.data.size(), 0);
+	CHECK(!rle.raw);
+	freeImageBuffer(image);
+}
+
+// Literal packets before, between and after runs, equal pixels below the minimum run are literals
+static void testLiterals()
+{
+	IMAGEPIXEL pixels[] = { 1, 2, 3, 3, 3, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 7 };
+	IMAGEBUFFER image;
+	RLEIMAGE rle;
+	attachImageBuffer(image, pixels, sizeof(pixels) / sizeof(pixels[0]), 1, sizeof(pixels));
+
+	CHECK(isRoundTripEqual(image, rle));
+	CHECK(!rle.raw);
+	const uint32_t expected[] = { 2, 1, 2, IMAGERLERUNFLAG | 3, 3, 2, 4, 4, IMAGERLERUNFLAG | 4, 5, IMAGERLERUNFLAG | 14, 6, 1, 7 };
+	CHECKEQUAL(rle.data.size(), sizeof(expected) / sizeof(expected[0]));
+	for (size_t i = 0; (i < rle.data.size()) && (i < sizeof(expected) / sizeof(expected[0])); i++) CHECKEQUAL(rle.data[i], expected[i]);
+	freeRLEImage(rle);
+}
+
+// Noise is stored uncompressed, because packets would not save memory
+static void testUncompressed()
+{
+	std::mt19937 random(16);
+	IMAGEBUFFER image;
+	RLEIMAGE rle;
+	createImageBuffer(image, 31, 9);
+	for (int y = 0; y < image.height; y++)
+		for (int x = 0; x < image.width; x++) imageRow(image, y)[x] = random();
+
+	CHECK(isRoundTripEqual(image, rle));
+	CHECK(rle.raw);
+	CHECKEQUAL(rle.data.size(), 31 * 9);
+	CHECK(getRLEImageBytes(rle) <= (size_t)31 * 9 * IMAGEBYTESPERPIXEL);
+	freeImageBuffer(image);
+
+	// Stripes are smaller than the raw size
+	createImageBuffer(image, 64, 64);
+	fillStripes(image, random);
+	CHECK(isRoundTripEqual(image, rle));
+	CHECK(!rle.raw);
+	CHECK(rle.data.size() < 64 * 64);
+	CHECKEQUAL(getRLEImageBytes(rle), rle.data.size() * sizeof(uint32_t)); // Allocated once with the exact size
+	freeRLEImage(rle);
+	freeImageBuffer(image);
+}
+
+// Views with a stride larger than the width as source and target
+static void testViews()
+{
+	std::mt19937 random(17);
+	IMAGEBUFFER image, view, target, targetView;
+	RLEIMAGE rle;
+	createImageBuffer(image, 100, 80);
+	fillStripes(image, random);
+	createImageBuffer(target, 90, 50);
+	fillImage(target, 0xABCDEF);
+
+	for (int raw = 0; raw < 2; raw++)
+	{
+		if (raw == 1) // Noise for the uncompressed case
+			for (int y = 0; y < image.height; y++)
+				for (int x = 0; x < image.width; x++) imageRow(image, y)[x] = random();
+
+		CHECK(getImageView(image, 5, 7, 33, 17, view));
+		CHECK(isRoundTripEqual(view, rle));
+		CHECKEQUAL(rle.raw, raw);
+
+		CHECK(getImageView(target, 40, 20, 33, 17, targetView));
+		CHECK(decompressImageRLE(rle, targetView));
+		bool bEqual = true;
+		for (int y = 0; y < view.height; y++)
+			for (int x = 0; x < view.width; x++)
+				if (getImagePixel(targetView, x, y) != getImagePixel(view, x, y)) bEqual = false;
+		CHECK(bEqual);
+
+		// Pixels beside the target view are unchanged
+		CHECKEQUAL(getImagePixel(target, 39, 20), 0xABCDEF);
+		CHECKEQUAL(getImagePixel(target, 73, 36), 0xABCDEF);
+		CHECKEQUAL(getImagePixel(target, 40, 37), 0xABCDEF);
+		CHECKEQUAL(getImagePixel(target, 40, 19), 0xABCDEF);
+	}
+	freeRLEImage(rle);
+	freeImageBuffer(image);
+	freeImageBuffer(target);
+}
+
+// Images with one row or one column
+static void testThinImages()
+{
+	std::mt19937 random(18);
+	const int sizes[][2] = { { 1, 1 }, { 1, 70 }, { 70, 1 }, { 2, 41 }, { 41, 2 } };
+	for (const auto& size : sizes)
+	{
+		IMAGEBUFFER image;
+		RLEIMAGE rle;
+		createImageBuffer(image, size[0], size[1]);
+		fillStripes(image, random);
+		CHECK(isRoundTripEqual(image, rle));
+		fillImage(image, 0x010203);
+		CHECK(isRoundTripEqual(image, rle));
+		freeRLEImage(rle);
+		freeImageBuffer(image);
+	}
+}
+
+// Truncated and corrupt data, wrong target sizes and invalid images are rejected
+static void testCorrupt()
+{
+	std::mt19937 random(19);
+	IMAGEBUFFER image, target;
+	RLEIMAGE rle, corrupt;
+	createImageBuffer(image, 40, 6);
+	fillStripes(image, random);
+	createImageBuffer(target, 40, 6);
+	CHECK(compressImageRLE(image, rle));
+	CHECK(!rle.raw);
+	CHECK(decompressImageRLE(rle, target));
+
+	// Truncated at every position
+	bool bRejected = true;
+	for (size_t size = 0; size < rle.data.size(); size++)
+	{
+		corrupt = rle;
+		corrupt.data.resize(size);
+		if (decompressImageRLE(corrupt, target)) bRejected = false;
+	}
+	CHECK(bRejected);
+
+	// Data after the last row
+	corrupt = rle;
+	corrupt.data.push_back(0);
+	CHECK(!decompressImageRLE(corrupt, target));
+
+	// Packet with zero pixels, packet across the row end and too long literal packet
+	corrupt = rle;
+	corrupt.data[0] = IMAGERLERUNFLAG;
+	CHECK(!decompressImageRLE(corrupt, target));
+	corrupt.data[0] = IMAGERLERUNFLAG | 41;
+	CHECK(!decompressImageRLE(corrupt, target));
+	corrupt.data[0] = 0;
+	CHECK(!decompressImageRLE(corrupt, target));
+	corrupt.data[0] = IMAGERLEMAXCOUNT;
+	CHECK(!decompressImageRLE(corrupt, target));
+
+	// Uncompressed data with the wrong size
+	corrupt = rle;
+	corrupt.raw = true;
+	corrupt.data.assign(40 * 6 - 1, 0);
+	CHECK(!decompressImageRLE(corrupt, target));
+	corrupt.data.assign(40 * 6, 0);
+	CHECK(decompressImageRLE(corrupt, target));
+
+	// Size mismatch and invalid images
+	IMAGEBUFFER view, invalid = { 0 };
+	getImageView(target, 0, 0, 40, 5, view);
+	CHECK(!decompressImageRLE(rle, view));
+	CHECK(!decompressImageRLE(rle, invalid));
+	CHECK(!compressImageRLE(invalid, corrupt));
+	CHECKEQUAL(corrupt.data.size(), 0);
+	CHECKEQUAL(corrupt.width, 0);
+
+	freeRLEImage(rle);
+	freeImageBuffer(image);
+	freeImageBuffer(target);
+}
+
+int main()
+{
+	testRuns();
+	testLiterals();
+	testUncompressed();
+	testViews();
+	testThinImages();
+	testCorrupt();
+	return testResult();
+}
@@ -0,0 +1,146 @@
+/*+===================================================================
+  File:      pixelateTest.cpp
+
+  Summary:   Tests of the pixelation kernels against a simple reference
+             implementation, including partial edge blocks, views and
+             parallel bands
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "imageBuffer.h"
+#include "pixelate.h"
+#include "testCheck.h"
+#include <cstring>
+#include <random>
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: pixelateReference
+
+  Summary:   Pixelates an image pixel by pixel (reference for the kernels)
+
+  Args:     const IMAGEBUFFER &image
+              Image buffer or view
+            int blockSize
+              Width and height of a block in pixels
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+static void pixelateReference(const IMAGEBUFFER& image, int blockSize)
+{
+	for (int blockY = 0; blockY < image.height; blockY += blockSize)
+	{
+		for (int blockX = 0; blockX < image.width; blockX += blockSize)
+		{
+			uint32_t r = 0, g = 0, b = 0, count = 0;
+			for (int y = blockY; (y < blockY + blockSize) && (y < image.height); y++)
+			{
+				for (int x = blockX; (x < blockX + blockSize) && (x < image.width); x++)
+				{
+					IMAGEPIXEL pixel = getImagePixel(image, x, y);
+					r += pixel >> 16;
+					g += (pixel >> 8) & 0xff;
+					b += pixel & 0xff;
+					count++;
+				}
+			}
+			IMAGEPIXEL average = IMAGEPIXELRGB((r + count / 2) / count, (g + count / 2) / count, (b + count / 2) / count);
+			for (int y = blockY; (y < blockY + blockSize) && (y < image.height); y++)
+				for (int x = blockX; (x < blockX + blockSize) && (x < image.width); x++) imageRow(image, y)[x] = average;
+		}
+	}
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: isSameImage
+
+  Summary:   Compares all bytes of two images with the same size
+
+  Args:     const IMAGEBUFFER &a
+            const IMAGEBUFFER &b
+              Images
+
+  Returns:  bool
+
+-----------------------------------------------------------------F-F*/
+static bool isSameImage(const IMAGEBUFFER& a, const IMAGEBUFFER& b)
+{
+	for (int y = 0; y < a.height; y++)
+		if (memcmp(imageRow(a, y), imageRow(b, y), (size_t)a.width * IMAGEBYTESPERPIXEL) != 0) return false;
+	return true;
+}
+
+// All kernels supported by the CPU on random sizes, block sizes and views
+static void testKernels()
+{
+	std::mt19937 random(1);
+	PIXELATEKERNEL bestKernel = getBestPixelateKernel();
+
+	for (int i = 0; i < 300; i++)
+	{
+		int width = 1 + random() % 200;
+		int height = 1 + random() % 100;
+		int blockSize = 1 + random() % 40;
+		if (i % 50 == 0) blockSize = PIXELATEMAXBLOCKSIZE + random() % 3; // Scalar fallback for large blocks
+
+		IMAGEBUFFER source, expected, actual, view;
+		createImageBuffer(source, width + 5, height + 3);
+		createImageBuffer(expected, width + 5, height + 3);
+		createImageBuffer(actual, width + 5, height + 3);
+		for (int y = 0; y < source.height; y++)
+			for (int x = 0; x < source.width; x++) imageRow(source, y)[x] = random(); // Includes random upper bytes
+
+		copyImage(expected, source);
+		getImageView(expected, 2, 1, width, height, view);
+		pixelateReference(view, blockSize);
+
+		for (int kernel = pixelateKernelScalar; kernel <= bestKernel; kernel++)
+		{
+			copyImage(actual, source);
+			getImageView(actual, 2, 1, width, height, view);
+			pixelateImage(view, blockSize, (PIXELATEKERNEL)kernel, 1);
+			if (!isSameImage(actual, expected)) // Also checks, that pixels outside the view are unchanged
+			{
+				fprintf(stderr, "kernel %d, %dx%d, block size %d\n", kernel, width, height, blockSize);
+				CHECK(false);
+			}
+		}
+		freeImageBuffer(source);
+		freeImageBuffer(expected);
+		freeImageBuffer(actual);
+	}
+}
+
+// Result does not depend on the number of bands
+static void testBands()
+{
+	std::mt19937 random(2);
+	IMAGEBUFFER source, expected, actual;
+	createImageBuffer(source, 1500, 1000); // More than PIXELATEPARALLELMINPIXELS
+	createImageBuffer(expected, 1500, 1000);
+	createImageBuffer(actual, 1500, 1000);
+	for (int y = 0; y < source.height; y++)
+		for (int x = 0; x < source.width; x++) imageRow(source, y)[x] = random();
+
+	copyImage(expected, source);
+	pixelateReference(expected, 7);
+	for (int threads = 1; threads <= 16; threads++)
+	{
+		copyImage(actual, source);
+		pixelateImage(actual, 7, pixelateKernelAuto, threads);
+		CHECK(isSameImage(actual, expected));
+	}
+	freeImageBuffer(source);
+	freeImageBuffer(expected);
+	freeImageBuffer(actual);
+}
+
+int main()
+{
+	testKernels();
+	testBands();
+	return testResult();
+}
@@ -0,0 +1,470 @@
+/*+===================================================================
+  File:      pngDecoder.h
+
+  Summary:   Small zlib inflater (RFC 1950/1951) and PNG decoder for the
+             round-trip tests of the encoder. Checks all CRC and Adler-32
+             values and decodes 8 bit RGB and indexed PNGs with bit depth
+             1, 2, 4 or 8 (the formats written by pngEncoder.cpp).
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#pragma once
+
+#include "deflate.h"
+#include "imageBuffer.h"
+#include "pngEncoder.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Reader for the bit stream of deflate data
+struct INFLATESTATE {
+	const uint8_t* pData; // Compressed data
+	size_t size; // Bytes of the compressed data
+	size_t position; // Next byte
+	uint32_t bitBuffer; // Bits not used so far
+	int bitCount; // Number of bits in bitBuffer
+	bool bError; // true, when the data ended too early
+	std::vector<uint8_t>* pOutput; // Decompressed data
+};
+
+// Canonical Huffman code
+struct INFLATEHUFFMAN {
+	uint16_t counts[16]; // Number of codes per length
+	uint16_t symbols[320]; // Symbols ordered by code
+};
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getInflateBits
+
+  Summary:   Gets the next bits of the stream (LSB first)
+
+  Args:     INFLATESTATE &state
+              Reader (call by ref)
+            int count
+              Number of bits (0-16)
+
+  Returns:  uint32_t
+
+-----------------------------------------------------------------F-F*/
+inline uint32_t getInflateBits(INFLATESTATE& state, int count)
+{
+	while (state.bitCount < count)
+	{
+		if (state.position >= state.size)
+		{
+			state.bError = true;
+			return 0;
+		}
+		state.bitBuffer |= (uint32_t)state.pData[state.position++] << state.bitCount;
+		state.bitCount += 8;
+	}
+	uint32_t bits = state.bitBuffer & ((1u << count) - 1);
+	state.bitBuffer >>= count;
+	state.bitCount -= count;
+	return bits;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: buildInflateHuffman
+
+  Summary:   Builds a canonical Huffman code from code lengths
+
+  Args:     INFLATEHUFFMAN &huffman
+              Code (call by ref)
+            const uint8_t* pLengths
+              Code length of each symbol (0 = unused)
+            int count
+              Number of symbols
+
+  Returns:  bool
+              true = valid code
+              false = over-subscribed code
+
+-----------------------------------------------------------------F-F*/
+inline bool buildInflateHuffman(INFLATEHUFFMAN& huffman, const uint8_t* pLengths, int count)
+{
+	uint16_t offsets[16];
+	memset(huffman.counts, 0, sizeof(huffman.counts));
+	for (int i = 0; i < count; i++) huffman.counts[pLengths[i]]++;
+	huffman.counts[0] = 0;
+
+	int left = 1;
+	for (int length = 1; length < 16; length++)
+	{
+		left = (left << 1) - huffman.counts[length];
+		if (left < 0) return false;
+	}
+	offsets[1] = 0;
+	for (int length = 1; length < 15; length++) offsets[length + 1] = offsets[length] + huffman.counts[length];
+	for (int i = 0; i < count; i++)
+		if (pLengths[i] != 0) huffman.symbols[offsets[pLengths[i]]++] = (uint16_t)i;
+	return true;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: decodeInflateSymbol
+
+  Summary:   Decodes the next symbol with a Huffman code
+
+  Args:     INFLATESTATE &state
+              Reader (call by ref)
+            const INFLATEHUFFMAN &huffman
+              Code
+
+  Returns:  int
+              Symbol or -1 for an invalid code
+
+-----------------------------------------------------------------F-F*/
+inline int decodeInflateSymbol(INFLATESTATE& state, const INFLATEHUFFMAN& huffman)
+{
+	int code = 0, first = 0, index = 0;
+	for (int length = 1; length < 16; length++)
+	{
+		code |= (int)getInflateBits(state, 1);
+		int count = huffman.counts[length];
+		if (code - count < first) return huffman.symbols[index + (code - first)];
+		index += count;
+		first = (first + count) << 1;
+		code <<= 1;
+		if (state.bError) return -1;
+	}
+	return -1;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: inflateCodes
+
+  Summary:   Decodes the literals and matches of a compressed block
+
+  Args:     INFLATESTATE &state
+              Reader (call by ref)
+            const INFLATEHUFFMAN &literals
+            const INFLATEHUFFMAN &distances
+              Codes of the block
+
+  Returns:  bool
+              true = success
+              false = invalid data
+
+-----------------------------------------------------------------F-F*/
+inline bool inflateCodes(INFLATESTATE& state, const INFLATEHUFFMAN& literals, const INFLATEHUFFMAN& distances)
+{
+	static const uint16_t lengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	static const uint8_t lengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	static const uint16_t distanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+	static const uint8_t distanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+	std::vector<uint8_t>& output = *state.pOutput;
+
+	while (true)
+	{
+		int symbol = decodeInflateSymbol(state, literals);
+		if (symbol < 0) return false;
+		if (symbol < 256)
+		{
+			output.push_back((uint8_t)symbol);
+			continue;
+		}
+		if (symbol == 256) return true; // End of block
+		symbol -= 257;
+		if (symbol >= 29) return false;
+		size_t length = lengthBase[symbol] + getInflateBits(state, lengthExtra[symbol]);
+		int distanceSymbol = decodeInflateSymbol(state, distances);
+		if ((distanceSymbol < 0) || (distanceSymbol >= 30)) return false;
+		size_t distance = distanceBase[distanceSymbol] + getInflateBits(state, distanceExtra[distanceSymbol]);
+		if (state.bError || (distance > output.size()) || (distance > DEFLATEWINDOWSIZE)) return false;
+		size_t start = output.size() - distance;
+		for (size_t i = 0; i < length; i++) output.push_back(output[start + i]);
+	}
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: inflateRaw
+
+  Summary:   Decompresses raw deflate data (RFC 1951)
+
+  Args:     INFLATESTATE &state
+              Reader (call by ref)
+
+  Returns:  bool
+              true = success
+              false = invalid data
+
+-----------------------------------------------------------------F-F*/
+inline bool inflateRaw(INFLATESTATE& state)
+{
+	static const uint8_t lengthOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+	bool bFinal;
+	do {
+		bFinal = getInflateBits(state, 1) != 0;
+		uint32_t type = getInflateBits(state, 2);
+		INFLATEHUFFMAN literals, distances;
+		uint8_t lengths[320];
+
+		if (type == 0) // Stored
+		{
+			state.bitBuffer = 0;
+			state.bitCount = 0;
+			if (state.position + 4 > state.size) return false;
+			uint32_t length = state.pData[state.position] | (state.pData[state.position + 1] << 8);
+			uint32_t inverse = state.pData[state.position + 2] | (state.pData[state.position + 3] << 8);
+			state.position += 4;
+			if ((length != (~inverse & 0xffff)) || (state.position + length > state.size)) return false;
+			state.pOutput->insert(state.pOutput->end(), state.pData + state.position, state.pData + state.position + length);
+			state.position += length;
+			continue;
+		}
+		if (type == 1) // Fixed codes
+		{
+			for (int i = 0; i < 288; i++) lengths[i] = (i < 144) ? 8 : (i < 256) ? 9 : (i < 280) ? 7 : 8;
+			buildInflateHuffman(literals, lengths, 288);
+			for (int i = 0; i < 30; i++) lengths[i] = 5;
+			buildInflateHuffman(distances, lengths, 30);
+		}
+		else if (type == 2) // Dynamic codes
+		{
+			int literalCount = (int)getInflateBits(state, 5) + 257;
+			int distanceCount = (int)getInflateBits(state, 5) + 1;
+			int lengthCount = (int)getInflateBits(state, 4) + 4;
+			if ((literalCount > 286) || (distanceCount > 30)) return false;
+			memset(lengths, 0, sizeof(lengths));
+			for (int i = 0; i < lengthCount; i++) lengths[lengthOrder[i]] = (uint8_t)getInflateBits(state, 3);
+			INFLATEHUFFMAN lengthCode;
+			if (!buildInflateHuffman(lengthCode, lengths, 19)) return false;
+
+			int i = 0;
+			while (i < literalCount + distanceCount)
+			{
+				int symbol = decodeInflateSymbol(state, lengthCode);
+				if (symbol < 0) return false;
+				if (symbol < 16)
+				{
+					lengths[i++] = (uint8_t)symbol;
+					continue;
+				}
+				uint8_t length = 0;
+				int repeat;
+				if (symbol == 16)
+				{
+					if (i == 0) return false;
+					length = lengths[i - 1];
+					repeat = 3 + (int)getInflateBits(state, 2);
+				}
+				else if (symbol == 17) repeat = 3 + (int)getInflateBits(state, 3);
+				else repeat = 11 + (int)getInflateBits(state, 7);
+				if (i + repeat > literalCount + distanceCount) return false;
+				while (repeat-- > 0) lengths[i++] = length;
+			}
+			if (lengths[256] == 0) return false; // No end of block code
+			if (!buildInflateHuffman(literals, lengths, literalCount)) return false;
+			if (!buildInflateHuffman(distances, lengths + literalCount, distanceCount)) return false;
+		}
+		else return false;
+		if (!inflateCodes(state, literals, distances)) return false;
+	} while (!bFinal && !state.bError);
+	return !state.bError;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: inflateZlib
+
+  Summary:   Decompresses a zlib stream (RFC 1950) and checks header and
+             Adler-32
+
+  Args:     const uint8_t* pData
+              Stream
+            size_t size
+              Bytes of the stream
+            std::vector<uint8_t> &output
+              Decompressed data (call by ref)
+
+  Returns:  bool
+              true = success
+              false = invalid stream
+
+-----------------------------------------------------------------F-F*/
+inline bool inflateZlib(const uint8_t* pData, size_t size, std::vector<uint8_t>& output)
+{
+	output.clear();
+	if (size < 6) return false;
+	if (((pData[0] & 0x0f) != 8) || ((pData[0] >> 4) > 7) || (((pData[0] << 8) | pData[1]) % 31 != 0) || (pData[1] & 0x20)) return false;
+
+	INFLATESTATE state = { pData, size - 4, 2, 0, 0, false, &output };
+	if (!inflateRaw(state)) return false;
+	if (state.position != size - 4) return false; // Data after the deflate stream
+
+	const uint8_t* pAdler = pData + size - 4;
+	uint32_t adler = ((uint32_t)pAdler[0] << 24) | ((uint32_t)pAdler[1] << 16) | ((uint32_t)pAdler[2] << 8) | pAdler[3];
+	return adler == updateAdler32(1, output.data(), output.size());
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getPNGUInt32
+
+  Summary:   Gets big-endian 32 bit value
+
+  Args:     const uint8_t* pData
+              First byte
+
+  Returns:  uint32_t
+
+-----------------------------------------------------------------F-F*/
+inline uint32_t getPNGUInt32(const uint8_t* pData)
+{
+	return ((uint32_t)pData[0] << 24) | ((uint32_t)pData[1] << 16) | ((uint32_t)pData[2] << 8) | pData[3];
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: paethPredictor
+
+  Summary:   Paeth predictor of the PNG filter type 4
+
+  Args:     int a
+            int b
+            int c
+              Left, upper and upper left byte
+
+  Returns:  int
+
+-----------------------------------------------------------------F-F*/
+inline int paethPredictor(int a, int b, int c)
+{
+	int p = a + b - c;
+	int pa = (p > a) ? p - a : a - p;
+	int pb = (p > b) ? p - b : b - p;
+	int pc = (p > c) ? p - c : c - p;
+	if ((pa <= pb) && (pa <= pc)) return a;
+	return (pb <= pc) ? b : c;
+}
+
+// Information about a decoded PNG
+struct PNGDECODEINFO {
+	int bitDepth = 0; // Bit depth from IHDR
+	int colorType = 0; // Color type from IHDR (2 = RGB, 3 = indexed)
+	int paletteColors = 0; // Entries of the PLTE chunk
+	int idatChunks = 0; // Number of IDAT chunks
+};
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: decodePNG
+
+  Summary:   Decodes a PNG created by the encoder into a new image buffer
+
+  Args:     const std::vector<uint8_t> &png
+              PNG file
+            IMAGEBUFFER &image
+              Decoded image (call by ref, must be freed with freeImageBuffer)
+            PNGDECODEINFO &info
+              Format of the PNG (call by ref)
+
+  Returns:  bool
+              true = success
+              false = invalid or unsupported PNG
+
+-----------------------------------------------------------------F-F*/
+inline bool decodePNG(const std::vector<uint8_t>& png, IMAGEBUFFER& image, PNGDECODEINFO& info)
+{
+	static const uint8_t signature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+	image = { 0 };
+	info = PNGDECODEINFO();
+	if ((png.size() < 8) || (memcmp(png.data(), signature, 8) != 0)) return false;
+
+	int width = 0, height = 0;
+	std::vector<uint8_t> idat;
+	IMAGEPIXEL palette[PNGMAXPALETTECOLORS] = { 0 };
+	bool bEnd = false;
+	size_t position = 8;
+	while (!bEnd)
+	{
+		if (position + 12 > png.size()) return false;
+		uint32_t length = getPNGUInt32(&png[position]);
+		if (position + 12 + length > png.size()) return false;
+		const uint8_t* pType = &png[position + 4];
+		const uint8_t* pData = pType + 4;
+		if (getPNGUInt32(pData + length) != updateCRC32(0, pType, (size_t)length + 4)) return false;
+
+		if (memcmp(pType, "IHDR", 4) == 0)
+		{
+			if (length != 13) return false;
+			width = (int)getPNGUInt32(pData);
+			height = (int)getPNGUInt32(pData + 4);
+			info.bitDepth = pData[8];
+			info.colorType = pData[9];
+			if ((pData[10] != 0) || (pData[11] != 0) || (pData[12] != 0)) return false; // Compression, filter method, interlace
+		}
+		else if (memcmp(pType, "PLTE", 4) == 0)
+		{
+			if ((length % 3 != 0) || (length / 3 > PNGMAXPALETTECOLORS)) return false;
+			info.paletteColors = (int)(length / 3);
+			for (int i = 0; i < info.paletteColors; i++) palette[i] = IMAGEPIXELRGB(pData[i * 3], pData[i * 3 + 1], pData[i * 3 + 2]);
+		}
+		else if (memcmp(pType, "IDAT", 4) == 0)
+		{
+			idat.insert(idat.end(), pData, pData + length);
+			info.idatChunks++;
+		}
+		else if (memcmp(pType, "IEND", 4) == 0) bEnd = true;
+		position += 12 + (size_t)length;
+	}
+	if (position != png.size()) return false;
+
+	int bitsPerPixel;
+	if ((info.colorType == 2) && (info.bitDepth == 8)) bitsPerPixel = 24;
+	else if ((info.colorType == 3) && ((info.bitDepth == 1) || (info.bitDepth == 2) || (info.bitDepth == 4) || (info.bitDepth == 8)) && (info.paletteColors > 0)) bitsPerPixel = info.bitDepth;
+	else return false;
+
+	std::vector<uint8_t> data;
+	if (!inflateZlib(idat.data(), idat.size(), data)) return false;
+	size_t rowSize = ((size_t)width * bitsPerPixel + 7) / 8;
+	if (data.size() != (rowSize + 1) * height) return false;
+	if (!createImageBuffer(image, width, height)) return false;
+
+	int bytesPerPixel = (bitsPerPixel + 7) / 8;
+	std::vector<uint8_t> previous(rowSize, 0), row(rowSize);
+	for (int y = 0; y < height; y++)
+	{
+		const uint8_t* pFiltered = &data[(rowSize + 1) * y];
+		uint8_t filter = pFiltered[0];
+		for (size_t i = 0; i < rowSize; i++)
+		{
+			int a = (i >= (size_t)bytesPerPixel) ? row[i - bytesPerPixel] : 0;
+			int b = previous[i];
+			int c = (i >= (size_t)bytesPerPixel) ? previous[i - bytesPerPixel] : 0;
+			int predictor;
+			switch (filter)
+			{
+				case 0: predictor = 0; break;
+				case 1: predictor = a; break;
+				case 2: predictor = b; break;
+				case 3: predictor = (a + b) / 2; break;
+				case 4: predictor = paethPredictor(a, b, c); break;
+				default:
+					freeImageBuffer(image);
+					return false;
+			}
+			row[i] = (uint8_t)(pFiltered[1 + i] + predictor);
+		}
+
+		IMAGEPIXEL* pRow = imageRow(image, y);
+		for (int x = 0; x < width; x++)
+		{
+			if (bitsPerPixel == 24) pRow[x] = IMAGEPIXELRGB(row[x * 3], row[x * 3 + 1], row[x * 3 + 2]);
+			else
+			{
+				int bit = x * bitsPerPixel;
+				int index = (row[bit / 8] >> (8 - bitsPerPixel - bit % 8)) & ((1 << bitsPerPixel) - 1);
+				if (index >= info.paletteColors)
+				{
+					freeImageBuffer(image);
+					return false;
+				}
+				pRow[x] = palette[index];
+			}
+		}
+		previous.swap(row);
+	}
+	return true;
+}
@@ -0,0 +1,252 @@
+/*+===================================================================
+  File:      pngEncoderTest.cpp
+
+  Summary:   Round-trip tests of the PNG encoder: encode, decode with the
+             inflater of pngDecoder.h and compare the pixels. Covers odd
+             widths, 1x1 images, views with a stride larger than the width,
+             all filters, levels, window sizes, profiles and palettes.
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "imageBuffer.h"
+#include "pngDecoder.h"
+#include "pngEncoder.h"
+#include "testCheck.h"
+#include <random>
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: fillTestImage
+
+  Summary:   Fills an image with screenshot-like content (areas, text-like
+             pixels and noise) with a limited number of colors and random
+             upper bytes
+
+  Args:     const IMAGEBUFFER &image
+              Image buffer or view
+            int colors
+              Number of colors (0 = noise with all colors)
+            uint32_t seed
+              Seed of the random generator
+
+  Returns:
+
+-----------------------------------------------------------------F-F*/
+static void fillTestImage(const IMAGEBUFFER& image, int colors, uint32_t seed)
+{
+	std::mt19937 random(seed);
+	for (int y = 0; y < image.height; y++)
+	{
+		for (int x = 0; x < image.width; x++)
+		{
+			IMAGEPIXEL color;
+			if (colors == 0) color = random() & IMAGEPIXELCOLORMASK;
+			else
+			{
+				int index = ((x / 5 + y / 3) % 7 == 0) ? random() % colors : (x / 11 + y / 7) % colors; // Areas and random pixels
+				color = IMAGEPIXELRGB(index * 37, index * 101, index * 13); // Different colors for index 0-255
+			}
+			imageRow(image, y)[x] = color | (random() << 24);
+		}
+	}
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: checkRoundTrip
+
+  Summary:   Encodes an image, decodes the PNG and compares the pixels
+
+  Args:     const IMAGEBUFFER &image
+              Image buffer or view
+            const PNGOPTIONS &options
+              Encoder options
+            PNGDECODEINFO &info
+              Format of the PNG (call by ref)
+
+  Returns:  bool
+              true = same pixels
+              false = encode or decode failed or different pixels
+
+-----------------------------------------------------------------F-F*/
+static bool checkRoundTrip(const IMAGEBUFFER& image, const PNGOPTIONS& options, PNGDECODEINFO& info)
+{
+	std::vector<uint8_t> png;
+	IMAGEBUFFER decoded;
+	if (!encodePNGToMemory(image, png, options)) return false;
+	if (!decodePNG(png, decoded, info)) return false;
+
+	bool bSame = (decoded.width == image.width) && (decoded.height == image.height);
+	for (int y = 0; bSame && (y < image.height); y++)
+		for (int x = 0; bSame && (x < image.width); x++) bSame = getImagePixel(decoded, x, y) == getImagePixel(image, x, y);
+	freeImageBuffer(decoded);
+	return bSame;
+}
+
+// Sizes including 1x1, odd widths and single rows or columns
+static void testSizes()
+{
+	const int sizes[][2] = { { 1, 1 }, { 1, 7 }, { 7, 1 }, { 3, 3 }, { 17, 5 }, { 333, 77 }, { 1001, 3 }, { 2, 600 } };
+	for (const int* pSize : sizes)
+	{
+		for (int colors : { 0, 2, 200 })
+		{
+			IMAGEBUFFER image;
+			PNGDECODEINFO info;
+			createImageBuffer(image, pSize[0], pSize[1]);
+			fillTestImage(image, colors, (uint32_t)(pSize[0] * 1000 + pSize[1]));
+			if (!checkRoundTrip(image, PNGOPTIONS(), info))
+			{
+				fprintf(stderr, "%dx%d, %d colors\n", pSize[0], pSize[1], colors);
+				CHECK(false);
+			}
+			freeImageBuffer(image);
+		}
+	}
+}
+
+// Views with a stride larger than the width
+static void testViews()
+{
+	IMAGEBUFFER image, view;
+	PNGDECODEINFO info;
+	createImageBuffer(image, 301, 101);
+	fillTestImage(image, 0, 1);
+	getImageView(image, 3, 5, 97, 41, view);
+	CHECK(checkRoundTrip(view, PNGOPTIONS(), info));
+	CHECKEQUAL(info.colorType, 2);
+	getImageView(image, 300, 100, 1, 1, view);
+	CHECK(checkRoundTrip(view, PNGOPTIONS(), info));
+
+	fillTestImage(image, 16, 2);
+	getImageView(image, 1, 1, 299, 99, view);
+	CHECK(checkRoundTrip(view, PNGOPTIONS(), info));
+	CHECKEQUAL(info.colorType, 3);
+	freeImageBuffer(image);
+}
+
+// Every filter, compression level and window size
+static void testFiltersAndLevels()
+{
+	IMAGEBUFFER image;
+	PNGDECODEINFO info;
+	createImageBuffer(image, 259, 67);
+	fillTestImage(image, 40, 3);
+	for (int filter = pngFilterNone; filter <= pngFilterAdaptiveSampled; filter++)
+	{
+		for (bool bPalette : { false, true })
+		{
+			PNGOPTIONS options;
+			options.filter = (PNGFILTER)filter;
+			options.bPalette = bPalette;
+			if (!checkRoundTrip(image, options, info))
+			{
+				fprintf(stderr, "filter %d, palette %d\n", filter, bPalette);
+				CHECK(false);
+			}
+		}
+	}
+	for (int level = DEFLATEMINLEVEL; level <= DEFLATEMAXLEVEL; level++)
+	{
+		for (int windowBits : { DEFLATEMINWINDOWBITS, 12, DEFLATEMAXWINDOWBITS })
+		{
+			PNGOPTIONS options;
+			options.compressionLevel = level;
+			options.windowBits = windowBits;
+			options.bPalette = false;
+			if (!checkRoundTrip(image, options, info))
+			{
+				fprintf(stderr, "level %d, window bits %d\n", level, windowBits);
+				CHECK(false);
+			}
+		}
+	}
+	for (int profile = pngProfileFast; profile <= pngProfileSmallest; profile++)
+		CHECK(checkRoundTrip(image, getPNGOptionsForProfile((PNGCOMPRESSIONPROFILE)profile), info));
+	freeImageBuffer(image);
+}
+
+// Bit depth of indexed PNGs for 1-256 colors and truecolor for more colors
+static void testPalette()
+{
+	const int counts[][2] = { { 1, 1 }, { 2, 1 }, { 3, 2 }, { 4, 2 }, { 5, 4 }, { 16, 4 }, { 17, 8 }, { 256, 8 } };
+	for (const int* pCount : counts)
+	{
+		IMAGEBUFFER image;
+		PNGDECODEINFO info;
+		createImageBuffer(image, 131, 29); // Odd width for partial bytes at the end of the rows
+		fillTestImage(image, pCount[0], 4);
+		for (int i = 0; i < pCount[0]; i++) imageRow(image, i / 131)[i % 131] = IMAGEPIXELRGB(i * 37, i * 101, i * 13); // All colors exist
+
+		PNGPALETTE palette;
+		CHECK(getPNGPalette(image, palette));
+		CHECKEQUAL(palette.count, pCount[0]);
+		CHECK(checkRoundTrip(image, PNGOPTIONS(), info));
+		CHECKEQUAL(info.colorType, 3);
+		CHECKEQUAL(info.bitDepth, pCount[1]);
+		CHECKEQUAL(info.paletteColors, pCount[0]);
+		freeImageBuffer(image);
+	}
+
+	// 257 colors
+	IMAGEBUFFER image;
+	PNGPALETTE palette;
+	PNGDECODEINFO info;
+	createImageBuffer(image, 300, 2);
+	fillImage(image, 0);
+	for (int i = 0; i < 257; i++) imageRow(image, 0)[i] = IMAGEPIXELRGB(i, i / 2, 0);
+	CHECK(!getPNGPalette(image, palette));
+	CHECK(checkRoundTrip(image, PNGOPTIONS(), info));
+	CHECKEQUAL(info.colorType, 2);
+	freeImageBuffer(image);
+}
+
+// Large images are split into several IDAT chunks
+static void testLargeImage()
+{
+	IMAGEBUFFER image;
+	PNGDECODEINFO info;
+	createImageBuffer(image, 1920, 1080);
+	fillTestImage(image, 0, 5);
+	PNGOPTIONS options;
+	options.compressionLevel = 1;
+	CHECK(checkRoundTrip(image, options, info));
+	CHECK(info.idatChunks > 1);
+	freeImageBuffer(image);
+}
+
+// Write function can cancel the encoding, invalid images and PNGs
+static void testWriteError()
+{
+	IMAGEBUFFER image;
+	createImageBuffer(image, 10, 10);
+	fillTestImage(image, 0, 6);
+	int calls = 0;
+	CHECK(!encodePNG(image, [&](const uint8_t*, size_t) { return ++calls < 3; }));
+	CHECKEQUAL(calls, 3);
+	IMAGEBUFFER invalid = { 0 };
+	std::vector<uint8_t> png;
+	CHECK(!encodePNGToMemory(invalid, png));
+
+	// Decoder of the test rejects a changed byte (CRC)
+	IMAGEBUFFER decoded;
+	PNGDECODEINFO info;
+	CHECK(encodePNGToMemory(image, png));
+	CHECK(decodePNG(png, decoded, info));
+	freeImageBuffer(decoded);
+	png[png.size() - 20] ^= 1;
+	CHECK(!decodePNG(png, decoded, info));
+	freeImageBuffer(image);
+}
+
+int main()
+{
+	testSizes();
+	testViews();
+	testFiltersAndLevels();
+	testPalette();
+	testLargeImage();
+	testWriteError();
+	return testResult();
+}
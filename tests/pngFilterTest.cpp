@@ -0,0 +1,182 @@
+/*+===================================================================
+  File:      pngFilterTest.cpp
+
+  Summary:   Tests of the PNG row filters and the filter selection: the
+             SSE2 and AVX2 kernels against a reference implementation of
+             the PNG specification for odd row sizes, 1, 3 and 4 bytes per
+             pixel and the rounding and tie cases of Average and Paeth
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "pngFilter.h"
+#include "testCheck.h"
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#define GUARDBYTES 64 // Bytes behind the filtered row, which must not be changed
+#define GUARDVALUE 0xA5 // Value of the guard bytes
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: filterReference
+
+  Summary:   Filters one byte like the PNG specification (reference for the
+             kernels)
+
+  Args:     int filter
+              Filter type (pngFilterNone-pngFilterPaeth)
+            const uint8_t *pRow
+            const uint8_t *pPreviousRow
+              Row and previous row (NULL for the first row)
+            size_t i
+              Byte of the row
+            int bytesPerPixel
+              Bytes per pixel
+
+  Returns:  uint8_t
+              Filtered byte
+
+-----------------------------------------------------------------F-F*/
+static uint8_t filterReference(int filter, const uint8_t* pRow, const uint8_t* pPreviousRow, size_t i, int bytesPerPixel)
+{
+	int a = (i >= (size_t)bytesPerPixel) ? pRow[i - bytesPerPixel] : 0;
+	int b = pPreviousRow ? pPreviousRow[i] : 0;
+	int c = (pPreviousRow && (i >= (size_t)bytesPerPixel)) ? pPreviousRow[i - bytesPerPixel] : 0;
+	int predictor = 0;
+	switch (filter)
+	{
+	case pngFilterSub: predictor = a; break;
+	case pngFilterUp: predictor = b; break;
+	case pngFilterAverage: predictor = (a + b) >> 1; break;
+	case pngFilterPaeth:
+	{
+		int p = a + b - c, pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+		predictor = ((pa <= pb) && (pa <= pc)) ? a : ((pb <= pc) ? b : c);
+		break;
+	}
+	}
+	return (uint8_t)(pRow[i] - predictor);
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: checkRow
+
+  Summary:   Compares filterPNGRow, sumPNGFilters and selectPNGFilter at each
+             SIMD level with the reference
+
+  Args:     const std::vector<uint8_t> &row
+              Row
+            const std::vector<uint8_t> *pPreviousRow
+              Previous row (NULL for the first row)
+            int bytesPerPixel
+              Bytes per pixel
+
+  Returns:  int
+              Number of differences
+
+-----------------------------------------------------------------F-F*/
+static int checkRow(const std::vector<uint8_t>& row, const std::vector<uint8_t>* pPreviousRow, int bytesPerPixel)
+{
+	const uint8_t* pPrevious = pPreviousRow ? pPreviousRow->data() : NULL;
+	size_t size = row.size();
+	int errors = 0;
+
+	uint64_t expectedSums[PNGFILTERTYPES] = { 0 };
+	std::vector<uint8_t> expected[PNGFILTERTYPES];
+	int expectedFilter = pngFilterNone;
+	for (int filter = pngFilterNone; filter <= pngFilterPaeth; filter++)
+	{
+		expected[filter].resize(size);
+		for (size_t i = 0; i < size; i++)
+		{
+			expected[filter][i] = filterReference(filter, row.data(), pPrevious, i, bytesPerPixel);
+			expectedSums[filter] += (expected[filter][i] < 128) ? expected[filter][i] : 256 - expected[filter][i];
+		}
+		if (expectedSums[filter] < expectedSums[expectedFilter]) expectedFilter = filter;
+	}
+
+	for (int level = simdLevelNone; level <= simdLevelAVX2; level++)
+	{
+		for (int filter = pngFilterNone; filter <= pngFilterPaeth; filter++)
+		{
+			std::vector<uint8_t> filtered(size + GUARDBYTES, GUARDVALUE);
+			filterPNGRow((PNGFILTER)filter, row.data(), pPrevious, size, bytesPerPixel, filtered.data(), (SIMDLEVEL)level);
+			for (size_t i = 0; i < size; i++)
+				if (filtered[i] != expected[filter][i]) errors++;
+			for (size_t i = size; i < filtered.size(); i++)
+				if (filtered[i] != GUARDVALUE) errors++;
+		}
+
+		uint64_t sums[PNGFILTERTYPES];
+		sumPNGFilters(row.data(), pPrevious, size, bytesPerPixel, sums, (SIMDLEVEL)level);
+		for (int filter = pngFilterNone; filter <= pngFilterPaeth; filter++)
+			if (sums[filter] != expectedSums[filter]) errors++;
+		if (selectPNGFilter(row.data(), pPrevious, size, bytesPerPixel, (SIMDLEVEL)level) != expectedFilter) errors++;
+	}
+	if (errors > 0) fprintf(stderr, "%zu bytes, %d bytes per pixel, previous row %d: %d differences\n", size, bytesPerPixel, pPreviousRow != NULL, errors);
+	return errors;
+}
+
+// Random rows with all sizes up to 3 AVX2 registers and some larger odd sizes
+static void testRandomRows()
+{
+	std::mt19937 random(12);
+	const int bytesPerPixels[] = { 1, 3, 4 };
+	int errors = 0;
+	for (int bytesPerPixel : bytesPerPixels)
+	{
+		std::vector<size_t> sizes;
+		for (size_t size = 1; size <= 100; size++) sizes.push_back(size);
+		for (size_t width : { 333, 1001, 3841 }) sizes.push_back(width * bytesPerPixel);
+		for (size_t size : sizes)
+		{
+			std::vector<uint8_t> row(size), previousRow(size);
+			for (size_t i = 0; i < size; i++)
+			{
+				row[i] = (uint8_t)random();
+				previousRow[i] = (uint8_t)random();
+			}
+			errors += checkRow(row, &previousRow, bytesPerPixel);
+			errors += checkRow(row, NULL, bytesPerPixel);
+		}
+	}
+	CHECKEQUAL(errors, 0);
+}
+
+// Values, where Average rounds and Paeth has ties or overflows 8 bit
+static void testEdgeValues()
+{
+	std::mt19937 random(13);
+	const uint8_t values[] = { 0, 1, 2, 127, 128, 129, 254, 255 };
+	int errors = 0;
+	for (int bytesPerPixel : { 1, 3, 4 })
+	{
+		for (int repeat = 0; repeat < 50; repeat++)
+		{
+			size_t size = (size_t)bytesPerPixel * (1 + random() % 80);
+			std::vector<uint8_t> row(size), previousRow(size);
+			for (size_t i = 0; i < size; i++)
+			{
+				row[i] = values[random() % 8];
+				previousRow[i] = values[random() % 8];
+			}
+			errors += checkRow(row, &previousRow, bytesPerPixel);
+		}
+		// Screenshot-like rows with equal neighbors (many ties)
+		std::vector<uint8_t> row((size_t)bytesPerPixel * 77, 255), previousRow((size_t)bytesPerPixel * 77, 255);
+		for (size_t i = 40; i < row.size(); i++) row[i] = 30;
+		errors += checkRow(row, &previousRow, bytesPerPixel);
+		errors += checkRow(previousRow, &row, bytesPerPixel);
+	}
+	CHECKEQUAL(errors, 0);
+}
+
+int main()
+{
+	testRandomRows();
+	testEdgeValues();
+	return testResult();
+}
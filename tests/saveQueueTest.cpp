@@ -0,0 +1,123 @@
+/*+===================================================================
+  File:      saveQueueTest.cpp
+
+  Summary:   Tests of the save queue: jobs run in order on the writer
+             thread, a full queue rejects jobs without blocking the caller
+             and stopSaveQueue finishes the waiting jobs. The queue is
+             global and cannot be restarted, so the stop test runs last.
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "saveQueue.h"
+#include "testCheck.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// Gate, which holds jobs in the writer thread until it is opened
+struct TESTGATE {
+	std::mutex mutex;
+	std::condition_variable opened;
+	bool bOpen = false;
+
+	void wait()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		opened.wait(lock, [this] { return bOpen; });
+	}
+	void open()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			bOpen = true;
+		}
+		opened.notify_all();
+	}
+};
+
+// Jobs run one after another in the writer thread in the order of enqueueSaveJob, also after a job has thrown
+static void testOrder()
+{
+	std::mutex mutex;
+	std::vector<int> order;
+	std::thread::id callerThread = std::this_thread::get_id();
+	bool bOtherThread = true;
+	for (int i = 0; i < 50; i++)
+	{
+		SAVEJOBFUNCTION job = [i, &mutex, &order, &bOtherThread, callerThread] {
+			std::lock_guard<std::mutex> lock(mutex);
+			order.push_back(i);
+			if (std::this_thread::get_id() == callerThread) bOtherThread = false;
+			if (i == 10) throw std::runtime_error("Job error");
+		};
+		if (!enqueueSaveJob(job)) // Queue is full
+		{
+			waitForSaveJobs();
+			CHECK(enqueueSaveJob(job));
+		}
+	}
+	waitForSaveJobs();
+	CHECKEQUAL(order.size(), 50);
+	for (size_t i = 0; i < order.size(); i++) CHECKEQUAL(order[i], i);
+	CHECK(bOtherThread);
+	SAVEQUEUESTATISTICS statistics = getSaveQueueStatistics();
+	CHECKEQUAL(statistics.depth, 0);
+	CHECK(statistics.maxDepth <= SAVEQUEUEMAXJOBS);
+}
+
+// A full queue rejects jobs immediately, while the writer thread is busy
+static void testFullQueue()
+{
+	TESTGATE gate;
+	int finished = 0;
+	unsigned int rejectedJobs = getSaveQueueStatistics().rejectedJobs;
+	for (int i = 0; i < SAVEQUEUEMAXJOBS; i++) CHECK(enqueueSaveJob([&gate, &finished] { gate.wait(); finished++; }));
+	CHECKEQUAL(getSaveQueueStatistics().depth, SAVEQUEUEMAXJOBS);
+
+	auto start = std::chrono::steady_clock::now();
+	bool bQueued = enqueueSaveJob([&finished] { finished++; });
+	double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	CHECK(!bQueued);
+	CHECK(elapsed < 100);
+	CHECKEQUAL(getSaveQueueStatistics().rejectedJobs, rejectedJobs + 1);
+
+	gate.open();
+	waitForSaveJobs();
+	CHECKEQUAL(finished, SAVEQUEUEMAXJOBS);
+	CHECK(enqueueSaveJob([&finished] { finished++; }));
+	waitForSaveJobs();
+	CHECKEQUAL(finished, SAVEQUEUEMAXJOBS + 1);
+}
+
+// stopSaveQueue finishes all waiting jobs, later jobs are rejected
+static void testStopDrainsQueue()
+{
+	int finished = 0;
+	for (int i = 0; i < SAVEQUEUEMAXJOBS; i++)
+	{
+		CHECK(enqueueSaveJob([&finished] {
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			finished++;
+		}));
+	}
+	stopSaveQueue();
+	CHECKEQUAL(finished, SAVEQUEUEMAXJOBS);
+	CHECKEQUAL(getSaveQueueStatistics().depth, 0);
+	CHECK(!enqueueSaveJob([&finished] { finished++; }));
+	stopSaveQueue(); // Second stop does nothing
+	CHECKEQUAL(finished, SAVEQUEUEMAXJOBS);
+}
+
+int main()
+{
+	testOrder();
+	testFullQueue();
+	testStopDrainsQueue();
+	return testResult();
+}
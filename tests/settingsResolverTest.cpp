@@ -0,0 +1,181 @@
+/*+===================================================================
+  File:      settingsResolverTest.cpp
+
+  Summary:   Table driven tests of the precedence of the registry locations
+             (GPO, user settings, GPO recommended, program default) with
+             missing locations, rejected and out-of-range values
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "settingsResolver.h"
+#include "testCheck.h"
+
+#define UP (1u << settingSourceUserPolicy) // Found in the GPO path under HKCU
+#define MP (1u << settingSourceMachinePolicy) // Found in the GPO path under HKLM
+#define US (1u << settingSourceUser) // Found in the program settings under HKCU
+#define UR (1u << settingSourceUserRecommended) // Found in the GPO recommended path under HKCU
+#define MR (1u << settingSourceMachineRecommended) // Found in the GPO recommended path under HKLM
+
+#define DEFAULTVALUE 7 // Program default of the test setting
+
+// Test case for a DWORD setting
+struct RESOLVERCASE {
+	unsigned int found; // Registry locations with a value (bit mask)
+	bool bPolicyAllowed; // Setting supports GPO
+	SETTINGSOURCE expectedSource; // Expected registry location
+	bool bExpectedPolicy; // Expected GPO flag
+};
+
+static const RESOLVERCASE g_cases[] = {
+	// Nothing found
+	{ 0, true, settingSourceDefault, false },
+	{ 0, false, settingSourceDefault, false },
+	// Single location
+	{ UP, true, settingSourceUserPolicy, true },
+	{ MP, true, settingSourceMachinePolicy, true },
+	{ US, true, settingSourceUser, false },
+	{ UR, true, settingSourceUserRecommended, false },
+	{ MR, true, settingSourceMachineRecommended, false },
+	// GPO wins over user, user wins over recommended
+	{ UP | MP | US | UR | MR, true, settingSourceUserPolicy, true },
+	{ MP | US | UR | MR, true, settingSourceMachinePolicy, true },
+	{ US | UR | MR, true, settingSourceUser, false },
+	{ UR | MR, true, settingSourceUserRecommended, false },
+	{ UP | UR, true, settingSourceUserPolicy, true },
+	{ MP | MR, true, settingSourceMachinePolicy, true },
+	{ US | MR, true, settingSourceUser, false },
+	// HKCU wins over HKLM on the same level
+	{ UP | MP, true, settingSourceUserPolicy, true },
+	{ UR | MR | MP, true, settingSourceMachinePolicy, true },
+	// Settings without GPO support use only the user location
+	{ UP | MP | US | UR | MR, false, settingSourceUser, false },
+	{ UP | MP | UR | MR, false, settingSourceDefault, false },
+	{ US, false, settingSourceUser, false },
+};
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: getCandidates
+
+  Summary:   Creates DWORD candidates with a different value per location
+
+  Args:     unsigned int found
+              Registry locations with a value (bit mask)
+
+  Returns:  DWORDSETTINGCANDIDATES
+
+-----------------------------------------------------------------F-F*/
+static DWORDSETTINGCANDIDATES getCandidates(unsigned int found)
+{
+	DWORDSETTINGCANDIDATES candidates;
+	for (int source = 0; source < SETTINGSOURCES; source++)
+	{
+		candidates.bFound[source] = (found & (1u << source)) != 0;
+		candidates.value[source] = candidates.bFound[source] ? 100 + source : 0;
+	}
+	return candidates;
+}
+
+// Precedence table for DWORD settings
+static void testPrecedenceTable()
+{
+	for (const RESOLVERCASE& test : g_cases)
+	{
+		DWORDSETTINGCANDIDATES candidates = getCandidates(test.found);
+		bool bPolicy = !test.bExpectedPolicy;
+		uint32_t value = resolveDWORDSetting(candidates, test.bPolicyAllowed, DEFAULTVALUE, &bPolicy);
+		uint32_t expectedValue = (test.expectedSource == settingSourceDefault) ? DEFAULTVALUE : 100 + test.expectedSource;
+		SETTINGRESOLUTION resolution = resolveSettingSource(candidates.bFound, test.bPolicyAllowed);
+		if ((value != expectedValue) || (bPolicy != test.bExpectedPolicy) || (resolution.source != test.expectedSource))
+		{
+			fprintf(stderr, "found 0x%02x, policy allowed %d: value %u, policy %d\n", test.found, test.bPolicyAllowed, value, bPolicy);
+			CHECK(false);
+		}
+	}
+}
+
+// All combinations of found locations against the order of precedence
+static void testAllCombinations()
+{
+	const SETTINGSOURCE order[] = { settingSourceUserPolicy, settingSourceMachinePolicy, settingSourceUser, settingSourceUserRecommended, settingSourceMachineRecommended };
+	for (unsigned int found = 0; found <= SETTINGSOURCESALL; found++)
+	{
+		DWORDSETTINGCANDIDATES candidates = getCandidates(found);
+		SETTINGSOURCE expected = settingSourceDefault;
+		for (SETTINGSOURCE source : order)
+		{
+			if (found & (1u << source))
+			{
+				expected = source;
+				break;
+			}
+		}
+		SETTINGRESOLUTION resolution = resolveSettingSource(candidates.bFound, true);
+		CHECKEQUAL(resolution.source, expected);
+		CHECK(resolution.bPolicy == isPolicySettingSource(expected));
+		CHECKEQUAL(resolveSettingSource(candidates.bFound, false).source, (found & US) ? settingSourceUser : settingSourceDefault);
+	}
+}
+
+// Out-of-range values are returned unchanged (limits are checked by the caller), a value of 0 is a valid value
+static void testOutOfRangeValues()
+{
+	DWORDSETTINGCANDIDATES candidates;
+	bool bPolicy = false;
+	candidates.bFound[settingSourceMachinePolicy] = true;
+	candidates.value[settingSourceMachinePolicy] = 0xFFFFFFFF;
+	candidates.bFound[settingSourceUser] = true;
+	candidates.value[settingSourceUser] = 1;
+	CHECKEQUAL(resolveDWORDSetting(candidates, true, DEFAULTVALUE, &bPolicy), 0xFFFFFFFF);
+	CHECK(bPolicy);
+
+	candidates.value[settingSourceMachinePolicy] = 0;
+	CHECKEQUAL(resolveDWORDSetting(candidates, true, DEFAULTVALUE, &bPolicy), 0);
+	CHECKEQUAL(resolveDWORDSetting(candidates, true, DEFAULTVALUE), 0); // Without GPO flag
+
+	candidates.bFound[settingSourceMachinePolicy] = false;
+	candidates.value[settingSourceUser] = 0x80000000;
+	CHECKEQUAL(resolveDWORDSetting(candidates, true, DEFAULTVALUE, &bPolicy), 0x80000000);
+	CHECK(!bPolicy);
+}
+
+// Rejected values (e.g. a screenshot folder, which does not exist) fall back to the next level
+static void testRejectedValues()
+{
+	bool found[SETTINGSOURCES] = { true, false, true, false, true };
+	SETTINGRESOLUTION resolution;
+
+	// Rejected GPO falls back to GPO recommended (not to the user value), but stays a GPO setting
+	resolution = resolveSettingSource(found, true, [](SETTINGSOURCE source) { return source != settingSourceUserPolicy; });
+	CHECKEQUAL(resolution.source, settingSourceMachineRecommended);
+	CHECK(resolution.bPolicy);
+
+	// First found value of a level is used or rejected as a whole
+	bool recommended[SETTINGSOURCES] = { false, false, true, true, true };
+	resolution = resolveSettingSource(recommended, true, [](SETTINGSOURCE source) { return source == settingSourceMachineRecommended; });
+	CHECKEQUAL(resolution.source, settingSourceDefault);
+	CHECK(!resolution.bPolicy);
+
+	// Rejected user value falls back to GPO recommended
+	resolution = resolveSettingSource(recommended, true, [](SETTINGSOURCE source) { return source != settingSourceUser; });
+	CHECKEQUAL(resolution.source, settingSourceUserRecommended);
+
+	// All rejected
+	resolution = resolveSettingSource(found, true, [](SETTINGSOURCE) { return false; });
+	CHECKEQUAL(resolution.source, settingSourceDefault);
+	CHECK(resolution.bPolicy);
+	resolution = resolveSettingSource(found, false, [](SETTINGSOURCE) { return false; });
+	CHECKEQUAL(resolution.source, settingSourceDefault);
+	CHECK(!resolution.bPolicy);
+}
+
+int main()
+{
+	testPrecedenceTable();
+	testAllCombinations();
+	testOutOfRangeValues();
+	testRejectedValues();
+	return testResult();
+}
@@ -0,0 +1,38 @@
+/*+===================================================================
+  File:      testCheck.h
+
+  Summary:   Minimal check macros for the unit tests. A failed check prints
+             file, line and condition and lets the test continue, main
+             returns testResult() for ctest.
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#pragma once
+
+#include <cstdio>
+
+inline int g_testFailures = 0; // Failed checks
+
+#define CHECK(condition) do { if (!(condition)) { fprintf(stderr, "%s(%d): CHECK(%s) failed\n", __FILE__, __LINE__, #condition); g_testFailures++; } } while (0)
+#define CHECKEQUAL(actual, expected) do { long long actualValue = (long long)(actual), expectedValue = (long long)(expected); if (actualValue != expectedValue) { fprintf(stderr, "%s(%d): CHECKEQUAL(%s, %s) failed: %lld != %lld\n", __FILE__, __LINE__, #actual, #expected, actualValue, expectedValue); g_testFailures++; } } while (0)
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: testResult
+
+  Summary:   Prints the number of failed checks and gets the exit code
+
+  Args:
+
+  Returns:  int
+              0 = all checks passed
+              1 = at least one check failed
+
+-----------------------------------------------------------------F-F*/
+inline int testResult()
+{
+	if (g_testFailures > 0) fprintf(stderr, "%d check(s) failed\n", g_testFailures);
+	return (g_testFailures > 0) ? 1 : 0;
+}
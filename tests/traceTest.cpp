@@ -0,0 +1,265 @@
+/*+===================================================================
+  File:      traceTest.cpp
+
+  Summary:   Tests of the trace writer: events of two threads, JSON syntax,
+             escaping of event names, thread ids and dropped events
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "testCheck.h"
+#include "trace.h"
+#include <cctype>
+#include <cstring>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Parsed JSON value
+struct JSONVALUE {
+	enum { jsonNull, jsonBool, jsonNumber, jsonString, jsonArray, jsonObject } type = jsonNull;
+	double number = 0; // Value of numbers and booleans
+	std::string text; // Value of strings (UTF-8)
+	std::vector<JSONVALUE> items; // Items of arrays
+	std::map<std::string, JSONVALUE> members; // Members of objects
+};
+
+// Strict JSON parser (RFC 8259) for the output of writeTraceJSON
+struct JSONPARSER {
+	const std::string& json; // Text
+	size_t position = 0; // Next character
+
+	// Skips white space
+	void skipSpace()
+	{
+		while ((position < json.size()) && ((json[position] == ' ') || (json[position] == '\t') || (json[position] == '\n') || (json[position] == '\r'))) position++;
+	}
+
+	// Skips the text, when it follows
+	bool expect(const char* pText)
+	{
+		size_t length = strlen(pText);
+		if (json.compare(position, length, pText) != 0) return false;
+		position += length;
+		return true;
+	}
+
+	// Parses a string with escape sequences
+	bool parseString(std::string& text)
+	{
+		if (!expect("\"")) return false;
+		while (position < json.size())
+		{
+			unsigned char c = (unsigned char)json[position++];
+			if (c == '"') return true;
+			if (c < 0x20) return false; // Control characters must be escaped
+			if (c != '\\')
+			{
+				text.push_back((char)c);
+				continue;
+			}
+			if (position >= json.size()) return false;
+			char escape = json[position++];
+			switch (escape)
+			{
+				case '"': text.push_back('"'); break;
+				case '\\': text.push_back('\\'); break;
+				case '/': text.push_back('/'); break;
+				case 'b': text.push_back('\b'); break;
+				case 'f': text.push_back('\f'); break;
+				case 'n': text.push_back('\n'); break;
+				case 'r': text.push_back('\r'); break;
+				case 't': text.push_back('\t'); break;
+				case 'u':
+				{
+					if (position + 4 > json.size()) return false;
+					unsigned int code = (unsigned int)std::stoul(json.substr(position, 4), nullptr, 16);
+					position += 4;
+					if (code >= 0x80) return false; // Only ASCII control characters are escaped by the writer
+					text.push_back((char)code);
+					break;
+				}
+				default: return false;
+			}
+		}
+		return false;
+	}
+
+	// Parses an object, array, string, number or literal
+	bool parseValue(JSONVALUE& value)
+	{
+		skipSpace();
+		if (position >= json.size()) return false;
+		char c = json[position];
+		if (c == '{')
+		{
+			position++;
+			value.type = JSONVALUE::jsonObject;
+			skipSpace();
+			if (expect("}")) return true;
+			do {
+				std::string name;
+				skipSpace();
+				if (!parseString(name)) return false;
+				skipSpace();
+				if (!expect(":")) return false;
+				if (!parseValue(value.members[name])) return false;
+				skipSpace();
+			} while (expect(","));
+			return expect("}");
+		}
+		if (c == '[')
+		{
+			position++;
+			value.type = JSONVALUE::jsonArray;
+			skipSpace();
+			if (expect("]")) return true;
+			do {
+				value.items.emplace_back();
+				if (!parseValue(value.items.back())) return false;
+				skipSpace();
+			} while (expect(","));
+			return expect("]");
+		}
+		if (c == '"')
+		{
+			value.type = JSONVALUE::jsonString;
+			return parseString(value.text);
+		}
+		if (expect("true") || expect("false") || expect("null"))
+		{
+			value.type = JSONVALUE::jsonBool;
+			return true;
+		}
+		size_t start = position;
+		if ((position < json.size()) && (json[position] == '-')) position++;
+		while ((position < json.size()) && (isdigit((unsigned char)json[position]) || (json[position] == '.') || (json[position] == 'e') || (json[position] == 'E') || (json[position] == '+') || (json[position] == '-'))) position++;
+		if ((position == start) || !isdigit((unsigned char)json[position - 1])) return false;
+		value.type = JSONVALUE::jsonNumber;
+		value.number = std::stod(json.substr(start, position - start));
+		return true;
+	}
+};
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: writeAndParseTrace
+
+  Summary:   Writes the recorded events as JSON and parses the output
+
+  Args:     JSONVALUE &root
+              Parsed JSON object (call by ref)
+
+  Returns:  bool
+              true = written and valid JSON
+              false = write error or invalid JSON
+
+-----------------------------------------------------------------F-F*/
+static bool writeAndParseTrace(JSONVALUE& root)
+{
+	std::string json;
+	if (!writeTraceJSON([&](const char* pData, size_t size) { json.append(pData, size); return true; })) return false;
+	JSONPARSER parser = { json };
+	if (!parser.parseValue(root)) return false;
+	parser.skipSpace();
+	return (parser.position == json.size()) && (root.type == JSONVALUE::jsonObject);
+}
+
+// Disabled tracing records nothing
+static void testDisabled()
+{
+	enableTrace(false);
+	clearTrace();
+	{
+		TRACESCOPE scope("disabled");
+	}
+	addTraceEvent("disabled", "test", 0, 1);
+	CHECKEQUAL(getTraceEventCount(), 0);
+	CHECK(!isTraceEnabled());
+}
+
+// Events of two threads with escaped names and stable thread ids
+static void testTwoThreads()
+{
+	const std::string specialName = std::string("quote\" backslash\\ newline\n tab\t bell\x07 end\x1f");
+	enableTrace(true);
+	auto record = [&](const char* pPrefix) {
+		for (int i = 0; i < 50; i++)
+		{
+			TRACESCOPE scope(pPrefix, "test");
+		}
+		addTraceEvent(std::string(pPrefix) + specialName, "test", getTraceMicroseconds(), 5);
+	};
+	std::thread first(record, "first");
+	std::thread second(record, "second");
+	first.join();
+	second.join();
+	CHECKEQUAL(getTraceEventCount(), 102);
+
+	JSONVALUE root;
+	CHECK(writeAndParseTrace(root));
+	const JSONVALUE& events = root.members["traceEvents"];
+	CHECK(events.type == JSONVALUE::jsonArray);
+	CHECKEQUAL(events.items.size(), 102);
+	CHECKEQUAL(root.members["otherData"].members["droppedEvents"].number, 0);
+
+	std::map<std::string, std::vector<double>> threadIds; // Thread ids per prefix
+	int specialNames = 0;
+	for (const JSONVALUE& event : events.items)
+	{
+		std::map<std::string, JSONVALUE> members = event.members;
+		CHECK(members["ph"].text == "X");
+		CHECK(members["cat"].text == "test");
+		CHECK(members["ts"].type == JSONVALUE::jsonNumber);
+		CHECK(members["dur"].number >= 0);
+		std::string name = members["name"].text;
+		std::string prefix = (name.compare(0, 5, "first") == 0) ? "first" : "second";
+		if (name == prefix + specialName) specialNames++;
+		else CHECK(name == prefix);
+		threadIds[prefix].push_back(members["tid"].number);
+	}
+	CHECKEQUAL(specialNames, 2); // Names are unchanged after escaping and parsing
+	CHECKEQUAL(threadIds.size(), 2);
+	for (auto& thread : threadIds)
+		for (double threadId : thread.second) CHECK(threadId == thread.second.front()); // Same id for all events of a thread
+	if ((threadIds["first"].size() > 0) && (threadIds["second"].size() > 0)) CHECK(threadIds["first"].front() != threadIds["second"].front());
+
+	// Events stay recorded, so the output can be written again
+	JSONVALUE again;
+	CHECK(writeAndParseTrace(again));
+	CHECKEQUAL(again.members["traceEvents"].items.size(), 102);
+}
+
+// Events beyond TRACEMAXEVENTS are counted as dropped
+static void testDroppedEvents()
+{
+	enableTrace(true);
+	for (int i = 0; i < TRACEMAXEVENTS + 25; i++) addTraceEvent("event", "test", i, 1);
+	CHECKEQUAL(getTraceEventCount(), TRACEMAXEVENTS);
+	CHECKEQUAL(getDroppedTraceEventCount(), 25);
+
+	JSONVALUE root;
+	CHECK(writeAndParseTrace(root));
+	CHECKEQUAL(root.members["traceEvents"].items.size(), TRACEMAXEVENTS);
+	CHECKEQUAL(root.members["otherData"].members["droppedEvents"].number, 25);
+
+	// Write error stops the output
+	int calls = 0;
+	CHECK(!writeTraceJSON([&](const char*, size_t) { calls++; return false; }));
+	CHECKEQUAL(calls, 1);
+
+	enableTrace(true); // Enabling clears the events
+	CHECKEQUAL(getTraceEventCount(), 0);
+	CHECKEQUAL(getDroppedTraceEventCount(), 0);
+	enableTrace(false);
+}
+
+int main()
+{
+	testDisabled();
+	testTwoThreads();
+	testDroppedEvents();
+	return testResult();
+}
@@ -0,0 +1,85 @@
+/*+===================================================================
+  File:      workerPoolTest.cpp
+
+  Summary:   Tests of the worker pool: each task runs once, several callers
+             at the same time and a caller is not blocked by the tasks of
+             another caller (worker threads are only started on multi-core
+             machines, otherwise the calling thread runs all tasks)
+
+  License: CC0
+  Copyright (c) 2024-2025 codingABI
+
+===================================================================+*/
+
+#include "testCheck.h"
+#include "workerPool.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+// Each task runs exactly once, also with several callers at the same time
+static void testConcurrentCallers()
+{
+	std::atomic<int> failures{ 0 };
+	std::vector<std::thread> callers;
+	for (int caller = 0; caller < 4; caller++)
+	{
+		callers.emplace_back([caller, &failures] {
+			for (int i = 0; i < 2000; i++)
+			{
+				int taskCount = 1 + (i + caller) % 13;
+				std::vector<std::atomic<int>> calls(taskCount);
+				for (auto& count : calls) count = 0;
+				runWorkerTasks(taskCount, [&](int task) { calls[task]++; });
+				for (auto& count : calls)
+					if (count != 1) failures++;
+			}
+		});
+	}
+	for (std::thread& caller : callers) caller.join();
+	CHECKEQUAL(failures.load(), 0);
+}
+
+// A caller does not wait for the tasks of another caller, which are still running
+static void testIndependentCallers()
+{
+	std::atomic<bool> bRelease{ false };
+	std::atomic<int> blockedTasks{ 0 };
+	std::thread longCaller([&] {
+		runWorkerTasks(getWorkerThreadCount() * 2, [&](int) {
+			blockedTasks++;
+			for (int i = 0; (i < 10000) && !bRelease; i++) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		});
+	});
+	while (blockedTasks == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+	std::atomic<int> calls{ 0 };
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	runWorkerTasks(8, [&](int) { calls++; });
+	double time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	bRelease = true;
+	longCaller.join();
+
+	CHECKEQUAL(calls.load(), 8);
+	CHECK(time < 1000);
+}
+
+// Tasks can call runWorkerTasks
+static void testNestedCalls()
+{
+	std::atomic<int> calls{ 0 };
+	runWorkerTasks(4, [&](int) { runWorkerTasks(3, [&](int) { calls++; }); });
+	CHECKEQUAL(calls.load(), 12);
+}
+
+int main()
+{
+	CHECK(getWorkerThreadCount() >= 1);
+	CHECK(getWorkerThreadCount() <= WORKERPOOLMAXTHREADS);
+	runWorkerTasks(0, [](int) { CHECK(false); });
+	testConcurrentCallers();
+	testIndependentCallers();
+	testNestedCalls();
+	return testResult();
+}